@@ -0,0 +1,221 @@
+#pragma once
+#ifndef BENCH_SUPPORT_H
+#define BENCH_SUPPORT_H
+
+#include "t_manager/ItemManager.h"
+#include "utils/AllocationCounter.hpp"
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+// :::Benchmark support
+// :::Shared by the bench_* targets: synthetic stores, the sink that takes the library's console
+// :::output (and can tell when an async call has logged its completion), peak RSS, and main.
+// :::POSIX only (/proc, dup2).
+// **************************************************************************************************
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+namespace bench {
+
+    inline size_t envOr(const char* name, size_t fallback) {
+        const char* value = std::getenv(name);
+        return value && *value ? static_cast<size_t>(std::strtoull(value, nullptr, 10)) : fallback;
+    }
+
+    inline std::string tagOf(size_t i) {
+        return "item" + std::to_string(i);
+    }
+
+    // A store of `items` items of T made by `make(i)`, imported from a generated JSON file: addItem
+    // copies the store into the undo history on every call, an import does it once.
+    template<typename T, typename Make>
+    std::unique_ptr<ItemManager> generateStore(size_t items, Make make) {
+        static std::atomic<unsigned> generated{0};
+        const auto file = std::filesystem::temp_directory_path() /
+                          ("smartstore_bench_" + std::to_string(items) + "_" + std::to_string(generated++) + ".json");
+        {
+            const std::string type = typeid(T).name();
+            std::ofstream out(file, std::ios::binary);
+            out << "[";
+            for (size_t i = 0; i < items; ++i) {
+                const std::string tag = tagOf(i);
+                nlohmann::json entry = {{"id", tag}, {"tag", tag}, {"type", type},
+                                        {"data", {{"id", tag}, {"tag", tag}, {"type", type}, {"data", make(i)}}}};
+                out << (i ? ",\n" : "\n") << entry.dump();
+            }
+            out << "\n]";
+        }
+        auto store = std::make_unique<ItemManager>();
+        store->importFromFile_Json(file.string());
+        std::filesystem::remove(file);
+        return store;
+    }
+
+    // :::: Library output
+
+    // Takes everything the library prints. Armed with a marker, it records when that text goes by,
+    // which is how the end of a fire-and-forget async call is seen.
+    class OutputWatch : public std::streambuf {
+        public:
+            // Call while nothing else is printing.
+            void arm(std::string marker) {
+                marker_ = std::move(marker);
+                window_.clear();
+                seen_.store(false, std::memory_order_relaxed);
+            }
+
+            void disarm() { marker_.clear(); }
+
+            // Waits for the marker; false after `timeout`.
+            bool wait(std::chrono::seconds timeout = std::chrono::seconds(600)) const {
+                const auto deadline = std::chrono::steady_clock::now() + timeout;
+                while (!seen_.load(std::memory_order_acquire)) {
+                    if (std::chrono::steady_clock::now() > deadline) return false;
+                    std::this_thread::yield();
+                }
+                return true;
+            }
+
+        protected:
+            int overflow(int c) override {
+                if (c != traits_type::eof() && !marker_.empty()) {
+                    const char ch = static_cast<char>(c);
+                    scan(&ch, 1);
+                }
+                return traits_type::not_eof(c);
+            }
+
+            std::streamsize xsputn(const char* s, std::streamsize n) override {
+                if (!marker_.empty()) scan(s, static_cast<size_t>(n));
+                return n;
+            }
+
+        private:
+            void scan(const char* s, size_t n) {
+                const size_t from = window_.size() < marker_.size() ? 0 : window_.size() - marker_.size() + 1;
+                window_.append(s, n);
+                if (window_.find(marker_, from) != std::string::npos) {
+                    seen_.store(true, std::memory_order_release);
+                    window_.clear();
+                } else if (window_.size() > 4096) {
+                    window_.erase(0, window_.size() - marker_.size());
+                }
+            }
+
+            std::string marker_;
+            std::string window_;
+            std::atomic<bool> seen_{false};
+    };
+
+    inline OutputWatch& libraryOutput() {
+        static OutputWatch watch;
+        return watch;
+    }
+
+    // :::: Memory
+
+    // Resident set size from /proc/self/status: the current one, or the peak (VmHWM) since the last
+    // resetPeakRss, which is the peak of the whole process where /proc/self/clear_refs cannot be
+    // written. 0 where /proc is not available.
+    inline uint64_t rssBytes(bool peak = false) {
+        std::ifstream status("/proc/self/status");
+        const std::string key = peak ? "VmHWM:" : "VmRSS:";
+        for (std::string line; std::getline(status, line);) {
+            if (line.compare(0, key.size(), key) == 0) return std::strtoull(line.c_str() + key.size(), nullptr, 10) * 1024;
+        }
+        return 0;
+    }
+
+    inline void resetPeakRss() {
+        std::ofstream("/proc/self/clear_refs") << "5";
+    }
+
+    // :::: Allocations
+
+    // Heap allocations per iteration made on the benchmark's thread(s) since `scope`; reported only
+    // by a target that defines SMARTSTORE_ALLOCATION_HOOK before including this header.
+    inline void reportAllocations(benchmark::State& state, const AllocationScope& scope) {
+        if (!allocationCountingEnabled) return;
+        const AllocationCount count = scope.counted();
+        state.counters["allocs_per_op"] = benchmark::Counter(static_cast<double>(count.allocations), benchmark::Counter::kAvgIterations);
+        state.counters["alloc_bytes_per_op"] = benchmark::Counter(static_cast<double>(count.bytes), benchmark::Counter::kAvgIterations);
+    }
+
+    // :::: main
+
+    // Console output for the reporter, through a FILE* of its own.
+    class FileOutput : public std::streambuf {
+        public:
+            explicit FileOutput(std::FILE* file) : file_(file) {}
+
+        protected:
+            int overflow(int c) override {
+                return c == traits_type::eof() ? traits_type::not_eof(c) : std::fputc(c, file_);
+            }
+
+            std::streamsize xsputn(const char* s, std::streamsize n) override {
+                return static_cast<std::streamsize>(std::fwrite(s, 1, static_cast<size_t>(n), file_));
+            }
+
+            int sync() override { return std::fflush(file_); }
+
+        private:
+            std::FILE* file_;
+    };
+
+    // Registers with `registerAll`, then runs with the results on stdout (and in --benchmark_out) and
+    // the library's own output taken by libraryOutput(). What it prints with printf (the binary hex
+    // dumps) is sent to /dev/null with the rest of file descriptor 1.
+    inline int runBenchmarks(int argc, char** argv, const std::function<void()>& registerAll) {
+        benchmark::Initialize(&argc, argv);
+        if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+        registerAll();
+
+        // Honours --benchmark_format and --benchmark_color; decides on colour while stdout is still the console.
+        benchmark::BenchmarkReporter* reporter = benchmark::CreateDefaultDisplayReporter();
+
+        std::fflush(stdout);
+        const int consoleFd = ::dup(STDOUT_FILENO);
+        std::FILE* consoleFile = consoleFd >= 0 ? ::fdopen(consoleFd, "w") : nullptr;
+        const int nullFd = consoleFile ? ::open("/dev/null", O_WRONLY) : -1;
+        if (nullFd >= 0) ::dup2(nullFd, STDOUT_FILENO);
+
+        FileOutput consoleBuffer(nullFd >= 0 ? consoleFile : stdout);
+        std::ostream console(&consoleBuffer);
+        reporter->SetOutputStream(&console);
+        reporter->SetErrorStream(&std::cerr);
+        std::streambuf* stdoutBuffer = std::cout.rdbuf(&libraryOutput());
+
+        benchmark::RunSpecifiedBenchmarks(reporter);
+
+        std::cout.rdbuf(stdoutBuffer);
+        console.flush();
+        std::fflush(stdout);
+        if (nullFd >= 0) {
+            ::dup2(consoleFd, STDOUT_FILENO);
+            ::close(nullFd);
+        }
+        if (consoleFile) std::fclose(consoleFile);
+        else if (consoleFd >= 0) ::close(consoleFd);
+        benchmark::Shutdown();
+        return 0;
+    }
+
+}  // namespace bench
+
+#endif // BENCH_SUPPORT_H
@@ -0,0 +1,565 @@
+//     ::::::::::::::::::::::::::::::::::::::::::::
+//     :: *  © 2025 Victor. All rights reserved. ::
+//     :: *  Smart_Store Framework               ::
+//     :: *  Licensed under the MIT License      ::
+//     ::::::::::::::::::::::::::::::::::::::::::::
+
+// ::::| bench_Formats: export and import throughput of the four file formats
+// ***************************************************************************
+// Every format (JSON, binary, XML, CSV) against every payload shape (an arithmetic value, a 256-byte
+// string, a flat `to_json` struct, a nested struct and a 4096-element array), all generated here:
+//     Export/<fmt>/<shape>          exportToFile_* of a shared store
+//     Import/<fmt>/<shape>          importFromFile_* into an empty manager
+//     AsyncExport, AsyncImport      the async* variants, timed until they log their completion
+//     SingleImport/<fmt>/<shape>    importSingleObject_* of the item at 0..100% of the file, with and
+//     AsyncSingleImport             without the tag index sidecar (setExportTagIndex)
+// Reported as bytes/s (of the file) and items/s, with the file size and the peak resident set size
+// reached during the benchmark (absolute, and above what was resident when it started). A format and
+// shape the library cannot read back is reported as an error with the library's message; as of now
+// that is XML with non-object payloads, and single-object CSV imports of strings.
+//
+// Environment caps:
+//     SMARTSTORE_BENCH_FORMAT_ITEMS       items per store (default 10000)
+//     SMARTSTORE_BENCH_MAX_PAYLOAD_MB     largest store payload; larger shapes get fewer items (default 64)
+//     SMARTSTORE_BENCH_ASYNC_TIMEOUT_S    wait for an async call before giving up (default 300)
+//
+// JSON results for tracking over time:
+//     bench_Formats --benchmark_out=bench_Formats.json --benchmark_out_format=json
+
+#include "BenchSupport.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <regex>
+#include <string>
+#include <system_error>
+#include <vector>
+
+using json = nlohmann::json;
+using bench::envOr;
+using bench::tagOf;
+
+namespace {
+
+    // :::: Payload shapes
+
+    struct FlatRecord {
+        int id = 0;
+        std::string name;
+        double price = 0.0;
+        bool active = false;
+    };
+
+    void to_json(json& j, const FlatRecord& r) {
+        j = json{{"id", r.id}, {"name", r.name}, {"price", r.price}, {"active", r.active}};
+    }
+
+    void from_json(const json& j, FlatRecord& r) {
+        j.at("id").get_to(r.id);
+        j.at("name").get_to(r.name);
+        j.at("price").get_to(r.price);
+        j.at("active").get_to(r.active);
+    }
+
+    struct Address {
+        std::string street;
+        std::string city;
+        std::string zip;
+    };
+
+    struct OrderLine {
+        std::string sku;
+        int quantity = 0;
+        double price = 0.0;
+    };
+
+    struct Order {
+        int id = 0;
+        std::string customer;
+        Address shipTo;
+        std::vector<OrderLine> lines;
+    };
+
+    void to_json(json& j, const Address& a) {
+        j = json{{"street", a.street}, {"city", a.city}, {"zip", a.zip}};
+    }
+
+    void from_json(const json& j, Address& a) {
+        j.at("street").get_to(a.street);
+        j.at("city").get_to(a.city);
+        j.at("zip").get_to(a.zip);
+    }
+
+    void to_json(json& j, const OrderLine& l) {
+        j = json{{"sku", l.sku}, {"quantity", l.quantity}, {"price", l.price}};
+    }
+
+    void from_json(const json& j, OrderLine& l) {
+        j.at("sku").get_to(l.sku);
+        j.at("quantity").get_to(l.quantity);
+        j.at("price").get_to(l.price);
+    }
+
+    void to_json(json& j, const Order& o) {
+        j = json{{"id", o.id}, {"customer", o.customer}, {"shipTo", o.shipTo}, {"lines", o.lines}};
+    }
+
+    void from_json(const json& j, Order& o) {
+        j.at("id").get_to(o.id);
+        j.at("customer").get_to(o.customer);
+        j.at("shipTo").get_to(o.shipTo);
+        j.at("lines").get_to(o.lines);
+    }
+
+    struct Series {
+        std::string name;
+        std::vector<double> samples;
+    };
+
+    void to_json(json& j, const Series& s) {
+        j = json{{"name", s.name}, {"samples", s.samples}};
+    }
+
+    void from_json(const json& j, Series& s) {
+        j.at("name").get_to(s.name);
+        j.at("samples").get_to(s.samples);
+    }
+
+    template<typename T> T makePayload(size_t i);
+
+    template<> double makePayload<double>(size_t i) {
+        return static_cast<double>(i) * 1.25;
+    }
+
+    template<> std::string makePayload<std::string>(size_t i) {
+        return std::string(256, static_cast<char>('a' + i % 26));
+    }
+
+    template<> FlatRecord makePayload<FlatRecord>(size_t i) {
+        return {static_cast<int>(i), "record" + std::to_string(i), i * 0.5, i % 2 == 0};
+    }
+
+    template<> Order makePayload<Order>(size_t i) {
+        Order order{static_cast<int>(i), "customer" + std::to_string(i % 997),
+                    {std::to_string(i % 500) + " Main Street", "Springfield", std::to_string(10000 + i % 90000)}, {}};
+        for (int line = 0; line < 8; ++line) {
+            order.lines.push_back({"SKU-" + std::to_string((i + line) % 4096), line + 1, 9.99 + line});
+        }
+        return order;
+    }
+
+    template<> Series makePayload<Series>(size_t i) {
+        Series series{"series" + std::to_string(i), std::vector<double>(4096)};
+        for (size_t k = 0; k < series.samples.size(); ++k) series.samples[k] = static_cast<double>(i + k) / 8.0;
+        return series;
+    }
+
+    // :::: Formats
+
+    struct Format {
+        const char* name;
+        const char* extension;
+        bool (*exportTo)(const ItemManager&, const std::string&);
+        void (*asyncExportTo)(const ItemManager&, const std::string&);
+        bool (*importFrom)(ItemManager&, const std::string&);
+        void (*asyncImportFrom)(ItemManager&, const std::string&);
+        bool (*importSingle)(ItemManager&, const std::string&, const std::string&, const std::string&);
+        void (*asyncImportSingle)(ItemManager&, const std::string&, const std::string&, const std::string&);
+        // Last line logged by a successful async call (for the single-object import, the text before the tag).
+        const char* exportDone;
+        const char* importDone;
+        const char* singleDone;
+    };
+
+    const Format kFormats[] = {
+        {"json", ".json",
+         [](const ItemManager& m, const std::string& f) { m.exportToFile_Json(f); return true; },
+         [](const ItemManager& m, const std::string& f) { m.asyncExportToFile_Json(f); },
+         [](ItemManager& m, const std::string& f) { m.importFromFile_Json(f); return true; },
+         [](ItemManager& m, const std::string& f) { m.asyncImportFromFile_Json(f); },
+         [](ItemManager& m, const std::string& f, const std::string& type, const std::string& tag) {
+             return m.importSingleObject_Json(f, type, tag) != nullptr;
+         },
+         [](ItemManager& m, const std::string& f, const std::string& type, const std::string& tag) {
+             m.asyncImportSingleObject_Json(f, type, tag);
+         },
+         "items to file (atomically)", "Completed import of", "Async import of single item '"},
+        {"binary", ".bin",
+         [](const ItemManager& m, const std::string& f) { return m.exportToFile_Binary(f); },
+         [](const ItemManager& m, const std::string& f) { m.asyncExportToFile_Binary(f); },
+         [](ItemManager& m, const std::string& f) { return m.importFromFile_Binary(f); },
+         [](ItemManager& m, const std::string& f) { m.asyncImportFromFile_Binary(f); },
+         [](ItemManager& m, const std::string& f, const std::string& type, const std::string& tag) {
+             return m.importSingleObject_Binary(f, type, tag) != nullptr;
+         },
+         [](ItemManager& m, const std::string& f, const std::string& type, const std::string& tag) {
+             m.asyncImportSingleObject_Binary(f, type, tag);
+         },
+         "asyncExportToFile_Binary completed successfully", "asyncImportFromFile_Binary completed successfully",
+         "Async binary import of '"},
+        {"xml", ".xml",
+         [](const ItemManager& m, const std::string& f) { return m.exportToFile_XML(f); },
+         [](const ItemManager& m, const std::string& f) { m.asyncExportToFile_XML(f); },
+         [](ItemManager& m, const std::string& f) { return m.importFromFile_XML(f); },
+         [](ItemManager& m, const std::string& f) { m.asyncImportFromFile_XML(f); },
+         [](ItemManager& m, const std::string& f, const std::string& type, const std::string& tag) {
+             auto item = m.importSingleObject_XML(f, type, tag);
+             return item && *item;
+         },
+         [](ItemManager& m, const std::string& f, const std::string& type, const std::string& tag) {
+             m.asyncImportSingleObject_XML(f, type, tag);
+         },
+         "asyncExportToFile_XML completed successfully", "asyncImportFromFile_XML completed successfully",
+         "Async import of single item '"},
+        {"csv", ".csv",
+         [](const ItemManager& m, const std::string& f) { return m.exportToFile_CSV(f); },
+         [](const ItemManager& m, const std::string& f) { m.asyncExportToFile_CSV(f); },
+         [](ItemManager& m, const std::string& f) { return m.importFromFile_CSV(f); },
+         [](ItemManager& m, const std::string& f) { m.asyncImportFromFile_CSV(f); },
+         [](ItemManager& m, const std::string& f, const std::string& type, const std::string& tag) {
+             return m.importSingleObject_CSV(f, type, tag) != nullptr;
+         },
+         [](ItemManager& m, const std::string& f, const std::string& type, const std::string& tag) {
+             m.asyncImportSingleObject_CSV(f, type, tag);
+         },
+         "asyncExportToFile_CSV completed successfully", "asyncImportFromFile_CSV completed successfully",
+         "Async import of single item '"},
+    };
+
+    // :::: Stores and files
+
+    struct BenchLimits {
+        size_t items = envOr("SMARTSTORE_BENCH_FORMAT_ITEMS", 10'000);
+        size_t maxPayloadBytes = envOr("SMARTSTORE_BENCH_MAX_PAYLOAD_MB", 64) << 20;
+        std::chrono::seconds asyncTimeout{static_cast<long>(envOr("SMARTSTORE_BENCH_ASYNC_TIMEOUT_S", 300))};
+    };
+
+    const BenchLimits& limits() {
+        static const BenchLimits instance;
+        return instance;
+    }
+
+    std::filesystem::path workDir() {
+        static const std::filesystem::path dir = [] {
+            auto path = std::filesystem::temp_directory_path() / "smartstore_bench_formats";
+            std::filesystem::create_directories(path);
+            return path;
+        }();
+        return dir;
+    }
+
+    // Benchmarks are registered shape by shape, so only the latest shape's store is kept.
+    struct SharedStore {
+        std::mutex mutex;
+        std::unique_ptr<ItemManager> store;
+        std::string type;
+        size_t items = 0;
+    };
+
+    template<typename T>
+    ItemManager& sharedStore(size_t items) {
+        static SharedStore cache;
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        if (!cache.store || cache.type != typeid(T).name() || cache.items != items) {
+            cache.store.reset();
+            cache.store = bench::generateStore<T>(items, [](size_t i) { return makePayload<T>(i); });
+            cache.type = typeid(T).name();
+            cache.items = items;
+        }
+        return *cache.store;
+    }
+
+    // The export of `items` items of T in `format`, written once; with `indexed`, with its tag index sidecar.
+    template<typename T>
+    std::string exportedFile(const Format& format, size_t items, bool indexed) {
+        static std::mutex mutex;
+        static std::map<std::string, bool> written;
+        const std::string file = (workDir() / (std::string(format.name) + "_" + std::to_string(items) + "_" +
+                                               std::to_string(std::hash<std::string>{}(typeid(T).name())) +
+                                               (indexed ? "_indexed" : "") + format.extension)).string();
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!written[file]) {
+            ItemManager& store = sharedStore<T>(items);
+            store.setExportTagIndex(indexed);
+            try {
+                written[file] = format.exportTo(store, file);
+            } catch (const std::exception&) {
+                written[file] = false;
+            }
+            store.setExportTagIndex(false);
+        }
+        return written[file] ? file : std::string();
+    }
+
+    uint64_t fileSize(const std::string& file) {
+        std::error_code ec;
+        const auto size = std::filesystem::file_size(file, ec);
+        return ec ? 0 : size;
+    }
+
+    // Peak resident set size over the benchmark, absolute and above where it started.
+    class RssWatch {
+        public:
+            RssWatch() {
+                bench::resetPeakRss();
+                start_ = bench::rssBytes();
+            }
+
+            void report(benchmark::State& state) const {
+                const uint64_t peak = std::max(bench::rssBytes(true), start_);
+                state.counters["peak_rss_MB"] = peak / 1048576.0;
+                state.counters["rss_growth_MB"] = (peak - start_) / 1048576.0;
+            }
+
+        private:
+            uint64_t start_ = 0;
+    };
+
+    void reportFile(benchmark::State& state, uint64_t bytes, size_t items) {
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes));
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(items));
+        state.counters["file_MB"] = bytes / 1048576.0;
+    }
+
+    size_t itemsOf(const benchmark::State& state) {
+        return static_cast<size_t>(state.range(0));
+    }
+
+    // Runs `call`, turning a false result or an exception (the library throws on most errors) into a
+    // skipped benchmark.
+    template<typename Call>
+    bool attempt(benchmark::State& state, const char* what, Call&& call) {
+        try {
+            if (call()) return true;
+            state.SkipWithError((std::string(what) + " failed").c_str());
+        } catch (const std::exception& e) {
+            // The message is a whole log line: keep the text after the level, without colour codes.
+            std::string message = e.what();
+            message = std::regex_replace(message, std::regex("\x1b\\[[0-9;]*m|\n"), "");
+            if (const auto level = message.find(":::| "); level != std::string::npos) {
+                message.erase(0, message.find(':', level + 5) + 1);
+            }
+            state.SkipWithError((std::string(what) + " failed:" + message).c_str());
+        }
+        return false;
+    }
+
+    // :::: Whole-file export and import
+
+    template<typename T>
+    void BM_Export(benchmark::State& state, const Format* format) {
+        const size_t items = itemsOf(state);
+        const ItemManager& store = sharedStore<T>(items);
+        const std::string file = (workDir() / (std::string("out_") + format->name + format->extension)).string();
+        RssWatch rss;
+        for (auto _ : state) {
+            if (!attempt(state, "export", [&] { return format->exportTo(store, file); })) return;
+        }
+        rss.report(state);
+        reportFile(state, fileSize(file), items);
+    }
+
+    template<typename T>
+    void BM_AsyncExport(benchmark::State& state, const Format* format) {
+        const size_t items = itemsOf(state);
+        const ItemManager& store = sharedStore<T>(items);
+        const std::string file = (workDir() / (std::string("out_async_") + format->name + format->extension)).string();
+        // A failure inside the detached thread ends the process, so the synchronous export must work first.
+        if (exportedFile<T>(*format, items, false).empty()) {
+            state.SkipWithError("export failed");
+            return;
+        }
+        bench::OutputWatch& output = bench::libraryOutput();
+        RssWatch rss;
+        for (auto _ : state) {
+            output.arm(format->exportDone);
+            format->asyncExportTo(store, file);
+            if (!output.wait(limits().asyncTimeout)) {
+                output.disarm();
+                state.SkipWithError("async export did not complete");
+                return;
+            }
+        }
+        output.disarm();
+        rss.report(state);
+        reportFile(state, fileSize(file), items);
+    }
+
+    template<typename T>
+    void BM_Import(benchmark::State& state, const Format* format) {
+        const size_t items = itemsOf(state);
+        const std::string file = exportedFile<T>(*format, items, false);
+        if (file.empty()) {
+            state.SkipWithError("export failed");
+            return;
+        }
+        std::unique_ptr<ItemManager> store;
+        RssWatch rss;
+        for (auto _ : state) {
+            state.PauseTiming();
+            store = std::make_unique<ItemManager>();
+            state.ResumeTiming();
+            if (!attempt(state, "import", [&] { return format->importFrom(*store, file); })) return;
+        }
+        rss.report(state);
+        if (!store->hasItem(tagOf(items - 1))) {
+            state.SkipWithError("import did not load every item");
+            return;
+        }
+        reportFile(state, fileSize(file), items);
+    }
+
+    template<typename T>
+    void BM_AsyncImport(benchmark::State& state, const Format* format) {
+        const size_t items = itemsOf(state);
+        const std::string file = exportedFile<T>(*format, items, false);
+        if (file.empty()) {
+            state.SkipWithError("export failed");
+            return;
+        }
+        {
+            ItemManager probe;
+            if (!attempt(state, "import", [&] { return format->importFrom(probe, file); })) return;
+        }
+        bench::OutputWatch& output = bench::libraryOutput();
+        std::unique_ptr<ItemManager> store;
+        RssWatch rss;
+        for (auto _ : state) {
+            state.PauseTiming();
+            store = std::make_unique<ItemManager>();
+            output.arm(format->importDone);
+            state.ResumeTiming();
+            format->asyncImportFrom(*store, file);
+            if (!output.wait(limits().asyncTimeout)) {
+                // The import still runs against `store`, which must then outlive it.
+                output.disarm();
+                store.release();
+                state.SkipWithError("async import did not complete");
+                return;
+            }
+        }
+        output.disarm();
+        rss.report(state);
+        if (!store->hasItem(tagOf(items - 1))) {
+            state.SkipWithError("import did not load every item");
+            return;
+        }
+        reportFile(state, fileSize(file), items);
+    }
+
+    // :::: Single-object import, by position of the item in the file
+
+    // Arguments: items, position (percent of the way into the file), indexed (tag index sidecar).
+    template<typename T>
+    void BM_SingleImport(benchmark::State& state, const Format* format) {
+        const size_t items = itemsOf(state);
+        const std::string tag = tagOf((items - 1) * static_cast<size_t>(state.range(1)) / 100);
+        const std::string file = exportedFile<T>(*format, items, state.range(2) != 0);
+        if (file.empty()) {
+            state.SkipWithError("export failed");
+            return;
+        }
+        ItemManager store;
+        const std::string type = typeid(T).name();
+        for (auto _ : state) {
+            if (!attempt(state, "single-object import", [&] { return format->importSingle(store, file, type, tag); })) return;
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    template<typename T>
+    void BM_AsyncSingleImport(benchmark::State& state, const Format* format) {
+        const size_t items = itemsOf(state);
+        const std::string tag = tagOf((items - 1) * static_cast<size_t>(state.range(1)) / 100);
+        const std::string file = exportedFile<T>(*format, items, state.range(2) != 0);
+        if (file.empty()) {
+            state.SkipWithError("export failed");
+            return;
+        }
+        static ItemManager store;  // outlives a call that times out
+        const std::string type = typeid(T).name();
+        if (!attempt(state, "single-object import", [&] { return format->importSingle(store, file, type, tag); })) return;
+        bench::OutputWatch& output = bench::libraryOutput();
+        for (auto _ : state) {
+            output.arm(format->singleDone + tag + "'");
+            format->asyncImportSingle(store, file, type, tag);
+            if (!output.wait(limits().asyncTimeout)) {
+                output.disarm();
+                state.SkipWithError("async import did not complete");
+                return;
+            }
+        }
+        output.disarm();
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // :::: Registration
+
+    struct Shape {
+        const char* name;
+        size_t approxBytes;  // payload of one item, to scale the store to the payload cap
+        void (*registerAll)(const std::string& shape, size_t items);
+    };
+
+    template<typename T>
+    void registerShape(const std::string& shape, size_t items) {
+        const std::vector<int64_t> positions = {0, 25, 50, 75, 100};
+        const int64_t n = static_cast<int64_t>(items);
+
+        for (const Format& format : kFormats) {
+            const std::string suffix = std::string("/") + format.name + "/" + shape;
+            benchmark::RegisterBenchmark(("Export" + suffix).c_str(), BM_Export<T>, &format)
+                ->Arg(n)->ArgName("items")->Unit(benchmark::kMillisecond)->UseRealTime();
+            benchmark::RegisterBenchmark(("AsyncExport" + suffix).c_str(), BM_AsyncExport<T>, &format)
+                ->Arg(n)->ArgName("items")->Unit(benchmark::kMillisecond)->UseRealTime();
+            benchmark::RegisterBenchmark(("Import" + suffix).c_str(), BM_Import<T>, &format)
+                ->Arg(n)->ArgName("items")->Unit(benchmark::kMillisecond)->UseRealTime();
+            benchmark::RegisterBenchmark(("AsyncImport" + suffix).c_str(), BM_AsyncImport<T>, &format)
+                ->Arg(n)->ArgName("items")->Unit(benchmark::kMillisecond)->UseRealTime();
+
+            for (const char* name : {"SingleImport", "AsyncSingleImport"}) {
+                auto* bench = benchmark::RegisterBenchmark((name + suffix).c_str(),
+                                                           name[0] == 'S' ? BM_SingleImport<T> : BM_AsyncSingleImport<T>, &format);
+                bench->ArgNames({"items", "position", "indexed"})->Unit(benchmark::kMicrosecond)->UseRealTime();
+                for (int64_t indexed : {0, 1}) {
+                    for (int64_t position : positions) bench->Args({n, position, indexed});
+                }
+            }
+        }
+    }
+
+    const Shape kShapes[] = {
+        {"double", sizeof(double), registerShape<double>},
+        {"string256", 256, registerShape<std::string>},
+        {"flat_struct", 64, registerShape<FlatRecord>},
+        {"nested_struct", 512, registerShape<Order>},
+        {"array4096", 4096 * sizeof(double), registerShape<Series>},
+    };
+
+    void registerBenchmarks() {
+        for (const Shape& shape : kShapes) {
+            const size_t items = std::max<size_t>(1, std::min(limits().items, limits().maxPayloadBytes / shape.approxBytes));
+            shape.registerAll(shape.name, items);
+        }
+    }
+
+}  // namespace
+
+SMART_STORE_REGISTER_TYPE(double, 1);
+SMART_STORE_REGISTER_TYPE(std::string, 1);
+SMART_STORE_REGISTER_TYPE(FlatRecord, 1);
+SMART_STORE_REGISTER_TYPE(Order, 1);
+SMART_STORE_REGISTER_TYPE(Series, 1);
+
+int main(int argc, char** argv) {
+    const int status = bench::runBenchmarks(argc, argv, [] {
+        benchmark::AddCustomContext("smartstore.format_items", std::to_string(limits().items));
+        benchmark::AddCustomContext("smartstore.max_payload_mb", std::to_string(limits().maxPayloadBytes >> 20));
+        registerBenchmarks();
+    });
+    std::error_code ec;
+    std::filesystem::remove_all(workDir(), ec);
+    return status;
+}
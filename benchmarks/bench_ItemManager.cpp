@@ -0,0 +1,353 @@
+//     ::::::::::::::::::::::::::::::::::::::::::::
+//     :: *  © 2025 Victor. All rights reserved. ::
+//     :: *  Smart_Store Framework               ::
+//     :: *  Licensed under the MIT License      ::
+//     ::::::::::::::::::::::::::::::::::::::::::::
+
+// ::::| bench_ItemManager: core ItemManager operations
+// ****************************************************
+// Reads (getItem, getItemRaw, hasItem, filterByTag, sortItemsByTag) run against a shared store of
+// 1k to 10M items, on 1 to 8 threads. Writes (addItem, modifyItem, removeByTag, undo/redo) run on a
+// fresh store each, single-threaded: every write copies the store into the undo history, so their
+// cost grows with the store and they get a smaller default cap. Payloads are `int`, `std::string`
+// and a `to_json` struct, at two sizes each. Each also reports its heap allocations per operation
+// (allocs_per_op, alloc_bytes_per_op; see utils/AllocationCounter.hpp).
+//
+// Environment caps (the full ranges take hours and tens of GB):
+//     SMARTSTORE_BENCH_MAX_ITEMS          largest read store (default 1000000; 10000000 for all)
+//     SMARTSTORE_BENCH_MAX_WRITE_ITEMS    largest write store (default 10000)
+//     SMARTSTORE_BENCH_MAX_PAYLOAD_MB     largest store payload, items x payload size (default 256)
+//     SMARTSTORE_BENCH_MAX_THREADS        most reader threads (default 8)
+//
+// JSON results for tracking over time:
+//     bench_ItemManager --benchmark_out=bench_ItemManager.json --benchmark_out_format=json
+// The library's console output is discarded while benchmarks run, so it is not what is measured.
+
+#define SMARTSTORE_ALLOCATION_HOOK   // allocs_per_op / alloc_bytes_per_op counters
+#include "BenchSupport.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using json = nlohmann::json;
+using bench::envOr;
+using bench::tagOf;
+
+namespace {
+
+    // :::: Payloads
+
+    struct BenchRecord {
+        std::string name;
+        std::vector<double> values;
+    };
+
+    void to_json(json& j, const BenchRecord& r) {
+        j = json{{"name", r.name}, {"values", r.values}};
+    }
+
+    void from_json(const json& j, BenchRecord& r) {
+        j.at("name").get_to(r.name);
+        j.at("values").get_to(r.values);
+    }
+
+    enum class Payload { Int, String, Struct };
+
+    const char* payloadName(Payload kind) {
+        switch (kind) {
+            case Payload::Int:    return "int";
+            case Payload::String: return "string";
+            case Payload::Struct: return "struct";
+        }
+        return "?";
+    }
+
+    template<typename T> T makePayload(size_t i, size_t bytes);
+
+    template<> int makePayload<int>(size_t i, size_t) {
+        return static_cast<int>(i);
+    }
+
+    template<> std::string makePayload<std::string>(size_t i, size_t bytes) {
+        return std::string(bytes, static_cast<char>('a' + i % 26));
+    }
+
+    template<> BenchRecord makePayload<BenchRecord>(size_t i, size_t bytes) {
+        return {"record" + std::to_string(i), std::vector<double>(std::max<size_t>(1, bytes / sizeof(double)), static_cast<double>(i))};
+    }
+
+    void touch(int& v) { ++v; }
+    void touch(std::string& v) { v[0] = v[0] == 'z' ? 'a' : static_cast<char>(v[0] + 1); }
+    void touch(BenchRecord& v) { v.values[0] += 1.0; }
+
+    // :::: Limits and stores
+
+    struct BenchLimits {
+        size_t maxItems = envOr("SMARTSTORE_BENCH_MAX_ITEMS", 1'000'000);
+        size_t maxWriteItems = envOr("SMARTSTORE_BENCH_MAX_WRITE_ITEMS", 10'000);
+        size_t maxPayloadBytes = envOr("SMARTSTORE_BENCH_MAX_PAYLOAD_MB", 256) << 20;
+        int maxThreads = static_cast<int>(envOr("SMARTSTORE_BENCH_MAX_THREADS", 8));
+    };
+
+    struct StoreKey {
+        size_t items = 0;
+        size_t bytes = 0;
+        std::string type;
+        bool operator==(const StoreKey& other) const { return items == other.items && bytes == other.bytes && type == other.type; }
+    };
+
+    template<typename T>
+    std::unique_ptr<ItemManager> buildStore(const StoreKey& key) {
+        return bench::generateStore<T>(key.items, [&](size_t i) { return makePayload<T>(i, key.bytes); });
+    }
+
+    // The read benchmarks of one store run back to back, so only the latest store is kept.
+    struct SharedStore {
+        std::mutex mutex;
+        std::unique_ptr<ItemManager> store;
+        StoreKey key;
+    };
+
+    SharedStore& sharedStoreCache() {
+        static SharedStore cache;
+        return cache;
+    }
+
+    template<typename T>
+    ItemManager& sharedStore(const StoreKey& key) {
+        SharedStore& cache = sharedStoreCache();
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        if (!cache.store || !(cache.key == key)) {
+            cache.store.reset();
+            cache.store = buildStore<T>(key);
+            cache.key = key;
+        }
+        return *cache.store;
+    }
+
+    // Tags of the store visited by readers, in a fixed pseudo-random order.
+    const std::vector<std::string>& sampleTags(size_t items) {
+        static std::mutex mutex;
+        static std::vector<std::string> tags;
+        static size_t builtFor = 0;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (builtFor != items) {
+            std::mt19937_64 rng(items);
+            tags.assign(std::min<size_t>(items, 1 << 14), {});
+            for (auto& tag : tags) tag = tagOf(rng() % items);
+            builtFor = items;
+        }
+        return tags;
+    }
+
+    template<typename T>
+    StoreKey keyOf(const benchmark::State& state) {
+        return {static_cast<size_t>(state.range(0)), static_cast<size_t>(state.range(1)), typeid(T).name()};
+    }
+
+    // :::: Reads, on a shared store
+
+    template<typename T>
+    void BM_GetItem(benchmark::State& state) {
+        const auto key = keyOf<T>(state);
+        ItemManager& store = sharedStore<T>(key);
+        const auto& tags = sampleTags(key.items);
+        size_t i = static_cast<size_t>(state.thread_index()) * 7919;
+        AllocationScope allocations;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(store.getItem<T>(tags[i++ % tags.size()]));
+        }
+        bench::reportAllocations(state, allocations);
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    template<typename T>
+    void BM_GetItemRaw(benchmark::State& state) {
+        const auto key = keyOf<T>(state);
+        const ItemManager& store = sharedStore<T>(key);
+        const auto& tags = sampleTags(key.items);
+        size_t i = static_cast<size_t>(state.thread_index()) * 7919;
+        AllocationScope allocations;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(&store.getItemRaw<T>(tags[i++ % tags.size()]));
+        }
+        bench::reportAllocations(state, allocations);
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    template<typename T>
+    void BM_HasItem(benchmark::State& state) {
+        const auto key = keyOf<T>(state);
+        const ItemManager& store = sharedStore<T>(key);
+        const auto& tags = sampleTags(key.items);
+        size_t i = static_cast<size_t>(state.thread_index()) * 7919;
+        AllocationScope allocations;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(store.hasItem(tags[i++ % tags.size()]));
+        }
+        bench::reportAllocations(state, allocations);
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    template<typename T>
+    void BM_FilterByTag(benchmark::State& state) {
+        const auto key = keyOf<T>(state);
+        const ItemManager& store = sharedStore<T>(key);
+        const auto& sample = sampleTags(key.items);
+        const std::vector<std::string> tags(sample.begin(), sample.begin() + std::min<size_t>(sample.size(), 64));
+        AllocationScope allocations;
+        for (auto _ : state) {
+            store.filterByTag(tags);
+        }
+        bench::reportAllocations(state, allocations);
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(tags.size()));
+    }
+
+    template<typename T>
+    void BM_SortItemsByTag(benchmark::State& state) {
+        const auto key = keyOf<T>(state);
+        const ItemManager& store = sharedStore<T>(key);
+        AllocationScope allocations;
+        for (auto _ : state) {
+            store.sortItemsByTag();
+        }
+        bench::reportAllocations(state, allocations);
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(key.items));
+    }
+
+    // :::: Writes, on a fresh store, a fixed number of times
+
+    constexpr int64_t kWriteIterations = 64;
+
+    template<typename T>
+    void BM_AddItem(benchmark::State& state) {
+        const auto key = keyOf<T>(state);
+        std::unique_ptr<ItemManager> store = buildStore<T>(key);
+        size_t i = 0;
+        AllocationScope allocations;
+        for (auto _ : state) {
+            store->addItem(std::make_shared<T>(makePayload<T>(i, key.bytes)), "new" + std::to_string(i));
+            ++i;
+        }
+        bench::reportAllocations(state, allocations);
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    template<typename T>
+    void BM_ModifyItem(benchmark::State& state) {
+        const auto key = keyOf<T>(state);
+        std::unique_ptr<ItemManager> store = buildStore<T>(key);
+        const auto& tags = sampleTags(key.items);
+        size_t i = 0;
+        AllocationScope allocations;
+        for (auto _ : state) {
+            store->modifyItem<T>(tags[i++ % tags.size()], [](T& value) { touch(value); });
+        }
+        bench::reportAllocations(state, allocations);
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    template<typename T>
+    void BM_RemoveByTag(benchmark::State& state) {
+        const auto key = keyOf<T>(state);
+        std::unique_ptr<ItemManager> store = buildStore<T>(key);
+        size_t i = 0;
+        AllocationScope allocations;
+        for (auto _ : state) {
+            store->removeByTag(tagOf(i++));
+        }
+        bench::reportAllocations(state, allocations);
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // One undo and one redo per iteration, so the store ends where it started.
+    template<typename T>
+    void BM_UndoRedo(benchmark::State& state) {
+        const auto key = keyOf<T>(state);
+        std::unique_ptr<ItemManager> store = buildStore<T>(key);
+        store->modifyItem<T>(tagOf(0), [](T& value) { touch(value); });
+        AllocationScope allocations;
+        for (auto _ : state) {
+            store->undo();
+            store->redo();
+        }
+        bench::reportAllocations(state, allocations);
+        state.SetItemsProcessed(state.iterations() * 2);
+    }
+
+    // :::: Registration
+
+    using BenchFn = void (*)(benchmark::State&);
+
+    struct PayloadCase {
+        Payload kind;
+        size_t bytes;
+        BenchFn reads[5];
+        BenchFn writes[4];
+    };
+
+    template<typename T>
+    PayloadCase payloadCase(Payload kind, size_t bytes) {
+        return {kind, bytes,
+                {&BM_GetItem<T>, &BM_GetItemRaw<T>, &BM_HasItem<T>, &BM_FilterByTag<T>, &BM_SortItemsByTag<T>},
+                {&BM_AddItem<T>, &BM_ModifyItem<T>, &BM_RemoveByTag<T>, &BM_UndoRedo<T>}};
+    }
+
+    constexpr const char* kReadNames[] = {"GetItem", "GetItemRaw", "HasItem", "FilterByTag", "SortItemsByTag"};
+    constexpr const char* kWriteNames[] = {"AddItem", "ModifyItem", "RemoveByTag", "UndoRedo"};
+
+    void registerBenchmarks(const BenchLimits& limits) {
+        const PayloadCase cases[] = {
+            payloadCase<int>(Payload::Int, sizeof(int)),
+            payloadCase<std::string>(Payload::String, 16),
+            payloadCase<std::string>(Payload::String, 1024),
+            payloadCase<BenchRecord>(Payload::Struct, 64),
+            payloadCase<BenchRecord>(Payload::Struct, 4096),
+        };
+
+        // Grouped by store so that each shared store is built once.
+        for (size_t items = 1000; items <= 10'000'000; items *= 10) {
+            for (const auto& c : cases) {
+                if (items * c.bytes > limits.maxPayloadBytes) continue;
+                const std::string suffix = std::string("/") + payloadName(c.kind) + "/" + std::to_string(c.bytes) + "B";
+                const std::vector<int64_t> args = {static_cast<int64_t>(items), static_cast<int64_t>(c.bytes)};
+
+                if (items <= limits.maxItems) {
+                    for (size_t op = 0; op < std::size(kReadNames); ++op) {
+                        auto* bench = benchmark::RegisterBenchmark((std::string(kReadNames[op]) + suffix).c_str(), c.reads[op]);
+                        bench->Args(args)->ArgNames({"items", "bytes"})->UseRealTime();
+                        if (op < 3) {
+                            for (int threads = 1; threads <= limits.maxThreads; threads *= 2) bench->Threads(threads);
+                        }
+                    }
+                }
+                if (items <= limits.maxWriteItems) {
+                    for (size_t op = 0; op < std::size(kWriteNames); ++op) {
+                        benchmark::RegisterBenchmark((std::string(kWriteNames[op]) + suffix).c_str(), c.writes[op])
+                            ->Args(args)->ArgNames({"items", "bytes"})->Iterations(kWriteIterations)->Unit(benchmark::kMicrosecond);
+                    }
+                }
+            }
+        }
+    }
+
+}  // namespace
+
+SMART_STORE_REGISTER_TYPE(int, 1);
+SMART_STORE_REGISTER_TYPE(std::string, 1);
+SMART_STORE_REGISTER_TYPE(BenchRecord, 1);
+
+int main(int argc, char** argv) {
+    return bench::runBenchmarks(argc, argv, [] {
+        const BenchLimits limits;
+        benchmark::AddCustomContext("smartstore.max_items", std::to_string(limits.maxItems));
+        benchmark::AddCustomContext("smartstore.max_write_items", std::to_string(limits.maxWriteItems));
+        benchmark::AddCustomContext("smartstore.max_payload_mb", std::to_string(limits.maxPayloadBytes >> 20));
+        registerBenchmarks(limits);
+    });
+}
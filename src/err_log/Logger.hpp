@@ -11,6 +11,8 @@
 #include <string>
 #include <ctime>
 #include <variant>
+#include <optional>
+#include <stdexcept>
 #include <source_location>
 
 #define LOG_CONTEXT(level, message, hint) \
@@ -101,12 +103,14 @@ class Logger {
 public:
 using ErrorHint = std::variant<std::monostate, std::nullptr_t, std::exception_ptr, int, std::string, std::optional<std::string>, bool>;
 
+    // Written piece by piece: a log line costs no allocation beyond its message.
     static void log_base(LogLevel level, const std::string& message) {
-        std::string prefix = getPrefix(level);
-        std::string timestamp = getTimestamp();
-        std::cout << getColorCode(LogColor::CYAN) + "[" + getColorCode(LogColor::RESET) << timestamp << 
-                     getColorCode(LogColor::CYAN) + "]" + getColorCode(LogColor::RESET) << prefix << " " + 
-                     getColorCode(LogColor::CYAN) << message << getColorCode(LogColor::RESET) << std::endl;
+        char timestamp[20];
+        formatTimestamp(timestamp);
+        std::cout << colorCode(LogColor::CYAN) << '[' << colorCode(LogColor::RESET) << timestamp <<
+                     colorCode(LogColor::CYAN) << ']' << colorCode(LogColor::RESET) <<
+                     levelColor(level) << levelLabel(level) << colorCode(LogColor::RESET) << ' ' <<
+                     colorCode(LogColor::CYAN) << message << colorCode(LogColor::RESET) << std::endl;
     }
 
    static void log_with_context(LogLevel level,
@@ -115,29 +119,33 @@ using ErrorHint = std::variant<std::monostate, std::nullptr_t, std::exception_pt
                              const char* /*file*/,
                              int  /*line*/,
                              const char* function) {
-    std::string context = " >> Function: " + getColorCode(LogColor::RESET) +
-                          getColorCode(LogColor::RED) +
-                          std::string(function) +
-                          getColorCode(LogColor::RESET);
+    // Built only by the hints that print it.
+    auto context = [function]() {
+        std::string text;
+        text.reserve(48 + std::char_traits<char>::length(function));
+        text.append(" >> Function: ").append(colorCode(LogColor::RESET)).append(colorCode(LogColor::RED))
+            .append(function).append(colorCode(LogColor::RESET));
+        return text;
+    };
 
     std::visit(overloaded{
         [&](std::monostate) {
             log_base(level, message + "  ");
         },
         [&](std::nullptr_t) {
-            log_base(level, message + " — Null detected. " + context);
+            log_base(level, message + " — Null detected. " + context());
         },
         [&](std::exception_ptr eptr) {
             try {
                 if (eptr) std::rethrow_exception(eptr);
             } catch (const std::exception& e) {
                 throw std::runtime_error(getStamp() + getPrefix(level) + " " + getColorCode(LogColor::CYAN) + 
-                                    message + " " + std::string(e.what()) + "\n" + context);
+                                    message + " " + std::string(e.what()) + "\n" + context());
             }
         },
         [&](int code) {
             throw std::runtime_error(getStamp() + getPrefix(level) + " " + getColorCode(LogColor::CYAN) + 
-                                    message + " — Code: " + std::to_string(code) + "\n" + context);
+                                    message + " — Code: " + std::to_string(code) + "\n" + context());
         },
         [&](const std::string& extra) {
             log_base(level, message + " — " + extra);
@@ -146,12 +154,12 @@ using ErrorHint = std::variant<std::monostate, std::nullptr_t, std::exception_pt
             if (opt.has_value()) {
                 log_base(level, message + " — " + opt.value());
             } else {
-                log_base(level, message + " — Optional value missing. " + context);
+                log_base(level, message + " — Optional value missing. " + context());
             }
         },
         [&](bool value) {
             std::string state = value ? "true" : "false";
-            log_base(level, message + " — Boolean value: " + state + " — " + context);
+            log_base(level, message + " — Boolean value: " + state + " — " + context());
         },
     }, hint);
     }
@@ -164,6 +172,11 @@ using ErrorHint = std::variant<std::monostate, std::nullptr_t, std::exception_pt
     
     // Returns a color code for terminal output
     static std::string getColorCode(LogColor color) {
+        return colorCode(color);
+    }
+
+private:
+    static const char* colorCode(LogColor color) {
         switch (color) {
             case LogColor::RED: return "\033[1;31m";
             case LogColor::GREEN: return "\033[1;32m";
@@ -176,27 +189,46 @@ using ErrorHint = std::variant<std::monostate, std::nullptr_t, std::exception_pt
         }
     }
 
-private:
+    // "YYYY-MM-DD HH:MM:SS" into `buf`
+    static void formatTimestamp(char (&buf)[20]) {
+        std::time_t now = std::time(nullptr);
+        std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", std::localtime(&now));
+    }
+
     // Returns the current timestamp in a formatted string
     static std::string getTimestamp() {
-        std::time_t now = std::time(nullptr);
         char buf[20];
-        std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", std::localtime(&now));
+        formatTimestamp(buf);
         return std::string(buf);
     }
 
-    // Returns a prefix string based on the log level
-    static std::string getPrefix(LogLevel level) {
+    static const char* levelColor(LogLevel level) {
+        switch (level) {
+            case LogLevel::INFO: return colorCode(LogColor::GREEN);
+            case LogLevel::WARNING:
+            case LogLevel::ERR: return colorCode(LogColor::RED);
+            case LogLevel::DEBUG: return colorCode(LogColor::MAGENTA);
+            case LogLevel::DISPLAY: return colorCode(LogColor::YELLOW);
+        }
+        return "";
+    }
+
+    static const char* levelLabel(LogLevel level) {
         switch (level) {
-            case LogLevel::INFO: return  getColorCode(LogColor::GREEN) + " :::| INFO:" + getColorCode(LogColor::RESET);
-            case LogLevel::WARNING: return getColorCode(LogColor::RED) +" :::| WARNING:"  + getColorCode(LogColor::RESET);
-            case LogLevel::ERR: return getColorCode(LogColor::RED) + " :::| ERROR:"  + getColorCode(LogColor::RESET);
-            case LogLevel::DEBUG: return getColorCode(LogColor::MAGENTA) + " :::| DEBUG:" + getColorCode(LogColor::RESET);
-            case LogLevel::DISPLAY: return getColorCode(LogColor::YELLOW) + " :::| DISPLAY_INFO:" + getColorCode(LogColor::RESET);
+            case LogLevel::INFO: return " :::| INFO:";
+            case LogLevel::WARNING: return " :::| WARNING:";
+            case LogLevel::ERR: return " :::| ERROR:";
+            case LogLevel::DEBUG: return " :::| DEBUG:";
+            case LogLevel::DISPLAY: return " :::| DISPLAY_INFO:";
         }
         return "LOG";
     }
 
+    // Returns a prefix string based on the log level
+    static std::string getPrefix(LogLevel level) {
+        return std::string(levelColor(level)) + levelLabel(level) + colorCode(LogColor::RESET);
+    }
+
     
 
 };
@@ -29,6 +29,9 @@ public:
     virtual json serialize() const = 0;
 
     virtual std::shared_ptr<BaseItem> clone() const = 0;
+
+    // Copy that keeps the id, used to copy-on-write an item still referenced by a snapshot.
+    virtual std::shared_ptr<BaseItem> cloneForWrite() const { return clone(); }
     
     virtual std::string getTag() const = 0;
     
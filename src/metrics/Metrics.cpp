@@ -0,0 +1,184 @@
+#include "Metrics.h"
+
+#include <algorithm>
+#include <bit>
+#include <iterator>
+#include <utility>
+
+// ::::| Metrics: per-operation counters, latency histograms, lock timing
+// ***********************************************************************
+
+namespace {
+    constexpr const char* kOpNames[] = {
+        "addItem", "emplaceItem", "tryEmplace", "insertOrAssign", "modifyItem", "removeByTag", "undo", "redo",
+        "getItem", "getItemRaw", "hasItem", "filterByTag", "sortItemsByTag", "snapshot",
+        "exportToFile_Json", "importFromFile_Json", "importSingleObject_Json",
+        "exportToFile_Binary", "importFromFile_Binary", "importSingleObject_Binary",
+        "exportToFile_XML", "importFromFile_XML", "importSingleObject_XML",
+        "exportToFile_CSV", "exportToFile_CSVColumnar", "importFromFile_CSV", "importSingleObject_CSV",
+        "exportChangesSince", "applyDeltaFromFile_Json", "checkpointToFile", "recoverFromSnapshot",
+    };
+    static_assert(std::size(kOpNames) == static_cast<size_t>(MetricOp::Count), "a MetricOp without a name");
+
+    void raiseTo(std::atomic<uint64_t>& slot, uint64_t value) noexcept {
+        uint64_t current = slot.load(std::memory_order_relaxed);
+        while (current < value && !slot.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+    }
+
+    void lowerTo(std::atomic<uint64_t>& slot, uint64_t value) noexcept {
+        uint64_t current = slot.load(std::memory_order_relaxed);
+        while (current > value && !slot.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+    }
+
+    std::chrono::steady_clock::rep nowTicks() {
+        return std::chrono::steady_clock::now().time_since_epoch().count();
+    }
+
+    nlohmann::json histogramJson(const HistogramSnapshot& h) {
+        return {{"count", h.count}, {"total_ns", h.totalNs}, {"mean_ns", h.meanNs()}, {"min_ns", h.minNs},
+                {"max_ns", h.maxNs}, {"p50_ns", h.p50Ns}, {"p90_ns", h.p90Ns}, {"p99_ns", h.p99Ns}, {"p999_ns", h.p999Ns}};
+    }
+}
+
+const char* metricOpName(MetricOp op) {
+    const auto index = static_cast<size_t>(op);
+    return index < std::size(kOpNames) ? kOpNames[index] : "unknown";
+}
+
+// :::: LatencyHistogram
+
+size_t LatencyHistogram::bucketOf(uint64_t nanoseconds) noexcept {
+    if (nanoseconds < kSubBuckets) return static_cast<size_t>(nanoseconds);
+    // The leading bit picks the power of two, the 4 bits below it the sub-bucket.
+    const unsigned msb = 63u - static_cast<unsigned>(std::countl_zero(nanoseconds));
+    const unsigned shift = msb - 4;
+    const size_t bucket = (shift + 1) * kSubBuckets + ((nanoseconds >> shift) & (kSubBuckets - 1));
+    return bucket < kBuckets ? bucket : kBuckets - 1;
+}
+
+uint64_t LatencyHistogram::upperBoundOf(size_t bucket) noexcept {
+    if (bucket < kSubBuckets) return bucket;
+    const unsigned shift = static_cast<unsigned>(bucket / kSubBuckets) - 1;
+    return ((uint64_t{kSubBuckets} + bucket % kSubBuckets + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t nanoseconds) noexcept {
+    buckets_[bucketOf(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    total_.fetch_add(nanoseconds, std::memory_order_relaxed);
+    lowerTo(min_, nanoseconds);
+    raiseTo(max_, nanoseconds);
+}
+
+HistogramSnapshot LatencyHistogram::snapshot() const {
+    // Buckets are read one by one while others may still record: the sum of the copied buckets is the
+    // count the percentiles are taken from, so they stay consistent with each other.
+    std::array<uint64_t, kBuckets> counts;
+    uint64_t total = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        counts[i] = buckets_[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+
+    HistogramSnapshot out;
+    out.count = total;
+    out.totalNs = total_.load(std::memory_order_relaxed);
+    out.maxNs = max_.load(std::memory_order_relaxed);
+    out.minNs = total ? min_.load(std::memory_order_relaxed) : 0;
+    if (!total) return out;
+
+    const std::pair<double, uint64_t HistogramSnapshot::*> percentiles[] = {
+        {0.50, &HistogramSnapshot::p50Ns}, {0.90, &HistogramSnapshot::p90Ns},
+        {0.99, &HistogramSnapshot::p99Ns}, {0.999, &HistogramSnapshot::p999Ns}};
+    size_t bucket = 0;
+    uint64_t seen = counts[0];
+    for (const auto& [fraction, field] : percentiles) {
+        const auto rank = static_cast<uint64_t>(fraction * static_cast<double>(total - 1)) + 1;
+        while (seen < rank && bucket + 1 < kBuckets) seen += counts[++bucket];
+        // A bucket's bound can exceed the largest value actually recorded.
+        out.*field = std::min(upperBoundOf(bucket), out.maxNs);
+    }
+    return out;
+}
+
+void LatencyHistogram::reset() noexcept {
+    for (auto& bucket : buckets_) bucket.store(0, std::memory_order_relaxed);
+    total_.store(0, std::memory_order_relaxed);
+    min_.store(UINT64_MAX, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+// :::: MetricsSnapshot
+
+const OperationMetrics* MetricsSnapshot::find(MetricOp op) const {
+    const std::string name = metricOpName(op);
+    for (const auto& operation : operations) {
+        if (operation.name == name) return &operation;
+    }
+    return nullptr;
+}
+
+nlohmann::json MetricsSnapshot::toJson() const {
+    nlohmann::json ops = nlohmann::json::object();
+    for (const auto& operation : operations) {
+        nlohmann::json entry = {{"calls", operation.calls}, {"latency", histogramJson(operation.latency)}};
+        if (operation.bytes || operation.items) {
+            entry["bytes"] = operation.bytes;
+            entry["items"] = operation.items;
+        }
+        ops[operation.name] = std::move(entry);
+    }
+    return {{"enabled", enabled},
+            {"seconds", seconds},
+            {"operations", std::move(ops)},
+            {"lock", {{"wait", histogramJson(lockWait)}, {"hold", histogramJson(lockHold)}}},
+            {"migration", {{"records", migratedRecords}, {"steps", migrationSteps}, {"chains_built", migrationChainsBuilt}}}};
+}
+
+// :::: MetricsRegistry
+
+MetricsRegistry::MetricsRegistry() : since_(nowTicks()) {}
+
+void MetricsRegistry::recordCall(MetricOp op, uint64_t nanoseconds) noexcept {
+    Operation& operation = operations_[static_cast<size_t>(op)];
+    operation.calls.fetch_add(1, std::memory_order_relaxed);
+    operation.latency.record(nanoseconds);
+}
+
+void MetricsRegistry::recordTransfer(MetricOp op, uint64_t bytes, uint64_t items) noexcept {
+    Operation& operation = operations_[static_cast<size_t>(op)];
+    operation.bytes.fetch_add(bytes, std::memory_order_relaxed);
+    operation.items.fetch_add(items, std::memory_order_relaxed);
+}
+
+MetricsSnapshot MetricsRegistry::snapshot() const {
+    MetricsSnapshot out;
+    const auto elapsed = std::chrono::steady_clock::duration(nowTicks() - since_.load(std::memory_order_relaxed));
+    out.seconds = std::chrono::duration<double>(elapsed).count();
+    for (size_t i = 0; i < operations_.size(); ++i) {
+        const Operation& operation = operations_[i];
+        const uint64_t calls = operation.calls.load(std::memory_order_relaxed);
+        if (!calls) continue;
+        OperationMetrics entry;
+        entry.name = metricOpName(static_cast<MetricOp>(i));
+        entry.calls = calls;
+        entry.bytes = operation.bytes.load(std::memory_order_relaxed);
+        entry.items = operation.items.load(std::memory_order_relaxed);
+        entry.latency = operation.latency.snapshot();
+        out.operations.push_back(std::move(entry));
+    }
+    out.lockWait = lockWait_.snapshot();
+    out.lockHold = lockHold_.snapshot();
+    return out;
+}
+
+void MetricsRegistry::reset() noexcept {
+    for (auto& operation : operations_) {
+        operation.calls.store(0, std::memory_order_relaxed);
+        operation.bytes.store(0, std::memory_order_relaxed);
+        operation.items.store(0, std::memory_order_relaxed);
+        operation.latency.reset();
+    }
+    lockWait_.reset();
+    lockHold_.reset();
+    since_.store(nowTicks(), std::memory_order_relaxed);
+}
@@ -0,0 +1,210 @@
+#pragma once
+#ifndef SMARTSTORE_METRICS_H
+#define SMARTSTORE_METRICS_H
+
+#include <nlohmann/json.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// :::Metrics
+// :::Optional instrumentation of an ItemManager (see ItemManager::setMetricsEnabled): a call count and
+// :::a latency histogram per public operation, how long callers wait for the store lock and how long
+// :::they hold it, and the bytes and items moved by whole-file imports and exports. Recording is a few
+// :::relaxed atomic adds, with no lock and no allocation; while metrics are off an operation pays one
+// :::pointer load. A MetricsSnapshot is a plain copy of the counters, convertible to JSON.
+// **************************************************************************************************
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+enum class MetricOp : uint8_t {
+    AddItem, EmplaceItem, TryEmplace, InsertOrAssign, ModifyItem, RemoveByTag, Undo, Redo,
+    GetItem, GetItemRaw, HasItem, FilterByTag, SortItemsByTag, Snapshot,
+    ExportJson, ImportJson, ImportSingleJson,
+    ExportBinary, ImportBinary, ImportSingleBinary,
+    ExportXml, ImportXml, ImportSingleXml,
+    ExportCsv, ExportCsvColumnar, ImportCsv, ImportSingleCsv,
+    ExportChanges, ApplyDelta, Checkpoint, Recover,
+    Count
+};
+
+// "addItem", "importFromFile_Json", ...: the name of the ItemManager function.
+const char* metricOpName(MetricOp op);
+
+// :::: Latency histogram
+
+struct HistogramSnapshot {
+    uint64_t count = 0;
+    uint64_t totalNs = 0;
+    uint64_t minNs = 0;
+    uint64_t maxNs = 0;
+    // Upper bounds of the buckets holding each percentile, within 1/16 of the recorded value.
+    uint64_t p50Ns = 0;
+    uint64_t p90Ns = 0;
+    uint64_t p99Ns = 0;
+    uint64_t p999Ns = 0;
+
+    double meanNs() const { return count ? static_cast<double>(totalNs) / static_cast<double>(count) : 0.0; }
+};
+
+// HDR-style log-linear buckets: exact below 16 ns, then 16 per power of two, so a value is placed
+// within 1/16 of itself. Values past 2^48 ns (about three days) share the last bucket; max stays exact.
+class LatencyHistogram {
+    public:
+        static constexpr unsigned kSubBuckets = 16;
+        static constexpr size_t kBuckets = 45 * kSubBuckets;
+
+        void record(uint64_t nanoseconds) noexcept;
+
+        HistogramSnapshot snapshot() const;
+
+        void reset() noexcept;
+
+        static size_t bucketOf(uint64_t nanoseconds) noexcept;
+        static uint64_t upperBoundOf(size_t bucket) noexcept;
+
+    private:
+        std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+        std::atomic<uint64_t> total_{0};
+        std::atomic<uint64_t> min_{UINT64_MAX};
+        std::atomic<uint64_t> max_{0};
+};
+
+// :::: Snapshot
+
+struct OperationMetrics {
+    std::string name;
+    uint64_t calls = 0;
+    uint64_t bytes = 0;   // file bytes read or written (imports and exports)
+    uint64_t items = 0;   // items imported or exported
+    HistogramSnapshot latency;
+};
+
+struct MetricsSnapshot {
+    bool enabled = false;
+    double seconds = 0.0;                      // since metrics were first enabled or last reset
+    std::vector<OperationMetrics> operations;  // those called at least once, in MetricOp order
+    HistogramSnapshot lockWait;                // time from asking for the store lock to getting it
+    HistogramSnapshot lockHold;                // time from getting it to releasing it
+    uint64_t migratedRecords = 0;              // as in ItemManager::migrationCounters()
+    uint64_t migrationSteps = 0;
+    uint64_t migrationChainsBuilt = 0;
+
+    const OperationMetrics* find(MetricOp op) const;
+
+    nlohmann::json toJson() const;
+};
+
+// :::: Registry
+
+class MetricsRegistry {
+    public:
+        MetricsRegistry();
+
+        void recordCall(MetricOp op, uint64_t nanoseconds) noexcept;
+
+        void recordTransfer(MetricOp op, uint64_t bytes, uint64_t items) noexcept;
+
+        LatencyHistogram& lockWait() noexcept { return lockWait_; }
+        LatencyHistogram& lockHold() noexcept { return lockHold_; }
+
+        // Everything but the migration counters, which the manager keeps.
+        MetricsSnapshot snapshot() const;
+
+        void reset() noexcept;
+
+    private:
+        struct Operation {
+            std::atomic<uint64_t> calls{0};
+            std::atomic<uint64_t> bytes{0};
+            std::atomic<uint64_t> items{0};
+            LatencyHistogram latency;
+        };
+
+        std::array<Operation, static_cast<size_t>(MetricOp::Count)> operations_;
+        LatencyHistogram lockWait_;
+        LatencyHistogram lockHold_;
+        std::atomic<std::chrono::steady_clock::rep> since_;
+};
+
+// :::: Instrumentation
+
+// Times the enclosing scope as one call of `op`, if `metrics` is set.
+class ScopedOperation {
+    public:
+        ScopedOperation(MetricsRegistry* metrics, MetricOp op) noexcept
+            : metrics_(metrics), op_(op), start_(metrics ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{}) {}
+
+        ~ScopedOperation() {
+            if (metrics_) {
+                metrics_->recordCall(op_, static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count()));
+            }
+        }
+
+        ScopedOperation(const ScopedOperation&) = delete;
+        ScopedOperation& operator=(const ScopedOperation&) = delete;
+
+    private:
+        MetricsRegistry* metrics_;
+        MetricOp op_;
+        std::chrono::steady_clock::time_point start_;
+};
+
+// std::mutex that records wait and hold times into the registry `metrics` points to, when it points
+// to one. Whether a hold is timed is decided when the lock is taken.
+class MeteredMutex {
+    public:
+        explicit MeteredMutex(const std::atomic<MetricsRegistry*>& metrics) noexcept : metrics_(metrics) {}
+
+        MeteredMutex(const MeteredMutex&) = delete;
+        MeteredMutex& operator=(const MeteredMutex&) = delete;
+
+        void lock() {
+            MetricsRegistry* metrics = metrics_.load(std::memory_order_acquire);
+            if (!metrics) {
+                mutex_.lock();
+                holder_ = nullptr;
+                return;
+            }
+            const auto asked = std::chrono::steady_clock::now();
+            mutex_.lock();
+            acquired_ = std::chrono::steady_clock::now();
+            holder_ = metrics;
+            metrics->lockWait().record(nanosecondsBetween(asked, acquired_));
+        }
+
+        bool try_lock() {
+            if (!mutex_.try_lock()) return false;
+            holder_ = metrics_.load(std::memory_order_acquire);
+            if (holder_) {
+                acquired_ = std::chrono::steady_clock::now();
+                holder_->lockWait().record(0);
+            }
+            return true;
+        }
+
+        void unlock() {
+            if (MetricsRegistry* metrics = holder_) {
+                metrics->lockHold().record(nanosecondsBetween(acquired_, std::chrono::steady_clock::now()));
+            }
+            mutex_.unlock();
+        }
+
+    private:
+        static uint64_t nanosecondsBetween(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count());
+        }
+
+        std::mutex mutex_;
+        const std::atomic<MetricsRegistry*>& metrics_;
+        // Written by the thread that holds mutex_.
+        MetricsRegistry* holder_ = nullptr;
+        std::chrono::steady_clock::time_point acquired_;
+};
+
+#endif // SMARTSTORE_METRICS_H
@@ -0,0 +1,97 @@
+#include "Checkpointer.h"
+#include "err_log/Logger.hpp"
+#include "utils/AtomicFileWriter .hpp"
+#include "utils/TokenBucket.hpp"
+
+#include <iostream>
+#include <stdexcept>
+
+// ::::| Checkpointer: periodic, throttled background save
+// ********************************************************
+
+Checkpointer::Checkpointer(CheckpointOptions options, SequenceFn sequence, CaptureFn capture)
+    : options_(std::move(options)), sequence_(std::move(sequence)), capture_(std::move(capture)) {
+
+    if (options_.path.empty()) {
+        LOG_CONTEXT(LogLevel::ERR, "", std::make_exception_ptr(std::invalid_argument("Checkpoint path cannot be empty.")));
+    }
+    thread_ = std::thread(&Checkpointer::run, this);
+}
+
+Checkpointer::~Checkpointer() {
+    stop();
+}
+
+void Checkpointer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+}
+
+CheckpointStats Checkpointer::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void Checkpointer::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!cv_.wait_for(lock, options_.interval, [this] { return stop_; })) {
+        lock.unlock();
+        try {
+            checkpointOnce();
+        } catch (const std::exception& e) {
+            std::cerr << ":::| ERROR in checkpointer thread: " << e.what() << "\n";
+            std::lock_guard<std::mutex> failed(mutex_);
+            ++stats_.failures;
+        }
+        lock.lock();
+    }
+}
+
+void Checkpointer::checkpointOnce() {
+    const uint64_t current = sequence_();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (hasCheckpoint_ && current == stats_.lastSequence) {
+            ++stats_.skipped;
+            return;
+        }
+    }
+
+    const auto started = std::chrono::steady_clock::now();
+    uint64_t sequence = 0;
+    const std::string snapshot = capture_(sequence);
+
+    // Throttle between chunks; waiting on the condition variable lets stop() cut a slow write short.
+    TokenBucket bucket(static_cast<double>(options_.maxBytesPerSecond), static_cast<double>(options_.chunkSize));
+    auto throttle = [&](size_t bytes) {
+        const auto wait = bucket.acquire(bytes);
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (wait.count() > 0) cv_.wait_for(lock, wait, [this] { return stop_; });
+        return !stop_;
+    };
+
+    const bool written = AtomicFileWriter::writeAtomicallyChunked(options_.path, snapshot, options_.chunkSize, throttle,
+                                                                  AtomicWriteOptions{options_.durable});
+    const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!written) {
+        if (!stop_) {
+            ++stats_.failures;
+            LOG_CONTEXT(LogLevel::WARNING, "Checkpoint to '" + options_.path + "' failed; retrying next cycle.", {});
+        }
+        return;
+    }
+
+    hasCheckpoint_ = true;
+    ++stats_.checkpoints;
+    stats_.bytesWritten += snapshot.size();
+    stats_.lastBytes = snapshot.size();
+    stats_.lastSequence = sequence;
+    stats_.lastCheckpoint = std::chrono::system_clock::now();
+    stats_.lastDuration = duration;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#ifndef CHECKPOINTER_H
+#define CHECKPOINTER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// :::Checkpointer class
+// :::Background thread that periodically saves a store to one file. Each cycle asks the
+// :::store for its change sequence and skips the save if nothing changed since the last
+// :::one; otherwise it captures an encoded snapshot and writes it atomically, in chunks
+// :::throttled by a token bucket so the disk bandwidth left to foreground work is bounded.
+// **************************************************************************************************
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+enum class CheckpointFormat {
+    Binary,  // same layout as exportToFile_Binary
+    Json     // same layout as exportToFile_Json
+};
+
+struct CheckpointOptions {
+    std::string path;
+    CheckpointFormat format = CheckpointFormat::Binary;
+    std::chrono::milliseconds interval{5000};
+    size_t maxBytesPerSecond = 0;   // 0 = unthrottled
+    size_t chunkSize = 64 * 1024;   // bytes written per throttling step
+    bool durable = false;           // fdatasync the file and fsync its directory on each checkpoint
+};
+
+struct CheckpointStats {
+    uint64_t checkpoints = 0;       // snapshots written
+    uint64_t skipped = 0;           // cycles skipped because nothing changed
+    uint64_t failures = 0;          // snapshots that could not be written
+    uint64_t bytesWritten = 0;      // total over all snapshots
+    uint64_t lastBytes = 0;
+    uint64_t lastSequence = 0;      // store change sequence covered by the last snapshot
+    std::chrono::system_clock::time_point lastCheckpoint{};
+    std::chrono::milliseconds lastDuration{0};  // capture + write of the last snapshot
+};
+
+class Checkpointer {
+    public:
+        // Returns the store's current change sequence.
+        using SequenceFn = std::function<uint64_t()>;
+        // Encodes a consistent snapshot and reports the change sequence it covers.
+        using CaptureFn = std::function<std::string(uint64_t& sequence)>;
+
+        Checkpointer(CheckpointOptions options, SequenceFn sequence, CaptureFn capture);
+        ~Checkpointer();
+
+        Checkpointer(const Checkpointer&) = delete;
+        Checkpointer& operator=(const Checkpointer&) = delete;
+
+        // Stops the thread. A throttled write still in progress is abandoned; the previous
+        // checkpoint file stays intact.
+        void stop();
+
+        CheckpointStats stats() const;
+        const CheckpointOptions& options() const { return options_; }
+
+    private:
+        void run();
+        void checkpointOnce();
+
+        CheckpointOptions options_;
+        SequenceFn sequence_;
+        CaptureFn capture_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable cv_;
+        bool stop_ = false;
+        bool hasCheckpoint_ = false;
+        CheckpointStats stats_;
+        std::thread thread_;
+};
+
+#endif // CHECKPOINTER_H
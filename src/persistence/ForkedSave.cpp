@@ -0,0 +1,112 @@
+#include "ForkedSave.h"
+
+#include <cerrno>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SMART_STORE_HAS_FORK 1
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// ::::| ForkedSave: BGSAVE-style save in a child process
+// *******************************************************
+
+bool ForkedSave::supported() {
+#if defined(SMART_STORE_HAS_FORK)
+    return true;
+#else
+    return false;
+#endif
+}
+
+#if defined(SMART_STORE_HAS_FORK)
+
+std::unique_ptr<ForkedSave> ForkedSave::start(const ChildWork& work) {
+    int fds[2];
+    if (::pipe(fds) != 0) return nullptr;
+
+    const auto started = std::chrono::steady_clock::now();
+    const pid_t pid = ::fork();
+    const auto forked = std::chrono::steady_clock::now();
+
+    if (pid < 0) {
+        ::close(fds[0]);
+        ::close(fds[1]);
+        return nullptr;
+    }
+
+    if (pid == 0) {
+        // Child: no logging, no locks, no exceptions escaping; see the constraints in ForkedSave.h.
+        ::close(fds[0]);
+        std::optional<uint64_t> bytes;
+        try {
+            bytes = work();
+        } catch (...) {
+            bytes.reset();
+        }
+        const uint64_t report = bytes.value_or(0);
+        ssize_t ignored = ::write(fds[1], &report, sizeof(report));
+        (void)ignored;
+        ::_exit(bytes ? 0 : 1);
+    }
+
+    ::close(fds[1]);
+    std::unique_ptr<ForkedSave> save(new ForkedSave());
+    save->pid_ = pid;
+    save->pipe_ = fds[0];
+    save->started_ = started;
+    save->result_.forkPause = std::chrono::duration_cast<std::chrono::microseconds>(forked - started);
+    return save;
+}
+
+ForkedSave::~ForkedSave() {
+    // Never leave a zombie behind.
+    if (!reaped_) wait();
+}
+
+bool ForkedSave::running() {
+    if (reaped_) return false;
+    int status = 0;
+    pid_t done = ::waitpid(static_cast<pid_t>(pid_), &status, WNOHANG);
+    if (done == 0) return true;
+    collect(done < 0 ? -1 : status);
+    return false;
+}
+
+ForkedSaveResult ForkedSave::wait() {
+    if (reaped_) return result_;
+    int status = 0;
+    pid_t done = -1;
+    do {
+        done = ::waitpid(static_cast<pid_t>(pid_), &status, 0);
+    } while (done < 0 && errno == EINTR);
+    collect(done < 0 ? -1 : status);
+    return result_;
+}
+
+void ForkedSave::collect(int status) {
+    uint64_t bytes = 0;
+    ssize_t n = -1;
+    do {
+        n = ::read(pipe_, &bytes, sizeof(bytes));
+    } while (n < 0 && errno == EINTR);
+    ::close(pipe_);
+    pipe_ = -1;
+
+    reaped_ = true;
+    result_.exitStatus = (status >= 0 && WIFEXITED(status)) ? WEXITSTATUS(status) : -1;
+    result_.ok = result_.exitStatus == 0 && n == static_cast<ssize_t>(sizeof(bytes));
+    result_.bytes = result_.ok ? bytes : 0;
+    result_.duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started_);
+}
+
+#else
+
+std::unique_ptr<ForkedSave> ForkedSave::start(const ChildWork&) { return nullptr; }
+ForkedSave::~ForkedSave() = default;
+bool ForkedSave::running() { return false; }
+ForkedSaveResult ForkedSave::wait() { return result_; }
+void ForkedSave::collect(int) {}
+
+#endif
@@ -0,0 +1,67 @@
+#pragma once
+#ifndef FORKED_SAVE_H
+#define FORKED_SAVE_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+
+// :::ForkedSave class
+// :::Runs a save in a fork()ed child (POSIX only). The child sees a copy-on-write image of the
+// :::parent's memory, does the serialization and the disk write, reports the number of bytes
+// :::written through a pipe and leaves with _exit; the parent collects it with waitpid.
+// :::
+// :::Constraints of fork() in a multi-threaded process, which the child work must respect:
+// :::  - only the forking thread exists in the child. Any lock another thread held at fork time
+// :::    (store lock, logger/iostream locks, write-ahead log, checkpointer) stays locked forever,
+// :::    so the child must only read data that no other thread could be changing and must not log;
+// :::  - the child leaves with _exit: no destructors, atexit handlers or stdio flushes run;
+// :::  - memory pages the parent writes while the child runs are duplicated, so a write-heavy
+// :::    parent can need up to twice the store's memory until the child exits.
+// **************************************************************************************************
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+struct ForkedSaveResult {
+    bool ok = false;
+    uint64_t bytes = 0;                       // bytes the child reported writing
+    int exitStatus = -1;                      // child exit code, -1 if it died from a signal
+    std::chrono::microseconds forkPause{0};   // time the parent spent in fork()
+    std::chrono::milliseconds duration{0};    // fork to child exit
+};
+
+class ForkedSave {
+    public:
+        // Work run in the child. Returns the bytes written, or nullopt on failure.
+        using ChildWork = std::function<std::optional<uint64_t>()>;
+
+        // Forks and runs `work` in the child. Returns nullptr if fork is unavailable or fails.
+        static std::unique_ptr<ForkedSave> start(const ChildWork& work);
+
+        ~ForkedSave();
+
+        ForkedSave(const ForkedSave&) = delete;
+        ForkedSave& operator=(const ForkedSave&) = delete;
+
+        // Non-blocking: true while the child has not exited.
+        bool running();
+
+        // Blocks until the child exits and returns its outcome (cached after the first call).
+        ForkedSaveResult wait();
+
+        static bool supported();
+
+    private:
+        ForkedSave() = default;
+
+        long pid_ = -1;
+        int pipe_ = -1;
+        bool reaped_ = false;
+        ForkedSaveResult result_;
+        std::chrono::steady_clock::time_point started_;
+
+        void collect(int status);
+};
+
+#endif // FORKED_SAVE_H
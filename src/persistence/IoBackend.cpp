@@ -0,0 +1,419 @@
+#include "IoBackend.h"
+#include "err_log/Logger.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define SMART_STORE_HAS_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+// ::::| IoBackend: io_uring / thread-pool bulk file I/O
+// ******************************************************
+
+namespace {
+
+#if !defined(_WIN32)
+
+    // Completes one request with blocking positional I/O, resuming after short transfers.
+    bool runBlocking(IoRequest request) {
+        while (request.size > 0) {
+            ssize_t n = request.op == IoRequest::Op::Read
+                ? ::pread(request.fd, request.data, request.size, static_cast<off_t>(request.offset))
+                : ::pwrite(request.fd, request.data, request.size, static_cast<off_t>(request.offset));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;  // error, or end of file on a read
+            request.data += n;
+            request.size -= static_cast<size_t>(n);
+            request.offset += static_cast<uint64_t>(n);
+        }
+        return true;
+    }
+
+    // :: Thread-pool backend: workers take requests from a shared queue
+    // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+    class ThreadPoolBackend : public IoBackend {
+        public:
+            ThreadPoolBackend(unsigned threads, size_t chunkSize) : IoBackend(chunkSize) {
+                threads = threads ? threads : 1;
+                for (unsigned i = 0; i < threads; ++i) workers_.emplace_back(&ThreadPoolBackend::work, this);
+            }
+
+            ~ThreadPoolBackend() override {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    stop_ = true;
+                }
+                cv_.notify_all();
+                for (auto& worker : workers_) worker.join();
+            }
+
+            bool run(std::vector<IoRequest>& requests) override {
+                struct Batch {
+                    std::mutex mutex;
+                    std::condition_variable done;
+                    size_t remaining = 0;
+                    bool ok = true;
+                };
+                auto batch = std::make_shared<Batch>();
+                batch->remaining = requests.size();
+                if (requests.empty()) return true;
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    for (const IoRequest& request : requests) {
+                        queue_.push_back([batch, request] {
+                            const bool ok = runBlocking(request);
+                            std::lock_guard<std::mutex> batchLock(batch->mutex);
+                            batch->ok = batch->ok && ok;
+                            if (--batch->remaining == 0) batch->done.notify_all();
+                        });
+                    }
+                }
+                cv_.notify_all();
+
+                std::unique_lock<std::mutex> lock(batch->mutex);
+                batch->done.wait(lock, [&] { return batch->remaining == 0; });
+                return batch->ok;
+            }
+
+            const char* name() const override { return "thread-pool"; }
+
+        private:
+            void work() {
+                std::unique_lock<std::mutex> lock(mutex_);
+                while (true) {
+                    cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+                    if (queue_.empty()) return;
+                    auto task = std::move(queue_.front());
+                    queue_.pop_front();
+                    lock.unlock();
+                    task();
+                    lock.lock();
+                }
+            }
+
+            std::mutex mutex_;
+            std::condition_variable cv_;
+            std::deque<std::function<void()>> queue_;
+            std::vector<std::thread> workers_;
+            bool stop_ = false;
+    };
+
+#endif
+
+#if defined(SMART_STORE_HAS_IO_URING)
+
+    // :: io_uring backend over the raw syscalls (no liburing dependency)
+    // :::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+    int uringSetup(unsigned entries, io_uring_params* params) {
+        return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+    }
+
+    int uringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+        return static_cast<int>(::syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+    }
+
+    int uringRegister(int fd, unsigned opcode, void* arg, unsigned count) {
+        return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, count));
+    }
+
+    class UringBackend : public IoBackend {
+        public:
+            UringBackend(unsigned depth, unsigned fallbackThreads, size_t chunkSize)
+                : IoBackend(chunkSize), fallbackThreads_(fallbackThreads) {
+                io_uring_params params{};
+                ringFd_ = uringSetup(depth ? depth : 32, &params);
+                if (ringFd_ < 0) return;
+
+                sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+                cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+                const bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+                if (singleMap) sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+
+                sqRing_ = ::mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQ_RING);
+                cqRing_ = singleMap ? sqRing_
+                                    : ::mmap(nullptr, cqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_CQ_RING);
+                sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+                sqes_ = ::mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQES);
+                if (sqRing_ == MAP_FAILED || cqRing_ == MAP_FAILED || sqes_ == MAP_FAILED) return;
+
+                auto* sq = static_cast<char*>(sqRing_);
+                auto* cq = static_cast<char*>(cqRing_);
+                sqHead_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+                sqTail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+                sqMask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+                sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+                cqHead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+                cqTail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+                cqMask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+                cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+                entries_ = params.sq_entries;
+
+                usable_ = supportsReadWrite();
+            }
+
+            ~UringBackend() override {
+                if (sqes_ && sqes_ != MAP_FAILED) ::munmap(sqes_, sqesSize_);
+                if (cqRing_ && cqRing_ != MAP_FAILED && cqRing_ != sqRing_) ::munmap(cqRing_, cqRingSize_);
+                if (sqRing_ && sqRing_ != MAP_FAILED) ::munmap(sqRing_, sqRingSize_);
+                if (ringFd_ >= 0) ::close(ringFd_);
+            }
+
+            bool usable() const { return usable_; }
+
+            const char* name() const override { return "io_uring"; }
+
+            bool run(std::vector<IoRequest>& requests) override {
+                std::unique_lock<std::mutex> lock(mutex_);  // one batch on the ring at a time
+                if (fallback_) {
+                    lock.unlock();   // set once and never replaced
+                    return fallback_->run(requests);
+                }
+
+                // Work list of what is left of each request; short transfers are resubmitted.
+                std::vector<IoRequest> pending(requests.begin(), requests.end());
+                std::deque<size_t> toSubmit;
+                for (size_t i = 0; i < pending.size(); ++i) {
+                    if (pending[i].size > 0) toSubmit.push_back(i);
+                }
+
+                bool ok = true;
+                size_t inFlight = 0;   // consumed by the kernel, not completed yet
+                auto reap = [&] {
+                    size_t reaped = 0;
+                    unsigned head = *cqHead_;
+                    while (head != __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE)) {
+                        const io_uring_cqe& cqe = cqes_[head & cqMask_];
+                        const size_t index = static_cast<size_t>(cqe.user_data);
+                        IoRequest& request = pending[index];
+                        --inFlight;
+                        ++reaped;
+
+                        if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+                            toSubmit.push_back(index);
+                        } else if (cqe.res <= 0) {
+                            ok = false;  // error, or end of file on a read
+                        } else {
+                            const size_t done = static_cast<size_t>(cqe.res);
+                            request.data += done;
+                            request.size -= done;
+                            request.offset += done;
+                            if (request.size > 0) toSubmit.push_back(index);
+                        }
+                        ++head;
+                    }
+                    __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+                    return reaped;
+                };
+
+                while (!toSubmit.empty() || inFlight > 0) {
+                    const unsigned sqHead = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+                    unsigned tail = *sqTail_;
+                    while (!toSubmit.empty() && inFlight + (tail - sqHead) < entries_) {
+                        const size_t index = toSubmit.front();
+                        toSubmit.pop_front();
+                        const IoRequest& request = pending[index];
+
+                        const unsigned slot = tail & sqMask_;
+                        io_uring_sqe& sqe = static_cast<io_uring_sqe*>(sqes_)[slot];
+                        std::memset(&sqe, 0, sizeof(sqe));
+                        sqe.opcode = request.op == IoRequest::Op::Read ? IORING_OP_READ : IORING_OP_WRITE;
+                        sqe.fd = request.fd;
+                        sqe.addr = reinterpret_cast<uint64_t>(request.data);
+                        sqe.len = static_cast<uint32_t>(std::min<size_t>(request.size, 1u << 30));
+                        sqe.off = request.offset;
+                        sqe.user_data = index;
+                        sqArray_[slot] = slot;
+                        ++tail;
+                    }
+                    __atomic_store_n(sqTail_, tail, __ATOMIC_RELEASE);
+
+                    // Entries left over from a partial submission go in again along with the new ones.
+                    const int entered = uringEnter(ringFd_, tail - sqHead, 1, IORING_ENTER_GETEVENTS);
+                    const int error = entered < 0 ? errno : 0;
+                    const unsigned consumed = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+                    inFlight += consumed - sqHead;
+
+                    if (error && error != EINTR && error != EAGAIN && error != EBUSY) {
+                        // The ring is unusable. Take back what the kernel never read, and wait for
+                        // what it did (the completion ring is shared memory), since those requests
+                        // still point into the caller's buffers. Everything left, and every later
+                        // batch, goes to the thread pool.
+                        for (unsigned entry = consumed; entry != tail; ++entry) {
+                            toSubmit.push_front(static_cast<size_t>(static_cast<io_uring_sqe*>(sqes_)[entry & sqMask_].user_data));
+                        }
+                        __atomic_store_n(sqTail_, consumed, __ATOMIC_RELEASE);
+                        while (inFlight > 0) {
+                            if (!reap()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                        }
+
+                        LOG_CONTEXT(LogLevel::WARNING, std::string("io_uring_enter failed (") + std::strerror(error)
+                                                       + "); using the thread-pool I/O backend from now on.", {});
+                        fallback_ = std::make_unique<ThreadPoolBackend>(fallbackThreads_, chunkSize());
+                        std::vector<IoRequest> rest;
+                        for (size_t index : toSubmit) {
+                            if (pending[index].size > 0) rest.push_back(pending[index]);
+                        }
+                        return fallback_->run(rest) && ok;
+                    }
+
+                    if (!reap() && error) std::this_thread::yield();   // interrupted or out of resources: retry
+                }
+                return ok;
+            }
+
+        private:
+            bool supportsReadWrite() {
+                // IORING_OP_READ/WRITE arrived in 5.6, as did the probe; a failing probe means too old.
+                const size_t size = sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op);
+                std::vector<uint64_t> storage((size + sizeof(uint64_t) - 1) / sizeof(uint64_t), 0);
+                auto* probe = reinterpret_cast<io_uring_probe*>(storage.data());
+                if (uringRegister(ringFd_, IORING_REGISTER_PROBE, probe, 256) < 0) return false;
+                auto supported = [probe](unsigned op) {
+                    return op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+                };
+                return supported(IORING_OP_READ) && supported(IORING_OP_WRITE);
+            }
+
+            std::mutex mutex_;
+            int ringFd_ = -1;
+            bool usable_ = false;
+            unsigned fallbackThreads_ = 0;
+            std::unique_ptr<ThreadPoolBackend> fallback_;   // once the ring has failed
+            unsigned entries_ = 0;
+
+            void* sqRing_ = nullptr;
+            void* cqRing_ = nullptr;
+            void* sqes_ = nullptr;
+            size_t sqRingSize_ = 0;
+            size_t cqRingSize_ = 0;
+            size_t sqesSize_ = 0;
+
+            unsigned* sqHead_ = nullptr;
+            unsigned* sqTail_ = nullptr;
+            unsigned* sqArray_ = nullptr;
+            unsigned sqMask_ = 0;
+            unsigned* cqHead_ = nullptr;
+            unsigned* cqTail_ = nullptr;
+            unsigned cqMask_ = 0;
+            io_uring_cqe* cqes_ = nullptr;
+    };
+
+#endif
+
+#if defined(_WIN32)
+
+    // Windows: no positional bulk I/O here; requests run one after another.
+    class SequentialBackend : public IoBackend {
+        public:
+            explicit SequentialBackend(size_t chunkSize) : IoBackend(chunkSize) {}
+            bool run(std::vector<IoRequest>&) override { return false; }
+            const char* name() const override { return "sequential"; }
+    };
+
+#endif
+}
+
+std::unique_ptr<IoBackend> IoBackend::create(const IoBackendOptions& options) {
+#if defined(_WIN32)
+    return std::make_unique<SequentialBackend>(options.chunkSize);
+#else
+#if defined(SMART_STORE_HAS_IO_URING)
+    if (options.kind != IoBackendKind::ThreadPool) {
+        auto uring = std::make_unique<UringBackend>(options.queueDepth, options.threads, options.chunkSize);
+        if (uring->usable()) return uring;
+        if (options.kind == IoBackendKind::IoUring) {
+            LOG_CONTEXT(LogLevel::WARNING, "io_uring is not available on this kernel; using the thread-pool I/O backend.", {});
+        }
+    }
+#endif
+    return std::make_unique<ThreadPoolBackend>(options.threads, options.chunkSize);
+#endif
+}
+
+std::shared_ptr<IoBackend> IoBackend::shared() {
+    static std::shared_ptr<IoBackend> backend = create();
+    return backend;
+}
+
+std::optional<std::string> IoBackend::readFile(const std::string& path) {
+#if defined(_WIN32)
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return std::nullopt;
+    return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return std::nullopt;
+
+    struct stat info{};
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        return std::nullopt;
+    }
+
+    std::string content(static_cast<size_t>(info.st_size), '\0');
+    std::vector<IoRequest> requests;
+    for (size_t offset = 0; offset < content.size(); offset += chunkSize()) {
+        requests.push_back({IoRequest::Op::Read, fd, content.data() + offset,
+                            std::min(chunkSize(), content.size() - offset), offset});
+    }
+    const bool ok = run(requests);
+    ::close(fd);
+    if (!ok) return std::nullopt;
+    return content;
+#endif
+}
+
+bool IoBackend::writeFiles(const std::vector<FileWrite>& files) {
+#if defined(_WIN32)
+    bool ok = true;
+    for (const auto& file : files) ok = AtomicFileWriter::writeAtomically(file.path, file.data, file.options) && ok;
+    return ok;
+#else
+    std::vector<std::unique_ptr<AtomicFileWriter::Sink>> sinks;
+    std::vector<IoRequest> requests;
+    bool ok = true;
+
+    for (const auto& file : files) {
+        AtomicWriteOptions options = file.options;
+        options.expectedSize = file.data.size();
+        auto sink = std::make_unique<AtomicFileWriter::Sink>(file.path, options);
+        if (!sink->ok()) {
+            ok = false;
+            continue;
+        }
+        // The backend only reads through this pointer (a write request never modifies its buffer).
+        char* data = const_cast<char*>(file.data.data());
+        for (size_t offset = 0; offset < file.data.size(); offset += chunkSize()) {
+            requests.push_back({IoRequest::Op::Write, sink->fd(), data + offset,
+                                std::min(chunkSize(), file.data.size() - offset), offset});
+        }
+        sinks.push_back(std::move(sink));
+    }
+
+    ok = run(requests) && ok;
+    if (!ok) return false;  // the sinks' destructors drop every temporary
+
+    for (auto& sink : sinks) ok = sink->commit() && ok;
+    return ok;
+#endif
+}
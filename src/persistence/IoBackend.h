@@ -0,0 +1,83 @@
+#pragma once
+#ifndef IO_BACKEND_H
+#define IO_BACKEND_H
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "utils/AtomicFileWriter .hpp"
+
+// :::IoBackend class
+// :::Bulk file I/O for the exporters and importers. Whole files are split into large chunks
+// :::that are read or written at explicit offsets with many requests in flight at once:
+// :::through io_uring where the kernel supports it (Linux 5.6+), otherwise through a small
+// :::pool of threads issuing pread/pwrite. Multi-file writes share the same queue, so all the
+// :::files of a multi-file export are in flight together.
+// **************************************************************************************************
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+enum class IoBackendKind {
+    Auto,        // io_uring if available, else ThreadPool
+    IoUring,
+    ThreadPool
+};
+
+struct IoBackendOptions {
+    IoBackendKind kind = IoBackendKind::Auto;
+    unsigned queueDepth = 32;          // io_uring submission queue entries
+    unsigned threads = 4;              // thread-pool workers
+    size_t chunkSize = 1 << 20;        // bytes per request
+};
+
+// One positional read or write; the backend completes it fully or reports failure.
+struct IoRequest {
+    enum class Op { Read, Write };
+    Op op = Op::Read;
+    int fd = -1;
+    char* data = nullptr;
+    size_t size = 0;
+    uint64_t offset = 0;
+};
+
+// A whole file for writeFiles: written atomically, like AtomicFileWriter::writeAtomically.
+struct FileWrite {
+    std::string path;
+    std::string_view data;
+    AtomicWriteOptions options{};
+};
+
+class IoBackend {
+    public:
+        virtual ~IoBackend() = default;
+
+        // Runs every request, keeping up to the backend's limit in flight. False if any failed.
+        virtual bool run(std::vector<IoRequest>& requests) = 0;
+
+        virtual const char* name() const = 0;
+
+        // Reads a whole file; nullopt if it cannot be opened or read.
+        std::optional<std::string> readFile(const std::string& path);
+
+        // Writes each file atomically, with the chunks of all files in flight together.
+        bool writeFiles(const std::vector<FileWrite>& files);
+
+        size_t chunkSize() const { return chunkSize_; }
+
+        // Creates a backend of the requested kind (falls back to ThreadPool when io_uring is unusable).
+        static std::unique_ptr<IoBackend> create(const IoBackendOptions& options = {});
+
+        // Process-wide backend with default options, created on first use.
+        static std::shared_ptr<IoBackend> shared();
+
+    protected:
+        explicit IoBackend(size_t chunkSize) : chunkSize_(chunkSize ? chunkSize : (1 << 20)) {}
+
+    private:
+        size_t chunkSize_;
+};
+
+#endif // IO_BACKEND_H
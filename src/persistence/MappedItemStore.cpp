@@ -0,0 +1,539 @@
+#include "MappedItemStore.h"
+#include "err_log/Logger.hpp"
+#include "utils/Checksum.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SMART_STORE_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ::::| MappedItemStore: slab + hash index in memory-mapped files
+// ****************************************************************
+
+namespace {
+
+    constexpr char kSlabMagic[8]  = {'S', 'S', 'M', 'A', 'P', '0', '0', '1'};
+    constexpr char kIndexMagic[8] = {'S', 'S', 'I', 'D', 'X', '0', '0', '1'};
+
+    constexpr uint64_t kHeaderSize = 64;
+    constexpr uint64_t kSlabGrowth = 1 << 20;          // slab files grow in steps of at least 1 MiB
+    constexpr uint64_t kMinIndexCapacity = 1024;       // slots; always a power of two
+    constexpr uint64_t kSlotSize = 16;                 // hash + record offset
+    constexpr uint64_t kEmptySlot = 0;
+    constexpr uint64_t kDeletedSlot = 1;               // record offsets are >= kHeaderSize
+    constexpr uint32_t kLiveFlag = 1;
+    constexpr uint32_t kMaxBodySize = 1u << 30;
+
+    struct SlabHeader {
+        char magic[8];
+        uint64_t end;           // offset just past the last record
+        uint64_t records;       // live records
+        uint64_t liveBytes;     // bytes held by live records
+        uint64_t reserved[4];
+    };
+
+    struct IndexHeader {
+        char magic[8];
+        uint64_t capacity;      // slots
+        uint64_t used;          // slots holding a record
+        uint64_t deleted;       // tombstone slots
+        uint64_t slabEnd;       // slab end the index matched when last marked clean
+        uint64_t clean;         // 1 only between sync() and the next mutation
+        uint64_t reserved[2];
+    };
+
+    // Record frame; the body (encoding, lengths, tag, type, id, payload) follows.
+    struct RecordFrame {
+        uint32_t bodySize;
+        uint32_t crc;           // of the body
+        uint32_t flags;         // kLiveFlag until replaced or erased; outside the CRC
+        uint32_t reserved;
+    };
+
+    struct RecordBodyHeader {
+        uint8_t encoding;
+        uint8_t pad[3];
+        uint32_t tagSize;
+        uint32_t typeSize;
+        uint32_t idSize;
+    };
+
+    static_assert(sizeof(SlabHeader) == kHeaderSize && sizeof(IndexHeader) == kHeaderSize, "store headers are 64 bytes");
+
+    uint64_t align8(uint64_t value) { return (value + 7) & ~uint64_t{7}; }
+
+    uint64_t recordSize(uint32_t bodySize) { return align8(sizeof(RecordFrame) + bodySize); }
+
+    uint64_t hashTag(std::string_view tag) {
+        uint64_t h = 1469598103934665603ull;   // FNV-1a
+        for (unsigned char c : tag) {
+            h ^= c;
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    [[noreturn]] void fail(const std::string& message) {
+        LOG_CONTEXT(LogLevel::ERR, "", std::make_exception_ptr(std::runtime_error(message)));
+        throw std::runtime_error(message);  // LOG_CONTEXT rethrows; keeps the compiler informed
+    }
+}
+
+struct MappedItemStore::Slot {
+    uint64_t hash;
+    uint64_t offset;   // kEmptySlot, kDeletedSlot or the record's slab offset
+};
+
+MappedItemStore::Slot* MappedItemStore::slotsOf(char* base) {
+    static_assert(sizeof(Slot) == kSlotSize, "index slots are 16 bytes");
+    return reinterpret_cast<Slot*>(base + kHeaderSize);
+}
+
+bool MappedItemStore::supported() {
+#if defined(SMART_STORE_HAS_MMAP)
+    return true;
+#else
+    return false;
+#endif
+}
+
+#if defined(SMART_STORE_HAS_MMAP)
+
+namespace {
+
+    SlabHeader& slabHeader(char* base) { return *reinterpret_cast<SlabHeader*>(base); }
+    IndexHeader& indexHeader(char* base) { return *reinterpret_cast<IndexHeader*>(base); }
+
+    char* mapFile(int fd, uint64_t size) {
+        void* p = ::mmap(nullptr, static_cast<size_t>(size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        return p == MAP_FAILED ? nullptr : static_cast<char*>(p);
+    }
+
+    // Creates `path` holding an empty index of `capacity` slots and maps it.
+    bool createIndexFile(const std::string& path, uint64_t capacity, int& fd, char*& base, uint64_t& size) {
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) return false;
+        size = kHeaderSize + capacity * kSlotSize;
+        if (::ftruncate(fd, static_cast<off_t>(size)) != 0 || !(base = mapFile(fd, size))) {
+            ::close(fd);
+            fd = -1;
+            return false;
+        }
+        IndexHeader& header = indexHeader(base);
+        std::memcpy(header.magic, kIndexMagic, sizeof(kIndexMagic));
+        header.capacity = capacity;
+        return true;
+    }
+}
+
+MappedItemStore::MappedItemStore(const std::string& path) : path_(path) {
+    openSlab();
+    openIndex();
+}
+
+MappedItemStore::~MappedItemStore() {
+    try {
+        sync();
+    } catch (const std::exception& e) {
+        std::cerr << ":::| ERROR while syncing mapped store: " << e.what() << "\n";
+    }
+    close();
+}
+
+void MappedItemStore::close() {
+    for (Mapping* m : {&slab_, &index_}) {
+        if (m->base) ::munmap(m->base, static_cast<size_t>(m->size));
+        if (m->fd >= 0) ::close(m->fd);
+        *m = Mapping{};
+    }
+}
+
+void MappedItemStore::openSlab() {
+    slab_.fd = ::open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (slab_.fd < 0) fail("Cannot open mapped store '" + path_ + "'.");
+
+    struct stat st{};
+    if (::fstat(slab_.fd, &st) != 0) {
+        close();
+        fail("Cannot stat mapped store '" + path_ + "'.");
+    }
+
+    const bool fresh = st.st_size == 0;
+    slab_.size = fresh ? kSlabGrowth : static_cast<uint64_t>(st.st_size);
+    if (fresh && ::ftruncate(slab_.fd, static_cast<off_t>(slab_.size)) != 0) {
+        close();
+        fail("Cannot size mapped store '" + path_ + "'.");
+    }
+    if (slab_.size < kHeaderSize || !(slab_.base = mapFile(slab_.fd, slab_.size))) {
+        close();
+        fail("Cannot map store '" + path_ + "'.");
+    }
+
+    SlabHeader& header = slabHeader(slab_.base);
+    if (fresh) {
+        std::memcpy(header.magic, kSlabMagic, sizeof(kSlabMagic));
+        header.end = kHeaderSize;
+    } else if (std::memcmp(header.magic, kSlabMagic, sizeof(kSlabMagic)) != 0 ||
+               header.end < kHeaderSize || header.end > slab_.size) {
+        close();
+        fail("'" + path_ + "' is not a mapped item store.");
+    }
+}
+
+void MappedItemStore::openIndex() {
+    const std::string indexPath = path_ + ".index";
+    const SlabHeader& slab = slabHeader(slab_.base);
+
+    index_.fd = ::open(indexPath.c_str(), O_RDWR | O_CLOEXEC);
+    if (index_.fd >= 0) {
+        struct stat st{};
+        const uint64_t size = ::fstat(index_.fd, &st) == 0 ? static_cast<uint64_t>(st.st_size) : 0;
+        if (size >= kHeaderSize && (index_.base = mapFile(index_.fd, size))) {
+            index_.size = size;
+            const IndexHeader& header = indexHeader(index_.base);
+            const uint64_t capacity = header.capacity;
+            const bool usable = std::memcmp(header.magic, kIndexMagic, sizeof(kIndexMagic)) == 0 &&
+                                header.clean == 1 && header.slabEnd == slab.end &&
+                                capacity >= kMinIndexCapacity && (capacity & (capacity - 1)) == 0 &&
+                                size == kHeaderSize + capacity * kSlotSize;
+            if (usable) return;
+            ::munmap(index_.base, static_cast<size_t>(index_.size));
+        }
+        ::close(index_.fd);
+        index_ = Mapping{};
+    }
+
+    // Missing, stale or left dirty by a crash: the slab is authoritative.
+    rebuildIndex(kMinIndexCapacity);
+    indexRebuilt_ = true;
+}
+
+void MappedItemStore::rebuildIndex(uint64_t capacity) {
+    SlabHeader& slab = slabHeader(slab_.base);
+
+    // First pass: find the end of the intact records (a torn tail is dropped) and size the table.
+    uint64_t validEnd = kHeaderSize;
+    uint64_t liveFrames = 0;
+    while (slab.end - validEnd >= sizeof(RecordFrame)) {
+        const auto* frame = reinterpret_cast<const RecordFrame*>(slab_.base + validEnd);
+        if (frame->bodySize > kMaxBodySize || frame->bodySize < sizeof(RecordBodyHeader) ||
+            recordSize(frame->bodySize) > slab.end - validEnd ||
+            Checksum::crc32(slab_.base + validEnd + sizeof(RecordFrame), frame->bodySize) != frame->crc) {
+            break;
+        }
+        if (frame->flags & kLiveFlag) ++liveFrames;
+        validEnd += recordSize(frame->bodySize);
+    }
+    while (liveFrames * 2 >= capacity) capacity *= 2;
+
+    const std::string indexPath = path_ + ".index";
+    const std::string tmpPath = indexPath + ".tmp";
+    Mapping fresh;
+    if (!createIndexFile(tmpPath, capacity, fresh.fd, fresh.base, fresh.size)) {
+        fail("Cannot create index of mapped store '" + path_ + "'.");
+    }
+    Mapping old = index_;
+    index_ = fresh;
+
+    // Second pass: the last live record of a tag wins; earlier ones (a dead flag lost in a crash)
+    // are flagged dead again.
+    IndexHeader& header = indexHeader(index_.base);
+    uint64_t records = 0, liveBytes = 0;
+    for (uint64_t offset = kHeaderSize; offset < validEnd;) {
+        auto* frame = reinterpret_cast<RecordFrame*>(slab_.base + offset);
+        const uint64_t size = recordSize(frame->bodySize);
+        if (frame->flags & kLiveFlag) {
+            const std::string_view tag = recordAt(offset).tag;
+            const uint64_t hash = hashTag(tag);
+            Slot* slot = findSlot(tag, hash, true);
+            if (slot->offset > kDeletedSlot) {
+                auto* previous = reinterpret_cast<RecordFrame*>(slab_.base + slot->offset);
+                previous->flags &= ~kLiveFlag;
+                liveBytes -= recordSize(previous->bodySize);
+                --records;
+            } else {
+                ++header.used;
+            }
+            *slot = Slot{hash, offset};
+            liveBytes += size;
+            ++records;
+        }
+        offset += size;
+    }
+
+    slab.end = validEnd;
+    slab.records = records;
+    slab.liveBytes = liveBytes;
+
+    if (std::rename(tmpPath.c_str(), indexPath.c_str()) != 0) {
+        fail("Cannot install index of mapped store '" + path_ + "'.");
+    }
+    if (old.base) ::munmap(old.base, static_cast<size_t>(old.size));
+    if (old.fd >= 0) ::close(old.fd);
+}
+
+MappedItemStore::Slot* MappedItemStore::findSlot(std::string_view tag, uint64_t hash, bool forInsert) const {
+    const uint64_t capacity = indexHeader(index_.base).capacity;
+    Slot* table = slotsOf(index_.base);
+    Slot* tombstone = nullptr;
+    for (uint64_t probe = 0, i = hash & (capacity - 1); probe < capacity; ++probe, i = (i + 1) & (capacity - 1)) {
+        Slot& s = table[i];
+        if (s.offset == kEmptySlot) {
+            if (!forInsert) return nullptr;
+            return tombstone ? tombstone : &s;
+        }
+        if (s.offset == kDeletedSlot) {
+            if (!tombstone) tombstone = &s;
+            continue;
+        }
+        if (s.hash == hash && recordAt(s.offset).tag == tag) return &s;
+    }
+    return forInsert ? tombstone : nullptr;
+}
+
+MappedRecord MappedItemStore::recordAt(uint64_t offset) const {
+    const auto* frame = reinterpret_cast<const RecordFrame*>(slab_.base + offset);
+    const char* body = slab_.base + offset + sizeof(RecordFrame);
+    RecordBodyHeader h;
+    std::memcpy(&h, body, sizeof(h));
+
+    const char* p = body + sizeof(h);
+    MappedRecord record;
+    record.encoding = static_cast<MappedEncoding>(h.encoding);
+    record.tag = std::string_view(p, h.tagSize);
+    p += h.tagSize;
+    record.type = std::string_view(p, h.typeSize);
+    p += h.typeSize;
+    record.id = std::string_view(p, h.idSize);
+    p += h.idSize;
+    record.payload = std::string_view(p, frame->bodySize - (p - body));
+    return record;
+}
+
+std::optional<MappedRecord> MappedItemStore::find(std::string_view tag) const {
+    const Slot* slot = findSlot(tag, hashTag(tag), false);
+    if (!slot) return std::nullopt;
+    return recordAt(slot->offset);
+}
+
+void MappedItemStore::markIndexDirty() {
+    IndexHeader& header = indexHeader(index_.base);
+    if (header.clean == 0) return;
+    header.clean = 0;
+    // Must reach the disk before any mutation does, or a crash could leave a stale index marked clean.
+    ::msync(index_.base, kHeaderSize, MS_SYNC);
+}
+
+void MappedItemStore::growSlab(uint64_t needed) {
+    uint64_t size = std::max(slab_.size * 2, (needed + kSlabGrowth - 1) / kSlabGrowth * kSlabGrowth);
+    if (::ftruncate(slab_.fd, static_cast<off_t>(size)) != 0) fail("Cannot grow mapped store '" + path_ + "'.");
+    ::munmap(slab_.base, static_cast<size_t>(slab_.size));
+    slab_.base = mapFile(slab_.fd, size);
+    if (!slab_.base) fail("Cannot remap store '" + path_ + "'.");
+    slab_.size = size;
+}
+
+void MappedItemStore::put(std::string_view tag, std::string_view type, std::string_view id,
+                          MappedEncoding encoding, std::string_view payload) {
+    const uint64_t bodySize = sizeof(RecordBodyHeader) + tag.size() + type.size() + id.size() + payload.size();
+    if (bodySize > kMaxBodySize) fail("Record for tag '" + std::string(tag) + "' is too large for the mapped store.");
+    const uint64_t size = recordSize(static_cast<uint32_t>(bodySize));
+
+    markIndexDirty();
+    if (slabHeader(slab_.base).end + size > slab_.size) growSlab(slabHeader(slab_.base).end + size);
+
+    // Keep the load factor under 1/2; tombstones are dropped by the rebuild.
+    {
+        const IndexHeader& header = indexHeader(index_.base);
+        if ((header.used + header.deleted + 1) * 2 > header.capacity) {
+            uint64_t capacity = header.capacity;
+            while ((header.used + 1) * 4 > capacity) capacity *= 2;
+            rebuildIndex(capacity);
+            markIndexDirty();
+        }
+    }
+
+    SlabHeader& slab = slabHeader(slab_.base);
+    const uint64_t offset = slab.end;
+    char* out = slab_.base + offset;
+    RecordFrame frame{static_cast<uint32_t>(bodySize), 0, kLiveFlag, 0};
+    RecordBodyHeader h{static_cast<uint8_t>(encoding), {0, 0, 0}, static_cast<uint32_t>(tag.size()),
+                       static_cast<uint32_t>(type.size()), static_cast<uint32_t>(id.size())};
+
+    char* body = out + sizeof(frame);
+    char* p = body;
+    std::memcpy(p, &h, sizeof(h));
+    p += sizeof(h);
+    for (std::string_view piece : {tag, type, id, payload}) {
+        if (!piece.empty()) std::memcpy(p, piece.data(), piece.size());
+        p += piece.size();
+    }
+    std::memset(p, 0, static_cast<size_t>(size - sizeof(frame) - bodySize));
+    frame.crc = Checksum::crc32(body, bodySize);
+    std::memcpy(out, &frame, sizeof(frame));
+
+    const uint64_t hash = hashTag(tag);
+    Slot* slot = findSlot(tag, hash, true);
+    IndexHeader& header = indexHeader(index_.base);
+    if (slot->offset > kDeletedSlot) {
+        auto* previous = reinterpret_cast<RecordFrame*>(slab_.base + slot->offset);
+        previous->flags &= ~kLiveFlag;
+        slab.liveBytes -= recordSize(previous->bodySize);
+        --slab.records;
+    } else {
+        if (slot->offset == kDeletedSlot) --header.deleted;
+        ++header.used;
+    }
+    *slot = Slot{hash, offset};
+
+    slab.end = offset + size;
+    slab.liveBytes += size;
+    ++slab.records;
+}
+
+bool MappedItemStore::erase(std::string_view tag) {
+    Slot* slot = findSlot(tag, hashTag(tag), false);
+    if (!slot) return false;
+
+    markIndexDirty();
+    auto* frame = reinterpret_cast<RecordFrame*>(slab_.base + slot->offset);
+    frame->flags &= ~kLiveFlag;
+
+    SlabHeader& slab = slabHeader(slab_.base);
+    slab.liveBytes -= recordSize(frame->bodySize);
+    --slab.records;
+
+    IndexHeader& header = indexHeader(index_.base);
+    slot->offset = kDeletedSlot;
+    --header.used;
+    ++header.deleted;
+    return true;
+}
+
+void MappedItemStore::clear() {
+    markIndexDirty();
+    SlabHeader& slab = slabHeader(slab_.base);
+    slab.end = kHeaderSize;
+    slab.records = 0;
+    slab.liveBytes = 0;
+
+    IndexHeader& header = indexHeader(index_.base);
+    std::memset(slotsOf(index_.base), 0, static_cast<size_t>(header.capacity * kSlotSize));
+    header.used = 0;
+    header.deleted = 0;
+}
+
+void MappedItemStore::forEach(const std::function<void(const MappedRecord&)>& visitor) const {
+    const uint64_t end = slabHeader(slab_.base).end;
+    for (uint64_t offset = kHeaderSize; offset < end;) {
+        const auto* frame = reinterpret_cast<const RecordFrame*>(slab_.base + offset);
+        if (frame->flags & kLiveFlag) visitor(recordAt(offset));
+        offset += recordSize(frame->bodySize);
+    }
+}
+
+size_t MappedItemStore::size() const {
+    return static_cast<size_t>(slabHeader(slab_.base).records);
+}
+
+MappedStoreStats MappedItemStore::stats() const {
+    const SlabHeader& slab = slabHeader(slab_.base);
+    MappedStoreStats s;
+    s.records = slab.records;
+    s.liveBytes = slab.liveBytes;
+    s.usedBytes = slab.end;
+    s.fileBytes = slab_.size;
+    s.indexRebuilt = indexRebuilt_;
+    return s;
+}
+
+void MappedItemStore::sync() {
+    if (!slab_.base || !index_.base) return;
+    if (::msync(slab_.base, static_cast<size_t>(slab_.size), MS_SYNC) != 0) {
+        fail("Cannot sync mapped store '" + path_ + "'.");
+    }
+    IndexHeader& header = indexHeader(index_.base);
+    header.slabEnd = slabHeader(slab_.base).end;
+    header.clean = 1;
+    if (::msync(index_.base, static_cast<size_t>(index_.size), MS_SYNC) != 0) {
+        fail("Cannot sync index of mapped store '" + path_ + "'.");
+    }
+}
+
+void MappedItemStore::compact() {
+    const SlabHeader& slab = slabHeader(slab_.base);
+    const std::string tmpPath = path_ + ".compact";
+
+    Mapping fresh;
+    fresh.fd = ::open(tmpPath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fresh.fd < 0) fail("Cannot compact mapped store '" + path_ + "'.");
+    fresh.size = std::max<uint64_t>(kSlabGrowth, (kHeaderSize + slab.liveBytes + kSlabGrowth - 1) / kSlabGrowth * kSlabGrowth);
+    if (::ftruncate(fresh.fd, static_cast<off_t>(fresh.size)) != 0 || !(fresh.base = mapFile(fresh.fd, fresh.size))) {
+        ::close(fresh.fd);
+        std::remove(tmpPath.c_str());
+        fail("Cannot compact mapped store '" + path_ + "'.");
+    }
+
+    // Copy live records in slab order; their frames (CRC included) stay valid as they are.
+    SlabHeader& out = slabHeader(fresh.base);
+    std::memcpy(out.magic, kSlabMagic, sizeof(kSlabMagic));
+    out.end = kHeaderSize;
+    for (uint64_t offset = kHeaderSize; offset < slab.end;) {
+        const auto* frame = reinterpret_cast<const RecordFrame*>(slab_.base + offset);
+        const uint64_t size = recordSize(frame->bodySize);
+        if (frame->flags & kLiveFlag) {
+            std::memcpy(fresh.base + out.end, slab_.base + offset, static_cast<size_t>(size));
+            out.end += size;
+        }
+        offset += size;
+    }
+
+    if (::msync(fresh.base, static_cast<size_t>(fresh.size), MS_SYNC) != 0 ||
+        std::rename(tmpPath.c_str(), path_.c_str()) != 0) {
+        ::munmap(fresh.base, static_cast<size_t>(fresh.size));
+        ::close(fresh.fd);
+        std::remove(tmpPath.c_str());
+        fail("Cannot install compacted mapped store '" + path_ + "'.");
+    }
+
+    ::munmap(slab_.base, static_cast<size_t>(slab_.size));
+    ::close(slab_.fd);
+    slab_ = fresh;
+
+    rebuildIndex(kMinIndexCapacity);
+}
+
+#else
+
+MappedItemStore::MappedItemStore(const std::string& path) : path_(path) {
+    fail("Memory-mapped stores are not supported on this platform.");
+}
+MappedItemStore::~MappedItemStore() = default;
+void MappedItemStore::close() {}
+void MappedItemStore::openSlab() {}
+void MappedItemStore::openIndex() {}
+void MappedItemStore::rebuildIndex(uint64_t) {}
+void MappedItemStore::growSlab(uint64_t) {}
+void MappedItemStore::markIndexDirty() {}
+MappedItemStore::Slot* MappedItemStore::findSlot(std::string_view, uint64_t, bool) const { return nullptr; }
+MappedRecord MappedItemStore::recordAt(uint64_t) const { return {}; }
+std::optional<MappedRecord> MappedItemStore::find(std::string_view) const { return std::nullopt; }
+void MappedItemStore::put(std::string_view, std::string_view, std::string_view, MappedEncoding, std::string_view) {}
+bool MappedItemStore::erase(std::string_view) { return false; }
+void MappedItemStore::clear() {}
+void MappedItemStore::forEach(const std::function<void(const MappedRecord&)>&) const {}
+size_t MappedItemStore::size() const { return 0; }
+MappedStoreStats MappedItemStore::stats() const { return {}; }
+void MappedItemStore::sync() {}
+void MappedItemStore::compact() {}
+
+#endif
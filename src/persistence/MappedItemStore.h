@@ -0,0 +1,117 @@
+#pragma once
+#ifndef MAPPED_ITEM_STORE_H
+#define MAPPED_ITEM_STORE_H
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// :::MappedItemStore class
+// :::Persistent tag -> item table kept in two memory-mapped files (POSIX only):
+// :::  <path>        slab of records (tag, type, id, encoding, payload), appended to; a record
+// :::                replaced or erased is only flagged dead and its space reclaimed by compact()
+// :::  <path>.index  open-addressing hash table of tag -> record offset
+// :::Opening an existing store maps both files and is ready at once; nothing is decoded. The
+// :::index is marked clean only by sync()/close, so after a crash it is rebuilt by scanning the
+// :::slab (every record carries a CRC; the scan stops at the first torn one).
+// :::Not thread-safe: the owner serializes access (ItemManager calls it under its store lock).
+// **************************************************************************************************
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// How a record's payload is encoded. Scalars are stored as raw bytes and can be read
+// straight from the mapping; everything else is the item's serialize() output as MessagePack.
+enum class MappedEncoding : uint8_t {
+    MsgPack = 1,
+    Int     = 2,   // int64_t
+    UInt    = 3,   // uint64_t
+    Float   = 4,   // double
+    Bool    = 5,   // uint8_t
+    String  = 6    // UTF-8 bytes
+};
+
+// A record as seen through the mapping. The views are invalidated by the next put, erase or compact.
+struct MappedRecord {
+    std::string_view tag;
+    std::string_view type;
+    std::string_view id;
+    MappedEncoding encoding = MappedEncoding::MsgPack;
+    std::string_view payload;
+};
+
+struct MappedStoreStats {
+    uint64_t records = 0;       // live records
+    uint64_t liveBytes = 0;     // bytes held by live records
+    uint64_t usedBytes = 0;     // bytes of the slab in use, dead records included
+    uint64_t fileBytes = 0;     // mapped size of the slab file
+    bool indexRebuilt = false;  // the index was rebuilt from the slab when the store was opened
+};
+
+class MappedItemStore {
+    public:
+        // Opens (or creates) the store at `path`. Throws std::runtime_error if the files cannot be
+        // created or mapped, or the slab is not a store file.
+        explicit MappedItemStore(const std::string& path);
+        ~MappedItemStore();
+
+        MappedItemStore(const MappedItemStore&) = delete;
+        MappedItemStore& operator=(const MappedItemStore&) = delete;
+
+        std::optional<MappedRecord> find(std::string_view tag) const;
+        bool contains(std::string_view tag) const { return find(tag).has_value(); }
+
+        // Inserts or replaces the record of `tag`.
+        void put(std::string_view tag, std::string_view type, std::string_view id,
+                 MappedEncoding encoding, std::string_view payload);
+
+        // False if there was no record for `tag`.
+        bool erase(std::string_view tag);
+
+        // Drops every record (the files stay mapped).
+        void clear();
+
+        // Visits every live record in slab order.
+        void forEach(const std::function<void(const MappedRecord&)>& visitor) const;
+
+        size_t size() const;
+        MappedStoreStats stats() const;
+        const std::string& path() const { return path_; }
+
+        // Flushes both mappings to disk and marks the index consistent with the slab.
+        void sync();
+
+        // Rewrites the slab with only the live records and rebuilds the index.
+        void compact();
+
+        static bool supported();
+
+    private:
+        struct Slot;
+
+        struct Mapping {
+            int fd = -1;
+            char* base = nullptr;
+            uint64_t size = 0;
+        };
+
+        void openSlab();
+        void openIndex();
+        void rebuildIndex(uint64_t capacity);
+        void growSlab(uint64_t needed);
+        void markIndexDirty();
+
+        static Slot* slotsOf(char* indexBase);
+
+        // Slot holding `tag`; with forInsert, the slot to use when it is absent.
+        Slot* findSlot(std::string_view tag, uint64_t hash, bool forInsert) const;
+        MappedRecord recordAt(uint64_t offset) const;
+        void close();
+
+        std::string path_;
+        Mapping slab_;
+        Mapping index_;
+        bool indexRebuilt_ = false;
+};
+
+#endif // MAPPED_ITEM_STORE_H
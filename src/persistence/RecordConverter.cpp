@@ -0,0 +1,746 @@
+#include "RecordConverter.h"
+#include "err_log/Logger.hpp"
+#include "utils/AtomicFileWriter .hpp"
+#include "utils/Csv_utils.hpp"
+#include "tinyxml2.h"
+
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using json = nlohmann::json;
+
+// ::::| RecordConverter: streaming format conversion with migration
+// *****************************************************************
+
+std::optional<RecordFormat> parseRecordFormat(std::string_view name) {
+    std::string lower(name);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (lower == "json") return RecordFormat::Json;
+    if (lower == "binary" || lower == "bin") return RecordFormat::Binary;
+    if (lower == "xml") return RecordFormat::Xml;
+    if (lower == "csv") return RecordFormat::Csv;
+    return std::nullopt;
+}
+
+std::optional<RecordFormat> recordFormatOf(const std::string& path) {
+    std::string extension = std::filesystem::path(path).extension().string();
+    if (extension.empty()) return std::nullopt;
+    if (extension == ".dat") return RecordFormat::Binary;
+    return parseRecordFormat(std::string_view(extension).substr(1));
+}
+
+const char* recordFormatName(RecordFormat format) {
+    switch (format) {
+        case RecordFormat::Json:   return "json";
+        case RecordFormat::Binary: return "binary";
+        case RecordFormat::Xml:    return "xml";
+        case RecordFormat::Csv:    return "csv";
+    }
+    return "unknown";
+}
+
+namespace {
+
+    constexpr size_t kBlockSize = 1 << 16;
+
+    // :::: Input, read a block at a time
+
+    class BlockInput {
+        public:
+            explicit BlockInput(const std::string& path) : in_(path, std::ios::binary), block_(kBlockSize) {
+                std::error_code ec;
+                size_ = std::filesystem::file_size(path, ec);
+                if (ec) size_ = 0;
+            }
+
+            bool isOpen() const { return in_.is_open(); }
+            uint64_t consumed() const { return consumed_; }
+            uint64_t remaining() const { return size_ > consumed_ ? size_ - consumed_ : 0; }
+
+            int get() {
+                if (pos_ == end_ && !refill()) return EOF;
+                ++consumed_;
+                return static_cast<unsigned char>(block_[pos_++]);
+            }
+
+            bool read(char* out, size_t count) {
+                while (count > 0) {
+                    if (pos_ == end_ && !refill()) return false;
+                    const size_t n = std::min(count, end_ - pos_);
+                    std::memcpy(out, block_.data() + pos_, n);
+                    pos_ += n;
+                    consumed_ += n;
+                    out += n;
+                    count -= n;
+                }
+                return true;
+            }
+
+            // Appends up to one block to `out`; false at the end of the file.
+            bool readBlock(std::string& out) {
+                if (pos_ == end_ && !refill()) return false;
+                out.append(block_.data() + pos_, end_ - pos_);
+                consumed_ += end_ - pos_;
+                pos_ = end_;
+                return true;
+            }
+
+            bool getline(std::string& line) {
+                line.clear();
+                int c = get();
+                if (c == EOF) return false;
+                while (c != EOF && c != '\n') {
+                    line.push_back(static_cast<char>(c));
+                    c = get();
+                }
+                return true;
+            }
+
+        private:
+            bool refill() {
+                in_.read(block_.data(), static_cast<std::streamsize>(block_.size()));
+                pos_ = 0;
+                end_ = static_cast<size_t>(in_.gcount());
+                return end_ > 0;
+            }
+
+            std::ifstream in_;
+            std::vector<char> block_;
+            size_t pos_ = 0;
+            size_t end_ = 0;
+            uint64_t consumed_ = 0;
+            uint64_t size_ = 0;
+    };
+
+    // :::: Readers: one raw record per call, nothing decoded
+
+    class RecordReader {
+        public:
+            explicit RecordReader(const std::string& path) : in_(path) {}
+            virtual ~RecordReader() = default;
+
+            // Checks what precedes the records; false if the file is not in this format.
+            virtual bool open() { return in_.isOpen(); }
+            // The next record; false at the end of the records, or if the input ends inside one.
+            virtual bool next(std::string& raw) = 0;
+            uint64_t bytesRead() const { return in_.consumed(); }
+            // The input ended before the records did (a torn copy or an interrupted write).
+            bool truncated() const { return truncated_; }
+
+        protected:
+            BlockInput in_;
+            bool truncated_ = false;
+    };
+
+    // The elements of the top-level array, or of the "items" array of a top-level object, scanned
+    // for their extent with string and nesting state only.
+    class JsonReader : public RecordReader {
+        public:
+            using RecordReader::RecordReader;
+
+            bool open() override {
+                if (!in_.isOpen()) return false;
+                int c = skipSpace();
+                if (c == '[') return true;
+                if (c != '{') return false;
+
+                int depth = 1;
+                std::string lastString, key;
+                while ((c = in_.get()) != EOF) {
+                    if (c == '"') {
+                        lastString = readString();
+                    } else if (c == ':' && depth == 1) {
+                        key = lastString;
+                    } else if (c == '[' && depth == 1 && key == "items") {
+                        return true;
+                    } else if (c == '{' || c == '[') {
+                        ++depth;
+                    } else if (c == '}' || c == ']') {
+                        if (--depth == 0) return false;
+                    } else if (c == ',' && depth == 1) {
+                        key.clear();
+                    }
+                }
+                return false;
+            }
+
+            bool next(std::string& raw) override {
+                if (finished_) return false;
+                int c;
+                do { c = skipSpace(); } while (c == ',');
+                if (c == EOF || c == ']') {
+                    finished_ = true;
+                    truncated_ = (c == EOF);
+                    return false;
+                }
+
+                raw.clear();
+                int depth = 0;
+                for (; c != EOF; c = in_.get()) {
+                    if (c == '"') {
+                        raw.push_back('"');
+                        appendString(raw);
+                        continue;
+                    }
+                    if (depth == 0 && (c == ',' || c == ']')) {
+                        finished_ = (c == ']');
+                        return true;
+                    }
+                    if (c == '{' || c == '[') ++depth;
+                    else if (c == '}' || c == ']') --depth;
+                    raw.push_back(static_cast<char>(c));
+                }
+                finished_ = true;
+                truncated_ = true;
+                const size_t last = raw.find_last_not_of(" \t\r\n");
+                return depth == 0 && last != std::string::npos && raw[last] == '}';   // keep the last element if it is whole
+            }
+
+        private:
+            int skipSpace() {
+                int c = in_.get();
+                while (c != EOF && std::isspace(c)) c = in_.get();
+                return c;
+            }
+
+            // After the opening quote: appends the rest of the string, closing quote included.
+            void appendString(std::string& out) {
+                for (int c = in_.get(); c != EOF; c = in_.get()) {
+                    out.push_back(static_cast<char>(c));
+                    if (c == '\\') {
+                        c = in_.get();
+                        if (c == EOF) return;
+                        out.push_back(static_cast<char>(c));
+                    } else if (c == '"') {
+                        return;
+                    }
+                }
+            }
+
+            std::string readString() {
+                std::string s;
+                appendString(s);
+                if (!s.empty()) s.pop_back();
+                return s;
+            }
+
+            bool finished_ = false;
+    };
+
+    // typeSize, type, tagSize, tag, dataSize, payload: the whole framed record is the raw record.
+    class BinaryReader : public RecordReader {
+        public:
+            using RecordReader::RecordReader;
+
+            bool next(std::string& raw) override {
+                raw.clear();
+                if (in_.remaining() == 0) return false;   // ends between records
+                for (int field = 0; field < 3; ++field) {
+                    uint32_t size = 0;
+                    if (!in_.read(reinterpret_cast<char*>(&size), sizeof(size)) || size > in_.remaining()) {
+                        truncated_ = true;
+                        return false;
+                    }
+                    const size_t at = raw.size();
+                    raw.append(reinterpret_cast<const char*>(&size), sizeof(size));
+                    raw.resize(at + sizeof(size) + size);
+                    if (!in_.read(raw.data() + at + sizeof(size), size)) {
+                        truncated_ = true;
+                        return false;
+                    }
+                }
+                return true;
+            }
+    };
+
+    // The <Item>...</Item> spans under <SmartStore>; item text is escaped, so a span ends at the
+    // first closing tag. The records end at </SmartStore> (or an empty <SmartStore/>).
+    class XmlReader : public RecordReader {
+        public:
+            using RecordReader::RecordReader;
+
+            bool open() override {
+                if (!in_.isOpen()) return false;
+                size_t root;
+                while ((root = pending_.find("<SmartStore")) == std::string::npos) {
+                    if (pending_.size() > kBlockSize * 4 || !in_.readBlock(pending_)) return false;
+                }
+                while (pending_.find('>', root) == std::string::npos) {
+                    if (!in_.readBlock(pending_)) return false;
+                }
+                finished_ = pending_[pending_.find('>', root) - 1] == '/';
+                return true;
+            }
+
+            bool next(std::string& raw) override {
+                static constexpr std::string_view kOpen = "<Item>";
+                static constexpr std::string_view kClose = "</Item>";
+                static constexpr std::string_view kEnd = "</SmartStore>";
+                if (finished_) return false;
+
+                size_t start;
+                while ((start = pending_.find(kOpen, offset_)) == std::string::npos) {
+                    if (pending_.find(kEnd, offset_) != std::string::npos) {
+                        finished_ = true;
+                        return false;
+                    }
+                    // Keep enough to find either tag split across two blocks.
+                    offset_ = pending_.size() > kEnd.size() ? pending_.size() - kEnd.size() : 0;
+                    if (!refill()) {
+                        truncated_ = true;
+                        return false;
+                    }
+                }
+                size_t end;
+                while ((end = pending_.find(kClose, start)) == std::string::npos) {
+                    const size_t shift = compact(start);
+                    start -= shift;
+                    if (!in_.readBlock(pending_)) {
+                        truncated_ = true;
+                        return false;
+                    }
+                }
+                end += kClose.size();
+                raw.assign(pending_, start, end - start);
+                offset_ = end;
+                return true;
+            }
+
+        private:
+            bool refill() {
+                compact(offset_);
+                return in_.readBlock(pending_);
+            }
+
+            // Drops the bytes before `keep`; returns how many were dropped.
+            size_t compact(size_t keep) {
+                if (keep == 0) return 0;
+                pending_.erase(0, keep);
+                offset_ -= std::min(offset_, keep);
+                return keep;
+            }
+
+            std::string pending_;
+            size_t offset_ = 0;
+            bool finished_ = false;
+    };
+
+    class CsvReader : public RecordReader {
+        public:
+            using RecordReader::RecordReader;
+
+            bool open() override {
+                std::string header;
+                return in_.isOpen() && in_.getline(header) && header == "id,tag,type,data";
+            }
+
+            bool next(std::string& raw) override {
+                while (in_.getline(raw)) {
+                    if (!raw.empty()) return true;
+                }
+                return false;
+            }
+    };
+
+    std::unique_ptr<RecordReader> makeReader(RecordFormat format, const std::string& path) {
+        switch (format) {
+            case RecordFormat::Json:   return std::make_unique<JsonReader>(path);
+            case RecordFormat::Binary: return std::make_unique<BinaryReader>(path);
+            case RecordFormat::Xml:    return std::make_unique<XmlReader>(path);
+            case RecordFormat::Csv:    return std::make_unique<CsvReader>(path);
+        }
+        return nullptr;
+    }
+
+    // :::: Records: decoded into the form migrations see, and encoded back
+
+    struct Record {
+        std::string type;
+        std::string tag;
+        int version = 1;
+        json item;     // {id, tag, type, data}
+        json schema;   // JSON entries only
+    };
+
+    int versionOf(const json& j) {
+        if (!j.is_object()) return 1;
+        auto it = j.find("version");
+        return it != j.end() && it->is_number_integer() ? it->get<int>() : 1;
+    }
+
+    // Fills in what the importers fill in when a record leaves it out.
+    void completeItem(Record& record) {
+        if (!record.item.contains("id") && !record.tag.empty()) record.item["id"] = record.tag;
+        if (!record.item.contains("tag")) record.item["tag"] = record.tag;
+        if (!record.item.contains("type")) record.item["type"] = record.type;
+    }
+
+    bool decodeJson(const std::string& raw, Record& record) {
+        json entry = json::parse(raw);
+        if (!entry.is_object() || !entry.contains("tag") || !entry.contains("type") || !entry.contains("data")) return false;
+        record.tag = entry["tag"].get<std::string>();
+        record.type = entry["type"].get<std::string>();
+        record.version = entry.value("version", 1);
+        record.item = std::move(entry["data"]);
+        if (!record.item.is_object()) return false;
+        if (!record.item.contains("id") && entry.contains("id")) record.item["id"] = entry["id"];
+        if (entry.contains("schema")) record.schema = std::move(entry["schema"]);
+        return true;
+    }
+
+    bool decodeBinary(const std::string& raw, Record& record) {
+        size_t at = 0;
+        auto field = [&raw, &at]() {
+            uint32_t size = 0;
+            std::memcpy(&size, raw.data() + at, sizeof(size));
+            at += sizeof(size);
+            std::string_view value(raw.data() + at, size);
+            at += size;
+            return value;
+        };
+        record.type = std::string(field());
+        record.tag = std::string(field());
+        record.item = json::parse(field());
+        if (!record.item.is_object()) return false;
+        record.version = versionOf(record.item);
+        completeItem(record);
+        return true;
+    }
+
+    bool decodeXml(const std::string& raw, Record& record) {
+        tinyxml2::XMLDocument doc;
+        if (doc.Parse(raw.data(), raw.size()) != tinyxml2::XML_SUCCESS) return false;
+        auto* item = doc.FirstChildElement("Item");
+        auto* tag = item ? item->FirstChildElement("Tag") : nullptr;
+        auto* type = item ? item->FirstChildElement("Type") : nullptr;
+        auto* data = item ? item->FirstChildElement("Data") : nullptr;
+        auto* version = item ? item->FirstChildElement("Version") : nullptr;
+        if (!tag || !type || !data || !tag->GetText() || !type->GetText() || !data->GetText()) return false;
+
+        record.tag = tag->GetText();
+        record.type = type->GetText();
+        record.version = version && version->GetText() ? std::atoi(version->GetText()) : 1;
+        record.item = json::parse(data->GetText());
+        if (!record.item.is_object()) return false;
+        completeItem(record);
+        return true;
+    }
+
+    // Same splitting as importFromFile_CSV; the version travels inside the data.
+    bool decodeCsv(const std::string& raw, Record& record) {
+        std::vector<std::string> fields(1);
+        bool inQuotes = false;
+        for (size_t i = 0; i < raw.size(); ++i) {
+            const char c = raw[i];
+            if (c == '"') {
+                if (i + 1 < raw.size() && raw[i + 1] == '"') {
+                    fields.back() += '"';
+                    ++i;
+                } else {
+                    inQuotes = !inQuotes;
+                }
+            } else if (c == ',' && !inQuotes) {
+                fields.emplace_back();
+            } else {
+                fields.back() += c;
+            }
+        }
+        if (inQuotes || fields.size() != 4) return false;   // a torn last line ends inside a quote
+
+        json data;
+        try {
+            data = json::parse(fields[3]);
+        } catch (...) {
+            data = fields[3];
+        }
+        record.tag = fields[1];
+        record.type = fields[2];
+        record.version = versionOf(data);
+        record.item = {{"id", fields[0]}, {"tag", fields[1]}, {"type", fields[2]}, {"data", std::move(data)}};
+        return true;
+    }
+
+    bool decode(RecordFormat format, const std::string& raw, Record& record) {
+        switch (format) {
+            case RecordFormat::Json:   return decodeJson(raw, record);
+            case RecordFormat::Binary: return decodeBinary(raw, record);
+            case RecordFormat::Xml:    return decodeXml(raw, record);
+            case RecordFormat::Csv:    return decodeCsv(raw, record);
+        }
+        return false;
+    }
+
+    // Entries indented as in exportToFile_Json.
+    void encodeJson(Record& record, std::string& out) {
+        json entry;
+        entry["id"] = record.item.contains("id") ? record.item["id"] : json(record.tag);
+        entry["tag"] = record.tag;
+        entry["type"] = record.type;
+        if (record.version != 1) entry["version"] = record.version;
+        if (!record.schema.is_null()) entry["schema"] = std::move(record.schema);
+        entry["data"] = std::move(record.item);
+
+        out += "    ";
+        for (char c : entry.dump(4)) {
+            out += c;
+            if (c == '\n') out += "    ";
+        }
+    }
+
+    void encodeBinary(const Record& record, std::string& out) {
+        const std::string payload = record.item.dump();
+        for (std::string_view field : {std::string_view(record.type), std::string_view(record.tag), std::string_view(payload)}) {
+            const uint32_t size = static_cast<uint32_t>(field.size());
+            out.append(reinterpret_cast<const char*>(&size), sizeof(size));
+            out.append(field.data(), field.size());
+        }
+    }
+
+    void encodeXml(Record& record, std::string& out) {
+        json wrapped = std::move(record.item);
+        wrapped.erase("version");   // carried by <Version>
+        if (wrapped.contains("data") && !wrapped["data"].is_object()) {
+            wrapped["data"] = {{"value", std::move(wrapped["data"])}};
+        }
+        const std::string data = wrapped.dump();
+
+        tinyxml2::XMLPrinter printer(nullptr, false, 1);
+        printer.OpenElement("Item");
+        printer.OpenElement("Tag");
+        printer.PushText(record.tag.c_str());
+        printer.CloseElement();
+        printer.OpenElement("Type");
+        printer.PushText(record.type.c_str());
+        printer.CloseElement();
+        if (record.version != 1) {
+            printer.OpenElement("Version");
+            printer.PushText(record.version);
+            printer.CloseElement();
+        }
+        printer.OpenElement("Data");
+        printer.PushText(data.c_str());
+        printer.CloseElement();
+        printer.CloseElement();
+        out.append(printer.CStr(), printer.CStrSize() - 1);
+        out.push_back('\n');
+    }
+
+    void encodeCsv(Record& record, std::string& out) {
+        json& data = record.item["data"];
+        if (record.version != 1 && data.is_object()) data["version"] = record.version;
+        const std::string dataStr = data.is_string() ? data.get<std::string>() : data.dump();
+        const std::string id = record.item["id"].is_string() ? record.item["id"].get<std::string>() : record.item["id"].dump();
+
+        CsvUtils::appendQuoted(out, id);
+        out.push_back(',');
+        CsvUtils::appendQuoted(out, record.tag);
+        out.push_back(',');
+        CsvUtils::appendQuoted(out, record.type);
+        out.push_back(',');
+        CsvUtils::appendQuoted(out, dataStr);
+        out.push_back('\n');
+    }
+
+    void encode(RecordFormat format, Record& record, std::string& out) {
+        switch (format) {
+            case RecordFormat::Json:   encodeJson(record, out); break;
+            case RecordFormat::Binary: encodeBinary(record, out); break;
+            case RecordFormat::Xml:    encodeXml(record, out); break;
+            case RecordFormat::Csv:    encodeCsv(record, out); break;
+        }
+    }
+
+    // What surrounds and separates the records of each format.
+    struct Framing {
+        std::string_view prologue;
+        std::string_view separator;
+        std::string_view epilogue;
+        std::string_view empty;
+    };
+
+    Framing framingOf(RecordFormat format) {
+        switch (format) {
+            case RecordFormat::Json:   return {"[\n", ",\n", "\n]", "[]"};
+            case RecordFormat::Binary: return {"", "", "", ""};
+            case RecordFormat::Xml:    return {"<SmartStore>\n", "", "</SmartStore>\n", "<SmartStore/>\n"};
+            case RecordFormat::Csv:    return {"id,tag,type,data\n", "", "", "id,tag,type,data\n"};
+        }
+        return {};
+    }
+
+    // :::: Pipeline: reader -> workers -> in-order writer
+
+    struct Batch {
+        uint64_t seq = 0;
+        std::vector<std::string> raw;
+        std::string out;
+        uint64_t records = 0;
+        uint64_t migrated = 0;
+        uint64_t skipped = 0;
+    };
+
+    struct Pipeline {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<std::unique_ptr<Batch>> todo;
+        std::map<uint64_t, std::unique_ptr<Batch>> done;
+        size_t inFlight = 0;
+        uint64_t batchesRead = 0;
+        bool readerDone = false;
+    };
+
+}  // namespace
+
+std::optional<ConvertStats> RecordConverter::convert(const std::string& input, const std::string& output,
+                                                     const ConvertOptions& options) const {
+    const auto started = std::chrono::steady_clock::now();
+
+    auto reader = makeReader(options.from, input);
+    if (!reader->open()) {
+        LOG_CONTEXT(LogLevel::ERR, "Cannot read '" + input + "' as " + recordFormatName(options.from) + ".", false);
+        return std::nullopt;
+    }
+
+    AtomicWriteOptions writeOptions;
+    writeOptions.durable = options.durable;
+    AtomicFileWriter::Sink sink(output, writeOptions);
+    if (!sink.ok()) {
+        LOG_CONTEXT(LogLevel::ERR, "Cannot open '" + output + "' for writing.", false);
+        return std::nullopt;
+    }
+
+    ConvertStats stats;
+    stats.workers = options.workers ? options.workers : std::max(1u, std::thread::hardware_concurrency());
+    const size_t batchSize = std::max<size_t>(1, options.batchSize);
+    const size_t maxInFlight = options.maxBatchesInFlight ? options.maxBatchesInFlight : stats.workers * 2;
+    const Framing framing = framingOf(options.to);
+
+    Pipeline pipe;
+
+    auto work = [&](Batch& batch) {
+        for (const std::string& raw : batch.raw) {
+            Record record;
+            try {
+                if (!decode(options.from, raw, record)) {
+                    ++batch.skipped;
+                    continue;
+                }
+                if (options.migrate) {
+                    const int reached = migrations_.upgradeInPlace(record.type, record.version, record.item);
+                    if (reached != record.version) {
+                        ++batch.migrated;
+                        record.version = reached;
+                    }
+                }
+                if (record.version != 1) record.item["version"] = record.version;
+                if (!batch.out.empty()) batch.out += framing.separator;
+                encode(options.to, record, batch.out);
+                ++batch.records;
+            } catch (const std::exception& e) {
+                LOG_CONTEXT(LogLevel::WARNING, "Skipping record of '" + record.tag + "': " + e.what(), {});
+                ++batch.skipped;
+            }
+        }
+        batch.raw.clear();
+        batch.raw.shrink_to_fit();
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < stats.workers; ++i) {
+        workers.emplace_back([&pipe, &work] {
+            std::unique_lock<std::mutex> lock(pipe.mutex);
+            for (;;) {
+                pipe.cv.wait(lock, [&pipe] { return !pipe.todo.empty() || pipe.readerDone; });
+                if (pipe.todo.empty()) return;
+                auto batch = std::move(pipe.todo.front());
+                pipe.todo.pop_front();
+                lock.unlock();
+                work(*batch);
+                lock.lock();
+                const uint64_t seq = batch->seq;
+                pipe.done.emplace(seq, std::move(batch));
+                pipe.cv.notify_all();
+            }
+        });
+    }
+
+    bool written = true;
+    bool first = true;   // nothing written yet
+    std::thread writer([&] {
+        std::unique_lock<std::mutex> lock(pipe.mutex);
+        for (uint64_t next = 0;; ++next) {
+            pipe.cv.wait(lock, [&pipe, next] { return pipe.done.count(next) || (pipe.readerDone && next == pipe.batchesRead); });
+            auto it = pipe.done.find(next);
+            if (it == pipe.done.end()) return;
+            auto batch = std::move(it->second);
+            pipe.done.erase(it);
+            lock.unlock();
+
+            if (!batch->out.empty()) {
+                written = sink.write(first ? framing.prologue : framing.separator) && written;
+                written = sink.write(batch->out) && written;
+                stats.bytesOut += batch->out.size();
+                first = false;
+            }
+            stats.records += batch->records;
+            stats.migrated += batch->migrated;
+            stats.skipped += batch->skipped;
+            batch.reset();
+
+            lock.lock();
+            --pipe.inFlight;
+            pipe.cv.notify_all();
+        }
+    });
+
+    for (bool more = true; more;) {
+        auto batch = std::make_unique<Batch>();
+        batch->raw.reserve(batchSize);
+        std::string raw;
+        while (batch->raw.size() < batchSize && (more = reader->next(raw))) {
+            batch->raw.push_back(std::move(raw));
+        }
+
+        std::unique_lock<std::mutex> lock(pipe.mutex);
+        if (!batch->raw.empty()) {
+            pipe.cv.wait(lock, [&pipe, maxInFlight] { return pipe.inFlight < maxInFlight; });
+            batch->seq = pipe.batchesRead++;
+            ++pipe.inFlight;
+            pipe.todo.push_back(std::move(batch));
+        }
+        if (!more) pipe.readerDone = true;
+        pipe.cv.notify_all();
+    }
+
+    for (auto& worker : workers) worker.join();
+    writer.join();
+    stats.bytesIn = reader->bytesRead();
+    if (reader->truncated()) {
+        LOG_CONTEXT(LogLevel::WARNING, "'" + input + "' ends inside a record; the partial record is skipped.", {});
+        ++stats.skipped;
+    }
+
+    written = sink.write(first ? framing.empty : framing.epilogue) && written;
+    if (!written || !sink.commit()) {
+        LOG_CONTEXT(LogLevel::ERR, "Failed to write '" + output + "'.", false);
+        return std::nullopt;
+    }
+
+    stats.elapsed = std::chrono::steady_clock::now() - started;
+    if (stats.skipped) {
+        LOG_CONTEXT(LogLevel::WARNING, std::to_string(stats.skipped) + " record(s) of '" + input + "' could not be converted.", {});
+    }
+    return stats;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#ifndef RECORD_CONVERTER_H
+#define RECORD_CONVERTER_H
+
+#include "versionForMigration/MigrationRegistry.h"
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// :::RecordConverter class
+// :::Offline conversion of an export file from one format to another (JSON, binary, XML, CSV, in the
+// :::layouts of the ItemManager exporters), upgrading every record to its latest version on the way.
+// :::Nothing is deserialized: a reader streams raw records out of the input in blocks, worker threads
+// :::decode, migrate and re-encode them a batch at a time, and a writer appends the batches in input
+// :::order to a temporary that replaces the output once complete. At most `maxBatchesInFlight` batches
+// :::exist at once, so memory stays bounded whatever the size of the file.
+// :::Migrations see a record as importFromFile_Json/_Binary/_XML hand it to them: {id, tag, type, data}.
+// :::A record that was upgraded, or was read with a version other than 1, is written with its version.
+// **************************************************************************************************
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+enum class RecordFormat { Json, Binary, Xml, Csv };
+
+// "json", "binary" (or "bin"), "xml", "csv"; nullopt for anything else.
+std::optional<RecordFormat> parseRecordFormat(std::string_view name);
+// The format named by the extension of `path` (.json, .bin/.dat, .xml, .csv).
+std::optional<RecordFormat> recordFormatOf(const std::string& path);
+const char* recordFormatName(RecordFormat format);
+
+struct ConvertOptions {
+    RecordFormat from = RecordFormat::Json;
+    RecordFormat to = RecordFormat::Binary;
+    unsigned workers = 0;              // 0: one per hardware thread
+    size_t batchSize = 512;            // records per batch
+    size_t maxBatchesInFlight = 0;     // 0: two per worker
+    bool migrate = true;
+    bool durable = false;              // fsync the output before it replaces the old one
+};
+
+struct ConvertStats {
+    uint64_t records = 0;     // records written
+    uint64_t migrated = 0;    // records upgraded by at least one step
+    uint64_t skipped = 0;     // records that could not be decoded or migrated, or were cut off by the end of the input
+    uint64_t bytesIn = 0;
+    uint64_t bytesOut = 0;
+    unsigned workers = 0;
+    std::chrono::duration<double> elapsed{0};
+
+    double recordsPerSecond() const { return elapsed.count() > 0 ? records / elapsed.count() : 0.0; }
+    double megabytesPerSecond() const { return elapsed.count() > 0 ? bytesIn / 1e6 / elapsed.count() : 0.0; }
+};
+
+class RecordConverter {
+    public:
+        explicit RecordConverter(const MigrationRegistry& migrations) : migrations_(migrations) {}
+
+        // Converts `input` into `output`; nullopt (and `output` untouched) if the input cannot be
+        // opened or is not in the expected format, or the output cannot be written.
+        std::optional<ConvertStats> convert(const std::string& input, const std::string& output,
+                                            const ConvertOptions& options) const;
+
+    private:
+        const MigrationRegistry& migrations_;
+};
+
+#endif // RECORD_CONVERTER_H
@@ -0,0 +1,766 @@
+#include "SegmentLog.h"
+#include "err_log/Logger.hpp"
+#include "utils/Checksum.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// ::::| SegmentLog: append-only segments, footers and background compaction
+// **************************************************************************
+
+namespace {
+
+    constexpr char kSegmentMagic[8] = {'S', 'S', 'S', 'E', 'G', '0', '0', '1'};
+    constexpr char kFooterMagic[8]  = {'S', 'S', 'S', 'E', 'G', 'E', 'N', 'D'};
+    constexpr size_t kSegmentHeader = sizeof(kSegmentMagic) + sizeof(uint64_t);   // magic + segment id
+    constexpr size_t kFrameHeader = sizeof(uint32_t) * 2;                          // body length + CRC
+    constexpr size_t kTrailerSize = 32;    // footer offset, counts, CRC, magic
+    constexpr uint32_t kMaxRecordSize = 1u << 30;
+    constexpr uint32_t kNoType = 0xFFFFFFFFu;
+
+    enum : uint8_t { OpPut = 1, OpDelete = 2, OpTypeDef = 3 };
+
+    // :: Thin platform layer over file descriptors
+    // ::::::::::::::::::::::::::::::::::::::::::::
+
+    int openSegment(const std::string& path, bool create) {
+#if defined(_WIN32)
+        return ::_open(path.c_str(), _O_RDWR | _O_BINARY | _O_APPEND | (create ? _O_CREAT | _O_EXCL : 0), _S_IREAD | _S_IWRITE);
+#else
+        return ::open(path.c_str(), O_RDWR | O_APPEND | O_CLOEXEC | (create ? O_CREAT | O_EXCL : 0), 0644);
+#endif
+    }
+
+    bool writeAll(int fd, const char* data, size_t size) {
+        while (size > 0) {
+#if defined(_WIN32)
+            int n = ::_write(fd, data, static_cast<unsigned int>(size));
+#else
+            ssize_t n = ::write(fd, data, size);
+            if (n < 0 && errno == EINTR) continue;
+#endif
+            if (n <= 0) return false;
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    // Callers serialize reads of one descriptor (the Windows path seeks).
+    bool readAt(int fd, char* data, size_t size, uint64_t offset) {
+        while (size > 0) {
+#if defined(_WIN32)
+            if (::_lseeki64(fd, static_cast<long long>(offset), SEEK_SET) < 0) return false;
+            int n = ::_read(fd, data, static_cast<unsigned int>(size));
+#else
+            ssize_t n = ::pread(fd, data, size, static_cast<off_t>(offset));
+            if (n < 0 && errno == EINTR) continue;
+#endif
+            if (n <= 0) return false;
+            data += n;
+            size -= static_cast<size_t>(n);
+            offset += static_cast<uint64_t>(n);
+        }
+        return true;
+    }
+
+    uint64_t fileSize(int fd) {
+#if defined(_WIN32)
+        return static_cast<uint64_t>(::_lseeki64(fd, 0, SEEK_END));
+#else
+        return static_cast<uint64_t>(::lseek(fd, 0, SEEK_END));
+#endif
+    }
+
+    bool syncData(int fd) {
+#if defined(_WIN32)
+        return ::_commit(fd) == 0;
+#elif defined(__APPLE__)
+        return ::fsync(fd) == 0;
+#else
+        return ::fdatasync(fd) == 0;
+#endif
+    }
+
+    bool truncateTo(int fd, uint64_t size) {
+#if defined(_WIN32)
+        return ::_chsize_s(fd, static_cast<long long>(size)) == 0;
+#else
+        return ::ftruncate(fd, static_cast<off_t>(size)) == 0;
+#endif
+    }
+
+    void closeSegment(int fd) {
+#if defined(_WIN32)
+        ::_close(fd);
+#else
+        ::close(fd);
+#endif
+    }
+
+    // Makes renames and removals in `directory` durable.
+    bool syncDirectory(const std::string& directory) {
+#if defined(_WIN32)
+        (void)directory;
+        return true;
+#else
+        const int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) return false;
+        const bool synced = ::fsync(fd) == 0;
+        ::close(fd);
+        return synced;
+#endif
+    }
+
+    // :: Encoding
+    // :::::::::::
+
+    template<typename T>
+    void putRaw(std::string& out, T value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template<typename T>
+    bool getRaw(const char*& p, const char* end, T& value) {
+        if (static_cast<size_t>(end - p) < sizeof(T)) return false;
+        std::memcpy(&value, p, sizeof(T));
+        p += sizeof(T);
+        return true;
+    }
+
+    // Frame: [body size][CRC] body: [seq][op][type id][tag size][tag][payload]
+    std::string encodeRecord(uint64_t seq, uint8_t op, uint32_t typeId, std::string_view tag, std::string_view payload) {
+        const size_t bodySize = sizeof(seq) + sizeof(op) + sizeof(typeId) + sizeof(uint32_t) + tag.size() + payload.size();
+        std::string frame;
+        frame.reserve(kFrameHeader + bodySize);
+        putRaw(frame, static_cast<uint32_t>(bodySize));
+        putRaw(frame, uint32_t{0});
+        putRaw(frame, seq);
+        putRaw(frame, op);
+        putRaw(frame, typeId);
+        putRaw(frame, static_cast<uint32_t>(tag.size()));
+        frame.append(tag.data(), tag.size());
+        frame.append(payload.data(), payload.size());
+        const uint32_t crc = Checksum::crc32(frame.data() + kFrameHeader, bodySize);
+        std::memcpy(&frame[sizeof(uint32_t)], &crc, sizeof(crc));
+        return frame;
+    }
+
+    struct DecodedRecord {
+        uint64_t seq = 0;
+        uint8_t op = 0;
+        uint32_t typeId = kNoType;
+        std::string_view tag;
+        std::string_view payload;
+    };
+
+    // Decodes the frame at the start of `data`; false if it is torn or corrupt.
+    bool decodeRecord(const char* data, size_t available, DecodedRecord& record, uint32_t& frameSize) {
+        if (available < kFrameHeader) return false;
+        uint32_t bodySize = 0, crc = 0;
+        std::memcpy(&bodySize, data, sizeof(bodySize));
+        std::memcpy(&crc, data + sizeof(bodySize), sizeof(crc));
+        if (bodySize > kMaxRecordSize || available - kFrameHeader < bodySize) return false;
+
+        const char* body = data + kFrameHeader;
+        if (Checksum::crc32(body, bodySize) != crc) return false;
+
+        const char* p = body;
+        const char* end = body + bodySize;
+        uint32_t tagSize = 0;
+        if (!getRaw(p, end, record.seq) || !getRaw(p, end, record.op) || !getRaw(p, end, record.typeId) ||
+            !getRaw(p, end, tagSize) || static_cast<size_t>(end - p) < tagSize) {
+            return false;
+        }
+        record.tag = std::string_view(p, tagSize);
+        record.payload = std::string_view(p + tagSize, static_cast<size_t>(end - p - tagSize));
+        frameSize = static_cast<uint32_t>(kFrameHeader + bodySize);
+        return true;
+    }
+
+    std::string segmentHeader(uint64_t id) {
+        std::string header(kSegmentMagic, sizeof(kSegmentMagic));
+        putRaw(header, id);
+        return header;
+    }
+
+    bool parseSegmentId(const std::string& name, uint64_t& id) {
+        // segment-<digits>.log
+        constexpr std::string_view prefix = "segment-", suffix = ".log";
+        if (name.size() <= prefix.size() + suffix.size() || name.compare(0, prefix.size(), prefix) != 0 ||
+            name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+            return false;
+        }
+        const std::string digits = name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+        if (digits.empty() || !std::all_of(digits.begin(), digits.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+            return false;
+        }
+        id = std::stoull(digits);
+        return true;
+    }
+
+    [[noreturn]] void fail(const std::string& message) {
+        LOG_CONTEXT(LogLevel::ERR, "", std::make_exception_ptr(std::runtime_error(message)));
+        throw std::runtime_error(message);  // LOG_CONTEXT rethrows; keeps the compiler informed
+    }
+}
+
+SegmentLog::SegmentLog(const std::string& directory, SegmentLogOptions options)
+    : directory_(directory), options_(options) {
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory_, ec);
+    if (!std::filesystem::is_directory(directory_, ec)) fail("Cannot create segment log directory '" + directory_ + "'.");
+
+    openExisting();
+    if (segments_.count(activeId_) == 0) startSegment();
+
+    if (options_.compactionInterval.count() > 0) {
+        compactor_ = std::thread(&SegmentLog::compactorLoop, this);
+    }
+}
+
+SegmentLog::~SegmentLog() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    if (compactor_.joinable()) compactor_.join();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto active = segments_.find(activeId_);
+    if (active != segments_.end() && !syncData(active->second.fd)) {
+        std::cerr << ":::| ERROR while syncing segment log '" << directory_ << "'\n";
+    }
+    for (auto& [id, segment] : segments_) closeSegment(segment.fd);
+}
+
+std::string SegmentLog::segmentPath(uint64_t id) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "segment-%010llu.log", static_cast<unsigned long long>(id));
+    return (std::filesystem::path(directory_) / name).string();
+}
+
+void SegmentLog::openExisting() {
+    std::vector<uint64_t> ids;
+    for (const auto& entry : std::filesystem::directory_iterator(directory_)) {
+        const std::string name = entry.path().filename().string();
+        uint64_t id = 0;
+        if (parseSegmentId(name, id)) {
+            ids.push_back(id);
+        } else if (name.size() > 4 && name.compare(name.size() - 4, 4, ".tmp") == 0) {
+            std::filesystem::remove(entry.path());   // merge interrupted by a crash
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+
+    // Newest record of every tag across all segments; tombstones count, so a later delete wins.
+    struct Latest {
+        Location location;
+        bool removed = false;
+    };
+    std::unordered_map<std::string, Latest> latest;
+    std::vector<uint64_t> unsealed;
+
+    for (uint64_t id : ids) {
+        Segment segment;
+        segment.fd = openSegment(segmentPath(id), false);
+        if (segment.fd < 0) fail("Cannot open segment '" + segmentPath(id) + "'.");
+
+        std::vector<FooterEntry> entries;
+        if (loadFooter(segment, entries)) {
+            segment.sealed = true;
+            ++stats_.footersRead;
+        } else {
+            scanSegment(id, segment, entries);
+            unsealed.push_back(id);
+        }
+
+        segment.overheadBytes = segment.bytes;
+        for (const auto& e : entries) {
+            segment.overheadBytes -= e.size;
+            lastSeq_ = std::max(lastSeq_, e.seq);
+            auto& slot = latest[e.tag];
+            if (slot.location.seq <= e.seq) {
+                slot.location = Location{id, e.offset, e.size, e.seq};
+                slot.removed = e.op == OpDelete;
+            }
+        }
+        if (!segment.sealed) segment.entries = std::move(entries);
+        segments_.emplace(id, std::move(segment));
+        nextId_ = std::max(nextId_, id + 1);
+    }
+
+    for (auto& [tag, slot] : latest) {
+        if (slot.removed) continue;
+        segments_[slot.location.segment].liveBytes += slot.location.size;
+        index_.emplace(tag, slot.location);
+    }
+
+    // Keep appending to the newest unsealed segment; seal any older one a crash left open.
+    if (!unsealed.empty()) {
+        activeId_ = unsealed.back();
+        unsealed.pop_back();
+        for (uint64_t id : unsealed) seal(id);
+    }
+}
+
+bool SegmentLog::loadFooter(Segment& segment, std::vector<FooterEntry>& entries) {
+    const uint64_t size = fileSize(segment.fd);
+    segment.bytes = size;
+    if (size < kSegmentHeader + kTrailerSize) return false;
+
+    char trailer[kTrailerSize];
+    if (!readAt(segment.fd, trailer, sizeof(trailer), size - kTrailerSize) ||
+        std::memcmp(trailer + kTrailerSize - sizeof(kFooterMagic), kFooterMagic, sizeof(kFooterMagic)) != 0) {
+        return false;
+    }
+    uint64_t footerOffset = 0;
+    uint32_t entryCount = 0, typeCount = 0, crc = 0;
+    const char* t = trailer;
+    const char* tEnd = trailer + kTrailerSize;
+    getRaw(t, tEnd, footerOffset);
+    getRaw(t, tEnd, entryCount);
+    getRaw(t, tEnd, typeCount);
+    getRaw(t, tEnd, crc);
+    if (footerOffset < kSegmentHeader || footerOffset > size - kTrailerSize) return false;
+
+    std::string footer(static_cast<size_t>(size - kTrailerSize - footerOffset), '\0');
+    if (!readAt(segment.fd, footer.data(), footer.size(), footerOffset) ||
+        Checksum::crc32(footer.data(), footer.size()) != crc) {
+        return false;
+    }
+
+    const char* p = footer.data();
+    const char* end = p + footer.size();
+    entries.reserve(entryCount);
+    for (uint32_t i = 0; i < entryCount; ++i) {
+        FooterEntry e;
+        uint32_t tagSize = 0;
+        if (!getRaw(p, end, e.op) || !getRaw(p, end, e.seq) || !getRaw(p, end, e.offset) ||
+            !getRaw(p, end, e.size) || !getRaw(p, end, tagSize) || static_cast<size_t>(end - p) < tagSize) {
+            entries.clear();
+            return false;
+        }
+        e.tag.assign(p, tagSize);
+        p += tagSize;
+        entries.push_back(std::move(e));
+    }
+    for (uint32_t i = 0; i < typeCount; ++i) {
+        uint32_t nameSize = 0;
+        if (!getRaw(p, end, nameSize) || static_cast<size_t>(end - p) < nameSize) {
+            entries.clear();
+            return false;
+        }
+        segment.types.emplace_back(p, nameSize);
+        p += nameSize;
+    }
+    return true;
+}
+
+void SegmentLog::scanSegment(uint64_t id, Segment& segment, std::vector<FooterEntry>& entries) {
+    const uint64_t size = fileSize(segment.fd);
+    std::string image(static_cast<size_t>(size), '\0');
+    if (size > 0 && !readAt(segment.fd, image.data(), image.size(), 0)) fail("Cannot read segment '" + segmentPath(id) + "'.");
+
+    if (image.size() < kSegmentHeader || std::memcmp(image.data(), kSegmentMagic, sizeof(kSegmentMagic)) != 0) {
+        // Crashed before its header was written: start it over.
+        const std::string header = segmentHeader(id);
+        if (!truncateTo(segment.fd, 0) || !writeAll(segment.fd, header.data(), header.size())) {
+            fail("Cannot reset segment '" + segmentPath(id) + "'.");
+        }
+        segment.bytes = header.size();
+        return;
+    }
+
+    size_t offset = kSegmentHeader;
+    DecodedRecord record;
+    uint32_t frameSize = 0;
+    while (decodeRecord(image.data() + offset, image.size() - offset, record, frameSize)) {
+        if (record.op == OpTypeDef) {
+            if (segment.types.size() <= record.typeId) segment.types.resize(record.typeId + 1);
+            segment.types[record.typeId] = std::string(record.tag);
+            segment.typeIds[std::string(record.tag)] = record.typeId;
+        } else {
+            entries.push_back(FooterEntry{std::string(record.tag), record.seq, offset, frameSize, record.op});
+        }
+        offset += frameSize;
+    }
+
+    // Drop a torn tail before appending after it.
+    if (offset < image.size() && !truncateTo(segment.fd, offset)) {
+        fail("Cannot truncate torn tail of segment '" + segmentPath(id) + "'.");
+    }
+    segment.bytes = offset;
+}
+
+void SegmentLog::startSegment() {
+    const uint64_t id = nextId_++;
+    Segment segment;
+    segment.fd = openSegment(segmentPath(id), true);
+    const std::string header = segmentHeader(id);
+    if (segment.fd < 0 || !writeAll(segment.fd, header.data(), header.size())) {
+        if (segment.fd >= 0) closeSegment(segment.fd);
+        fail("Cannot create segment '" + segmentPath(id) + "'.");
+    }
+    segment.bytes = segment.overheadBytes = header.size();
+    segments_.emplace(id, std::move(segment));
+    activeId_ = id;
+}
+
+void SegmentLog::seal(uint64_t id) {
+    Segment& segment = segments_.at(id);
+
+    // Footer: the segment's records (tag, seq, offset, size, op) then its type names, closed by a
+    // fixed-size trailer so opening the segment later needs two reads instead of a scan.
+    std::string footer;
+    for (const auto& e : segment.entries) {
+        putRaw(footer, e.op);
+        putRaw(footer, e.seq);
+        putRaw(footer, e.offset);
+        putRaw(footer, e.size);
+        putRaw(footer, static_cast<uint32_t>(e.tag.size()));
+        footer.append(e.tag);
+    }
+    for (const auto& name : segment.types) {
+        putRaw(footer, static_cast<uint32_t>(name.size()));
+        footer.append(name);
+    }
+    const uint32_t crc = Checksum::crc32(footer.data(), footer.size());
+    putRaw(footer, segment.bytes);
+    putRaw(footer, static_cast<uint32_t>(segment.entries.size()));
+    putRaw(footer, static_cast<uint32_t>(segment.types.size()));
+    putRaw(footer, crc);
+    putRaw(footer, uint32_t{0});
+    footer.append(kFooterMagic, sizeof(kFooterMagic));
+
+    if (!writeAll(segment.fd, footer.data(), footer.size()) || !syncData(segment.fd)) {
+        fail("Cannot seal segment '" + segmentPath(id) + "'.");
+    }
+    segment.bytes += footer.size();
+    segment.overheadBytes += footer.size();
+    segment.sealed = true;
+    segment.entries.clear();
+    segment.entries.shrink_to_fit();
+    segment.typeIds.clear();
+}
+
+SegmentLog::Location SegmentLog::append(uint8_t op, std::string_view tag, std::string_view type, std::string_view payload) {
+    Segment& segment = segments_.at(activeId_);
+
+    uint32_t typeId = kNoType;
+    if (!type.empty()) {
+        auto known = segment.typeIds.find(std::string(type));
+        if (known != segment.typeIds.end()) {
+            typeId = known->second;
+        } else {
+            // First record of this type in the segment: define its id.
+            typeId = static_cast<uint32_t>(segment.types.size());
+            const std::string def = encodeRecord(0, OpTypeDef, typeId, type, {});
+            if (!writeAll(segment.fd, def.data(), def.size())) fail("Write to segment '" + segmentPath(activeId_) + "' failed.");
+            segment.bytes += def.size();
+            segment.overheadBytes += def.size();
+            segment.types.emplace_back(type);
+            segment.typeIds.emplace(std::string(type), typeId);
+        }
+    }
+
+    const uint64_t seq = ++lastSeq_;
+    const std::string frame = encodeRecord(seq, op, typeId, tag, payload);
+    if (!writeAll(segment.fd, frame.data(), frame.size()) || (options_.durable && !syncData(segment.fd))) {
+        fail("Write to segment '" + segmentPath(activeId_) + "' failed.");
+    }
+
+    Location location{activeId_, segment.bytes, static_cast<uint32_t>(frame.size()), seq};
+    segment.entries.push_back(FooterEntry{std::string(tag), seq, segment.bytes, location.size, op});
+    segment.bytes += frame.size();
+    return location;
+}
+
+void SegmentLog::retire(const Location& location) {
+    auto it = segments_.find(location.segment);
+    if (it != segments_.end()) it->second.liveBytes -= location.size;
+}
+
+uint64_t SegmentLog::put(std::string_view tag, std::string_view type, std::string_view payload) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const Location location = append(OpPut, tag, type, payload);
+
+    auto [it, inserted] = index_.try_emplace(std::string(tag), location);
+    if (!inserted) {
+        retire(it->second);
+        it->second = location;
+    }
+    segments_.at(location.segment).liveBytes += location.size;
+
+    if (segments_.at(activeId_).bytes >= options_.segmentBytes) {
+        seal(activeId_);
+        startSegment();
+        cv_.notify_all();
+    }
+    return location.seq;
+}
+
+bool SegmentLog::remove(std::string_view tag) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = index_.find(std::string(tag));
+    if (it == index_.end()) return false;
+
+    retire(it->second);
+    index_.erase(it);
+    append(OpDelete, tag, {}, {});   // dead from the start; dropped by the next merge that covers it
+
+    if (segments_.at(activeId_).bytes >= options_.segmentBytes) {
+        seal(activeId_);
+        startSegment();
+        cv_.notify_all();
+    }
+    return true;
+}
+
+std::optional<SegmentRecord> SegmentLog::read(const std::string& tag) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(tag);
+    if (it == index_.end()) return std::nullopt;
+
+    const Segment& segment = segments_.at(it->second.segment);
+    std::string frame(it->second.size, '\0');
+    DecodedRecord record;
+    uint32_t frameSize = 0;
+    if (!readAt(segment.fd, frame.data(), frame.size(), it->second.offset) ||
+        !decodeRecord(frame.data(), frame.size(), record, frameSize) || record.op != OpPut) {
+        LOG_CONTEXT(LogLevel::ERR, "Corrupt record for tag '" + tag + "' in segment '" + segmentPath(it->second.segment) + "'.", {});
+        return std::nullopt;
+    }
+
+    SegmentRecord out;
+    out.seq = record.seq;
+    if (record.typeId < segment.types.size()) out.type = segment.types[record.typeId];
+    out.payload.assign(record.payload.data(), record.payload.size());
+    return out;
+}
+
+std::vector<std::string> SegmentLog::tags() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> out;
+    out.reserve(index_.size());
+    for (const auto& [tag, _] : index_) out.push_back(tag);
+    return out;
+}
+
+void SegmentLog::roll() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (segments_.at(activeId_).entries.empty()) return;
+    seal(activeId_);
+    startSegment();
+}
+
+void SegmentLog::sync() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!syncData(segments_.at(activeId_).fd)) fail("Cannot sync segment '" + segmentPath(activeId_) + "'.");
+}
+
+SegmentLogStats SegmentLog::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    SegmentLogStats s = stats_;
+    s.segments = segments_.size();
+    s.records = index_.size();
+    s.lastSequence = lastSeq_;
+    for (const auto& [id, segment] : segments_) {
+        s.totalBytes += segment.bytes;
+        if (segment.sealed) {
+            s.sealedBytes += segment.bytes;
+            s.deadBytes += segment.bytes - segment.overheadBytes - segment.liveBytes;
+        }
+    }
+    return s;
+}
+
+bool SegmentLog::shouldCompact() const {
+    uint64_t sealed = 0, dead = 0;
+    for (const auto& [id, segment] : segments_) {
+        if (!segment.sealed) continue;
+        sealed += segment.bytes - segment.overheadBytes;
+        dead += segment.bytes - segment.overheadBytes - segment.liveBytes;
+    }
+    return dead >= options_.minCompactBytes && static_cast<double>(dead) > options_.garbageRatio * static_cast<double>(sealed);
+}
+
+bool SegmentLog::compact() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return !compacting_; });
+    return compactSealed(lock);
+}
+
+bool SegmentLog::compactSealed(std::unique_lock<std::mutex>& lock) {
+    // Under the lock: pick every sealed segment and the records of theirs the index still points to.
+    struct Source {
+        int fd = -1;
+        std::vector<std::string> types;
+    };
+    std::map<uint64_t, Source> sources;
+    for (const auto& [id, segment] : segments_) {
+        if (segment.sealed) sources.emplace(id, Source{segment.fd, segment.types});
+    }
+    if (sources.empty()) return false;
+
+    struct Move {
+        std::string tag;
+        Location from;
+        Location to;
+    };
+    std::vector<Move> moves;
+    for (const auto& [tag, location] : index_) {
+        if (sources.count(location.segment)) moves.push_back(Move{tag, location, {}});
+    }
+    std::sort(moves.begin(), moves.end(), [](const Move& a, const Move& b) {
+        return a.from.segment != b.from.segment ? a.from.segment < b.from.segment : a.from.offset < b.from.offset;
+    });
+
+    const uint64_t mergedId = nextId_++;
+    compacting_ = true;
+    lock.unlock();
+
+    // Without the lock: sealed segments never change, and only compaction deletes them.
+    const std::string finalPath = segmentPath(mergedId);
+    const std::string tmpPath = finalPath + ".tmp";
+    Segment merged;
+    merged.fd = openSegment(tmpPath, true);
+    bool ok = merged.fd >= 0;
+    if (ok) {
+        // Records are copied through a bounded buffer; `merged.bytes` counts what reached the file.
+        constexpr size_t kFlushBytes = 1 << 20;
+        std::string out = segmentHeader(mergedId);
+        merged.overheadBytes = out.size();
+        std::unordered_map<std::string, uint32_t> typeIds;
+        std::string frame;
+        for (auto& move : moves) {
+            const Source& source = sources.at(move.from.segment);
+            frame.assign(move.from.size, '\0');
+            DecodedRecord record;
+            uint32_t frameSize = 0;
+            if (!readAt(source.fd, frame.data(), frame.size(), move.from.offset) ||
+                !decodeRecord(frame.data(), frame.size(), record, frameSize)) {
+                ok = false;
+                break;
+            }
+
+            // Type ids are per segment: re-number them for the merged one.
+            uint32_t typeId = kNoType;
+            if (record.typeId < source.types.size()) {
+                const std::string& name = source.types[record.typeId];
+                auto known = typeIds.find(name);
+                if (known == typeIds.end()) {
+                    known = typeIds.emplace(name, static_cast<uint32_t>(merged.types.size())).first;
+                    merged.types.push_back(name);
+                    const std::string def = encodeRecord(0, OpTypeDef, known->second, name, {});
+                    merged.overheadBytes += def.size();
+                    out += def;
+                }
+                typeId = known->second;
+            }
+
+            const std::string copy = encodeRecord(record.seq, record.op, typeId, record.tag, record.payload);
+            const uint64_t offset = merged.bytes + out.size();
+            move.to = Location{mergedId, offset, static_cast<uint32_t>(copy.size()), record.seq};
+            merged.entries.push_back(FooterEntry{move.tag, record.seq, offset, move.to.size, record.op});
+            out += copy;
+
+            if (out.size() >= kFlushBytes) {
+                if (!writeAll(merged.fd, out.data(), out.size())) {
+                    ok = false;
+                    break;
+                }
+                merged.bytes += out.size();
+                out.clear();
+            }
+        }
+
+        ok = ok && writeAll(merged.fd, out.data(), out.size());
+        merged.bytes += out.size();
+    }
+
+    if (ok) {
+        // Seal it like any other segment; until it replaces the sources it holds no live record.
+        lock.lock();
+        Segment& sealed = segments_.emplace(mergedId, std::move(merged)).first->second;
+        try {
+            seal(mergedId);
+        } catch (const std::exception&) {
+            ok = false;
+        }
+        lock.unlock();
+
+        // The merged segment must be durably in place before any source it replaces is removed.
+        const bool renamed = ok && std::rename(tmpPath.c_str(), finalPath.c_str()) == 0;
+        ok = renamed && syncDirectory(directory_);
+        lock.lock();
+        if (!ok) {
+            closeSegment(sealed.fd);
+            segments_.erase(mergedId);
+            if (renamed) std::remove(finalPath.c_str());
+        }
+    } else {
+        if (merged.fd >= 0) closeSegment(merged.fd);
+        lock.lock();
+    }
+
+    if (!ok) {
+        std::remove(tmpPath.c_str());
+        compacting_ = false;
+        cv_.notify_all();
+        LOG_CONTEXT(LogLevel::ERR, "Compaction of segment log '" + directory_ + "' failed; segments left as they were.", {});
+        return false;
+    }
+
+    // Re-point tags not written again meanwhile, then drop the merged segments.
+    Segment& target = segments_.at(mergedId);
+    for (const auto& move : moves) {
+        auto it = index_.find(move.tag);
+        if (it == index_.end() || it->second.segment != move.from.segment || it->second.offset != move.from.offset) continue;
+        it->second = move.to;
+        target.liveBytes += move.to.size;
+    }
+    for (const auto& [id, source] : sources) {
+        auto it = segments_.find(id);
+        stats_.reclaimedBytes += it->second.bytes;
+        closeSegment(it->second.fd);
+        std::remove(segmentPath(id).c_str());
+        segments_.erase(it);
+    }
+    stats_.reclaimedBytes -= target.bytes;
+    ++stats_.compactions;
+
+    compacting_ = false;
+    cv_.notify_all();
+    return true;
+}
+
+void SegmentLog::compactorLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_) {
+        cv_.wait_for(lock, options_.compactionInterval, [this] { return stop_; });
+        if (stop_) break;
+        if (compacting_ || !shouldCompact()) continue;
+        try {
+            compactSealed(lock);
+        } catch (const std::exception& e) {
+            std::cerr << ":::| ERROR in segment log compactor: " << e.what() << "\n";
+        }
+    }
+}
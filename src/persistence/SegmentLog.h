@@ -0,0 +1,146 @@
+#pragma once
+#ifndef SEGMENT_LOG_H
+#define SEGMENT_LOG_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// :::SegmentLog class
+// :::Log-structured persistence: every change is appended to the active segment file of a
+// :::directory as a CRC-framed record (tag, type id, sequence, payload). When the active
+// :::segment reaches `segmentBytes` it is sealed: a footer listing its records is appended and
+// :::the file never changes again. An in-memory index maps each tag to its latest record.
+// :::A background compactor merges the sealed segments into one, keeping only the records
+// :::the index still points to, once dead bytes exceed `garbageRatio` of the sealed bytes.
+// :::On open the index is rebuilt from the footers of sealed segments; only the active
+// :::segment is scanned (and a torn tail dropped).
+// **************************************************************************************************
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+struct SegmentLogOptions {
+    uint64_t segmentBytes = 8ull << 20;     // seal the active segment once it is this large
+    double garbageRatio = 0.5;              // compact when dead / sealed bytes exceeds this
+    uint64_t minCompactBytes = 1ull << 20;  // ...and at least this many sealed bytes are dead
+    std::chrono::milliseconds compactionInterval{1000};  // 0 = no background compactor
+    bool durable = false;                   // fdatasync after every append
+};
+
+struct SegmentLogStats {
+    uint64_t segments = 0;         // sealed + active
+    uint64_t records = 0;          // live tags
+    uint64_t totalBytes = 0;       // all segment files
+    uint64_t sealedBytes = 0;
+    uint64_t deadBytes = 0;        // sealed bytes no longer referenced by the index
+    uint64_t compactions = 0;
+    uint64_t reclaimedBytes = 0;   // total freed by compaction
+    uint64_t lastSequence = 0;
+    uint64_t footersRead = 0;      // sealed segments indexed from their footer when opened
+};
+
+// Latest record of a tag, as read back from its segment.
+struct SegmentRecord {
+    uint64_t seq = 0;
+    std::string type;
+    std::string payload;
+};
+
+class SegmentLog {
+    public:
+        // Opens (or creates) the log in `directory`. Throws std::runtime_error if it cannot.
+        explicit SegmentLog(const std::string& directory, SegmentLogOptions options = {});
+        ~SegmentLog();
+
+        SegmentLog(const SegmentLog&) = delete;
+        SegmentLog& operator=(const SegmentLog&) = delete;
+
+        // Appends a new version of `tag`; returns its sequence number.
+        uint64_t put(std::string_view tag, std::string_view type, std::string_view payload);
+
+        // Appends a tombstone; false if the tag has no live record.
+        bool remove(std::string_view tag);
+
+        std::optional<SegmentRecord> read(const std::string& tag) const;
+
+        // Tags with a live record, in no particular order.
+        std::vector<std::string> tags() const;
+
+        // Merges the sealed segments now, whatever the garbage ratio. Returns false if there was
+        // nothing to merge.
+        bool compact();
+
+        // Seals the active segment (so it becomes eligible for compaction) and starts a new one.
+        void roll();
+
+        void sync();
+
+        SegmentLogStats stats() const;
+        const std::string& directory() const { return directory_; }
+
+    private:
+        struct Location {
+            uint64_t segment = 0;
+            uint64_t offset = 0;
+            uint32_t size = 0;     // whole frame
+            uint64_t seq = 0;
+        };
+
+        // One line of a segment footer (also kept for the active segment until it is sealed).
+        struct FooterEntry {
+            std::string tag;
+            uint64_t seq = 0;
+            uint64_t offset = 0;
+            uint32_t size = 0;
+            uint8_t op = 0;
+        };
+
+        struct Segment {
+            int fd = -1;
+            uint64_t bytes = 0;
+            uint64_t liveBytes = 0;        // records the index points to
+            uint64_t overheadBytes = 0;    // header, type definitions and footer
+            bool sealed = false;
+            std::vector<std::string> types;                      // type id -> name
+            std::unordered_map<std::string, uint32_t> typeIds;   // active segment only
+            std::vector<FooterEntry> entries;                    // active segment only
+        };
+
+        std::string segmentPath(uint64_t id) const;
+        void openExisting();
+        bool loadFooter(Segment& segment, std::vector<FooterEntry>& entries);
+        void scanSegment(uint64_t id, Segment& segment, std::vector<FooterEntry>& entries);
+        void startSegment();
+        void seal(uint64_t id);
+        Location append(uint8_t op, std::string_view tag, std::string_view type, std::string_view payload);
+        void retire(const Location& location);
+
+        bool shouldCompact() const;
+        bool compactSealed(std::unique_lock<std::mutex>& lock);
+        void compactorLoop();
+
+        std::string directory_;
+        SegmentLogOptions options_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable cv_;
+        std::map<uint64_t, Segment> segments_;
+        std::unordered_map<std::string, Location> index_;
+        uint64_t activeId_ = 0;
+        uint64_t nextId_ = 1;
+        uint64_t lastSeq_ = 0;
+        bool compacting_ = false;
+        bool stop_ = false;
+        SegmentLogStats stats_;
+        std::thread compactor_;
+};
+
+#endif // SEGMENT_LOG_H
@@ -0,0 +1,169 @@
+#include "TagIndex.h"
+#include "err_log/Logger.hpp"
+#include "utils/AtomicFileWriter .hpp"
+#include "utils/Checksum.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+// ::::| TagIndex: sidecar tag -> record location index for single-object imports
+// *******************************************************************************
+
+namespace {
+    // Layout (host byte order, as the other on-disk formats):
+    //   header     "SSTIX002" | u64 data file size | i64 data file mtime | u32 entries | u32 buckets
+    //   directory  u64 offset per bucket, plus one past the last: bucket b spans [dir[b], dir[b + 1])
+    //   entry      u64 offset | u64 length | u32 crc | u32 type size | u32 tag size | type | tag
+    // Entries are grouped by a hash of (type, tag), so a lookup reads one bucket instead of the file.
+    constexpr char kMagic[8] = {'S', 'S', 'T', 'I', 'X', '0', '0', '2'};
+    constexpr size_t kHeaderSize = sizeof(kMagic) + 8 + 8 + 4 + 4;
+    constexpr size_t kEntryFixed = 8 + 8 + 4 + 4 + 4;
+
+    uint32_t bucketOf(std::string_view type, std::string_view tag, uint32_t buckets) {
+        return Checksum::crc32(tag.data(), tag.size(), Checksum::crc32(type.data(), type.size())) % buckets;
+    }
+
+    template<typename T>
+    void put(std::string& out, T value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template<typename T>
+    T get(const char* p) {
+        T value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    // Size and modification time of `path`; false if it cannot be read.
+    bool fileStamp(const std::string& path, uint64_t& size, int64_t& mtime) {
+        std::error_code ec;
+        size = std::filesystem::file_size(path, ec);
+        if (ec) return false;
+        auto time = std::filesystem::last_write_time(path, ec);
+        if (ec) return false;
+        mtime = static_cast<int64_t>(time.time_since_epoch().count());
+        return true;
+    }
+}
+
+void TagIndex::add(std::string_view type, std::string_view tag, uint64_t offset, std::string_view record) {
+    entries_.push_back({std::string(type), std::string(tag), offset, record.size(),
+                        Checksum::crc32(record.data(), record.size())});
+}
+
+bool TagIndex::write(const std::string& dataFile) const {
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    if (!fileStamp(dataFile, size, mtime)) {
+        LOG_CONTEXT(LogLevel::WARNING, "Cannot stat '" + dataFile + "' — tag index not written.", {});
+        return false;
+    }
+
+    // About one entry per bucket; entries are laid out bucket by bucket.
+    const uint32_t buckets = static_cast<uint32_t>(std::max<size_t>(entries_.size(), 1));
+    std::vector<uint32_t> bucketOfEntry(entries_.size());
+    std::vector<uint64_t> directory(buckets + 1, 0);
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        bucketOfEntry[i] = bucketOf(entries_[i].type, entries_[i].tag, buckets);
+        directory[bucketOfEntry[i] + 1] += kEntryFixed + entries_[i].type.size() + entries_[i].tag.size();
+    }
+    directory[0] = kHeaderSize + (uint64_t(buckets) + 1) * sizeof(uint64_t);
+    for (uint32_t b = 0; b < buckets; ++b) directory[b + 1] += directory[b];
+
+    std::vector<uint64_t> cursor(directory.begin(), directory.end() - 1);
+    std::string out;
+    out.reserve(static_cast<size_t>(directory[buckets]));
+    out.append(kMagic, sizeof(kMagic));
+    put<uint64_t>(out, size);
+    put<int64_t>(out, mtime);
+    put<uint32_t>(out, static_cast<uint32_t>(entries_.size()));
+    put<uint32_t>(out, buckets);
+    for (uint64_t offset : directory) put<uint64_t>(out, offset);
+    out.resize(static_cast<size_t>(directory[buckets]));
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        const Entry& entry = entries_[i];
+        char* p = out.data() + cursor[bucketOfEntry[i]];
+        std::memcpy(p, &entry.offset, 8);
+        std::memcpy(p + 8, &entry.length, 8);
+        std::memcpy(p + 16, &entry.crc, 4);
+        const auto typeSize = static_cast<uint32_t>(entry.type.size());
+        const auto tagSize = static_cast<uint32_t>(entry.tag.size());
+        std::memcpy(p + 20, &typeSize, 4);
+        std::memcpy(p + 24, &tagSize, 4);
+        std::memcpy(p + kEntryFixed, entry.type.data(), typeSize);
+        std::memcpy(p + kEntryFixed + typeSize, entry.tag.data(), tagSize);
+        cursor[bucketOfEntry[i]] += kEntryFixed + typeSize + tagSize;
+    }
+    return AtomicFileWriter::writeAtomically(sidecarPath(dataFile), out);
+}
+
+std::optional<std::string> TagIndex::readRecord(const std::string& dataFile, std::string_view type, std::string_view tag) {
+    std::ifstream sidecar(sidecarPath(dataFile), std::ios::binary);
+    if (!sidecar) return std::nullopt;
+
+    char header[kHeaderSize];
+    if (!sidecar.read(header, sizeof(header)) || std::memcmp(header, kMagic, sizeof(kMagic)) != 0) {
+        LOG_CONTEXT(LogLevel::DEBUG, "Tag index of '" + dataFile + "' is not readable.", {});
+        return std::nullopt;
+    }
+
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    if (!fileStamp(dataFile, size, mtime)) return std::nullopt;
+    if (get<uint64_t>(header + 8) != size || get<int64_t>(header + 16) != mtime) {
+        LOG_CONTEXT(LogLevel::DEBUG, "Tag index of '" + dataFile + "' is stale (size or mtime changed).", {});
+        return std::nullopt;
+    }
+
+    // Two directory slots give the one bucket the entry can be in.
+    const uint32_t buckets = get<uint32_t>(header + 28);
+    if (buckets == 0) return std::nullopt;
+    char span[2 * sizeof(uint64_t)];
+    const uint32_t bucket = bucketOf(type, tag, buckets);
+    if (!sidecar.seekg(static_cast<std::streamoff>(kHeaderSize + uint64_t(bucket) * sizeof(uint64_t))) ||
+        !sidecar.read(span, sizeof(span))) {
+        return std::nullopt;
+    }
+    const uint64_t begin = get<uint64_t>(span);
+    const uint64_t end = get<uint64_t>(span + 8);
+    if (end < begin || end - begin > (uint64_t{1} << 30)) return std::nullopt;
+
+    std::string index(static_cast<size_t>(end - begin), '\0');
+    if (!sidecar.seekg(static_cast<std::streamoff>(begin)) || !sidecar.read(index.data(), static_cast<std::streamsize>(index.size()))) {
+        return std::nullopt;
+    }
+
+    size_t pos = 0;
+    while (pos < index.size()) {
+        if (index.size() - pos < kEntryFixed) return std::nullopt;
+        const char* p = index.data() + pos;
+        const uint64_t offset = get<uint64_t>(p);
+        const uint64_t length = get<uint64_t>(p + 8);
+        const uint32_t crc = get<uint32_t>(p + 16);
+        const uint32_t typeSize = get<uint32_t>(p + 20);
+        const uint32_t tagSize = get<uint32_t>(p + 24);
+        pos += kEntryFixed;
+        if (index.size() - pos < uint64_t(typeSize) + tagSize) return std::nullopt;
+
+        const std::string_view entryType(index.data() + pos, typeSize);
+        const std::string_view entryTag(index.data() + pos + typeSize, tagSize);
+        pos += typeSize + tagSize;
+        if (entryType != type || entryTag != tag) continue;
+
+        if (offset > size || length > size - offset) return std::nullopt;
+        std::ifstream in(dataFile, std::ios::binary);
+        std::string record(length, '\0');
+        if (!in.seekg(static_cast<std::streamoff>(offset)) || !in.read(record.data(), static_cast<std::streamsize>(length))) {
+            return std::nullopt;
+        }
+        if (Checksum::crc32(record.data(), record.size()) != crc) {
+            LOG_CONTEXT(LogLevel::DEBUG, "Tag index of '" + dataFile + "' is stale (record checksum mismatch).", {});
+            return std::nullopt;
+        }
+        return record;
+    }
+    return std::nullopt;   // not indexed: the caller's scan reports it missing
+}
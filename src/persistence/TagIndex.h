@@ -0,0 +1,50 @@
+#pragma once
+#ifndef TAG_INDEX_H
+#define TAG_INDEX_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// :::TagIndex class
+// :::Sidecar index written next to an export file (`<file>.tagidx`): for every record, its type, tag,
+// :::byte offset and length in the file, and a CRC-32 of those bytes. The header records the size and
+// :::modification time of the file it describes, so a single-object import can seek straight to one
+// :::record and parse only that. Entries are hashed by (type, tag) into buckets behind a fixed
+// :::directory, so a lookup reads one bucket of the sidecar rather than all of it. readRecord returns nothing (and the caller falls back to scanning)
+// :::when the sidecar is missing, unreadable, or stale: the file size or mtime differs, or the bytes
+// :::at the recorded offset no longer match their CRC.
+// **************************************************************************************************
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+class TagIndex {
+    public:
+        // Records that `record` (a slice of the export content) starts at `offset`.
+        void add(std::string_view type, std::string_view tag, uint64_t offset, std::string_view record);
+
+        size_t size() const { return entries_.size(); }
+
+        // Writes the sidecar of `dataFile`, which must already be in its final place.
+        bool write(const std::string& dataFile) const;
+
+        // The verified bytes of the (type, tag) record of `dataFile`, found through one bucket of the
+        // sidecar and read with one seek; nullopt if the index cannot answer.
+        static std::optional<std::string> readRecord(const std::string& dataFile, std::string_view type, std::string_view tag);
+
+        static std::string sidecarPath(const std::string& dataFile) { return dataFile + ".tagidx"; }
+
+    private:
+        struct Entry {
+            std::string type;
+            std::string tag;
+            uint64_t offset = 0;
+            uint64_t length = 0;
+            uint32_t crc = 0;
+        };
+
+        std::vector<Entry> entries_;
+};
+
+#endif // TAG_INDEX_H
@@ -0,0 +1,402 @@
+#include "WriteAheadLog.h"
+#include "err_log/Logger.hpp"
+#include "utils/Checksum.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#if defined(_WIN32)
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// ::::| WriteAheadLog: append-only mutation log with group commit
+// ****************************************************************
+
+namespace {
+
+    constexpr char kWalMagic[8] = {'S', 'S', 'W', 'A', 'L', '0', '0', '1'};
+    constexpr size_t kFrameHeader = sizeof(uint32_t) * 2;   // body length + CRC
+    constexpr uint32_t kMaxRecordSize = 1u << 30;
+
+    // :: Thin platform layer over file descriptors
+    // ::::::::::::::::::::::::::::::::::::::::::::
+
+    int openLog(const std::string& path) {
+#if defined(_WIN32)
+        return ::_open(path.c_str(), _O_RDWR | _O_CREAT | _O_BINARY | _O_APPEND, _S_IREAD | _S_IWRITE);
+#else
+        return ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+#endif
+    }
+
+    bool writeAll(int fd, const char* data, size_t size) {
+        while (size > 0) {
+#if defined(_WIN32)
+            int n = ::_write(fd, data, static_cast<unsigned int>(size));
+#else
+            ssize_t n = ::write(fd, data, size);
+            if (n < 0 && errno == EINTR) continue;
+#endif
+            if (n <= 0) return false;
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    bool syncData(int fd) {
+#if defined(_WIN32)
+        return ::_commit(fd) == 0;
+#elif defined(__APPLE__)
+        return ::fsync(fd) == 0;
+#else
+        return ::fdatasync(fd) == 0;
+#endif
+    }
+
+    bool truncateTo(int fd, uint64_t size) {
+#if defined(_WIN32)
+        return ::_chsize_s(fd, static_cast<long long>(size)) == 0;
+#else
+        return ::ftruncate(fd, static_cast<off_t>(size)) == 0;
+#endif
+    }
+
+    void closeLog(int fd) {
+#if defined(_WIN32)
+        ::_close(fd);
+#else
+        ::close(fd);
+#endif
+    }
+
+    // Makes a rename or file creation in the directory holding `path` durable.
+    bool syncDirectoryOf(const std::string& path) {
+#if defined(_WIN32)
+        (void)path;
+        return true;
+#else
+        const std::filesystem::path dir = std::filesystem::path(path).parent_path();
+        const int dirFd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dirFd < 0) return false;
+        const bool synced = ::fsync(dirFd) == 0;
+        ::close(dirFd);
+        return synced;
+#endif
+    }
+
+    std::string sealedPathOf(const std::string& path) {
+        return path + ".prev";
+    }
+
+    // :: Record encoding
+    // ::::::::::::::::::
+
+    template<typename T>
+    void putRaw(std::string& out, T value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void putBytes(std::string& out, std::string_view bytes) {
+        putRaw(out, static_cast<uint32_t>(bytes.size()));
+        out.append(bytes.data(), bytes.size());
+    }
+
+    template<typename T>
+    bool getRaw(const char*& p, const char* end, T& value) {
+        if (static_cast<size_t>(end - p) < sizeof(T)) return false;
+        std::memcpy(&value, p, sizeof(T));
+        p += sizeof(T);
+        return true;
+    }
+
+    bool getBytes(const char*& p, const char* end, std::string& out) {
+        uint32_t size = 0;
+        if (!getRaw(p, end, size) || static_cast<size_t>(end - p) < size) return false;
+        out.assign(p, size);
+        p += size;
+        return true;
+    }
+
+    // Walks the framed records of a log image. Returns the number of intact records and
+    // reports in `validEnd` the offset just past the last of them.
+    size_t scanRecords(const std::string& image, const std::function<void(WalRecord&&)>& visitor, size_t& validEnd) {
+        validEnd = 0;
+        if (image.size() < sizeof(kWalMagic) || std::memcmp(image.data(), kWalMagic, sizeof(kWalMagic)) != 0) {
+            return 0;
+        }
+
+        size_t offset = sizeof(kWalMagic);
+        validEnd = offset;
+        size_t count = 0;
+
+        while (image.size() - offset >= kFrameHeader) {
+            uint32_t bodySize = 0, crc = 0;
+            std::memcpy(&bodySize, image.data() + offset, sizeof(bodySize));
+            std::memcpy(&crc, image.data() + offset + sizeof(bodySize), sizeof(crc));
+            if (bodySize > kMaxRecordSize || image.size() - offset - kFrameHeader < bodySize) break;
+
+            const char* body = image.data() + offset + kFrameHeader;
+            if (Checksum::crc32(body, bodySize) != crc) break;
+
+            WalRecord record;
+            uint8_t op = 0;
+            const char* p = body;
+            const char* end = body + bodySize;
+            if (!getRaw(p, end, record.seq) || !getRaw(p, end, op) ||
+                !getBytes(p, end, record.tag) || !getBytes(p, end, record.type) || !getBytes(p, end, record.payload)) {
+                break;
+            }
+            record.op = static_cast<WalOp>(op);
+
+            offset += kFrameHeader + bodySize;
+            validEnd = offset;
+            ++count;
+            if (visitor) visitor(std::move(record));
+        }
+        return count;
+    }
+
+    std::string readImage(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return {};
+        return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    }
+}
+
+WriteAheadLog::WriteAheadLog(const std::string& path, WalOptions options)
+    : path_(path), options_(options) {
+
+    // Recover the sequence counter and drop a torn tail before appending after it. A sealed file
+    // left by a rotation whose checkpoint never completed precedes the active one.
+    size_t validEnd = 0;
+    scanRecords(readImage(sealedPathOf(path_)), [this](WalRecord&& record) { sealedSeq_ = record.seq; }, validEnd);
+    lastSeq_ = sealedSeq_;
+
+    std::string image = readImage(path_);
+    scanRecords(image, [this](WalRecord&& record) { lastSeq_ = std::max(lastSeq_, record.seq); }, validEnd);
+    writtenSeq_ = durableSeq_ = lastSeq_;
+
+    fd_ = openLog(path_);
+    if (fd_ < 0) {
+        LOG_CONTEXT(LogLevel::ERR, "", std::make_exception_ptr(std::runtime_error(
+                                          "Cannot open write-ahead log '" + path_ + "'.")));
+    }
+
+    if (validEnd < image.size() || validEnd == 0) {
+        if (!truncateTo(fd_, validEnd)) {
+            closeLog(fd_);
+            LOG_CONTEXT(LogLevel::ERR, "", std::make_exception_ptr(std::runtime_error(
+                                              "Cannot truncate torn tail of write-ahead log '" + path_ + "'.")));
+        }
+        if (validEnd == 0 && !writeAll(fd_, kWalMagic, sizeof(kWalMagic))) {
+            closeLog(fd_);
+            LOG_CONTEXT(LogLevel::ERR, "", std::make_exception_ptr(std::runtime_error(
+                                              "Cannot write header of write-ahead log '" + path_ + "'.")));
+        }
+        syncData(fd_);
+    }
+    fileBytes_ = validEnd ? validEnd : sizeof(kWalMagic);
+
+    if (options_.policy == WalSyncPolicy::Interval) {
+        syncThread_ = std::thread(&WriteAheadLog::syncLoop, this);
+    }
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    stop_ = true;
+    cv_.notify_all();
+    if (syncThread_.joinable()) syncThread_.join();
+
+    try {
+        flush();
+    } catch (const std::exception& e) {
+        std::cerr << ":::| ERROR while flushing write-ahead log: " << e.what() << "\n";
+    }
+    if (fd_ >= 0) closeLog(fd_);
+}
+
+uint64_t WriteAheadLog::append(WalOp op, std::string_view tag, std::string_view type, std::string_view payload) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const uint64_t seq = ++lastSeq_;
+    const size_t bodySize = sizeof(seq) + sizeof(uint8_t) + 3 * sizeof(uint32_t) + tag.size() + type.size() + payload.size();
+
+    const size_t frameStart = pending_.size();
+    putRaw(pending_, static_cast<uint32_t>(bodySize));
+    putRaw(pending_, uint32_t{0});  // CRC placeholder
+
+    const size_t bodyStart = pending_.size();
+    putRaw(pending_, seq);
+    putRaw(pending_, static_cast<uint8_t>(op));
+    putBytes(pending_, tag);
+    putBytes(pending_, type);
+    putBytes(pending_, payload);
+
+    const uint32_t crc = Checksum::crc32(pending_.data() + bodyStart, bodySize);
+    std::memcpy(&pending_[frameStart + sizeof(uint32_t)], &crc, sizeof(crc));
+
+    ++stats_.records;
+    return seq;
+}
+
+void WriteAheadLog::commit(uint64_t seq) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    writeBatch(lock, seq, options_.policy == WalSyncPolicy::EveryOp);
+}
+
+void WriteAheadLog::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    writeBatch(lock, lastSeq_, true);
+}
+
+bool WriteAheadLog::rotate() {
+    std::lock_guard<std::mutex> sealLock(sealMutex_);
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // Nothing to seal yet, or the sealed file of an earlier rotation still waits for a checkpoint.
+    if (lastSeq_ == 0 || sealedSeq_ != 0) return false;
+
+    // Let an in-flight batch land in the old file, and make what it holds as durable as a
+    // commit would have: its waiters are only woken against the new file from here on.
+    cv_.wait(lock, [this] { return !flushing_; });
+    if (durableSeq_ < writtenSeq_ && syncData(fd_)) {
+        durableSeq_ = writtenSeq_;
+        ++stats_.syncs;
+    }
+
+    const std::string sealedPath = sealedPathOf(path_);
+    closeLog(fd_);  // some platforms refuse to rename an open file
+    if (std::rename(path_.c_str(), sealedPath.c_str()) != 0) {
+        fd_ = openLog(path_);
+        LOG_CONTEXT(LogLevel::WARNING, "Cannot seal write-ahead log '" + path_ + "'; it keeps growing until the next checkpoint.", {});
+        return fd_ >= 0;
+    }
+
+    // Records still pending go to the new file; replay reads the sealed file first.
+    fd_ = openLog(path_);
+    const bool ok = fd_ >= 0 && writeAll(fd_, kWalMagic, sizeof(kWalMagic)) && syncData(fd_) && syncDirectoryOf(path_);
+    fileBytes_ = sizeof(kWalMagic);
+    if (!ok) {
+        LOG_CONTEXT(LogLevel::ERR, "", std::make_exception_ptr(std::runtime_error(
+                                          "Cannot start a new write-ahead log '" + path_ + "'.")));
+    }
+    sealedSeq_ = lastSeq_;
+    return true;
+}
+
+void WriteAheadLog::truncateThrough(uint64_t seq) {
+    std::lock_guard<std::mutex> sealLock(sealMutex_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (sealedSeq_ == 0 || sealedSeq_ > seq) return;
+        sealedSeq_ = 0;
+    }
+
+    // Appends and commits go on meanwhile: they only touch the active file.
+    const std::string sealedPath = sealedPathOf(path_);
+    if (std::remove(sealedPath.c_str()) != 0) {
+        LOG_CONTEXT(LogLevel::WARNING, "Cannot remove sealed write-ahead log '" + sealedPath + "'.", {});
+        return;
+    }
+    syncDirectoryOf(sealedPath);
+}
+
+void WriteAheadLog::writeBatch(std::unique_lock<std::mutex>& lock, uint64_t seq, bool sync) {
+    // Leader/follower group commit: the first committer to find no batch in flight writes
+    // everything pending (its own record plus any appended meanwhile); the rest wait for it.
+    while ((sync ? durableSeq_ : writtenSeq_) < seq) {
+        if (failed_) {
+            LOG_CONTEXT(LogLevel::ERR, "", std::make_exception_ptr(std::runtime_error(
+                                              "Write-ahead log '" + path_ + "' failed earlier and cannot be repaired.")));
+        }
+        if (flushing_) {
+            cv_.wait(lock);
+            continue;
+        }
+
+        flushing_ = true;
+        std::string batch;
+        batch.swap(pending_);
+        const uint64_t batchEnd = lastSeq_;
+        const int fd = fd_;   // rotate() waits for this batch before it swaps the file
+        const uint64_t start = fileBytes_;
+
+        lock.unlock();
+        bool ok = batch.empty() || writeAll(fd, batch.data(), batch.size());
+        if (ok && sync) ok = syncData(fd);
+        // A failed batch is cut off again, so no torn frame is left for later records to follow.
+        const bool repaired = ok || truncateTo(fd, start);
+        lock.lock();
+
+        flushing_ = false;
+        cv_.notify_all();
+        if (!ok) {
+            // Put the batch back ahead of what was appended meanwhile: it is retried by the next
+            // commit, and no sequence number past it counts as written until then.
+            batch.append(pending_);
+            pending_.swap(batch);
+            failed_ = !repaired;
+            LOG_CONTEXT(LogLevel::ERR, "", std::make_exception_ptr(std::runtime_error(
+                                              "Write to write-ahead log '" + path_ + "' failed.")));
+        }
+
+        fileBytes_ = start + batch.size();
+        if (!batch.empty()) {
+            ++stats_.writes;
+            stats_.bytes += batch.size();
+        }
+        writtenSeq_ = batchEnd;
+        if (sync) {
+            durableSeq_ = batchEnd;
+            ++stats_.syncs;
+        }
+    }
+}
+
+void WriteAheadLog::syncLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_) {
+        cv_.wait_for(lock, options_.syncInterval, [this] { return stop_.load(); });
+        if (stop_) break;
+        if (durableSeq_ < lastSeq_) {
+            try {
+                writeBatch(lock, lastSeq_, true);
+            } catch (const std::exception& e) {
+                std::cerr << ":::| ERROR in write-ahead log sync thread: " << e.what() << "\n";
+            }
+        }
+    }
+}
+
+uint64_t WriteAheadLog::lastSequence() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lastSeq_;
+}
+
+uint64_t WriteAheadLog::durableSequence() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return durableSeq_;
+}
+
+WalStats WriteAheadLog::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+size_t WriteAheadLog::replay(const std::string& path, const std::function<void(WalRecord&&)>& visitor) {
+    size_t validEnd = 0;
+    size_t count = scanRecords(readImage(sealedPathOf(path)), visitor, validEnd);
+    return count + scanRecords(readImage(path), visitor, validEnd);
+}
@@ -0,0 +1,119 @@
+#pragma once
+#ifndef WRITE_AHEAD_LOG_H
+#define WRITE_AHEAD_LOG_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// :::WriteAheadLog class
+// :::Append-only log of store mutations. Each record carries a sequence number,
+// :::the operation, the item tag and type and an encoded payload, framed with a
+// :::length and CRC so a torn tail left by a crash is detected and dropped.
+// :::Writers append under the store lock and commit after releasing it, so
+// :::concurrent writers share a single write + fdatasync (group commit).
+// **************************************************************************************************
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+enum class WalOp : uint8_t {
+    Add    = 1,
+    Modify = 2,
+    Remove = 3
+};
+
+enum class WalSyncPolicy {
+    EveryOp,   // commit() returns once the record is on disk (fdatasync, batched across writers)
+    Interval,  // commit() hands the record to the OS; a background thread syncs every `syncInterval`
+    None       // commit() hands the record to the OS; syncing is left to the OS
+};
+
+struct WalOptions {
+    WalSyncPolicy policy = WalSyncPolicy::EveryOp;
+    std::chrono::milliseconds syncInterval{10};
+};
+
+struct WalRecord {
+    uint64_t seq = 0;
+    WalOp op = WalOp::Add;
+    std::string tag;
+    std::string type;
+    std::string payload;
+};
+
+struct WalStats {
+    uint64_t records = 0;   // records appended since open
+    uint64_t bytes = 0;     // bytes handed to the OS since open
+    uint64_t writes = 0;    // write batches issued
+    uint64_t syncs = 0;     // fdatasync calls issued
+};
+
+class WriteAheadLog {
+    public:
+        // Opens (or creates) the log at `path`. An existing log is scanned, a torn tail is
+        // truncated and sequence numbers continue from the last intact record.
+        explicit WriteAheadLog(const std::string& path, WalOptions options = {});
+        ~WriteAheadLog();
+
+        WriteAheadLog(const WriteAheadLog&) = delete;
+        WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+        // Buffers a record and returns its sequence number. Cheap: no I/O happens here.
+        uint64_t append(WalOp op, std::string_view tag, std::string_view type, std::string_view payload);
+
+        // Makes every record up to `seq` as durable as the sync policy promises. Throws if the
+        // write fails; the records stay pending and the next commit retries them.
+        void commit(uint64_t seq);
+
+        // Writes and syncs everything appended so far, regardless of policy.
+        void flush();
+
+        // Seals the current file as `<path>.prev` and continues in a fresh one, so the records
+        // a snapshot is about to cover can later be dropped whole. Only swaps files: no record
+        // is copied. Returns false (and keeps appending) while an earlier sealed file remains.
+        bool rotate();
+
+        // Deletes the sealed file once every record in it is at or below `seq` (typically the
+        // sequence covered by a snapshot). The file is removed without blocking appends.
+        void truncateThrough(uint64_t seq);
+
+        uint64_t lastSequence() const;
+        uint64_t durableSequence() const;
+        const std::string& path() const { return path_; }
+        WalStats stats() const;
+
+        // Reads every intact record of the log at `path` (its sealed file first) in order. Returns
+        // the number of records visited; reading stops at the first torn or corrupt record.
+        static size_t replay(const std::string& path, const std::function<void(WalRecord&&)>& visitor);
+
+    private:
+        void writeBatch(std::unique_lock<std::mutex>& lock, uint64_t seq, bool sync);
+        void syncLoop();
+
+        std::string path_;
+        WalOptions options_;
+        int fd_ = -1;
+
+        std::mutex sealMutex_;         // orders rotate() against the removal of the sealed file
+        mutable std::mutex mutex_;
+        std::condition_variable cv_;
+        std::string pending_;          // encoded records not yet handed to the OS
+        uint64_t lastSeq_ = 0;         // last sequence number assigned
+        uint64_t writtenSeq_ = 0;      // last sequence number handed to the OS
+        uint64_t durableSeq_ = 0;      // last sequence number known to be on disk
+        uint64_t sealedSeq_ = 0;       // last sequence number in the sealed file, 0 if there is none
+        bool flushing_ = false;        // a leader is currently writing a batch
+        bool failed_ = false;          // a failed batch could not be cut off: every commit throws
+        uint64_t fileBytes_ = 0;       // size of the active file once in-flight batches land
+        WalStats stats_;
+
+        std::atomic<bool> stop_{false};
+        std::thread syncThread_;
+};
+
+#endif // WRITE_AHEAD_LOG_H
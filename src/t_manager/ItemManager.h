@@ -3,12 +3,14 @@
 #pragma once
 
 #include "t_wrapper/ItemWrapper.h"
+#include "t_wrapper/LazyItem.h"
 #include <unordered_map>
 #include <functional>
 #include <stack>
 #include <vector>
 #include <optional>
 #include <map>
+#include <unordered_set>
 #include <iostream>
 #include <nlohmann/json.hpp>
 #include <fstream>
@@ -20,6 +22,18 @@
 #include <string>
 #include <typeinfo>
 #include "versionForMigration/MigrationRegistry.h"
+#include "versionForMigration/BackgroundMigrator.h"
+#include "persistence/WriteAheadLog.h"
+#include "persistence/Checkpointer.h"
+#include "persistence/ForkedSave.h"
+#include "persistence/IoBackend.h"
+#include "persistence/MappedItemStore.h"
+#include "persistence/SegmentLog.h"
+#include "persistence/TagIndex.h"
+#include "metrics/Metrics.h"
+#include "utils/TypeId.hpp"
+#include "utils/JsonSpan.hpp"
+#include "t_manager/TypeRegistration.h"
 #include <mutex>
 #if defined(__GNUC__) || defined(__clang__)
 #include <cxxabi.h>
@@ -47,61 +61,328 @@ public:
     // It allows for easy management of the current state, including undo and redo operations.
     using State = std::unordered_map<std::string, std::shared_ptr<BaseItem>>;
 
+    // Immutable point-in-time view of the store, as handed to exporters.
+    using Snapshot = std::shared_ptr<const State>;
+
 private:
+    // Where item wrappers, payloads built from files and undo clones are allocated (see setMemoryResource).
+    // Declared before every container of items; the items also keep it alive themselves.
+    ItemResource itemResource_ = std::make_shared<std::pmr::synchronized_pool_resource>();
+
     // Main storage.
     // This is a map that stores all items by their tags. The tag is a unique identifier for each item.
     // It allows for quick access to items by their tag, which is useful for operations like
     std::unordered_map<std::string, std::shared_ptr<BaseItem>> items;
 
+    // An undo state and the tags in which the next newer state differs from it. The newest entry's
+    // list is filled as writes mark tags; undo then marks only those instead of comparing stores.
+    struct HistoryEntry {
+        State state;
+        std::vector<std::string> changed;   // may name a tag more than once
+    };
+
     //Queues for managing redo and undo functions.
-    std::deque<State> undoHistory; // works like a queue (can trim front)
+    std::deque<HistoryEntry> undoHistory; // works like a queue (can trim front)
     std::queue<State> redoQueue;   // replaces redoStack
+    std::vector<std::string> redoChanged_;   // tags changed by the undos queued for redo
+    std::vector<std::string> spareTags_;     // buffers of dropped history lists, reused by noteUndoable
 
     //::->       DATA STRUCTURES.
     //****************************************
 
-    // Maps type names to their usage count. This allows tracking how many times each type is used
+    // Maps type ids to their usage count. This allows tracking how many times each type is used
     // This is useful for optimization and understanding which types are most common in the system
-    std::unordered_map<std::string, int> typeUsage;
+    std::unordered_map<TypeId, int> typeUsage;
     
     // Maps item IDs to their BaseItem pointers for fast lookup. This allows quick access to items by their unique ID
     std::unordered_map<std::string, std::shared_ptr<BaseItem>> idMap;
 
-    // Maps for managing type registration and schema. This maps type names to their std::type_index for fast lookup
-    std::unordered_map<std::string, std::type_index> registeredTypes;
+    // The registries below are keyed by TypeIds::of<T>(). Records name their type by its typeid() name
+    // (the "wire name"); this maps the wire names of registered types to their id (see typeIdOf).
+    std::unordered_map<std::string, TypeId> typeIds_;
+
+    // Maps for managing type registration and schema. This maps type ids to their std::type_index for fast lookup
+    std::unordered_map<TypeId, std::type_index> registeredTypes;
+
+    // Maps type ids to their schema functions. This maps type ids to functions that return their schema as json
+    std::unordered_map<TypeId, std::function<json()>> schemaRegistry;
+
+    // Deserializes json into an item, sharing the one already in idMap under the same id.
+    using Deserializer = std::shared_ptr<BaseItem> (ItemManager::*)(const json&);
+
+    // Builds an item from json without touching idMap, so it can run on several threads at once
+    // (used by parallel recovery, lazy and mapped decoding).
+    using ItemFactory = std::shared_ptr<BaseItem> (*)(const json&, const ItemResource&);
+
+    // Dispatch table of registered types, indexed by TypeIds::indexOf<T>() (dense across the process,
+    // so the table has holes for types this manager never saw); removing the type's last item clears
+    // the slot's functions, re-registering fills them again. Importers resolve a record's type to its
+    // slot through a TypeDispatch, then call straight through the slot's function pointers.
+    struct TypeSlot {
+        TypeId id = 0;
+        Deserializer deserialize = nullptr;
+        ItemFactory factory = nullptr;
+
+        bool registered() const { return deserialize != nullptr; }
+    };
+    std::vector<TypeSlot> typeTable_;
+    std::unordered_map<TypeId, uint32_t> typeSlots_;
+
+    // Per-import cache of wire name -> slot. Files hold few distinct types, mostly in runs, so names
+    // are compared against the previous hit and then the (short) list seen so far; typeIdOf and the
+    // slot lookup run once per distinct name per file. Slots are cached by copy, so importers that
+    // decode without mutex_ pass `lockOnMiss` and only hold it for those lookups.
+    class TypeDispatch {
+        public:
+            explicit TypeDispatch(const ItemManager& manager, bool lockOnMiss = false)
+                : manager_(manager), lockOnMiss_(lockOnMiss) {}
+
+            // The registered slot of `wireName`, or nullptr. Valid until the next call.
+            const TypeSlot* find(std::string_view wireName);
+
+        private:
+            const ItemManager& manager_;
+            bool lockOnMiss_;
+            std::vector<std::pair<std::string, TypeSlot>> seen_;   // empty slot if unregistered
+            size_t last_ = 0;
+    };
 
-    // Maps type names to their schema functions. This maps type names to functions that return their schema as json
-    std::unordered_map<std::string, std::function<json()>> schemaRegistry;
+    // The registered slot of a type id, or nullptr.
+    const TypeSlot* typeSlot(TypeId id) const;
 
-    // Maps type names to their deserialization functions. This maps type names to functions that deserialize json into BaseItem pointers
-    std::unordered_map<std::string, std::function<std::shared_ptr<BaseItem>(const json&, const std::string&)>> deserializers;
+    // demangleType results, computed once per name (registered types are seeded with TypeIds::nameOf).
+    mutable std::unordered_map<std::string, std::string> demangled_;
+    mutable std::mutex demangleMutex_;
     
-    // thread-safety gatekeeper
-    mutable std::mutex mutex_;
+    // Registry in use while metrics are on (see setMetricsEnabled). Turning them off only clears the
+    // pointer: the registry lives as long as the manager, so a call still timing into it stays valid.
+    std::atomic<MetricsRegistry*> metrics_{nullptr};
+    std::unique_ptr<MetricsRegistry> metricsRegistry_;
+    mutable std::mutex metricsMutex_;  // guards metricsRegistry_
+
+    MetricsRegistry* activeMetrics() const { return metrics_.load(std::memory_order_acquire); }
+
+    // Bytes of `filename` and `items` as moved by `op`, when metrics are on.
+    void recordTransfer(MetricOp op, const std::string& filename, size_t items) const;
+
+    // thread-safety gatekeeper (times waits and holds while metrics are on)
+    mutable MeteredMutex mutex_{metrics_};
+
+    // Optional mutation log. Records are appended under mutex_ and committed after it is released,
+    // so concurrent writers share one disk sync.
+    std::shared_ptr<WriteAheadLog> wal_;
+    std::unordered_set<std::string> walDirty_;   // handed out by getItemRaw since the last log append
+
+    // Change tracking for incremental export. Every mutation takes the next change sequence;
+    // a tag is either in changedAt_ (last add/modify) or removedAt_ (tombstone), never both.
+    uint64_t changeSeq_ = 0;
+    std::unordered_map<std::string, uint64_t> changedAt_;
+    std::unordered_map<std::string, uint64_t> removedAt_;
+
+    // Cached export view of `items`. Mutations record their tag in snapshotStale_, so taking a
+    // snapshot re-points only those tags; in-place writers first copy an item the view still shares.
+    mutable std::shared_ptr<State> snapshot_;
+    mutable std::unordered_set<std::string> snapshotStale_;
+    // The view snapshot_ last replaced, kept to be re-pointed (by spareStale_) and reused once no
+    // exporter reads it, instead of copying snapshot_ while an exporter still reads that one.
+    mutable std::shared_ptr<State> spare_;
+    mutable std::unordered_set<std::string> spareStale_;
+
+    // Optional background checkpointer. Started and stopped without holding mutex_, since its
+    // thread takes mutex_ to capture snapshots.
+    std::unique_ptr<Checkpointer> checkpointer_;
+    mutable std::mutex checkpointerMutex_;
+    CheckpointStats lastCheckpointStats_;
+
+    // Bulk file I/O used by the importers and multi-file exporters; IoBackend::shared() when unset.
+    std::shared_ptr<IoBackend> io_;
+    mutable std::mutex ioMutex_;
+
+    // Save running in a forked child, if any (see startForkedSave).
+    std::unique_ptr<ForkedSave> forkedSave_;
+    std::mutex forkedSaveMutex_;
+
+    // Optional memory-mapped backing store (see enableMappedStore). Items it holds that have not been
+    // read since it was opened are not in `items`; they are decoded on first use.
+    std::unique_ptr<MappedItemStore> mapped_;
+    std::unordered_set<std::string> mappedDirty_;   // handed out by getItemRaw since the last sync
+
+    // Optional log-structured persistence (see enableSegmentLog). Changes are appended under mutex_;
+    // compaction runs on the log's own thread.
+    std::shared_ptr<SegmentLog> segmentLog_;
+    std::unordered_set<std::string> segmentDirty_;   // handed out by getItemRaw since the last append
+
+    // JSON, binary, XML and CSV exports also write a `<file>.tagidx` sidecar (see setExportTagIndex).
+    std::atomic<bool> exportTagIndex_{false};
+
+    // Whole-file imports leave LazyItem placeholders instead of decoding (see setLazyImport).
+    bool lazyImport_ = false;
+    // Co-owned by every placeholder's decoder, with migrationRegistry: snapshot views may keep
+    // undecoded placeholders alive after the manager is gone.
+    std::shared_ptr<std::mutex> lazyDecodeMutex_ = std::make_shared<std::mutex>();
+
+    // Whole-file imports leave placeholders for records older than their type's latest version only
+    // (see setDeferredMigration).
+    bool deferMigration_ = false;
+
+    // Optional background "migrate all" task (see startBackgroundMigration). Started and stopped
+    // without holding mutex_, since its thread takes mutex_ for each batch.
+    std::shared_ptr<BackgroundMigrator> migrator_;   // shared with waitBackgroundMigration callers
+    mutable std::mutex migratorMutex_;
+    uint64_t importGeneration_ = 0;   // bumped by applyImport; the migrator rescans when it moves
+    MigrationTaskStats lastMigrationStats_;
 
     
 
     //::->       PRIVATE FUNCTIONS.
     //****************************************
 
-    MigrationRegistry migrationRegistry;
+    std::shared_ptr<MigrationRegistry> migrationRegistry = std::make_shared<MigrationRegistry>();
     
     // Helper function to clone the current state of items
     State cloneCurrentState() const;
 
     //Automatic save for the redo and undo history.
     void saveState();
+
+    // Change tracking helpers; callers hold mutex_.
+    // `inPlace`: the caller writes through a reference afterwards, so the segment log gets the
+    // item at the next flushSegmentDirty rather than now.
+    void markChanged(const std::string& tag, bool inPlace = false);
+    void markRemoved(const std::string& tag);
+    void markCleared();                      // every current item is about to go
+    void markReplaced(const std::vector<std::string>& changed);  // `items` was swapped (undo/redo)
+    void noteUndoable(const std::string& tag, bool inPlace = false);   // into the newest history entry
+    void recycleTags(std::vector<std::string>& tags);                  // a history list being dropped
+
+    // Snapshot of `items`, O(changed since the view it re-points). Copies the pointer map only when
+    // exporters still hold both the current and the previous view. Caller holds mutex_.
+    Snapshot snapshotLocked() const;
+    void refreshView(State& view, const std::unordered_set<std::string>& tags) const;
+
+    // snapshot() without counting a call: what the exports use.
+    Snapshot takeSnapshot() const;
+
+    // Before writing to an item in place: if the cached snapshot shares it, swap in a private copy.
+    void detachFromSnapshot(State::iterator it);
     
+    // Installs T (slot, schema, and its declared version and migrations, if any) unless this manager
+    // already has it; that check is all a call costs afterwards.
     template<typename T>
     void registerType();
 
     template<typename T>
-    static std::string getCompilerTypeName();
+    static const std::string& getCompilerTypeName();
+
+    // Id of a type named by its wire name; a hash of the name itself if no registered type has it,
+    // which no registry entry matches unless one was made for that name (schemas read from a file).
+    TypeId typeIdOf(const std::string& wireName) const;
 
     json getSchemaForType(std::string type) const;
 
+    // Column names for the columnar CSV layout of a type: taken from its schema when one is
+    // registered, otherwise from the first-level keys of `sample` (empty for scalar payloads).
+    std::vector<std::string> csvColumnsForType(const std::string& typeName, const json& sample) const;
+
     template<typename T>
     std::shared_ptr<BaseItem> deserializeItemById(const json& j);
+
+    template<typename T>
+    static std::shared_ptr<BaseItem> makeItem(const json& j, const ItemResource& resource = nullptr);
+
+    // Appends one record of the binary export format: type, tag and json payload, each length-prefixed.
+    template<typename Buffer>
+    static void appendBinaryRecord(Buffer& buffer, const std::string& type, const std::string& tag, const std::string& payload);
+
+    // Appends one snapshot record for `item`; a lazy placeholder is copied from its raw record
+    // instead of being decoded.
+    static void appendSnapshotRecord(std::string& buffer, const std::string& tag, const BaseItem& item);
+
+    // Encodes every item of `view` in the layout of exportToFile_Binary / exportToFile_Json, without
+    // console output.
+    std::string encodeSnapshot(const State& view, CheckpointFormat format) const;
+
+    // Compact (MessagePack) encoding of an item's serialize() output, used as the WAL payload.
+    // Lazy placeholders are logged from their record, without decoding them.
+    static std::string encodeWalPayload(const BaseItem& item);
+
+    // Logs the current version of each of `tags` (Remove if it is gone), after the items handed out
+    // by getItemRaw since the last append. Caller holds mutex_ and commits the returned sequence
+    // once it is released; 0 if nothing was logged.
+    uint64_t appendWalRecords(const std::vector<std::string>& tags);
+
+    // Appends the current version of `tag` to the segment log. Caller holds mutex_.
+    void appendSegment(const std::string& tag);
+    void flushSegmentDirty();
+
+    // Mapped store helpers; callers hold mutex_.
+    void writeMapped(const std::string& tag);
+    void flushMappedDirty();
+    std::shared_ptr<BaseItem> decodeMapped(const MappedRecord& record) const;
+    static json mappedToJson(const MappedRecord& record);
+
+    // Reads a scalar straight from the mapping; nullopt if the record is not stored as one.
+    template<typename T>
+    static std::optional<T> readMappedScalar(const MappedRecord& record);
+
+    // Wrapper holding a T built from `args` in the same allocation. Caller holds mutex_.
+    template<typename T, typename... Args>
+    std::shared_ptr<BaseItem> makeInlineItem(const std::string& tag, Args&&... args) const;
+
+    // Shared tail of addItem and the emplace family: records undo state, registers T, stores `item`
+    // under `tag` (replacing what is there) and logs it. Releases `lock`.
+    template<typename T>
+    void storeItem(std::unique_lock<MeteredMutex>& lock, const std::string& tag, std::shared_ptr<BaseItem> item, WalOp op);
+
+    // Finds `tag` in `items`, decoding it from the mapped store first if it is only there.
+    State::iterator findOrLoad(const std::string& tag);
+
+    // Placeholder for a lazily imported record (see setLazyImport), decoded by `slot`'s factory.
+    // `raw` is the item's serialize() output as JSON text; `version` is 0 if not read yet.
+    std::shared_ptr<BaseItem> makeLazyItem(const TypeSlot& slot, const ItemResource& resource, const std::string& tag,
+                                           const std::string& typeName, std::string raw, std::string id, int version = 0);
+
+    // Whole-file imports read and decode without mutex_; this is what they need from the manager
+    // first, read under it.
+    struct ImportSettings {
+        bool lazy = false;
+        bool deferMigration = false;
+        ItemResource resource;
+    };
+    ImportSettings importSettings() const;
+
+    // One decoded record of a whole-file import.
+    struct ImportedItem {
+        std::string tag;
+        std::shared_ptr<BaseItem> item;
+        bool lazy = false;   // placeholders are not entered in idMap
+    };
+
+    // Lazy JSON import: a placeholder for every record of the array whose '[' is at `pos` in `text`,
+    // holding the record's "data" bytes as read. No document is built. False if the array is cut short.
+    bool collectLazyJson(std::string_view text, size_t pos, const ImportSettings& settings, TypeDispatch& dispatch,
+                         std::vector<ImportedItem>& imported, std::vector<std::pair<std::string, json>>& schemas);
+
+    // Merge adds records to the store (XML), Insert records undo state first (single objects),
+    // Replace records undo state and clears the store (JSON, binary, CSV).
+    enum class ImportApply { Merge, Insert, Replace };
+
+    // Installs decoded records under mutex_: items already in idMap under the same id are shared,
+    // as deserializeItemById does, and each entry is left holding the item stored. `schemas` are
+    // (wire name, schema) pairs read from the file. Returns the number of items in the store.
+    size_t applyImport(std::vector<ImportedItem>& imported, std::vector<std::pair<std::string, json>> schemas, ImportApply mode);
+
+    // Single-object imports: decodes `j` with `slot`'s factory without mutex_, then installs it with
+    // undo state (ImportApply::Insert). Returns the stored item, nullptr if the factory built none.
+    std::shared_ptr<BaseItem> installSingle(const TypeSlot& slot, const std::string& tag, const json& j,
+                                            std::vector<std::pair<std::string, json>> schemas = {});
+
+    // A placeholder whose record is older than its type's latest version. Caller holds mutex_.
+    bool isStalePlaceholder(const BaseItem& item) const;
+
+    // If `it` holds a lazy placeholder, decode it and put the real item in its place. Returns
+    // items.end() if decoding fails. Caller holds mutex_.
+    State::iterator materialize(State::iterator it);
         
     
     
@@ -112,17 +393,31 @@ private:
 
 public:
 
-    ItemManager() = default;
+    // Installs every type declared with SMART_STORE_REGISTER_TYPE.
+    ItemManager();
     ~ItemManager() {
         try {
+            stopCheckpointer();
+            stopBackgroundMigration();
+            waitForkedSave();
             {
-                std::lock_guard<std::mutex> lock(mutex_);
+                std::lock_guard<MeteredMutex> lock(mutex_);
+                appendWalRecords({});   // pending getItemRaw writes, while their items still exist
+                wal_.reset();
+                if (mapped_) {
+                    flushMappedDirty();
+                    mapped_.reset();
+                }
+                if (segmentLog_) flushSegmentDirty();
+                segmentLog_.reset();
                 items.clear();
                 idMap.clear();
                 registeredTypes.clear();
                 schemaRegistry.clear();
-                deserializers.clear();
+                typeTable_.clear();
+                typeSlots_.clear();
                 typeUsage.clear();
+                typeIds_.clear();
                 undoHistory.clear();
                 while (!redoQueue.empty()) redoQueue.pop();
             }
@@ -141,13 +436,20 @@ public:
 
     void showSignature();
 
+    // Adds T to the process-wide TypeRegistration list; used by SMART_STORE_REGISTER_TYPE.
+    template<typename T, int LatestVersion, typename... Migrations>
+    static bool declareType(Migrations... migrations);
+
+    // Records and migration steps applied by this manager so far, and chains resolved.
+    MigrationRegistry::Counters migrationCounters() const { return migrationRegistry->counters(); }
+
     // Get the compiler type name of a given type T
     // This function uses typeid and demangling to get a human-readable type name.
     std::string demangleType(const std::string& mangledName) const;
 
      // Display registered deserializers
      // This function displays all registered deserializers in the ItemManager.
-     // It iterates through the deserializers map and prints each type name and its corresponding function.
+     // It iterates through the type dispatch table and prints each registered type with its slot.
     void displayRegisteredDeserializers();
 
      // Check if an item with a specific tag exists
@@ -157,6 +459,19 @@ public:
     template<typename T>
     void addItem(std::shared_ptr<T> obj, const std::string& tag);
 
+       // Construct T from `args` inside the item's own allocation (one allocation for control block,
+       // wrapper and payload). Throws like addItem if `tag` is empty or already used.
+    template<typename T, typename... Args>
+    void emplaceItem(const std::string& tag, Args&&... args);
+
+       // Like emplaceItem, but returns false and constructs nothing if `tag` is already used.
+    template<typename T, typename... Args>
+    bool tryEmplace(const std::string& tag, Args&&... args);
+
+       // Emplace, replacing any item already under `tag` (whatever its type). True if it was inserted.
+    template<typename T, typename... Args>
+    bool insertOrAssign(const std::string& tag, Args&&... args);
+
        // Modify item using a given modifier function
      template<typename T>
      bool modifyItem(const std::string& tag, const std::function<void(T&)>& modifier);
@@ -245,6 +560,13 @@ public:
         // Asynchronously export items to a CSV file
      void asyncExportToFile_CSV(const std::string& filename) const;
 
+        // Export items to one CSV file per type, with a column per first-level field.
+        // Files are named <stem>_<type><ext> next to `filename`.
+     bool exportToFile_CSVColumnar(const std::string& filename) const;
+
+        // Asynchronously export items to per-type columnar CSV files
+     void asyncExportToFile_CSVColumnar(const std::string& filename) const;
+
         // Import items from a CSV file
      bool importFromFile_CSV(const std::string& filename);
 
@@ -257,6 +579,170 @@ public:
         // Asynchronously import a single object from a CSV file
      void asyncImportSingleObject_CSV(const std::string& filename, const std::string& type, const std::string& tag);
 
+       // Log every change to the store (writes, undo/redo, imports, deltas) to an append-only
+       // write-ahead log at `path`. Writes made through a getItemRaw reference are logged at the
+       // next logged change, flush or checkpoint. An existing log is reopened and appended to.
+     void enableWriteAheadLog(const std::string& path, WalOptions options = {});
+
+       // Flush and close the write-ahead log, if one is open
+     void disableWriteAheadLog();
+
+     bool isWriteAheadLogEnabled() const;
+
+       // Write and sync every logged mutation, whatever the sync policy
+     void flushWriteAheadLog();
+
+       // Write a binary snapshot of the store plus `<snapshotFile>.manifest`, which records the
+       // write-ahead log sequence the snapshot covers, then drop the log records it makes redundant.
+     bool checkpointToFile(const std::string& snapshotFile);
+
+       // Rebuild the store from a snapshot written by checkpointToFile and the tail of the
+       // write-ahead log at `walFile`. Only the last logged record of each tag is decoded, and
+       // decoding runs on `threads` workers (0 = one per core), sharded by tag. Types must be
+       // registered beforehand. Call enableWriteAheadLog afterwards to keep logging.
+     bool recoverFromSnapshot(const std::string& snapshotFile, const std::string& walFile, unsigned threads = 0);
+
+       // Save the store to `options.path` every `options.interval` from a background thread, skipping
+       // cycles with no changes and writing at most `options.maxBytesPerSecond`. Replaces a running checkpointer.
+     void startCheckpointer(const CheckpointOptions& options);
+
+     void stopCheckpointer();
+
+       // Counters of the running (or last stopped) checkpointer; all zero if none was started.
+     CheckpointStats checkpointerStats() const;
+
+       // Replace the I/O backend (io_uring or thread pool) used for bulk reads and multi-file writes.
+       // Pass nullptr to go back to the process-wide default.
+     void setIoBackend(std::shared_ptr<IoBackend> backend);
+
+     std::shared_ptr<IoBackend> ioBackend() const;
+
+       // BGSAVE-style save for very large stores (POSIX only): takes a snapshot, fork()s, and lets the
+       // child encode it (binary or JSON export layout) and write `filename` while the parent keeps
+       // serving. The store lock is held only for the snapshot and the fork. Returns false if a forked
+       // save is already running or fork is unavailable. See ForkedSave.h for the fork-time constraints.
+     bool startForkedSave(const std::string& filename, CheckpointFormat format = CheckpointFormat::Binary);
+
+     bool isForkedSaveRunning();
+
+       // Wait for the forked save to finish and return its outcome; nullopt if none was started.
+     std::optional<ForkedSaveResult> waitForkedSave();
+
+       // Keep the store in a memory-mapped file at `path` (plus `<path>.index`; POSIX only). Items already
+       // in the file are available at once and decoded on first use (scalars are read straight from the
+       // mapping); items in memory are written to it, and so is every later change. Writes made through
+       // getItemRaw references reach the file at the next syncMappedStore. Returns false if the file
+       // cannot be opened.
+     bool enableMappedStore(const std::string& path);
+
+       // Decode every item still only in the file, sync it and close it.
+     void disableMappedStore();
+
+     bool isMappedStoreEnabled() const;
+
+       // Write pending getItemRaw changes and flush the mapping to disk.
+     void syncMappedStore();
+
+       // Reclaim the space of replaced and removed items.
+     void compactMappedStore();
+
+     std::optional<MappedStoreStats> mappedStoreStats() const;
+
+       // Persist the store as log-structured segment files in `directory` (see SegmentLog.h): every change
+       // is appended, and a background compactor drops replaced versions once the garbage ratio is
+       // exceeded. Items already in the log are loaded (replacing in-memory items with the same tag; their
+       // types must be registered) and items only in memory are appended. False if the log cannot be opened.
+     bool enableSegmentLog(const std::string& directory, SegmentLogOptions options = {});
+
+     void disableSegmentLog();
+
+       // Merge the sealed segments now, whatever the garbage ratio.
+     bool compactSegmentLog();
+
+     std::optional<SegmentLogStats> segmentLogStats() const;
+
+       // Memory resource that item wrappers, payloads decoded from files and undo clones are allocated from.
+       // The default is a pool per manager (std::pmr::synchronized_pool_resource): blocks of each size come
+       // from their own slabs and freed ones, e.g. by the clear before a whole-file import, are reused
+       // without going back to the heap. Must be thread-safe. nullptr restores a fresh default pool; items
+       // already stored stay with the resource they came from, which they keep alive.
+     void setMemoryResource(ItemResource resource);
+
+     ItemResource memoryResource() const;
+
+       // Make exportToFile_Json/_Binary/_XML/_CSV also write a sidecar index (`<file>.tagidx`, see TagIndex.h)
+       // of where each record lies. importSingleObject_* then read and parse only the requested record,
+       // falling back to scanning the file when the sidecar is missing or no longer matches it. Off by default.
+     void setExportTagIndex(bool enabled);
+
+     bool isExportTagIndexEnabled() const;
+
+       // Per-operation call counts and latency histograms, store-lock wait and hold times, and bytes and
+       // items moved by whole-file imports and exports (see Metrics.h). Off by default; while off, each
+       // operation costs one extra pointer load. Counts survive turning metrics off and on again.
+     void setMetricsEnabled(bool enabled);
+
+     bool isMetricsEnabled() const;
+
+       // Counters so far, with the migration counters; empty (enabled == false) if metrics were never on.
+     MetricsSnapshot metrics() const;
+
+     void resetMetrics();
+
+       // Writes metrics().toJson() to `filename` (atomically), or hands the snapshot to `sink`.
+     bool dumpMetrics(const std::string& filename) const;
+
+     void dumpMetrics(const std::function<void(const MetricsSnapshot&)>& sink) const;
+
+       // Lazy import mode for importFromFile_Json / importFromFile_Binary: each record is kept as its raw
+       // bytes and only migrated and decoded on the first getItem, getItemRaw or modifyItem of its tag.
+       // Exports copy the bytes of records never decoded straight through. Types must still be registered
+       // before the import. Off by default.
+     void setLazyImport(bool enabled);
+
+     bool isLazyImportEnabled() const;
+
+       // Deferred migration for importFromFile_Json / importFromFile_Binary: records already at their
+       // type's latest version are decoded as usual, older ones are kept as placeholders (as in lazy
+       // import) and migrated on first access. Exports copy them through with their version, so the
+       // file stays readable. Off by default.
+     void setDeferredMigration(bool enabled);
+
+     bool isDeferredMigrationEnabled() const;
+
+       // Upgrade every item still waiting for migration from a background thread, `options.batchSize`
+       // at a time with `options.pause` between batches; a batch is put off while the store is busy.
+       // Imports that run meanwhile are picked up by the next batch. The thread ends once none is
+       // left. Replaces a running task.
+     void startBackgroundMigration(const MigrationTaskOptions& options = {});
+
+     void stopBackgroundMigration();
+
+       // Blocks until the background migration has finished (or was stopped).
+     void waitBackgroundMigration();
+
+       // Counters of the running (or last stopped) task; all zero if none was started.
+     MigrationTaskStats backgroundMigrationStats() const;
+
+       // Number of items still waiting for migration.
+     size_t pendingMigrations() const;
+
+       // Consistent view of every item, cheap to take (no item is copied) and safe to read without
+       // the store lock: later modifications copy-on-write instead of touching items it holds.
+     Snapshot snapshot() const;
+
+       // Current change sequence. Pass it to a later exportChangesSince to get what changed after this point.
+     uint64_t changeSequence() const;
+
+       // Write only the items added/modified and the tags removed after `sinceSeq` as a JSON delta file:
+       // {"format", "base_seq", "seq", "upserts": [entries as in exportToFile_Json], "removed": [tags]}.
+       // Undo/redo and whole-file imports count as changes to every tag whose content they change.
+     bool exportChangesSince(uint64_t sinceSeq, const std::string& filename) const;
+
+       // Apply a delta written by exportChangesSince on top of the current store (typically a base file
+       // just imported). Deltas must be applied in order; re-applying one is harmless.
+     bool applyDeltaFromFile_Json(const std::string& filename);
+
        // Register a type for serialization and deserialization
      void listRegisteredTypes() const;
 
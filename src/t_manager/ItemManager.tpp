@@ -5,14 +5,22 @@
 #include "err_log/Logger.hpp"
 #include "utils/AtomicFileWriter .hpp"
 #include "utils/Json_traits.hpp"
+#include "utils/Csv_utils.hpp"
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <stdexcept>
 #include <type_traits>
 #include "../lib/tinyxml2/tinyxml2.h"
 #include <string>
 #include <typeinfo>
 #include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <unordered_set>
 #if defined(__GNUC__) || defined(__clang__)
 #include <cxxabi.h> // For abi::__cxa_demangle
 #endif
@@ -25,8 +33,37 @@ using json = nlohmann::json;
 //******************************
 
 template<typename T>
-std::string ItemManager::getCompilerTypeName() {
- return typeid(T).name(); // Return the mangled name directly for simplicity
+const std::string& ItemManager::getCompilerTypeName() {
+    static const std::string name = typeid(T).name(); // The mangled name, built once per type
+    return name;
+}
+
+TypeId ItemManager::typeIdOf(const std::string& wireName) const {
+    auto it = typeIds_.find(wireName);
+    return it != typeIds_.end() ? it->second : TypeIds::hash(wireName);
+}
+
+const ItemManager::TypeSlot* ItemManager::typeSlot(TypeId id) const {
+    auto it = typeSlots_.find(id);
+    if (it == typeSlots_.end()) return nullptr;
+    const TypeSlot& slot = typeTable_[it->second];
+    return slot.registered() ? &slot : nullptr;
+}
+
+const ItemManager::TypeSlot* ItemManager::TypeDispatch::find(std::string_view wireName) {
+    if (last_ >= seen_.size() || seen_[last_].first != wireName) {
+        last_ = 0;
+        while (last_ < seen_.size() && seen_[last_].first != wireName) ++last_;
+        if (last_ == seen_.size()) {
+            const std::string name(wireName);
+            std::unique_lock<MeteredMutex> lock(manager_.mutex_, std::defer_lock);
+            if (lockOnMiss_) lock.lock();
+            const TypeSlot* slot = manager_.typeSlot(manager_.typeIdOf(name));
+            seen_.emplace_back(name, slot ? *slot : TypeSlot{});
+        }
+    }
+    const TypeSlot& slot = seen_[last_].second;
+    return slot.registered() ? &slot : nullptr;
 }
 
 ItemManager::State ItemManager::cloneCurrentState() const {
@@ -41,6 +78,7 @@ ItemManager::State ItemManager::cloneCurrentState() const {
 void ItemManager::saveState() {
     // Trim oldest undo if exceeding max history
     if (undoHistory.size() > MAX_UNDO_HISTORY) {
+        recycleTags(undoHistory.front().changed);
         undoHistory.pop_front();
     }
 
@@ -49,50 +87,512 @@ void ItemManager::saveState() {
     }
 }
 
-template<typename T>
-std::shared_ptr<BaseItem> ItemManager::deserializeItemById(const json& j) {
-    std::string id = j.at("id");
-    if (idMap.count(id)) {
-        return idMap[id];
+void ItemManager::markChanged(const std::string& tag, bool inPlace) {
+    noteUndoable(tag, inPlace);
+    changedAt_[tag] = ++changeSeq_;
+    removedAt_.erase(tag);
+    if (snapshot_) snapshotStale_.insert(tag);
+    if (mapped_) writeMapped(tag);
+    if (segmentLog_) {
+        if (inPlace) {
+            segmentDirty_.insert(tag);
+        } else {
+            segmentDirty_.erase(tag);
+            flushSegmentDirty();   // earlier in-place writes go ahead of this record
+            appendSegment(tag);
+        }
+    }
+}
+
+void ItemManager::markRemoved(const std::string& tag) {
+    noteUndoable(tag);
+    removedAt_[tag] = ++changeSeq_;
+    changedAt_.erase(tag);
+    if (snapshot_) snapshotStale_.insert(tag);
+    if (mapped_) {
+        mapped_->erase(tag);
+        mappedDirty_.erase(tag);
+    }
+    if (segmentLog_) {
+        segmentDirty_.erase(tag);
+        flushSegmentDirty();
+        try {
+            segmentLog_->remove(tag);
+        } catch (const std::exception& e) {
+            LOG_CONTEXT(LogLevel::ERR, "Cannot log removal of '" + tag + "' to the segment log: " + e.what(), {});
+        }
+    }
+}
+
+void ItemManager::noteUndoable(const std::string& tag, bool inPlace) {
+    if (undoHistory.empty()) return;
+    auto& changed = undoHistory.back().changed;
+    if (!changed.empty() && changed.back() == tag) return;
+    if (changed.capacity() == 0) changed.reserve(4);   // a write, then in-place writes through getItemRaw
+    if (inPlace && !spareTags_.empty() && spareTags_.back().capacity() >= tag.size()) {
+        // Spares are kept for getItemRaw, which otherwise allocates for a tag past the small-string
+        // buffer; the other writes allocate anyway and would use them all up.
+        changed.push_back(std::move(spareTags_.back()));
+        spareTags_.pop_back();
+        changed.back().assign(tag);
+    } else {
+        changed.push_back(tag);
+    }
+}
+
+void ItemManager::recycleTags(std::vector<std::string>& tags) {
+    constexpr size_t kMaxSpareTags = 64;
+    for (auto& tag : tags) {
+        if (spareTags_.size() >= kMaxSpareTags) break;
+        if (tag.capacity() > std::string().capacity()) spareTags_.push_back(std::move(tag));   // heap buffers only
+    }
+}
+
+void ItemManager::markCleared() {
+    for (const auto& [tag, _] : items) markRemoved(tag);
+    if (mapped_) {
+        // Items not read yet are only in the mapped store, but they go too.
+        std::vector<std::string> mappedOnly;
+        mapped_->forEach([&](const MappedRecord& record) {
+            std::string tag(record.tag);
+            if (items.find(tag) == items.end()) mappedOnly.push_back(std::move(tag));
+        });
+        for (const auto& tag : mappedOnly) markRemoved(tag);
+    }
+}
+
+void ItemManager::markReplaced(const std::vector<std::string>& changed) {
+    // The history lists are already right for the state now in `items`: keep these marks out of them.
+    std::vector<std::string> newest;
+    if (!undoHistory.empty()) newest = std::move(undoHistory.back().changed);
+
+    std::unordered_set<std::string_view> seen;
+    for (const auto& tag : changed) {
+        if (!seen.insert(tag).second) continue;
+        if (items.find(tag) != items.end()) {
+            markChanged(tag);
+        } else {
+            markRemoved(tag);
+        }
+    }
+
+    if (!undoHistory.empty()) undoHistory.back().changed = std::move(newest);
+}
+
+ItemManager::Snapshot ItemManager::snapshotLocked() const {
+    if (!snapshot_) {
+        snapshot_ = std::make_shared<State>(items);
+        // Items not read yet from a mapped store are decoded for the view only.
+        if (mapped_) {
+            mapped_->forEach([&](const MappedRecord& record) {
+                std::string tag(record.tag);
+                if (items.find(tag) != items.end()) return;
+                if (auto item = decodeMapped(record)) snapshot_->emplace(std::move(tag), std::move(item));
+            });
+        }
+        snapshotStale_.clear();
+        return snapshot_;
+    }
+    if (snapshotStale_.empty()) return snapshot_;
+
+    if (snapshot_.use_count() == 1) {
+        refreshView(*snapshot_, snapshotStale_);
+        if (spare_) spareStale_.insert(snapshotStale_.begin(), snapshotStale_.end());
+    } else if (spare_ && spare_.use_count() == 1) {
+        // An exporter still reads the current view, but no one reads the one before it: bring
+        // that one up to date and publish it.
+        refreshView(*spare_, spareStale_);
+        refreshView(*spare_, snapshotStale_);
+        std::swap(snapshot_, spare_);
+        spareStale_ = std::move(snapshotStale_);
+    } else {
+        // Both views are still read: start from a copy of the pointers.
+        spare_ = snapshot_;
+        spareStale_ = snapshotStale_;
+        snapshot_ = std::make_shared<State>(*snapshot_);
+        refreshView(*snapshot_, snapshotStale_);
+    }
+    snapshotStale_.clear();
+    return snapshot_;
+}
+
+void ItemManager::refreshView(State& view, const std::unordered_set<std::string>& tags) const {
+    for (const auto& tag : tags) {
+        auto it = items.find(tag);
+        std::optional<MappedRecord> record;
+        std::shared_ptr<BaseItem> decoded;
+        if (it != items.end()) {
+            view[tag] = it->second;
+        } else if (mapped_ && (record = mapped_->find(tag)) && (decoded = decodeMapped(*record))) {
+            view[tag] = std::move(decoded);
+        } else {
+            view.erase(tag);
+        }
     }
+}
+
+ItemManager::Snapshot ItemManager::snapshot() const {
+    const ScopedOperation timed(activeMetrics(), MetricOp::Snapshot);
+    return takeSnapshot();
+}
+
+ItemManager::Snapshot ItemManager::takeSnapshot() const {
+    std::lock_guard<MeteredMutex> lock(mutex_);
+    return snapshotLocked();
+}
+
+void ItemManager::detachFromSnapshot(State::iterator it) {
+    if (!snapshot_) return;
+    auto shared = snapshot_->find(it->first);
+    if (shared == snapshot_->end() || shared->second != it->second) return;
+
+    auto copy = it->second->cloneForWrite();
+    auto idIt = idMap.find(it->second->getId());
+    if (idIt != idMap.end() && idIt->second == it->second) idIt->second = copy;
+    it->second = std::move(copy);
+}
+
+template<typename T>
+std::shared_ptr<BaseItem> ItemManager::makeItem(const json& j, const ItemResource& resource) {
+    ItemAllocator<ItemWrapper<T>> alloc(resource);
     // Only call deserialization for supported types
-    std::shared_ptr<ItemWrapper<T>> item;
     if constexpr (has_from_json<T>::value) {
-        item = std::make_shared<ItemWrapper<T>>(j);
+        return std::allocate_shared<ItemWrapper<T>>(alloc, j, resource);
     } else if constexpr (std::is_arithmetic_v<T> || std::is_same_v<T, std::string>) {
-        item = std::make_shared<ItemWrapper<T>>(j);
+        return std::allocate_shared<ItemWrapper<T>>(alloc, j, resource);
     } else {
         // fallback: construct with default data only
-        item = std::make_shared<ItemWrapper<T>>(std::make_shared<T>(), j.value("tag", ""));
+        return std::allocate_shared<ItemWrapper<T>>(alloc, std::allocate_shared<T>(ItemAllocator<T>(resource)),
+                                                    j.value("tag", ""), resource);
     }
-    idMap[id] = item;
-    // Recursively deserialize children, using idMap
-    return item;
 }
 
 template<typename T>
-void ItemManager::registerType() {
-    std::string typeName = getCompilerTypeName<T>();
+std::shared_ptr<BaseItem> ItemManager::deserializeItemById(const json& j) {
+    // One probe of idMap: the slot is either the existing item or filled with the new one.
+    auto [slot, inserted] = idMap.try_emplace(j.at("id").get<std::string>());
+    if (!inserted) {
+        return slot->second;
+    }
+    try {
+        slot->second = makeItem<T>(j, itemResource_);
+    } catch (...) {
+        idMap.erase(slot);
+        throw;
+    }
+    return slot->second;
+}
+
+template<typename Buffer>
+void ItemManager::appendBinaryRecord(Buffer& buffer, const std::string& type, const std::string& tag, const std::string& payload) {
+    auto append = [&buffer](const void* data, size_t size) {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        buffer.insert(buffer.end(), bytes, bytes + size);
+    };
+
+    uint32_t typeSize = static_cast<uint32_t>(type.size());
+    uint32_t tagSize  = static_cast<uint32_t>(tag.size());
+    uint32_t dataSize = static_cast<uint32_t>(payload.size());
+
+    append(&typeSize, sizeof(typeSize));
+    append(type.data(), typeSize);
+    append(&tagSize, sizeof(tagSize));
+    append(tag.data(), tagSize);
+    append(&dataSize, sizeof(dataSize));
+    append(payload.data(), dataSize);
+}
+
+std::string ItemManager::encodeWalPayload(const BaseItem& item) {
+    std::string payload;
+    if (auto* lazy = dynamic_cast<const LazyItem*>(&item)) {
+        json::to_msgpack(lazy->rawJson(), payload);   // recovery migrates it by its "version"
+    } else {
+        json::to_msgpack(item.serialize(), payload);
+    }
+    return payload;
+}
 
-    if (deserializers.find(typeName) == deserializers.end()) {
-        // Use a lambda that calls deserializeItemById<T>
-        deserializers[typeName] = [this](const json& j, const std::string&) {
-            return this->deserializeItemById<T>(j);
+uint64_t ItemManager::appendWalRecords(const std::vector<std::string>& tags) {
+    if (!wal_) return 0;
+    uint64_t seq = 0;
+    std::unordered_set<std::string_view> logged;
+    auto log = [&](const std::string& tag) {
+        if (!logged.insert(tag).second) return;
+        auto it = items.find(tag);
+        seq = it != items.end()
+            ? wal_->append(WalOp::Modify, tag, it->second->getTypeName(), encodeWalPayload(*it->second))
+            : wal_->append(WalOp::Remove, tag, {}, {});
+    };
+    for (const auto& tag : walDirty_) log(tag);
+    for (const auto& tag : tags) log(tag);
+    walDirty_.clear();
+    return seq;
+}
+
+void ItemManager::writeMapped(const std::string& tag) {
+    auto it = items.find(tag);
+    if (it == items.end()) return;
+
+    try {
+        // Scalar payloads are stored as raw bytes so getItem can read them without decoding.
+        json j = it->second->serialize();
+        const json* data = j.is_object() && j.contains("data") ? &j.at("data") : nullptr;
+        MappedEncoding encoding = MappedEncoding::MsgPack;
+        std::string payload;
+        auto raw = [&payload](const auto& value) {
+            payload.assign(reinterpret_cast<const char*>(&value), sizeof(value));
         };
 
-        registeredTypes.emplace(typeName, std::type_index(typeid(T)));
+        if (data && data->is_number_integer() && !data->is_number_unsigned()) {
+            encoding = MappedEncoding::Int;
+            raw(data->get<int64_t>());
+        } else if (data && data->is_number_unsigned()) {
+            encoding = MappedEncoding::UInt;
+            raw(data->get<uint64_t>());
+        } else if (data && data->is_number_float()) {
+            encoding = MappedEncoding::Float;
+            raw(data->get<double>());
+        } else if (data && data->is_boolean()) {
+            encoding = MappedEncoding::Bool;
+            raw(static_cast<uint8_t>(data->get<bool>()));
+        } else if (data && data->is_string()) {
+            encoding = MappedEncoding::String;
+            payload = data->get<std::string>();
+        } else {
+            json::to_msgpack(j, payload);
+        }
+
+        mapped_->put(tag, it->second->getTypeName(), it->second->getId(), encoding, payload);
+    } catch (const std::exception& e) {
+        LOG_CONTEXT(LogLevel::ERR, "Cannot write item with tag '" + tag + "' to the mapped store: " + e.what(), {});
+    }
+}
+
+void ItemManager::appendSegment(const std::string& tag) {
+    auto it = items.find(tag);
+    if (it == items.end()) return;
+    try {
+        segmentLog_->put(tag, it->second->getTypeName(), encodeWalPayload(*it->second));
+    } catch (const std::exception& e) {
+        LOG_CONTEXT(LogLevel::ERR, "Cannot append item with tag '" + tag + "' to the segment log: " + e.what(), {});
+    }
+}
+
+void ItemManager::flushSegmentDirty() {
+    for (const auto& tag : segmentDirty_) appendSegment(tag);
+    segmentDirty_.clear();
+}
+
+void ItemManager::flushMappedDirty() {
+    for (const auto& tag : mappedDirty_) writeMapped(tag);
+    mappedDirty_.clear();
+}
+
+json ItemManager::mappedToJson(const MappedRecord& record) {
+    if (record.encoding == MappedEncoding::MsgPack) return json::from_msgpack(record.payload);
+
+    json j;
+    j["id"] = std::string(record.id);
+    j["tag"] = std::string(record.tag);
+    j["type"] = std::string(record.type);
+    switch (record.encoding) {
+        case MappedEncoding::Int:    j["data"] = *readMappedScalar<int64_t>(record); break;
+        case MappedEncoding::UInt:   j["data"] = *readMappedScalar<uint64_t>(record); break;
+        case MappedEncoding::Float:  j["data"] = *readMappedScalar<double>(record); break;
+        case MappedEncoding::Bool:   j["data"] = *readMappedScalar<bool>(record); break;
+        default:                     j["data"] = std::string(record.payload); break;
+    }
+    return j;
+}
+
+std::shared_ptr<BaseItem> ItemManager::decodeMapped(const MappedRecord& record) const {
+    const TypeSlot* slot = typeSlot(typeIdOf(std::string(record.type)));
+    if (!slot) {
+        LOG_CONTEXT(LogLevel::WARNING, "Type " + demangleType(std::string(record.type)) + " of mapped item '"
+                                         + std::string(record.tag) + "' is not registered; item skipped.", {});
+        return nullptr;
+    }
+    try {
+        return slot->factory(mappedToJson(record), itemResource_);
+    } catch (const std::exception& e) {
+        LOG_CONTEXT(LogLevel::WARNING, "Cannot decode mapped item '" + std::string(record.tag) + "': " + e.what(), {});
+        return nullptr;
+    }
+}
+
+template<typename T>
+std::optional<T> ItemManager::readMappedScalar(const MappedRecord& record) {
+    auto raw = [&record](auto value) {
+        std::memcpy(&value, record.payload.data(), std::min(sizeof(value), record.payload.size()));
+        return value;
+    };
+
+    if constexpr (std::is_same_v<T, bool>) {
+        if (record.encoding == MappedEncoding::Bool) return raw(uint8_t{0}) != 0;
+    } else if constexpr (std::is_arithmetic_v<T>) {
+        switch (record.encoding) {
+            case MappedEncoding::Int:   return static_cast<T>(raw(int64_t{0}));
+            case MappedEncoding::UInt:  return static_cast<T>(raw(uint64_t{0}));
+            case MappedEncoding::Float: return static_cast<T>(raw(double{0}));
+            default: break;
+        }
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        if (record.encoding == MappedEncoding::String) return std::string(record.payload);
+    }
+    return std::nullopt;
+}
+
+std::shared_ptr<BaseItem> ItemManager::makeLazyItem(const TypeSlot& slot, const ItemResource& resource, const std::string& tag,
+                                                    const std::string& typeName, std::string raw, std::string id, int version) {
+    // Migration runs with the record's own version at decode time. Decoding may happen without
+    // mutex_ (an exporter serializing a snapshot), so it is serialized on its own lock.
+    // It shares what it needs instead of capturing `this`, since it may run after the manager is gone.
+    LazyItem::Decoder decoder = [registry = migrationRegistry, decodeMutex = lazyDecodeMutex_, typeName,
+                                 make = slot.factory, resource](json& j) {
+        std::lock_guard<std::mutex> lock(*decodeMutex);
+        int version = j.value("version", 1);
+        registry->upgradeInPlace(typeName, version, j);
+        return make(j, resource);
+    };
+    return std::make_shared<LazyItem>(tag, typeName, std::make_shared<const std::string>(std::move(raw)),
+                                      std::move(decoder), std::move(id), version);
+}
 
-        if constexpr (has_schema<T>::value) {
-            schemaRegistry[typeName] = []() { return T::schema(); };
-            std::cout << Logger::getColorCode(LogColor::WHITE) + "::: Registered schema for type: " << typeName << Logger::getColorCode(LogColor::RESET) <<"\n";
+ItemManager::ImportSettings ItemManager::importSettings() const {
+    std::lock_guard<MeteredMutex> lock(mutex_);
+    return {lazyImport_, deferMigration_, itemResource_};
+}
+
+size_t ItemManager::applyImport(std::vector<ImportedItem>& imported, std::vector<std::pair<std::string, json>> schemas, ImportApply mode) {
+    std::unique_lock<MeteredMutex> lock(mutex_);
+    ++importGeneration_;
+    if (mode != ImportApply::Merge) {
+        undoHistory.push_back({cloneCurrentState(), {}});
+        redoQueue = {};
+        saveState();
+    }
+    if (mode == ImportApply::Replace) {
+        markCleared();
+        items.clear();
+    }
+    for (auto& [typeName, schema] : schemas) {
+        schemaRegistry[typeIdOf(typeName)] = [schema = std::move(schema)]() { return schema; };
+    }
+    for (auto& entry : imported) {
+        if (!entry.lazy) {
+            auto [slot, inserted] = idMap.try_emplace(entry.item->getId(), entry.item);
+            if (!inserted) entry.item = slot->second;
         }
+        items[entry.tag] = entry.item;
+        markChanged(entry.tag);
+    }
+
+    // With undo state, the newest history entry lists every tag cleared or imported.
+    std::shared_ptr<WriteAheadLog> wal = wal_;
+    uint64_t walSeq = 0;
+    if (wal && mode != ImportApply::Merge) {
+        walSeq = appendWalRecords(undoHistory.back().changed);
+    } else if (wal) {
+        std::vector<std::string> tags;
+        tags.reserve(imported.size());
+        for (const auto& entry : imported) tags.push_back(entry.tag);
+        walSeq = appendWalRecords(tags);
+    }
+    const size_t count = items.size();
+
+    lock.unlock();
+    if (walSeq) wal->commit(walSeq);
+    return count;
+}
+
+std::shared_ptr<BaseItem> ItemManager::installSingle(const TypeSlot& slot, const std::string& tag, const json& j,
+                                                    std::vector<std::pair<std::string, json>> schemas) {
+    auto item = slot.factory(j, importSettings().resource);
+    if (!item) return nullptr;
+    std::vector<ImportedItem> imported{{tag, std::move(item)}};
+    applyImport(imported, std::move(schemas), ImportApply::Insert);
+    return imported.front().item;
+}
+
+ItemManager::State::iterator ItemManager::materialize(State::iterator it) {
+    auto* lazy = it == items.end() ? nullptr : dynamic_cast<LazyItem*>(it->second.get());
+    if (!lazy) return it;
+
+    std::shared_ptr<BaseItem> decoded;
+    try {
+        decoded = lazy->materialize();
+    } catch (const std::exception& e) {
+        LOG_CONTEXT(LogLevel::ERR, "Lazy decode of '" + it->first + "' failed: " + e.what(), {});
+        return items.end();
+    }
+    // A snapshot may still hold the placeholder and read the decoded item through it; writers
+    // then get their own copy. Same content as before either way, so no change is recorded.
+    if (it->second.use_count() > 1) decoded = decoded->cloneForWrite();
+    idMap[decoded->getId()] = decoded;
+    it->second = std::move(decoded);
+    return it;
+}
+
+ItemManager::State::iterator ItemManager::findOrLoad(const std::string& tag) {
+    auto it = items.find(tag);
+    if (it != items.end()) return materialize(it);
+    if (!mapped_) return it;
 
-        std::cout << Logger::getColorCode(LogColor::MAGENTA) + "\n:::| Automatically registered type (without adding item): " << demangleType(typeName) << Logger::getColorCode(LogColor::RESET) + "\n";
+    auto record = mapped_->find(tag);
+    if (!record) return it;
+    auto item = decodeMapped(*record);
+    if (!item) return items.end();
+
+    // Same content as the file: no change is recorded.
+    idMap[item->getId()] = item;
+    return items.emplace(tag, std::move(item)).first;
+}
+
+template<typename T>
+void ItemManager::registerType() {
+    const uint32_t index = TypeIds::indexOf<T>();
+    if (index < typeTable_.size() && typeTable_[index].registered()) return;
+
+    constexpr TypeId id = TypeIds::of<T>();
+    if (index >= typeTable_.size()) typeTable_.resize(index + 1);
+    TypeSlot& slot = typeTable_[index];
+    slot.id = id;
+    typeSlots_[id] = index;
+
+    const std::string& typeName = getCompilerTypeName<T>();
+    typeIds_[typeName] = id;
+    {
+        std::lock_guard<std::mutex> lock(demangleMutex_);
+        demangled_.emplace(typeName, std::string(TypeIds::nameOf<T>()));
+    }
+
+    slot.deserialize = &ItemManager::deserializeItemById<T>;
+    slot.factory = &ItemManager::makeItem<T>;
+
+    registeredTypes.emplace(id, std::type_index(typeid(T)));
+
+    if constexpr (has_schema<T>::value) {
+        schemaRegistry[id] = []() { return T::schema(); };
+        std::cout << Logger::getColorCode(LogColor::WHITE) + "::: Registered schema for type: " << typeName << Logger::getColorCode(LogColor::RESET) <<"\n";
+    }
+
+    // Migrations are keyed by the name records carry, which is what importers look them up by.
+    if (auto declared = TypeRegistration::find(id)) {
+        declared->installMigrations(*migrationRegistry);
     }
+
+    std::cout << Logger::getColorCode(LogColor::MAGENTA) + "\n:::| Automatically registered type (without adding item): " << demangleType(typeName) << Logger::getColorCode(LogColor::RESET) + "\n";
+}
+
+template<typename T, int LatestVersion, typename... Migrations>
+bool ItemManager::declareType(Migrations... migrations) {
+    return TypeRegistration::add({TypeIds::of<T>(), getCompilerTypeName<T>(),
+                                  [](ItemManager& manager) { manager.registerType<T>(); },
+                                  LatestVersion, {MigrationRegistry::toStep(std::move(migrations))...}});
 }
 
 json ItemManager::getSchemaForType(std::string type) const {
-    auto it = schemaRegistry.find(type);
+    auto it = schemaRegistry.find(typeIdOf(type));
     return (it != schemaRegistry.end()) ? it->second() : json{};
 }
 
@@ -100,24 +600,35 @@ json ItemManager::getSchemaForType(std::string type) const {
 // ::::: MAIN API USER CALLS OR PUBLIC FUNCTIONS ::::::
 // ****************************************************
 
+ItemManager::ItemManager() {
+    for (const auto& declared : TypeRegistration::all()) {
+        declared.install(*this);
+    }
+}
+
 void ItemManager::showSignature() {
     Author::getSignature();
 }
 
 void ItemManager::displayRegisteredDeserializers() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<MeteredMutex> lock(mutex_);
     
     std::cout << Logger::getColorCode(LogColor::MAGENTA) << "\n:::| Registered Deserializers in ItemManager |:::\n" << Logger::getColorCode(LogColor::RESET);
     
-    if (deserializers.empty()) {
+    bool any = false;
+    for (size_t index = 0; index < typeTable_.size(); ++index) {
+        const TypeSlot& slot = typeTable_[index];
+        if (!slot.registered()) continue;
+        any = true;
+        auto type = registeredTypes.find(slot.id);
+        const std::string name = type != registeredTypes.end() ? demangleType(type->second.name()) : std::to_string(slot.id);
+        LOG_CONTEXT(LogLevel::DEBUG, "Type: " + name + " -> Deserialization Function Exists (slot " + std::to_string(index) + ")", {});
+    }
+    if (!any) {
         LOG_CONTEXT(LogLevel::INFO, "No deserializers registered", {});
         return;
     }
 
-    for (const auto& entry : deserializers) {
-        LOG_CONTEXT(LogLevel::DEBUG, "Type: " + demangleType(entry.first) + " -> Deserialization Function Exists", {});
-    }
-
     std::cout << "\n::::::::::::::::::::::::::::::::::::::::::::::::\n";
 
     std::cout << Logger::getColorCode(LogColor::MAGENTA) << "\n:::| Registered types in ItemManager |:::\n" << Logger::getColorCode(LogColor::RESET);
@@ -126,18 +637,19 @@ void ItemManager::displayRegisteredDeserializers() {
         return;
     }
     for (const auto& entry : registeredTypes) {
-        LOG_CONTEXT(LogLevel::DEBUG, "Type: " + demangleType(entry.first) + " -> Type Index: " + demangleType(entry.second.name()), {});
+        LOG_CONTEXT(LogLevel::DEBUG, "Type: " + demangleType(entry.second.name()) + " -> Type Id: " + std::to_string(entry.first), {});
     }
     std::cout << "\n::::::::::::::::::::::::::::::::::::::::::::::::\n";
 }
 
 bool ItemManager::hasItem(const std::string& tag) const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    const ScopedOperation timed(activeMetrics(), MetricOp::HasItem);
+    std::lock_guard<MeteredMutex> lock(mutex_);
     if (tag.empty()) {
         LOG_CONTEXT(LogLevel::WARNING, "Empty tag provided for hasItem check", false);
         return false;
     }
-    if(items.find(tag) != items.end()){
+    if(items.find(tag) != items.end() || (mapped_ && mapped_->contains(tag))){
         LOG_CONTEXT(LogLevel::DEBUG, "Item with tag '" + tag + "' exists in ItemManager", true);
         return true;
     } else {
@@ -147,6 +659,10 @@ bool ItemManager::hasItem(const std::string& tag) const {
 }
 
 std::string ItemManager::demangleType(const std::string& mangledName) const{
+    std::lock_guard<std::mutex> lock(demangleMutex_);
+    auto cached = demangled_.find(mangledName);
+    if (cached != demangled_.end()) return cached->second;
+
     #if defined(__GNUC__) || defined(__clang__)
     int status;
     char* demangled = abi::__cxa_demangle(mangledName.c_str(), nullptr, nullptr, &status);
@@ -160,6 +676,7 @@ std::string ItemManager::demangleType(const std::string& mangledName) const{
         result = mangledName.c_str();
     }
 
+    demangled_.emplace(mangledName, result);
     return result;
     #elif defined(_MSC_VER)
         return mangledName.c_str();
@@ -170,7 +687,8 @@ std::string ItemManager::demangleType(const std::string& mangledName) const{
 
 template<typename T>
 void ItemManager::addItem(std::shared_ptr<T> obj, const std::string& tag) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    const ScopedOperation timed(activeMetrics(), MetricOp::AddItem);
+    std::unique_lock<MeteredMutex> lock(mutex_);
 
     if (tag.empty()) {
         std::string errorMsg = "Tag cannot be empty for item of type: " + demangleType(typeid(T).name());
@@ -183,15 +701,78 @@ void ItemManager::addItem(std::shared_ptr<T> obj, const std::string& tag) {
     }
 
     // Check if an item with the same tag already exists
-    if (items.find(tag) != items.end()) {
+    if (items.find(tag) != items.end() || (mapped_ && mapped_->contains(tag))) {
         std::string errorMsg = "Item with tag '" + tag + "' already exists. Cannot add another item of type: " + demangleType(typeid(T).name());
         LOG_CONTEXT(LogLevel::ERR, errorMsg, std::make_exception_ptr(std::runtime_error(errorMsg)));
     }
 
-    std::cout <<Logger::getColorCode(LogColor::GREEN) + "\nAn item added with tag: " << tag << Logger::getColorCode(LogColor::RESET) << std::endl;
+    storeItem<T>(lock, tag, std::allocate_shared<ItemWrapper<T>>(ItemAllocator<ItemWrapper<T>>(itemResource_),
+                                                                 std::move(obj), tag, itemResource_), WalOp::Add);
+}
+
+template<typename T, typename... Args>
+void ItemManager::emplaceItem(const std::string& tag, Args&&... args) {
+    const ScopedOperation timed(activeMetrics(), MetricOp::EmplaceItem);
+    std::unique_lock<MeteredMutex> lock(mutex_);
+
+    if (tag.empty()) {
+        std::string errorMsg = "Tag cannot be empty for item of type: " + demangleType(typeid(T).name());
+        LOG_CONTEXT(LogLevel::ERR, "", std::make_exception_ptr(std::runtime_error(errorMsg)));
+    }
+
+    if (items.find(tag) != items.end() || (mapped_ && mapped_->contains(tag))) {
+        std::string errorMsg = "Item with tag '" + tag + "' already exists. Cannot emplace another item of type: " + demangleType(typeid(T).name());
+        LOG_CONTEXT(LogLevel::ERR, errorMsg, std::make_exception_ptr(std::runtime_error(errorMsg)));
+    }
+
+    storeItem<T>(lock, tag, makeInlineItem<T>(tag, std::forward<Args>(args)...), WalOp::Add);
+}
+
+template<typename T, typename... Args>
+bool ItemManager::tryEmplace(const std::string& tag, Args&&... args) {
+    const ScopedOperation timed(activeMetrics(), MetricOp::TryEmplace);
+    std::unique_lock<MeteredMutex> lock(mutex_);
+
+    if (tag.empty()) {
+        LOG_CONTEXT(LogLevel::WARNING, "Tag cannot be empty for item of type: " + demangleType(typeid(T).name()), false);
+        return false;
+    }
+    if (items.find(tag) != items.end() || (mapped_ && mapped_->contains(tag))) {
+        LOG_CONTEXT(LogLevel::DEBUG, "Item with tag '" + tag + "' already exists; tryEmplace left it unchanged.", {});
+        return false;
+    }
+
+    storeItem<T>(lock, tag, makeInlineItem<T>(tag, std::forward<Args>(args)...), WalOp::Add);
+    return true;
+}
+
+template<typename T, typename... Args>
+bool ItemManager::insertOrAssign(const std::string& tag, Args&&... args) {
+    const ScopedOperation timed(activeMetrics(), MetricOp::InsertOrAssign);
+    std::unique_lock<MeteredMutex> lock(mutex_);
+
+    if (tag.empty()) {
+        LOG_CONTEXT(LogLevel::WARNING, "Tag cannot be empty for item of type: " + demangleType(typeid(T).name()), false);
+        return false;
+    }
+    const bool exists = items.find(tag) != items.end() || (mapped_ && mapped_->contains(tag));
+
+    storeItem<T>(lock, tag, makeInlineItem<T>(tag, std::forward<Args>(args)...), exists ? WalOp::Modify : WalOp::Add);
+    return !exists;
+}
+
+template<typename T, typename... Args>
+std::shared_ptr<BaseItem> ItemManager::makeInlineItem(const std::string& tag, Args&&... args) const {
+    return std::allocate_shared<InlineItemWrapper<T>>(ItemAllocator<InlineItemWrapper<T>>(itemResource_),
+                                                      tag, itemResource_, std::forward<Args>(args)...);
+}
+
+template<typename T>
+void ItemManager::storeItem(std::unique_lock<MeteredMutex>& lock, const std::string& tag, std::shared_ptr<BaseItem> item, WalOp op) {
+    std::cout << Logger::getColorCode(LogColor::GREEN) << "\nAn item added with tag: " << tag << Logger::getColorCode(LogColor::RESET) << std::endl;
 
     saveState();
-    undoHistory.push_back(cloneCurrentState());
+    undoHistory.push_back({cloneCurrentState(), {}});
     redoQueue = {};
 
 #if defined(__cpp_concepts) && __cpp_concepts >= 201907L
@@ -200,41 +781,47 @@ void ItemManager::addItem(std::shared_ptr<T> obj, const std::string& tag) {
     std::cout << "Using SFINAE-based Registration (C++17 or older).\n";
 #endif
 
-    // Automatic Type Registration
-    migrationRegistry.registerVersion("User", 3);
-    migrationRegistry.registerMigration("User", 1, [](const json& j) {
-        json upgraded = j;
-        upgraded["age"] = 0;
-        return upgraded;
-    });
-    migrationRegistry.registerMigration("User", 2, [](const json& j) {
-        json upgraded = j;
-        upgraded["email"] = "unknown@example.com";
-        return upgraded;
-    });
-    registerType<T>();  // Ensures type is registered separately for imports
+    registerType<T>();  // A no-op once T is installed (at construction, if it was declared)
 
-    items[tag] = std::make_shared<ItemWrapper<T>>(std::move(obj), tag);
+    auto& stored = items[tag];
+    stored = std::move(item);
+    markChanged(tag);
 
-    for (const auto& [key, value] : items) {
-        LOG_CONTEXT(LogLevel::DEBUG, "Item with tag '" + key + "' registered with type: " + demangleType(value->getTypeName()), {});
-    }
+    std::shared_ptr<WriteAheadLog> wal = wal_;
+    if (!walDirty_.empty()) appendWalRecords({});
+    uint64_t walSeq = wal ? wal->append(op, tag, getCompilerTypeName<T>(), encodeWalPayload(*stored)) : 0;
 
     LOG_CONTEXT(LogLevel::INFO, "Item with tag '" + tag + "' added successfully. Type: " + demangleType(getCompilerTypeName<T>()), {});
+
+    lock.unlock();
+    if (wal) wal->commit(walSeq);
 }
 
 template<typename T>
 bool ItemManager::modifyItem(const std::string& tag, const std::function<void(T&)>& modifier) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    const ScopedOperation timed(activeMetrics(), MetricOp::ModifyItem);
+    std::unique_lock<MeteredMutex> lock(mutex_);
     
-    auto it = items.find(tag);
+    if (mapped_) registerType<T>();  // so an item still only in the mapped store can be decoded
+    auto it = findOrLoad(tag);
     if (it != items.end()) {
         auto wrapper = dynamic_cast<ItemWrapper<T>*>(it->second.get());
         if (wrapper) {
-            undoHistory.push_back(cloneCurrentState());
+            undoHistory.push_back({cloneCurrentState(), {}});
             redoQueue = {};
+            detachFromSnapshot(it);
+            wrapper = static_cast<ItemWrapper<T>*>(it->second.get());
             modifier(wrapper->getMutableData());
+            markChanged(tag);
+
+            std::shared_ptr<WriteAheadLog> wal = wal_;
+            if (!walDirty_.empty()) appendWalRecords({});
+            uint64_t walSeq = wal ? wal->append(WalOp::Modify, tag, wrapper->getTypeName(), encodeWalPayload(*wrapper)) : 0;
+
             LOG_CONTEXT(LogLevel::DEBUG, "Modified item with tag '" + tag + "' of type: " + demangleType(typeid(T).name()), {});
+
+            lock.unlock();
+            if (wal) wal->commit(walSeq);
             return true;
         }
     }
@@ -246,9 +833,27 @@ bool ItemManager::modifyItem(const std::string& tag, const std::function<void(T&
 
 template<typename T>
 std::optional<T> ItemManager::getItem(const std::string& tag) const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    const ScopedOperation timed(activeMetrics(), MetricOp::GetItem);
+    std::lock_guard<MeteredMutex> lock(mutex_);
     
-    auto it = items.find(tag);
+    auto* self = const_cast<ItemManager*>(this);   // decoding a lazy import fills a cache, not a change
+    auto it = self->items.find(tag);
+    if (it != items.end()) {
+        it = self->materialize(it);
+        if (it == items.end()) return std::nullopt;
+    } else if (mapped_) {
+        if (auto record = mapped_->find(tag); record && record->type == getCompilerTypeName<T>()) {
+            // Scalars are read straight from the mapping; anything else is decoded once and kept.
+            if (auto value = readMappedScalar<T>(*record)) return value;
+            auto item = makeItem<T>(mappedToJson(*record), itemResource_);
+            self->idMap[item->getId()] = item;
+            it = self->items.emplace(tag, std::move(item)).first;
+        } else if (record) {
+            LOG_CONTEXT(LogLevel::WARNING, "", std::make_exception_ptr(std::runtime_error(
+                    "Type mismatch for item with tag '" + tag + "'. Requested type: " + demangleType(typeid(T).name()) +
+                                                              ", Actual type: " + demangleType(std::string(record->type)))));
+        }
+    }
     if (it != items.end()) {
         auto wrapper = dynamic_cast<ItemWrapper<T>*>(it->second.get());
         if (wrapper) {
@@ -266,13 +871,19 @@ std::optional<T> ItemManager::getItem(const std::string& tag) const {
 
 template<typename T>
 T& ItemManager::getItemRaw(const std::string& tag) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    const ScopedOperation timed(activeMetrics(), MetricOp::GetItemRaw);
+    std::lock_guard<MeteredMutex> lock(mutex_);
 
-    auto it = items.find(tag);
+    if (mapped_) registerType<T>();
+    auto it = findOrLoad(tag);
     if (it != items.end()) {
         auto wrapper = dynamic_cast<ItemWrapper<T>*>(it->second.get());
         if (wrapper) {
-            return wrapper->getMutableData();
+            detachFromSnapshot(it);
+            markChanged(tag, true);  // the caller may write through the reference
+            if (mapped_) mappedDirty_.insert(tag);
+            if (wal_) walDirty_.insert(tag);
+            return static_cast<ItemWrapper<T>*>(it->second.get())->getMutableData();
         } else {
             LOG_CONTEXT(LogLevel::WARNING, "Type mismatch for item with tag '" + tag + "'. Requested type: "
                       + demangleType(typeid(T).name()) + ", Actual type: " + demangleType(it->second->getTypeName()), {});
@@ -286,9 +897,11 @@ T& ItemManager::getItemRaw(const std::string& tag) {
 
 template<typename T>
 const T& ItemManager::getItemRaw(const std::string& tag) const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    const ScopedOperation timed(activeMetrics(), MetricOp::GetItemRaw);
+    std::lock_guard<MeteredMutex> lock(mutex_);
 
-    auto it = items.find(tag);
+    // Decoding an item still only in the mapped store fills a cache; it is not a change.
+    auto it = const_cast<ItemManager*>(this)->findOrLoad(tag);
     if (it != items.end()) {
         auto wrapper = dynamic_cast<const ItemWrapper<T>*>(it->second.get());
         if (wrapper) {
@@ -305,7 +918,7 @@ const T& ItemManager::getItemRaw(const std::string& tag) const {
 }
 
 void ItemManager::displayAll() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<MeteredMutex> lock(mutex_);
 
     LOG_CONTEXT(LogLevel::DISPLAY, ":::::: Types Stored ::::::", {});
     if (!items.empty()) {
@@ -316,9 +929,9 @@ void ItemManager::displayAll() const {
 }
 
 void ItemManager::displayByTag(const std::string& tag) const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<MeteredMutex> lock(mutex_);
 
-    auto it = items.find(tag);
+    auto it = const_cast<ItemManager*>(this)->findOrLoad(tag);
     if (it != items.end()) {
         LOG_CONTEXT(LogLevel::DISPLAY, "Displaying item with tag '" + tag + "'", {});
         it->second->display();
@@ -329,15 +942,16 @@ void ItemManager::displayByTag(const std::string& tag) const {
 }
 
 void ItemManager::removeByTag(const std::string& tag) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    const ScopedOperation timed(activeMetrics(), MetricOp::RemoveByTag);
+    std::unique_lock<MeteredMutex> lock(mutex_);
 
     if (tag.empty()) {
         LOG_CONTEXT(LogLevel::WARNING, "Cannot remove item with empty tag.", ErrorCode::ITEM_NOT_FOUND);
     }
 
-    auto it = items.find(tag);
+    auto it = findOrLoad(tag);  // an item only in the mapped store is loaded so undo can restore it
     if (it != items.end()) {
-        undoHistory.push_back(cloneCurrentState());
+        undoHistory.push_back({cloneCurrentState(), {}});
 
         std::queue<State> empty;
         std::swap(redoQueue, empty);
@@ -345,18 +959,30 @@ void ItemManager::removeByTag(const std::string& tag) {
         std::string typeName = it->second->getTypeName();
         std::string id = it->second->getId(); // Extract ID before erasing
 
-        if (--typeUsage[typeName] == 0) {
-            typeUsage.erase(typeName);
-            registeredTypes.erase(typeName);
-            deserializers.erase(typeName);
-            schemaRegistry.erase(typeName);  //  Clean up schema too
+        const TypeId typeId = typeIdOf(typeName);
+        if (--typeUsage[typeId] == 0) {
+            typeUsage.erase(typeId);
+            registeredTypes.erase(typeId);
+            if (auto slot = typeSlots_.find(typeId); slot != typeSlots_.end()) {
+                typeTable_[slot->second] = TypeSlot{typeId};   // keeps its index for re-registration
+            }
+            schemaRegistry.erase(typeId);  //  Clean up schema too
+            typeIds_.erase(typeName);
             LOG_CONTEXT(LogLevel::DEBUG, "Removed type: " + demangleType(typeName) + " from registry", {});
         }
 
         items.erase(it);
         idMap.erase(id); // Now erase from idMap as well
+        markRemoved(tag);
+
+        std::shared_ptr<WriteAheadLog> wal = wal_;
+        if (!walDirty_.empty()) appendWalRecords({});
+        uint64_t walSeq = wal ? wal->append(WalOp::Remove, tag, typeName, {}) : 0;
 
         LOG_CONTEXT(LogLevel::DEBUG, "Removed item with tag '" + tag + "' and id '" + id + "'", {});
+
+        lock.unlock();
+        if (wal) wal->commit(walSeq);
     } else {
         LOG_CONTEXT(LogLevel::WARNING, "No item found with tag '" + tag + "' to be removed. -Code: "
                                                          + std::to_string(ErrorCode::ITEM_NOT_FOUND), {});
@@ -364,37 +990,58 @@ void ItemManager::removeByTag(const std::string& tag) {
 }
 
 void ItemManager::undo() {
-    std::lock_guard<std::mutex> lock(mutex_);  // Thread guard
+    const ScopedOperation timed(activeMetrics(), MetricOp::Undo);
+    std::unique_lock<MeteredMutex> lock(mutex_);  // Thread guard
 
     if (!undoHistory.empty()) {
         auto current = cloneCurrentState();            // Save current state
         auto prev = std::move(undoHistory.back());     // Last undo state
         undoHistory.pop_back();
 
+        // Redo restores queued states oldest first, so it marks what every queued undo changed.
+        if (redoQueue.empty()) redoChanged_.clear();
+        redoChanged_.insert(redoChanged_.end(), prev.changed.begin(), prev.changed.end());
         redoQueue.push(std::move(current));            // Push current into redo
-        items = std::move(prev);                       // Restore previous state
+        items = std::move(prev.state);                 // Restore previous state
+        markReplaced(prev.changed);
+
+        std::shared_ptr<WriteAheadLog> wal = wal_;
+        uint64_t walSeq = appendWalRecords(prev.changed);
+        recycleTags(prev.changed);
 
         LOG_CONTEXT(LogLevel::DEBUG, "Undo successful. Restored to previous state.", {});
+
+        lock.unlock();
+        if (wal && walSeq) wal->commit(walSeq);
     } else {
         LOG_CONTEXT(LogLevel::INFO, "Nothing to undo.", {});
     }
 }
 
 void ItemManager::redo() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    const ScopedOperation timed(activeMetrics(), MetricOp::Redo);
+    std::unique_lock<MeteredMutex> lock(mutex_);
   
     if (!redoQueue.empty()) {
-        undoHistory.push_back(cloneCurrentState());   // Save current state
+        undoHistory.push_back({cloneCurrentState(), redoChanged_});   // Save current state
         items = std::move(redoQueue.front());         // Restore redo state
         redoQueue.pop();
+        markReplaced(redoChanged_);
+
+        std::shared_ptr<WriteAheadLog> wal = wal_;
+        uint64_t walSeq = appendWalRecords(redoChanged_);
 
         LOG_CONTEXT(LogLevel::DEBUG, "Redo successful. Restored to next state.", {});
+
+        lock.unlock();
+        if (wal && walSeq) wal->commit(walSeq);
     } else {
         LOG_CONTEXT(LogLevel::INFO, "Nothing to redo.", {});
     }
 }
 
 void ItemManager::exportToFile_Json(const std::string& filename) const {
+    const ScopedOperation timed(activeMetrics(), MetricOp::ExportJson);
 
     if (filename.empty()) {
         LOG_CONTEXT(LogLevel::WARNING, "Cannot export to empty filename.", ErrorCode::ITEM_NOT_FOUND);
@@ -402,13 +1049,20 @@ void ItemManager::exportToFile_Json(const std::string& filename) const {
 
     LOG_CONTEXT(LogLevel::INFO, "Attempting JSON export to file: " + filename, {});
     
-    if (items.empty()) {
+    const Snapshot view = takeSnapshot();  // serialized and written without holding the store lock
+
+    if (view->empty()) {
             LOG_CONTEXT(LogLevel::WARNING, "No items found to export.", ErrorCode::ITEM_NOT_FOUND);
     }
 
-    nlohmann::json jArray = nlohmann::json::array();
+    // The text of the entries' array as dump(4) writes it, built entry by entry so the tag index can
+    // record where each one is. Each entry is dumped once and re-indented a line at a time.
+    const bool indexed = exportTagIndex_.load();
+    TagIndex index;
+    std::string jsonContent = "[\n";
+    size_t exported = 0;
 
-    for (const auto& [tag, item] : items) {
+    for (const auto& [tag, item] : *view) {
         if (!item) {
             LOG_CONTEXT(LogLevel::ERR, "Null item found for tag: " + tag + " — skipping.", {});
             continue;
@@ -420,8 +1074,13 @@ void ItemManager::exportToFile_Json(const std::string& filename) const {
         entry["tag"] = tag;
         entry["type"] = item->getTypeName();
 
+        auto* lazy = dynamic_cast<const LazyItem*>(item.get());
         try {
-            entry["data"] = item->serialize();
+            if (lazy) {
+                if (lazy->version() != 1) entry["version"] = lazy->version();   // never written to: "data" is copied below
+            } else {
+                entry["data"] = item->serialize();
+            }
         } catch (const std::exception& e) {
             LOG_CONTEXT(LogLevel::ERR, "Serialization failed for item '" + tag + "': " + e.what(), {});
             continue;
@@ -433,23 +1092,43 @@ void ItemManager::exportToFile_Json(const std::string& filename) const {
             LOG_CONTEXT(LogLevel::DEBUG, "Attached schema for type: " + demangleType(item->getTypeName()), {});
         }
 
-        jArray.push_back(entry);
+        const std::string text = entry.dump(4);
+        std::string_view rest = text;
+        if (exported++ > 0) jsonContent += ",\n";
+        const size_t start = jsonContent.size() + 4;
+        jsonContent += "    ";
+        if (lazy) {   // the bytes as imported, then the rest of the entry ("id", "tag", "type" follow)
+            jsonContent += "{\n        \"data\": ";
+            jsonContent += lazy->raw();
+            jsonContent += ",\n    ";
+            rest.remove_prefix(2);
+        }
+        for (size_t line = rest.find('\n'); line != std::string_view::npos; line = rest.find('\n')) {
+            jsonContent.append(rest.data(), line + 1);
+            jsonContent += "    ";
+            rest.remove_prefix(line + 1);
+        }
+        jsonContent.append(rest.data(), rest.size());
+        const std::string_view written = std::string_view(jsonContent).substr(start);
+        if (indexed) index.add(item->getTypeName(), tag, start, written);
 
         LOG_CONTEXT(LogLevel::INFO, "Exporting item with tag: " + tag + " of type: " + demangleType(item->getTypeName()), {});
         std::cout << Logger::getColorCode(LogColor::CYAN)
-                  << entry.dump(4) 
+                  << written
                   << Logger::getColorCode(LogColor::RESET) + "\n";
 
         LOG_CONTEXT(LogLevel::INFO, "Added entry for tag: " + tag, {});
     }
-
-    std::string jsonContent = jArray.dump(4);
+    if (exported == 0) jsonContent = "[]";
+    else jsonContent += "\n]";
 
     if (!AtomicFileWriter::writeAtomically(filename, jsonContent)) {
             LOG_CONTEXT(LogLevel::ERR, "Failed atomic write to file: " + filename, ErrorCode::FILE_LOAD_FAILED);
     }
+    if (indexed) index.write(filename);
 
-    LOG_CONTEXT(LogLevel::INFO, "Exported " + std::to_string(jArray.size()) + " items to file (atomically): " + filename, {});
+    recordTransfer(MetricOp::ExportJson, filename, exported);
+    LOG_CONTEXT(LogLevel::INFO, "Exported " + std::to_string(exported) + " items to file (atomically): " + filename, {});
 }
 
 void ItemManager::asyncExportToFile_Json(const std::string& filename) const {
@@ -464,6 +1143,7 @@ void ItemManager::asyncExportToFile_Json(const std::string& filename) const {
 }
 
 void ItemManager::importFromFile_Json(const std::string& filename) {
+    const ScopedOperation timed(activeMetrics(), MetricOp::ImportJson);
 
     if (filename.empty()) {
         LOG_CONTEXT(LogLevel::ERR, "Cannot import from empty filename.", ErrorCode::ITEM_NOT_FOUND);
@@ -471,33 +1151,55 @@ void ItemManager::importFromFile_Json(const std::string& filename) {
 
     LOG_CONTEXT(LogLevel::INFO, "Attempting JSON import from file: " + filename, {});
     
-    std::ifstream in(filename);
-    if (!in) {
+    auto content = ioBackend()->readFile(filename);
+    if (!content) {
         LOG_CONTEXT(LogLevel::ERR, "Cannot open file for reading: " + filename, ErrorCode::FILE_LOAD_FAILED);
     }
 
-    json parsedJson;
-    in >> parsedJson;
-
-    std::cout << Logger::getColorCode(LogColor::CYAN) + "\n:::| Loaded JSON content from file:\n" 
-                                        << Logger::getColorCode(LogColor::RESET) << parsedJson.dump(2) << "\n";
-    LOG_CONTEXT(LogLevel::DEBUG, "JSON file loaded successfully: " + filename, {});
-
-    if (parsedJson.is_array()) {
-        LOG_CONTEXT(LogLevel::DEBUG, "Processing JSON array format.", {});
-    } else if (parsedJson.contains("items") && parsedJson["items"].is_array()) {
-        parsedJson = parsedJson["items"];
-        LOG_CONTEXT(LogLevel::DEBUG, "Processing JSON with 'items' key.", {});
+    // Records are decoded without mutex_, then installed under it in one step.
+    const ImportSettings settings = importSettings();
+    TypeDispatch dispatch(*this, true);
+    std::vector<ImportedItem> imported;
+    std::vector<std::pair<std::string, json>> schemas;
+    json parsedJson;   // stays empty for a lazy import, whose records are collected from the text
+
+    if (settings.lazy) {
+        const std::string_view text = *content;
+        size_t records = JsonSpan::skipSpace(text, 0);
+        if (records < text.size() && text[records] == '{') {
+            const size_t object = records;
+            records = JsonSpan::npos;
+            JsonSpan::forEachMember(text, object, [&](std::string_view key, std::string_view value) {
+                if (key == "items" && value.front() == '[') records = static_cast<size_t>(value.data() - text.data());
+            });
+        }
+        if (records >= text.size() || text[records] != '[') {
+            LOG_CONTEXT(LogLevel::ERR, "", std::make_exception_ptr(std::runtime_error(
+                                              "Invalid JSON format: " + filename + " Expected an array or 'items' key.")));
+        }
+        if (!collectLazyJson(text, records, settings, dispatch, imported, schemas)) {
+            LOG_CONTEXT(LogLevel::ERR, "", std::make_exception_ptr(std::runtime_error(
+                                              "Truncated or malformed JSON: " + filename)));
+        }
+        LOG_CONTEXT(LogLevel::DEBUG, "JSON records located without parsing: " + filename, {});
     } else {
-        LOG_CONTEXT(LogLevel::ERR, "", std::make_exception_ptr(std::runtime_error(
-                                          "Invalid JSON format: " + filename + " Expected an array or 'items' key.")));
-    }
+        parsedJson = json::parse(*content);
 
-    undoHistory.push_back(cloneCurrentState());
-    redoQueue = {};
-    items.clear();
+        std::cout << Logger::getColorCode(LogColor::CYAN) + "\n:::| Loaded JSON content from file:\n" 
+                                            << Logger::getColorCode(LogColor::RESET) << parsedJson.dump(2) << "\n";
+        LOG_CONTEXT(LogLevel::DEBUG, "JSON file loaded successfully: " + filename, {});
 
-    int importCount = 0;
+        if (parsedJson.is_array()) {
+            LOG_CONTEXT(LogLevel::DEBUG, "Processing JSON array format.", {});
+        } else if (parsedJson.contains("items") && parsedJson["items"].is_array()) {
+            parsedJson = parsedJson["items"];
+            LOG_CONTEXT(LogLevel::DEBUG, "Processing JSON with 'items' key.", {});
+        } else {
+            LOG_CONTEXT(LogLevel::ERR, "", std::make_exception_ptr(std::runtime_error(
+                                              "Invalid JSON format: " + filename + " Expected an array or 'items' key.")));
+        }
+        imported.reserve(parsedJson.size());
+    }
 
     for (const auto& entry : parsedJson) {
         if (!entry.contains("tag") || !entry.contains("type") || !entry.contains("data")) {
@@ -518,23 +1220,30 @@ void ItemManager::importFromFile_Json(const std::string& filename) {
 
         if (entry.contains("schema")) {
             LOG_CONTEXT(LogLevel::DEBUG, "Schema detected for type: " + demangleType(typeName), {});
-            schemaRegistry[typeName] = [schema = entry["schema"]]() {
-                return schema;
-            };
+            schemas.emplace_back(typeName, entry["schema"]);
         }
 
-        json upgraded = migrationRegistry.upgradeToLatest(typeName, version, rawData);
-        LOG_CONTEXT(LogLevel::DEBUG, "Schema migration applied (if needed) for '" + tag + "' to latest version.", {});
-
-        auto typeIt = registeredTypes.find(typeName);
-        if (typeIt == registeredTypes.end()) {
-            LOG_CONTEXT(LogLevel::WARNING, "Unknown type: " + demangleType(typeName) + " — skipping.", {});
+        if (settings.deferMigration && version < migrationRegistry->getLatestVersion(typeName)) {
+            // Kept as read; the version travels with the bytes so migration can run at first access.
+            if (version != 1) rawData["version"] = version;
+            const TypeSlot* slot = dispatch.find(typeName);
+            if (!slot) {
+                LOG_CONTEXT(LogLevel::WARNING, "Unknown type: " + demangleType(typeName) + " — skipping.", {});
+                continue;
+            }
+            std::string id = rawData.contains("id") && rawData["id"].is_string() ? rawData["id"].get<std::string>() : std::string();
+            auto item = makeLazyItem(*slot, settings.resource, tag, typeName, rawData.dump(), std::move(id), version);
+            imported.push_back({std::move(tag), std::move(item), true});
             continue;
         }
 
-        auto desIt = deserializers.find(typeName);
-        if (desIt == deserializers.end()) {
-            LOG_CONTEXT(LogLevel::WARNING, "No deserializer registered for type: " + demangleType(typeName) + " — skipping.", {});
+        migrationRegistry->upgradeInPlace(typeName, version, rawData);
+        json& upgraded = rawData;
+        LOG_CONTEXT(LogLevel::DEBUG, "Schema migration applied (if needed) for '" + tag + "' to latest version.", {});
+
+        const TypeSlot* slot = dispatch.find(typeName);
+        if (!slot) {
+            LOG_CONTEXT(LogLevel::WARNING, "Unknown type: " + demangleType(typeName) + " — skipping.", {});
             continue;
         }
 
@@ -544,11 +1253,10 @@ void ItemManager::importFromFile_Json(const std::string& filename) {
                   << Logger::getColorCode(LogColor::RESET) + "\n";
 
         try {
-            auto newItem = desIt->second(upgraded, tag);
+            auto newItem = slot->factory(upgraded, settings.resource);
             if (newItem) {
-                items[tag] = std::move(newItem);
                 LOG_CONTEXT(LogLevel::INFO, "Item '" + tag + "' imported successfully.", {});
-                ++importCount;
+                imported.push_back({std::move(tag), std::move(newItem)});
             } else {
                 LOG_CONTEXT(LogLevel::ERR, "Deserializer returned null for tag: " + tag, {});
             }
@@ -558,39 +1266,121 @@ void ItemManager::importFromFile_Json(const std::string& filename) {
         }
     }
 
+    const size_t importCount = imported.size();
+    applyImport(imported, std::move(schemas), ImportApply::Replace);
+
+    recordTransfer(MetricOp::ImportJson, filename, importCount);
     LOG_CONTEXT(LogLevel::INFO, "Completed import of " + std::to_string(importCount) + " item(s) from JSON file: " + filename, {});
 }
 
-void ItemManager::asyncImportFromFile_Json(const std::string& filename) {
-    std::thread([this, filename]() {
-        try {
-            this->importFromFile_Json(filename);  // Thread-safe core
-        } catch (const std::exception& e) {
-            LOG_CONTEXT(LogLevel::ERR, "", std::make_exception_ptr(std::runtime_error(
-                                          "Error during async import from file '" + filename + "': " + e.what())));
+bool ItemManager::collectLazyJson(std::string_view text, size_t pos, const ImportSettings& settings, TypeDispatch& dispatch,
+                                  std::vector<ImportedItem>& imported, std::vector<std::pair<std::string, json>>& schemas) {
+    return JsonSpan::forEachElement(text, pos, [&](std::string_view record) {
+        std::string_view tagText, typeText, idText, versionText, data, schema;
+        const bool complete = JsonSpan::forEachMember(record, 0, [&](std::string_view key, std::string_view value) {
+            if (key == "tag") tagText = value;
+            else if (key == "type") typeText = value;
+            else if (key == "id") idText = value;
+            else if (key == "version") versionText = value;
+            else if (key == "data") data = value;
+            else if (key == "schema") schema = value;
+        });
+        if (!complete || tagText.empty() || typeText.empty() || data.empty()) {
+            LOG_CONTEXT(LogLevel::WARNING, "Skipping entry due to missing keys: 'tag', 'type', or 'data'.", {});
+            return;
         }
-    }).detach();  // Fire-and-forget style
-}
+
+        // Only the small fields are parsed; "data" stays as the bytes read.
+        std::string tag = json::parse(tagText).get<std::string>();
+        std::string typeName = json::parse(typeText).get<std::string>();
+        const int version = versionText.empty() ? 1 : json::parse(versionText).get<int>();
+        if (!schema.empty()) schemas.emplace_back(typeName, json::parse(schema));
+
+        const TypeSlot* slot = dispatch.find(typeName);
+        if (!slot) {
+            LOG_CONTEXT(LogLevel::WARNING, "Unknown type: " + demangleType(typeName) + " — skipping.", {});
+            return;
+        }
+
+        std::string id;
+        bool hasId = false, hasVersion = false;
+        size_t members = 0;
+        JsonSpan::forEachMember(data, 0, [&](std::string_view key, std::string_view value) {
+            ++members;
+            if (key == "id") {
+                hasId = true;
+                if (value.front() == '"') id = json::parse(value).get<std::string>();
+            } else if (key == "version") {
+                hasVersion = true;
+            }
+        });
+
+        // Decoding expects the record to carry its "id" and, when not 1, its "version", as the eager
+        // import adds them. What exportToFile_Json wrote has both, so the bytes are normally kept whole.
+        const bool addId = !hasId && !idText.empty() && idText.front() == '"';
+        const bool addVersion = !hasVersion && version != 1;
+        std::string raw;
+        if (data.front() == '{' && (addId || addVersion)) {
+            raw = "{";
+            if (addId) {
+                id = json::parse(idText).get<std::string>();
+                raw.append("\"id\":").append(idText).push_back(',');
+            }
+            if (addVersion) raw.append("\"version\":" + std::to_string(version) + ",");
+            if (members == 0) raw.pop_back();
+            raw.append(data.substr(1));
+        } else {
+            raw.assign(data);
+        }
+
+        LOG_CONTEXT(LogLevel::INFO, "Importing item: '" + tag + "' of type: '" + demangleType(typeName) + "'", {});
+        if (id.empty()) id = tag;   // what the placeholder would fall back to
+        auto item = makeLazyItem(*slot, settings.resource, tag, typeName, std::move(raw), std::move(id), version);
+        imported.push_back({std::move(tag), std::move(item), true});
+    });
+}
+
+void ItemManager::asyncImportFromFile_Json(const std::string& filename) {
+    std::thread([this, filename]() {
+        try {
+            this->importFromFile_Json(filename);  // Thread-safe core
+        } catch (const std::exception& e) {
+            LOG_CONTEXT(LogLevel::ERR, "", std::make_exception_ptr(std::runtime_error(
+                                          "Error during async import from file '" + filename + "': " + e.what())));
+        }
+    }).detach();  // Fire-and-forget style
+}
 
 std::shared_ptr<BaseItem> ItemManager::importSingleObject_Json(const std::string& filename, 
                                                                const std::string& typeName, 
                                                                const std::string& tag) {
+    const ScopedOperation timed(activeMetrics(), MetricOp::ImportSingleJson);
     
     if (filename.empty()) {
         LOG_CONTEXT(LogLevel::ERR, "Cannot import from empty filename.", ErrorCode::ITEM_NOT_FOUND);
     }
 
     LOG_CONTEXT(LogLevel::INFO, "Attempting to import single JSON object from file: " + filename, {});
-   
-    std::ifstream in(filename);
-    if (!in) {
-        LOG_CONTEXT(LogLevel::ERR, "Cannot open file for reading: " + filename, ErrorCode::FILE_LOAD_FAILED);
+
+    // With a current tag index only the matching entry is read and parsed.
+    auto record = TagIndex::readRecord(filename, typeName, tag);
+    std::ifstream in;
+    if (!record) {
+        in.open(filename);
+        if (!in) {
+            LOG_CONTEXT(LogLevel::ERR, "Cannot open file for reading: " + filename, ErrorCode::FILE_LOAD_FAILED);
+        }
     }
 
     json array;
     try {
-        in >> array;
-        LOG_CONTEXT(LogLevel::DEBUG, "JSON file parsed successfully.", {});
+        if (record) {
+            array = json::array({json::parse(*record)});
+            LOG_CONTEXT(LogLevel::DEBUG, "Entry read through the tag index.", {});
+        } else {
+            in >> array;
+            LOG_CONTEXT(LogLevel::DEBUG, "JSON file parsed successfully.", {});
+        }
     } catch (const std::exception& e) {
         LOG_CONTEXT(LogLevel::ERR, "", std::make_exception_ptr(std::runtime_error(
                                           "Failed to parse JSON from file '" + filename + "': " + e.what())));
@@ -613,41 +1403,32 @@ std::shared_ptr<BaseItem> ItemManager::importSingleObject_Json(const std::string
                 rawData["id"] = entry["id"];
             }
 
+            std::vector<std::pair<std::string, json>> schemas;
             if (entry.contains("schema")) {
                 LOG_CONTEXT(LogLevel::DEBUG, "Embedded schema detected for tag: " + tag, {});
-                schemaRegistry[typeName] = [schema = entry["schema"]]() {
-                    return schema;
-                };
+                schemas.emplace_back(typeName, entry["schema"]);
             }
 
-            json upgraded = migrationRegistry.upgradeToLatest(typeName, version, rawData);
+            migrationRegistry->upgradeInPlace(typeName, version, rawData);
+            json& upgraded = rawData;
             LOG_CONTEXT(LogLevel::DEBUG, "Schema migration applied (if needed) to latest version.", {});
 
-            auto typeIt = registeredTypes.find(typeName);
-            if (typeIt == registeredTypes.end()) {
+            TypeDispatch dispatch(*this, true);
+            const TypeSlot* slot = dispatch.find(typeName);
+            if (!slot) {
                 LOG_CONTEXT(LogLevel::WARNING, "Unknown type: " + demangleType(typeName) + " — skipping.", {});
                 return nullptr;
             }
 
-            auto desIt = deserializers.find(typeName);
-            if (desIt == deserializers.end()) {
-                LOG_CONTEXT(LogLevel::WARNING, "No deserializer registered for type: " + demangleType(typeName) + " — skipping.", {});
-                return nullptr;
-            }
-
             try {
                 LOG_CONTEXT(LogLevel::INFO, "Attempting to deserialize item with tag '" + tag + "' and type '" + demangleType(typeName) + "'.", {});
-                auto item = desIt->second(upgraded, tag);
+                auto item = installSingle(*slot, tag, upgraded, std::move(schemas));
                 if (item) {
                     LOG_CONTEXT(LogLevel::INFO, "Deserialization successful for tag '" + tag + "'.", {});
                 } else {
                     LOG_CONTEXT(LogLevel::ERR, "Deserializer returned null for tag: " + tag, {});
                 }
 
-                undoHistory.push_back(cloneCurrentState());
-                redoQueue = {};
-                items[tag] = item;  // safely inserts into store
-
                 return item;
             } catch (const std::exception& e) {
                 LOG_CONTEXT(LogLevel::ERR, "", std::make_exception_ptr(std::runtime_error(
@@ -666,8 +1447,6 @@ void ItemManager::asyncImportSingleObject_Json(const std::string& filename,
     std::thread([this, filename, typeName, tag]() {
         auto item = this->importSingleObject_Json(filename, typeName, tag);
         if (item) {
-            std::lock_guard<std::mutex> lock(mutex_);
-            items[tag] = std::move(item);  // safely inserts into store
             LOG_CONTEXT(LogLevel::INFO, "Async import of single item '" + tag + "' completed successfully.", {});
         } else {
             LOG_CONTEXT(LogLevel::WARNING, "Async import failed for tag '" + tag + "' from file '" + filename + "'.", {});
@@ -676,6 +1455,7 @@ void ItemManager::asyncImportSingleObject_Json(const std::string& filename,
 }
 
 bool ItemManager::exportToFile_Binary(const std::string& filename) const {
+    const ScopedOperation timed(activeMetrics(), MetricOp::ExportBinary);
 
     if (filename.empty()) {
         LOG_CONTEXT(LogLevel::ERR, "Cannot export to empty filename.", false);
@@ -684,14 +1464,31 @@ bool ItemManager::exportToFile_Binary(const std::string& filename) const {
 
     LOG_CONTEXT(LogLevel::INFO, "Attempting binary export to file: " + filename, {});
 
-    if (items.empty()) {
+    const Snapshot view = takeSnapshot();  // serialized and written without holding the store lock
+
+    if (view->empty()) {
         LOG_CONTEXT(LogLevel::WARNING, "", std::make_exception_ptr(
                                           std::runtime_error("No items found for export to file '" + filename + "'.")));
     }
 
     std::vector<uint8_t> buffer;
+    const bool indexed = exportTagIndex_.load();
+    TagIndex index;
+
+    for (const auto& [tag, item] : *view) {
+        const size_t start = buffer.size();
+        auto record = [&buffer, start] {
+            return std::string_view(reinterpret_cast<const char*>(buffer.data()) + start, buffer.size() - start);
+        };
+
+        if (auto* lazy = dynamic_cast<const LazyItem*>(item.get())) {
+            // Never written to since a lazy import: the record is copied as it was read.
+            appendBinaryRecord(buffer, lazy->getTypeName(), tag, lazy->raw());
+            if (indexed) index.add(lazy->getTypeName(), tag, start, record());
+            LOG_CONTEXT(LogLevel::DEBUG, "Copied raw binary record of '" + tag + "'.", {});
+            continue;
+        }
 
-    for (const auto& [tag, item] : items) {
         json serializedJson = item->serialize();
         serializedJson["id"] = item->getId();
         serializedJson["tag"] = tag;
@@ -705,17 +1502,8 @@ bool ItemManager::exportToFile_Binary(const std::string& filename) const {
         uint32_t tagSize  = static_cast<uint32_t>(tagStr.size());
         uint32_t dataSize = static_cast<uint32_t>(jsonStr.size());
 
-        auto append = [&buffer](const void* data, size_t size) {
-            const auto* bytes = static_cast<const uint8_t*>(data);
-            buffer.insert(buffer.end(), bytes, bytes + size);
-        };
-
-        append(&typeSize, sizeof(typeSize));
-        append(type.data(), typeSize);
-        append(&tagSize, sizeof(tagSize));
-        append(tagStr.data(), tagSize);
-        append(&dataSize, sizeof(dataSize));
-        append(jsonStr.data(), dataSize);
+        appendBinaryRecord(buffer, type, tagStr, jsonStr);
+        if (indexed) index.add(type, tagStr, start, record());
 
         LOG_CONTEXT(LogLevel::INFO, "Exported binary object with tag '" + tag + "' of type '" + demangleType(type) + "' [hex]:", {});
 
@@ -740,7 +1528,9 @@ bool ItemManager::exportToFile_Binary(const std::string& filename) const {
         LOG_CONTEXT(LogLevel::ERR, "Failed atomic binary export to '" + filename + "'.",  true);
         return false;
     }
+    if (indexed) index.write(filename);
 
+    recordTransfer(MetricOp::ExportBinary, filename, view->size());
     LOG_CONTEXT(LogLevel::INFO, "Binary export to '" + filename + "' completed successfully.", true);
     return true;
 }
@@ -762,6 +1552,7 @@ void ItemManager::asyncExportToFile_Binary(const std::string& filename) const {
 }
 
 bool ItemManager::importFromFile_Binary(const std::string& filename) {
+    const ScopedOperation timed(activeMetrics(), MetricOp::ImportBinary);
 
     if (filename.empty()) {
         LOG_CONTEXT(LogLevel::ERR, "Cannot import from empty filename.", false);
@@ -770,15 +1561,18 @@ bool ItemManager::importFromFile_Binary(const std::string& filename) {
 
    LOG_CONTEXT(LogLevel::INFO, "Attempting binary import from file: " + filename, {});
 
-    std::ifstream in(filename, std::ios::binary);
-    if (!in.is_open()) {
+    // The whole file is fetched with large parallel reads, then parsed from memory.
+    auto content = ioBackend()->readFile(filename);
+    if (!content) {
         LOG_CONTEXT(LogLevel::ERR, "Cannot open binary file '" + filename + "' for reading.", false);
         return false;
     }
+    std::istringstream in(std::move(*content), std::ios::binary);
 
-    undoHistory.push_back(cloneCurrentState());
-    redoQueue = {};
-    items.clear();
+    // Records are decoded without mutex_, then installed under it in one step.
+    const ImportSettings settings = importSettings();
+    TypeDispatch dispatch(*this, true);
+    std::vector<ImportedItem> imported;
 
     while (in.peek() != EOF) {
         uint32_t typeSize = 0, tagSize = 0, dataSize = 0;
@@ -804,6 +1598,18 @@ bool ItemManager::importFromFile_Binary(const std::string& filename) {
         in.read(jsonStr.data(), dataSize);
         if (in.gcount() != static_cast<std::streamsize>(dataSize)) break;
 
+        const TypeSlot* slot = dispatch.find(type);
+
+        if (settings.lazy) {
+            if (!slot) {
+                LOG_CONTEXT(LogLevel::WARNING, "No deserializer registered for type: " + type + " — skipping.", {});
+                continue;
+            }
+            auto item = makeLazyItem(*slot, settings.resource, tag, type, std::move(jsonStr), "");
+            imported.push_back({std::move(tag), std::move(item), true});
+            continue;
+        }
+
         LOG_CONTEXT(LogLevel::DEBUG, "Processing binary object with tag '" + tag + "' of type '" + demangleType(type) + "' [hex]:", {});
         for (size_t i = 0; i < dataSize; ++i) {
             std::printf("%02X ", static_cast<unsigned char>(jsonStr[i]));
@@ -829,32 +1635,45 @@ bool ItemManager::importFromFile_Binary(const std::string& filename) {
             version = serialized["version"].get<int>();
         }
 
-        json upgraded = migrationRegistry.upgradeToLatest(type, version, serialized);
+        if (settings.deferMigration && version < migrationRegistry->getLatestVersion(type)) {
+            if (!slot) {
+                LOG_CONTEXT(LogLevel::WARNING, "No deserializer registered for type: " + type + " — skipping.", {});
+                continue;
+            }
+            std::string id = serialized["id"].is_string() ? serialized["id"].get<std::string>() : tag;
+            auto item = makeLazyItem(*slot, settings.resource, tag, type, std::move(jsonStr), std::move(id), version);
+            imported.push_back({std::move(tag), std::move(item), true});
+            continue;
+        }
+
+        migrationRegistry->upgradeInPlace(type, version, serialized);
+        json& upgraded = serialized;
         LOG_CONTEXT(LogLevel::DEBUG, "Schema migration applied (if needed) for tag: " + tag + " to latest version.", {});
 
-        auto desIt = deserializers.find(type);
-        if (desIt == deserializers.end()) {
+        if (!slot) {
             LOG_CONTEXT(LogLevel::WARNING, "No deserializer registered for type: " + type + " — skipping.", {});
             continue;
         }
 
         try {
-            auto object = desIt->second(upgraded, tag);
+            auto object = slot->factory(upgraded, settings.resource);
             if (!object) {
                 LOG_CONTEXT(LogLevel::WARNING, "Deserializer returned null for tag: " + tag, {});
                 continue;
             }
 
-            items[tag] = object;
             LOG_CONTEXT(LogLevel::INFO, "Successfully imported item with tag '" + tag + "' and type '" + type + "' from binary file: " + filename, {});
+            imported.push_back({std::move(tag), std::move(object)});
         } catch (const std::exception& e) {
             LOG_CONTEXT(LogLevel::ERR, "Exception during deserialization of '" + tag + "': " + std::string(e.what()), {});
             continue;
         }
     }
 
-    in.close();
-    LOG_CONTEXT(LogLevel::INFO, "Binary import from '" + filename + "' completed successfully with " + std::to_string(items.size()) + " items.", true);
+    const size_t importCount = applyImport(imported, {}, ImportApply::Replace);
+
+    recordTransfer(MetricOp::ImportBinary, filename, importCount);
+    LOG_CONTEXT(LogLevel::INFO, "Binary import from '" + filename + "' completed successfully with " + std::to_string(importCount) + " items.", true);
     return true;
 }
 
@@ -873,6 +1692,7 @@ void ItemManager::asyncImportFromFile_Binary(const std::string& filename) {
 std::shared_ptr<BaseItem> ItemManager::importSingleObject_Binary(const std::string& filename, 
                                                                  const std::string& type, 
                                                                  const std::string& tag) {
+    const ScopedOperation timed(activeMetrics(), MetricOp::ImportSingleBinary);
 
     if (filename.empty()) {
         LOG_CONTEXT(LogLevel::ERR, "", std::make_exception_ptr(std::runtime_error("Cannot import from empty filename.")));
@@ -881,7 +1701,15 @@ std::shared_ptr<BaseItem> ItemManager::importSingleObject_Binary(const std::stri
     LOG_CONTEXT(LogLevel::INFO, "Attempting to import single binary object from file: " 
                                 + filename + " with type '" + demangleType(type) + "' and tag '" + tag + "'", {});
     
-    std::ifstream in(filename, std::ios::binary);
+    // With a current tag index only the matching record is read; otherwise the file is scanned.
+    std::unique_ptr<std::istream> input;
+    if (auto record = TagIndex::readRecord(filename, type, tag)) {
+        input = std::make_unique<std::istringstream>(std::move(*record), std::ios::binary);
+        LOG_CONTEXT(LogLevel::DEBUG, "Record read through the tag index.", {});
+    } else {
+        input = std::make_unique<std::ifstream>(filename, std::ios::binary);
+    }
+    std::istream& in = *input;
     if (!in) {
         LOG_CONTEXT(LogLevel::ERR, "Cannot open binary file '" + filename + "' for reading.", ErrorCode::FILE_LOAD_FAILED);
     }
@@ -946,24 +1774,22 @@ std::shared_ptr<BaseItem> ItemManager::importSingleObject_Binary(const std::stri
                 version = serialized["version"].get<int>();
             }
 
-            json upgraded = migrationRegistry.upgradeToLatest(entryType, version, serialized);
+            migrationRegistry->upgradeInPlace(entryType, version, serialized);
+            json& upgraded = serialized;
 
-            auto it = deserializers.find(entryType);
-            if (it == deserializers.end()) {
+            TypeDispatch dispatch(*this, true);
+            const TypeSlot* slot = dispatch.find(entryType);
+            if (!slot) {
                 LOG_CONTEXT(LogLevel::ERR, "", std::make_exception_ptr(
                                           std::runtime_error("No deserializer registered for type '" + demangleType(entryType) + "'.")));
             }
             
-            auto object = it->second(upgraded, tag);
+            auto object = installSingle(*slot, tag, upgraded);
             if (!object) {
                 LOG_CONTEXT(LogLevel::ERR, "", std::make_exception_ptr(
                                           std::runtime_error("Deserializer returned null for tag '" + tag + "'.")));
             }
 
-            undoHistory.push_back(cloneCurrentState());
-            redoQueue = {};
-            items[tag] = object;  // Safely insert into store
-
             LOG_CONTEXT(LogLevel::INFO, "Successfully imported object with tag '" + tag + "' from file '" + filename + "'", {});
             return object;
         }
@@ -979,8 +1805,6 @@ void ItemManager::asyncImportSingleObject_Binary(const std::string& filename,
     std::thread([this, filename, typeName, tag]() {
         auto item = this->importSingleObject_Binary(filename, typeName, tag);
         if (item) {
-            std::lock_guard<std::mutex> lock(mutex_);
-            items[tag] = std::move(item);
             LOG_CONTEXT(LogLevel::INFO, "Async binary import of '" + tag + "' succeeded.", {});
         } else {
             LOG_CONTEXT(LogLevel::WARNING, "Async binary import failed for tag '" + tag + "' from file '" + filename + "'.", {});
@@ -989,6 +1813,7 @@ void ItemManager::asyncImportSingleObject_Binary(const std::string& filename,
 }
 
 bool ItemManager::exportToFile_XML(const std::string& filename) const {
+    const ScopedOperation timed(activeMetrics(), MetricOp::ExportXml);
 
     if (filename.empty()) {
         LOG_CONTEXT(LogLevel::ERR, "Cannot export to empty filename.", ErrorCode::INVALID_INPUT );
@@ -996,7 +1821,9 @@ bool ItemManager::exportToFile_XML(const std::string& filename) const {
 
     LOG_CONTEXT(LogLevel::INFO, "Attempting XML export to file: " + filename, {});
 
-    if (items.empty()) {
+    const Snapshot view = takeSnapshot();  // serialized and written without holding the store lock
+
+    if (view->empty()) {
         LOG_CONTEXT(LogLevel::WARNING, "", std::make_exception_ptr(
                                           std::runtime_error("No items found for XML export to file '" + filename + "'.")));
     }
@@ -1005,7 +1832,7 @@ bool ItemManager::exportToFile_XML(const std::string& filename) const {
     auto* root = doc.NewElement("SmartStore");
     doc.InsertFirstChild(root);
 
-    for (const auto& [tag, item] : items) {
+    for (const auto& [tag, item] : *view) {
         if (!item) {
             LOG_CONTEXT(LogLevel::ERR, "Null item found for tag: " + tag + " — skipping.", {});
             continue;
@@ -1051,11 +1878,29 @@ bool ItemManager::exportToFile_XML(const std::string& filename) const {
     doc.Print(&printer);
     std::string xmlContent = printer.CStr();
 
+    // <Item> elements are printed in insertion order, and item text is escaped, so the n-th
+    // <Item>...</Item> span is the n-th item exported.
+    const bool indexed = exportTagIndex_.load();
+    TagIndex index;
+    if (indexed) {
+        size_t pos = 0;
+        for (const auto& [tag, item] : *view) {
+            if (!item) continue;
+            size_t start = xmlContent.find("<Item>", pos);
+            size_t end = start == std::string::npos ? start : xmlContent.find("</Item>", start);
+            if (end == std::string::npos) break;
+            pos = end + std::strlen("</Item>");
+            index.add(item->getTypeName(), tag, start, std::string_view(xmlContent).substr(start, pos - start));
+        }
+    }
+
     if (!AtomicFileWriter::writeAtomically(filename, xmlContent)) {
         LOG_CONTEXT(LogLevel::ERR, "Failed to write XML atomically to file: " + filename, false);
         return false;
     }
+    if (indexed) index.write(filename);
 
+    recordTransfer(MetricOp::ExportXml, filename, view->size());
     LOG_CONTEXT(LogLevel::INFO, "XML export completed successfully to file: " + filename, true);
     return true;
 }
@@ -1077,6 +1922,7 @@ void ItemManager::asyncExportToFile_XML(const std::string& filename) const {
 }
 
 bool ItemManager::importFromFile_XML(const std::string& filename) {
+    const ScopedOperation timed(activeMetrics(), MetricOp::ImportXml);
 
     if (filename.empty()) {
         LOG_CONTEXT(LogLevel::ERR, "Filename is empty — cannot proceed with XML import.", false);
@@ -1098,8 +1944,10 @@ bool ItemManager::importFromFile_XML(const std::string& filename) {
         return false;
     }
 
-    
-    int loadedCount = 0;
+    // Records are decoded without mutex_, then merged into the store under it in one step.
+    const ImportSettings settings = importSettings();
+    TypeDispatch dispatch(*this, true);
+    std::vector<ImportedItem> imported;
     for (auto* itemElement = root->FirstChildElement("Item"); itemElement; itemElement = itemElement->NextSiblingElement("Item")) {
         auto* tagElement = itemElement->FirstChildElement("Tag");
         auto* typeElement = itemElement->FirstChildElement("Type");
@@ -1144,20 +1992,20 @@ bool ItemManager::importFromFile_XML(const std::string& filename) {
         LOG_CONTEXT(LogLevel::DEBUG, "Upgrading item '" + tag + "' of type '" + demangleType(typeName) 
                                                                     + "' from version: " + std::to_string(version), {});
 
-        json upgraded = migrationRegistry.upgradeToLatest(typeName, version, j);
+        migrationRegistry->upgradeInPlace(typeName, version, j);
+        json& upgraded = j;
 
-        auto it = deserializers.find(typeName);
-        if (it == deserializers.end()) {
+        const TypeSlot* slot = dispatch.find(typeName);
+        if (!slot) {
             LOG_CONTEXT(LogLevel::WARNING, "No deserializer registered for type '" + demangleType(typeName) + "' — skipping item with tag '" + tag + "'", {});
             continue;
         }
 
         try {
-            auto item = it->second(upgraded, tag);
+            auto item = slot->factory(upgraded, settings.resource);
             if (item) {
-                items[tag] = item;
                 LOG_CONTEXT(LogLevel::INFO, "Successfully imported item with tag '" + tag + "' from XML.", {});
-                loadedCount++;
+                imported.push_back({std::move(tag), std::move(item)});
             } else {
                 LOG_CONTEXT(LogLevel::ERR, "Deserializer returned null for tag '" + tag + "' — skipping.", {});
             }
@@ -1167,6 +2015,10 @@ bool ItemManager::importFromFile_XML(const std::string& filename) {
         }
     }
 
+    const size_t loadedCount = imported.size();
+    applyImport(imported, {}, ImportApply::Merge);
+
+    recordTransfer(MetricOp::ImportXml, filename, loadedCount);
     LOG_CONTEXT(LogLevel::INFO, "XML import completed with " + std::to_string(loadedCount) + " items loaded from file: " + filename, true);
     return true;
 }
@@ -1193,6 +2045,7 @@ void ItemManager::asyncImportFromFile_XML(const std::string& filename) {
 std::optional<std::shared_ptr<BaseItem>> ItemManager::importSingleObject_XML(const std::string& filename, 
                                                                              const std::string& type, 
                                                                              const std::string& tag) {
+    const ScopedOperation timed(activeMetrics(), MetricOp::ImportSingleXml);
 
     if (filename.empty()) {
         LOG_CONTEXT(LogLevel::ERR, "Filename is empty — cannot import from XML.", {});
@@ -1207,8 +2060,15 @@ std::optional<std::shared_ptr<BaseItem>> ItemManager::importSingleObject_XML(con
         return std::nullopt;
     }
 
+    // With a current tag index only the matching <Item> element is read and parsed.
     tinyxml2::XMLDocument doc;
-    if (doc.LoadFile(filename.c_str()) != tinyxml2::XML_SUCCESS) {
+    if (auto record = TagIndex::readRecord(filename, type, tag)) {
+        const std::string xml = "<SmartStore>" + *record + "</SmartStore>";
+        if (doc.Parse(xml.c_str(), xml.size()) != tinyxml2::XML_SUCCESS) {
+            LOG_CONTEXT(LogLevel::ERR, "Failed to parse indexed XML item '" + tag + "' of file: " + filename, {});
+            return std::nullopt;
+        }
+    } else if (doc.LoadFile(filename.c_str()) != tinyxml2::XML_SUCCESS) {
         LOG_CONTEXT(LogLevel::ERR, "Failed to load XML file: " + filename, {});
         return std::nullopt;
     }
@@ -1246,25 +2106,21 @@ std::optional<std::shared_ptr<BaseItem>> ItemManager::importSingleObject_XML(con
 
             std::cout << Logger::getColorCode(LogColor::YELLOW) << j.dump(4) << Logger::getColorCode(LogColor::RESET) + "\n";
 
-            json upgraded = migrationRegistry.upgradeToLatest(type, 1, j); // Assumes version 1 if none is specified.
+            migrationRegistry->upgradeInPlace(type, 1, j); // Assumes version 1 if none is specified.
+            json& upgraded = j;
             LOG_CONTEXT(LogLevel::DEBUG, "Upgrading item '" + std::string(tagText) + "' of type '" 
                                                         + demangleType(std::string(typeText)) + "' to latest version.", {});
 
-            auto it = deserializers.find(type);
-            if (it == deserializers.end()) {
+            TypeDispatch dispatch(*this, true);
+            const TypeSlot* slot = dispatch.find(type);
+            if (!slot) {
                 LOG_CONTEXT(LogLevel::ERR, "No deserializer registered for type '" + demangleType(type) 
                                                             + "' — cannot import item with tag '" + tag + "'", {});
                 return std::nullopt;
             }
 
             LOG_CONTEXT(LogLevel::INFO, "Attempting to import item with tag '" + tag + "' from XML.", {});
-            auto item = it->second(upgraded, tag);
-
-            undoHistory.push_back(cloneCurrentState());
-            redoQueue = {};
-            items[tag] = item;
-
-            return item;
+            return installSingle(*slot, tag, upgraded);
         } catch (const std::exception& e) {
             LOG_CONTEXT(LogLevel::ERR, "Failed to parse JSON data for tag '" + tag + "': " + e.what(), {});
             return std::nullopt;
@@ -1281,8 +2137,6 @@ void ItemManager::asyncImportSingleObject_XML(const std::string& filename, const
         try {
             auto result = this->importSingleObject_XML(filename, type, tag);
             if (result.has_value() && result.value()) {
-                std::lock_guard lock(mutex_);  // Ensure thread-safe map update
-                items[tag] = result.value();
                 LOG_CONTEXT(LogLevel::INFO, "Async import of single item '" + tag + "' completed successfully from XML file: " + filename, {});
             } else {
                 LOG_CONTEXT(LogLevel::WARNING, "Async import failed or returned null for tag '" + tag + "' from XML file: " + filename, {});
@@ -1298,6 +2152,7 @@ void ItemManager::asyncImportSingleObject_XML(const std::string& filename, const
 }
 
 bool ItemManager::exportToFile_CSV(const std::string& filename) const {
+    const ScopedOperation timed(activeMetrics(), MetricOp::ExportCsv);
 
     if (filename.empty()) {
         LOG_CONTEXT(LogLevel::ERR, "CSV export failed: empty filename.", true);
@@ -1306,15 +2161,18 @@ bool ItemManager::exportToFile_CSV(const std::string& filename) const {
 
     LOG_CONTEXT(LogLevel::INFO, "Attempting CSV export to file: " + filename, {});
 
-    if (items.empty()) {
+    const Snapshot view = takeSnapshot();  // serialized and written without holding the store lock
+
+    if (view->empty()) {
         LOG_CONTEXT(LogLevel::WARNING, "", std::make_exception_ptr(
                                           std::runtime_error("CSV export failed: No items found for export to file '" + filename + "'.")));
     }
 
-    std::ostringstream oss;
-    oss << "id,tag,type,data\n"; // CSV header
+    std::string out = "id,tag,type,data\n"; // CSV header
+    const bool indexed = exportTagIndex_.load();
+    TagIndex index;
 
-    for (const auto& [tag, item] : items) {
+    for (const auto& [tag, item] : *view) {
         if (!item) {
             LOG_CONTEXT(LogLevel::ERR, "Null item found for tag: " + tag + " — skipping.", {});
             continue;
@@ -1341,28 +2199,27 @@ bool ItemManager::exportToFile_CSV(const std::string& filename) const {
                   << "  \"data\": " << dataStr << "\n"
                   << "}\n" + Logger::getColorCode(LogColor::RESET);
 
-        auto escapeCSV = [](const std::string& field) {
-            std::string escaped = "\"";
-            for (char c : field) {
-                escaped += (c == '"') ? "\"\"" : std::string(1, c);
-            }
-            escaped += "\"";
-            return escaped;
-        };
-
-        oss << escapeCSV(id) << ","
-            << escapeCSV(tag) << ","
-            << escapeCSV(type) << ","
-            << escapeCSV(dataStr) << "\n";
+        const size_t start = out.size();
+        CsvUtils::appendQuoted(out, id);
+        out.push_back(',');
+        CsvUtils::appendQuoted(out, tag);
+        out.push_back(',');
+        CsvUtils::appendQuoted(out, type);
+        out.push_back(',');
+        CsvUtils::appendQuoted(out, dataStr);
+        if (indexed) index.add(type, tag, start, std::string_view(out).substr(start));
+        out.push_back('\n');
 
         std::cout << Logger::getColorCode(LogColor::CYAN) + ":::| Item '" << tag << "' written to CSV.\n" + Logger::getColorCode(LogColor::RESET);
     }
 
-    if (!AtomicFileWriter::writeAtomically(filename, oss.str())) {
+    if (!AtomicFileWriter::writeAtomically(filename, out)) {
         LOG_CONTEXT(LogLevel::ERR, "Failed to write CSV atomically to file: " + filename, false);
         return false;
     }
+    if (indexed) index.write(filename);
 
+    recordTransfer(MetricOp::ExportCsv, filename, view->size());
     LOG_CONTEXT(LogLevel::INFO, "CSV export completed successfully to file: " + filename, true);
     return true;
 }
@@ -1385,7 +2242,179 @@ void ItemManager::asyncExportToFile_CSV(const std::string& filename) const {
     }).detach();
 }
 
+std::vector<std::string> ItemManager::csvColumnsForType(const std::string& typeName, const json& sample) const {
+    std::vector<std::string> columns;
+
+    // Prefer the registered schema: JSON-schema style {"properties": {...}} or a flat {"field": "type"} map.
+    json schema = getSchemaForType(typeName);
+    if (schema.is_object()) {
+        const json* fields = &schema;
+        if (schema.contains("properties") && schema["properties"].is_object()) {
+            fields = &schema["properties"];
+        } else {
+            for (const auto& [key, value] : schema.items()) {
+                if (!value.is_string()) { fields = nullptr; break; }
+            }
+        }
+        if (fields) {
+            for (const auto& [key, value] : fields->items()) columns.push_back(key);
+            if (!columns.empty()) return columns;
+        }
+    }
+
+    // Otherwise fall back to the first-level keys of the first item seen for this type.
+    if (sample.is_object()) {
+        for (const auto& [key, value] : sample.items()) columns.push_back(key);
+    }
+    return columns;
+}
+
+bool ItemManager::exportToFile_CSVColumnar(const std::string& filename) const {
+    const ScopedOperation timed(activeMetrics(), MetricOp::ExportCsvColumnar);
+
+    if (filename.empty()) {
+        LOG_CONTEXT(LogLevel::ERR, "Columnar CSV export failed: empty filename.", {});
+        return false;
+    }
+
+    LOG_CONTEXT(LogLevel::INFO, "Attempting columnar CSV export with base name: " + filename, {});
+
+    const Snapshot view = takeSnapshot();  // serialized and written without holding the store lock
+
+    if (view->empty()) {
+        LOG_CONTEXT(LogLevel::WARNING, "Columnar CSV export skipped: no items found for export.", {});
+        return false;
+    }
+
+    // Rows stream into one atomic sink per type, which hands them to the file in large writes.
+    struct TypeSection {
+        std::string file;
+        std::vector<std::string> columns;
+        std::unique_ptr<AtomicFileWriter::Sink> sink;
+        uint64_t bytes = 0;
+        size_t rows = 0;
+    };
+
+    const std::filesystem::path base(filename);
+    const std::string stem = (base.parent_path() / base.stem()).string();
+    const std::string ext = base.has_extension() ? base.extension().string() : ".csv";
+
+    std::unordered_map<std::string, TypeSection> sections;
+    std::unordered_set<std::string> usedFiles;
+    std::string row;
+
+    // Single pass over the store: every item is appended to the section of its type.
+    for (const auto& [tag, item] : *view) {
+        if (!item) {
+            LOG_CONTEXT(LogLevel::ERR, "Null item found for tag: " + tag + " — skipping.", {});
+            continue;
+        }
+
+        json data;
+        try {
+            data = item->toJson();
+        } catch (const std::exception& e) {
+            LOG_CONTEXT(LogLevel::WARNING, "Failed to serialize item '" + tag + "': " + e.what(), {});
+        }
+
+        const std::string type = item->getTypeName();
+        auto it = sections.find(type);
+        if (it == sections.end()) {
+            TypeSection section;
+
+            const std::string name = stem + "_" + CsvUtils::sanitizeForFilename(demangleType(type));
+            section.file = name + ext;
+            for (int n = 2; !usedFiles.insert(section.file).second; ++n) {
+                section.file = name + "_" + std::to_string(n) + ext;
+            }
+
+            section.columns = csvColumnsForType(type, data);
+            section.sink = std::make_unique<AtomicFileWriter::Sink>(section.file);
+            row = "id,tag";
+            if (section.columns.empty()) {
+                row += ",value";
+            }
+            for (const auto& column : section.columns) {
+                row.push_back(',');
+                CsvUtils::appendField(row, column);
+            }
+            row.push_back('\n');
+            section.bytes += row.size();
+            if (!section.sink->write(row)) {
+                LOG_CONTEXT(LogLevel::ERR, "Failed to write columnar CSV file: " + section.file, {});
+                return false;
+            }
+
+            it = sections.emplace(type, std::move(section)).first;
+        }
+
+        TypeSection& section = it->second;
+        row.clear();
+        CsvUtils::appendField(row, item->getId());
+        row.push_back(',');
+        CsvUtils::appendField(row, tag);
+
+        if (section.columns.empty()) {
+            row.push_back(',');
+            CsvUtils::appendJsonCell(row, data);
+        } else {
+            for (const auto& column : section.columns) {
+                row.push_back(',');
+                if (!data.is_object()) continue;
+                auto field = data.find(column);
+                if (field != data.end()) CsvUtils::appendJsonCell(row, *field);
+            }
+        }
+        row.push_back('\n');
+        section.bytes += row.size();
+        ++section.rows;
+        if (!section.sink->write(row)) {
+            LOG_CONTEXT(LogLevel::ERR, "Failed to write columnar CSV file: " + section.file, {});
+            return false;   // every sink is abandoned: no file is replaced
+        }
+    }
+
+    // Renamed into place only once every file is complete.
+    for (auto& [type, section] : sections) {
+        if (!section.sink->commit()) {
+            LOG_CONTEXT(LogLevel::ERR, "Failed to write columnar CSV files atomically with base name: " + filename, {});
+            return false;
+        }
+    }
+    if (MetricsRegistry* metrics = activeMetrics()) {
+        uint64_t bytes = 0, rows = 0;
+        for (const auto& [type, section] : sections) {
+            bytes += section.bytes;
+            rows += section.rows;
+        }
+        metrics->recordTransfer(MetricOp::ExportCsvColumnar, bytes, rows);
+    }
+    for (const auto& [type, section] : sections) {
+        LOG_CONTEXT(LogLevel::INFO, "Wrote " + std::to_string(section.rows) + " row(s) of type '" + demangleType(type)
+                                                                             + "' to file: " + section.file, {});
+    }
+
+    LOG_CONTEXT(LogLevel::INFO, "Columnar CSV export completed: " + std::to_string(sections.size()) + " file(s) written.", true);
+    return true;
+}
+
+void ItemManager::asyncExportToFile_CSVColumnar(const std::string& filename) const {
+    std::thread([this, filename]() {
+        try {
+            if (this->exportToFile_CSVColumnar(filename)) {
+                LOG_CONTEXT(LogLevel::INFO, "asyncExportToFile_CSVColumnar completed successfully for base name: " + filename, {});
+            } else {
+                LOG_CONTEXT(LogLevel::ERR, "asyncExportToFile_CSVColumnar failed for base name: " + filename, {});
+            }
+        } catch (const std::exception& ex) {
+            LOG_CONTEXT(LogLevel::ERR, "", std::make_exception_ptr(std::runtime_error(
+                                          "Exception in asyncExportToFile_CSVColumnar: " + std::string(ex.what()))));
+        }
+    }).detach();
+}
+
 bool ItemManager::importFromFile_CSV(const std::string& filename) {
+    const ScopedOperation timed(activeMetrics(), MetricOp::ImportCsv);
 
     if (filename.empty()) {
         LOG_CONTEXT(LogLevel::ERR, "Cannot import from empty filename.", false);
@@ -1407,11 +2436,10 @@ bool ItemManager::importFromFile_CSV(const std::string& filename) {
         return false;
     }
 
-    undoHistory.push_back(cloneCurrentState());
-    redoQueue = {};
-    items.clear();
-
-    int loadedCount = 0;
+    // Records are decoded without mutex_, then installed under it in one step.
+    const ImportSettings settings = importSettings();
+    TypeDispatch dispatch(*this, true);
+    std::vector<ImportedItem> imported;
     std::string line;
 
     while (std::getline(file, line)) {
@@ -1468,11 +2496,12 @@ bool ItemManager::importFromFile_CSV(const std::string& filename) {
                 version = parsedData["version"];
             }
 
-            json upgradedData = migrationRegistry.upgradeToLatest(type, version, parsedData);
+            migrationRegistry->upgradeInPlace(type, version, parsedData);
+            json& upgradedData = parsedData;
             LOG_CONTEXT(LogLevel::DEBUG, "Upgrading item '" + tag + "' of type '" + demangleType(type) + 
                                                                         "' from version: " + std::to_string(version), {});
 
-            j["data"] = upgradedData;
+            j["data"] = std::move(upgradedData);
             j["id"]   = id;
             j["tag"]  = tag;
             j["type"] = type;
@@ -1485,18 +2514,17 @@ bool ItemManager::importFromFile_CSV(const std::string& filename) {
 
         std::cout << "\n" + Logger::getColorCode(LogColor::YELLOW) << j.dump(4) << Logger::getColorCode(LogColor::RESET) + "\n";
 
-        auto it = deserializers.find(type);
-        if (it == deserializers.end()) {
+        const TypeSlot* slot = dispatch.find(type);
+        if (!slot) {
             LOG_CONTEXT(LogLevel::WARNING, "No deserializer registered for type '" + demangleType(type) + "' — skipping item with tag '" + tag + "'", {});
             continue;
         }
 
         try {
-            auto item = it->second(j, tag);
+            auto item = slot->factory(j, settings.resource);
             if (item) {
-                items[tag] = item;
-                loadedCount++;
                 LOG_CONTEXT(LogLevel::INFO, "Successfully imported item with tag '" + tag + "' from CSV.", {});
+                imported.push_back({std::move(tag), std::move(item)});
             } else {
                 LOG_CONTEXT(LogLevel::WARNING, "Deserializer returned null for tag '" + tag + "' — skipping.", {});
             }
@@ -1505,6 +2533,10 @@ bool ItemManager::importFromFile_CSV(const std::string& filename) {
         }
     }
 
+    const size_t loadedCount = imported.size();
+    applyImport(imported, {}, ImportApply::Replace);
+
+    recordTransfer(MetricOp::ImportCsv, filename, loadedCount);
     LOG_CONTEXT(LogLevel::INFO, "CSV import completed with " + std::to_string(loadedCount) + " items loaded from file: " + filename, true);
     return true;
 }
@@ -1530,6 +2562,7 @@ void ItemManager::asyncImportFromFile_CSV(const std::string& filename) {
 std::shared_ptr<BaseItem> ItemManager::importSingleObject_CSV(const std::string& filename, 
                                                               const std::string& type, 
                                                               const std::string& tag) {
+    const ScopedOperation timed(activeMetrics(), MetricOp::ImportSingleCsv);
    
     if (filename.empty()) {
         LOG_CONTEXT(LogLevel::ERR, "Filename is empty — cannot proceed with CSV import.", {});
@@ -1539,8 +2572,15 @@ std::shared_ptr<BaseItem> ItemManager::importSingleObject_CSV(const std::string&
     LOG_CONTEXT(LogLevel::INFO, "Attempting to import single CSV object from file: " + filename + " with type '" 
                                                                     + demangleType(type) + "' and tag '" + tag + "'", {});
     
-    std::ifstream file(filename);
-    if (!file.is_open()) {
+    // With a current tag index only the matching row is read; otherwise the file is scanned.
+    std::unique_ptr<std::istream> input;
+    if (auto row = TagIndex::readRecord(filename, type, tag)) {
+        input = std::make_unique<std::istringstream>("id,tag,type,data\n" + *row);
+    } else {
+        input = std::make_unique<std::ifstream>(filename);
+    }
+    std::istream& file = *input;
+    if (!file) {
         LOG_CONTEXT(LogLevel::ERR, "", std::make_exception_ptr(
                                           std::runtime_error("Cannot open CSV file '" + filename + "' for reading.")));
     }
@@ -1595,36 +2635,31 @@ std::shared_ptr<BaseItem> ItemManager::importSingleObject_CSV(const std::string&
             version = rawData["version"];
         }
 
-        json upgradedData = migrationRegistry.upgradeToLatest(typeIn, version, rawData);
+        migrationRegistry->upgradeInPlace(typeIn, version, rawData);
+        json& upgradedData = rawData;
 
         json wrapper;
         wrapper["id"]   = id;
         wrapper["tag"]  = tagIn;
         wrapper["type"] = typeIn;
-        wrapper["data"] = upgradedData;
+        wrapper["data"] = std::move(upgradedData);
 
         std::cout << Logger::getColorCode(LogColor::CYAN) + "\n>>> Matched CSV row: tag='"
                              << tag << "', type='" << demangleType(type) << "'\n" + Logger::getColorCode(LogColor::YELLOW);
 
         std::cout << Logger::getColorCode(LogColor::YELLOW) << wrapper.dump(4) << Logger::getColorCode(LogColor::RESET) + "\n";
 
-        auto it = deserializers.find(typeIn);
-        if (it == deserializers.end()) {
+        TypeDispatch dispatch(*this, true);
+        const TypeSlot* slot = dispatch.find(typeIn);
+        if (!slot) {
             LOG_CONTEXT(LogLevel::ERR, "No deserializer registered for type '" + demangleType(typeIn) + 
                                                     "' — cannot import item with tag '" + demangleType(tagIn) + "'", {});
             return nullptr;
         }
 
         try {
-            auto item = it->second(wrapper, tagIn);
             LOG_CONTEXT(LogLevel::INFO, "Attempting to import item with tag '" + demangleType(tagIn) + "' from CSV.", {});
-
-            // Undo/Redo support (only if it is actually imported)
-            undoHistory.push_back(cloneCurrentState());
-            redoQueue = {};
-            items[tagIn] = item;
-
-            return item;
+            return installSingle(*slot, tagIn, wrapper);   // with undo state, only if it is actually imported
         } catch (const std::exception& e) {
             LOG_CONTEXT(LogLevel::ERR, "", std::make_exception_ptr(
                                           std::runtime_error("Failed to deserialize item with tag '" + tagIn + "': " + e.what())));
@@ -1641,8 +2676,6 @@ void ItemManager::asyncImportSingleObject_CSV(const std::string& filename, const
         try {
             auto item = this->importSingleObject_CSV(filename, type, tag);
             if (item) {
-                std::lock_guard<std::mutex> lock(mutex_); // protect shared state
-                items[tag] = item;
                 LOG_CONTEXT(LogLevel::INFO, "Async import of single item '" + tag + "' completed successfully from CSV file: " + filename, {});
             } else {
                 LOG_CONTEXT(LogLevel::WARNING, "Async import failed or returned null for tag '" + tag + "' from CSV file: " + filename, {});
@@ -1657,17 +2690,889 @@ void ItemManager::asyncImportSingleObject_CSV(const std::string& filename, const
     }).detach();
 }
 
+void ItemManager::enableWriteAheadLog(const std::string& path, WalOptions options) {
+    if (path.empty()) {
+        LOG_CONTEXT(LogLevel::ERR, "", std::make_exception_ptr(std::runtime_error("Write-ahead log path cannot be empty.")));
+    }
+
+    auto wal = std::make_shared<WriteAheadLog>(path, options);
+
+    std::lock_guard<MeteredMutex> lock(mutex_);
+    wal_ = std::move(wal);
+    LOG_CONTEXT(LogLevel::INFO, "Write-ahead log enabled at: " + path + " (next sequence "
+                                + std::to_string(wal_->lastSequence() + 1) + ")", {});
+}
+
+void ItemManager::disableWriteAheadLog() {
+    std::shared_ptr<WriteAheadLog> wal;
+    {
+        std::lock_guard<MeteredMutex> lock(mutex_);
+        appendWalRecords({});
+        wal.swap(wal_);
+    }
+    if (wal) {
+        wal->flush();
+        LOG_CONTEXT(LogLevel::INFO, "Write-ahead log closed: " + wal->path(), {});
+    }
+}
+
+bool ItemManager::isWriteAheadLogEnabled() const {
+    std::lock_guard<MeteredMutex> lock(mutex_);
+    return wal_ != nullptr;
+}
+
+void ItemManager::flushWriteAheadLog() {
+    std::shared_ptr<WriteAheadLog> wal;
+    {
+        std::lock_guard<MeteredMutex> lock(mutex_);
+        appendWalRecords({});
+        wal = wal_;
+    }
+    if (wal) wal->flush();
+}
+
+uint64_t ItemManager::changeSequence() const {
+    std::lock_guard<MeteredMutex> lock(mutex_);
+    return changeSeq_;
+}
+
+bool ItemManager::exportChangesSince(uint64_t sinceSeq, const std::string& filename) const {
+    const ScopedOperation timed(activeMetrics(), MetricOp::ExportChanges);
+
+    if (filename.empty()) {
+        LOG_CONTEXT(LogLevel::ERR, "Cannot export changes to empty filename.", {});
+        return false;
+    }
+
+    Snapshot view;
+    uint64_t currentSeq = 0;
+    std::vector<std::string> changedTags;
+    json removed = json::array();
+    {
+        std::lock_guard<MeteredMutex> lock(mutex_);
+        view = snapshotLocked();
+        currentSeq = changeSeq_;
+        for (const auto& [tag, seq] : changedAt_) {
+            if (seq > sinceSeq) changedTags.push_back(tag);
+        }
+        for (const auto& [tag, seq] : removedAt_) {
+            if (seq > sinceSeq) removed.push_back(tag);
+        }
+    }
+
+    json upserts = json::array();
+    for (const auto& tag : changedTags) {
+        auto it = view->find(tag);
+        if (it == view->end() || !it->second) continue;
+
+        json entry;
+        entry["id"] = it->second->getId();
+        entry["tag"] = tag;
+        entry["type"] = it->second->getTypeName();
+        entry["data"] = it->second->serialize();
+        upserts.push_back(std::move(entry));
+    }
+
+    const size_t upsertCount = upserts.size();
+    const size_t removedCount = removed.size();
+    json delta = {{"format", "smart_store_delta"}, {"base_seq", sinceSeq}, {"seq", currentSeq},
+                  {"upserts", std::move(upserts)}, {"removed", std::move(removed)}};
+
+    if (!AtomicFileWriter::writeAtomically(filename, delta.dump(4))) {
+        LOG_CONTEXT(LogLevel::ERR, "Failed atomic write of delta file: " + filename, {});
+        return false;
+    }
+
+    LOG_CONTEXT(LogLevel::INFO, "Exported " + std::to_string(upsertCount) + " changed and " + std::to_string(removedCount)
+                                + " removed item(s) since sequence " + std::to_string(sinceSeq) + " to: " + filename, {});
+    return true;
+}
+
+bool ItemManager::applyDeltaFromFile_Json(const std::string& filename) {
+    const ScopedOperation timed(activeMetrics(), MetricOp::ApplyDelta);
+
+    if (filename.empty()) {
+        LOG_CONTEXT(LogLevel::ERR, "Cannot apply delta from empty filename.", {});
+        return false;
+    }
+
+    std::ifstream in(filename);
+    if (!in) {
+        LOG_CONTEXT(LogLevel::ERR, "Cannot open delta file for reading: " + filename, {});
+        return false;
+    }
+
+    json delta;
+    try {
+        in >> delta;
+    } catch (const std::exception& e) {
+        LOG_CONTEXT(LogLevel::ERR, "Failed to parse delta file '" + filename + "': " + e.what(), {});
+        return false;
+    }
+
+    if (!delta.is_object() || delta.value("format", "") != "smart_store_delta") {
+        LOG_CONTEXT(LogLevel::ERR, "Not a delta file (missing format marker): " + filename, {});
+        return false;
+    }
+
+    std::unique_lock<MeteredMutex> lock(mutex_);
+
+    undoHistory.push_back({cloneCurrentState(), {}});
+    redoQueue = {};
+
+    size_t removedCount = 0;
+    for (const auto& tagJson : delta.value("removed", json::array())) {
+        const std::string tag = tagJson.get<std::string>();
+        auto it = items.find(tag);
+        if (it == items.end()) continue;
+        idMap.erase(it->second->getId());
+        items.erase(it);
+        markRemoved(tag);
+        ++removedCount;
+    }
+
+    size_t upsertCount = 0;
+    TypeDispatch dispatch(*this);
+    for (const auto& entry : delta.value("upserts", json::array())) {
+        if (!entry.contains("tag") || !entry.contains("type") || !entry.contains("data")) {
+            LOG_CONTEXT(LogLevel::WARNING, "Skipping delta entry due to missing keys: 'tag', 'type', or 'data'.", {});
+            continue;
+        }
+
+        const std::string tag = entry["tag"].get<std::string>();
+        const std::string typeName = entry["type"].get<std::string>();
+        json rawData = entry["data"];
+        if (!rawData.contains("id") && entry.contains("id")) {
+            rawData["id"] = entry["id"];
+        }
+
+        const TypeSlot* slot = dispatch.find(typeName);
+        if (!slot) {
+            LOG_CONTEXT(LogLevel::WARNING, "No deserializer registered for type: " + demangleType(typeName) + " — skipping.", {});
+            continue;
+        }
+
+        try {
+            int version = rawData.value("version", entry.value("version", 1));
+            migrationRegistry->upgradeInPlace(typeName, version, rawData);
+            json& upgraded = rawData;
+
+            // Replacing an item must not resolve to the old object through idMap.
+            auto existing = items.find(tag);
+            if (existing != items.end()) idMap.erase(existing->second->getId());
+
+            auto item = (this->*slot->deserialize)(upgraded);
+            if (!item) {
+                LOG_CONTEXT(LogLevel::ERR, "Deserializer returned null for tag: " + tag, {});
+                continue;
+            }
+            items[tag] = std::move(item);
+            markChanged(tag);
+            ++upsertCount;
+        } catch (const std::exception& e) {
+            LOG_CONTEXT(LogLevel::ERR, "Error applying delta entry '" + tag + "': " + e.what(), {});
+        }
+    }
+
+    std::shared_ptr<WriteAheadLog> wal = wal_;
+    uint64_t walSeq = appendWalRecords(undoHistory.back().changed);   // what this delta marked
+
+    LOG_CONTEXT(LogLevel::INFO, "Applied delta " + std::to_string(delta.value("base_seq", uint64_t{0})) + " -> "
+                                + std::to_string(delta.value("seq", uint64_t{0})) + " from '" + filename + "': "
+                                + std::to_string(upsertCount) + " upserted, " + std::to_string(removedCount) + " removed.", {});
+
+    lock.unlock();
+    if (wal && walSeq) wal->commit(walSeq);
+    return true;
+}
+
+void ItemManager::appendSnapshotRecord(std::string& buffer, const std::string& tag, const BaseItem& item) {
+    if (auto* lazy = dynamic_cast<const LazyItem*>(&item)) {
+        appendBinaryRecord(buffer, item.getTypeName(), tag, lazy->raw());
+    } else {
+        appendBinaryRecord(buffer, item.getTypeName(), tag, item.serialize().dump());
+    }
+}
+
+std::string ItemManager::encodeSnapshot(const State& view, CheckpointFormat format) const {
+    if (format == CheckpointFormat::Binary) {
+        std::string buffer;
+        for (const auto& [tag, item] : view) {
+            if (item) appendSnapshotRecord(buffer, tag, *item);
+        }
+        return buffer;
+    }
+
+    json jArray = json::array();
+    for (const auto& [tag, item] : view) {
+        if (!item) continue;
+        json entry;
+        entry["id"] = item->getId();
+        entry["tag"] = tag;
+        entry["type"] = item->getTypeName();
+        if (auto* lazy = dynamic_cast<const LazyItem*>(item.get())) {
+            entry["data"] = lazy->rawJson();
+            if (entry["data"].contains("version")) entry["version"] = entry["data"]["version"];
+        } else {
+            entry["data"] = item->serialize();
+        }
+        auto schema = getSchemaForType(item->getTypeName());
+        if (!schema.is_null()) entry["schema"] = std::move(schema);
+        jArray.push_back(std::move(entry));
+    }
+    return jArray.dump(4);
+}
+
+void ItemManager::startCheckpointer(const CheckpointOptions& options) {
+    stopCheckpointer();
+
+    auto sequence = [this]() {
+        std::lock_guard<MeteredMutex> lock(mutex_);
+        return changeSeq_;
+    };
+    auto capture = [this, format = options.format](uint64_t& seq) {
+        Snapshot view;
+        {
+            std::lock_guard<MeteredMutex> lock(mutex_);
+            seq = changeSeq_;
+            view = snapshotLocked();
+        }
+        return encodeSnapshot(*view, format);
+    };
+
+    auto checkpointer = std::make_unique<Checkpointer>(options, std::move(sequence), std::move(capture));
+    std::lock_guard<std::mutex> lock(checkpointerMutex_);
+    checkpointer_ = std::move(checkpointer);
+
+    LOG_CONTEXT(LogLevel::INFO, "Checkpointer started: '" + options.path + "' every " + std::to_string(options.interval.count()) + " ms.", {});
+}
+
+void ItemManager::stopCheckpointer() {
+    std::unique_ptr<Checkpointer> checkpointer;
+    {
+        std::lock_guard<std::mutex> lock(checkpointerMutex_);
+        checkpointer.swap(checkpointer_);
+    }
+    if (checkpointer) {
+        checkpointer->stop();
+        // Keep the final counters readable after stopping.
+        std::lock_guard<std::mutex> lock(checkpointerMutex_);
+        lastCheckpointStats_ = checkpointer->stats();
+    }
+}
+
+void ItemManager::setIoBackend(std::shared_ptr<IoBackend> backend) {
+    std::lock_guard<std::mutex> lock(ioMutex_);
+    io_ = std::move(backend);
+}
+
+std::shared_ptr<IoBackend> ItemManager::ioBackend() const {
+    std::lock_guard<std::mutex> lock(ioMutex_);
+    return io_ ? io_ : IoBackend::shared();
+}
+
+bool ItemManager::startForkedSave(const std::string& filename, CheckpointFormat format) {
+
+    if (filename.empty()) {
+        LOG_CONTEXT(LogLevel::ERR, "Cannot start forked save to empty filename.", {});
+        return false;
+    }
+    if (!ForkedSave::supported()) {
+        LOG_CONTEXT(LogLevel::WARNING, "Forked save is not supported on this platform.", {});
+        return false;
+    }
+
+    std::lock_guard<std::mutex> saveLock(forkedSaveMutex_);
+    if (forkedSave_ && forkedSave_->running()) {
+        LOG_CONTEXT(LogLevel::WARNING, "A forked save is already running; not starting another for: " + filename, {});
+        return false;
+    }
+
+    {
+        // Holding the store lock across fork() guarantees no locked writer is half-way through a
+        // change in the child's image. The child never takes it: it only reads the snapshot.
+        std::lock_guard<MeteredMutex> lock(mutex_);
+        Snapshot view = snapshotLocked();
+        forkedSave_ = ForkedSave::start([this, view, filename, format]() -> std::optional<uint64_t> {
+            const std::string bytes = encodeSnapshot(*view, format);
+            if (!AtomicFileWriter::writeAtomicallyChunked(filename, bytes, 0, nullptr)) return std::nullopt;
+            return bytes.size();
+        });
+    }
+
+    if (!forkedSave_) {
+        LOG_CONTEXT(LogLevel::ERR, "fork() failed; forked save to '" + filename + "' not started.", {});
+        return false;
+    }
+    LOG_CONTEXT(LogLevel::INFO, "Forked save to '" + filename + "' started.", {});
+    return true;
+}
+
+bool ItemManager::isForkedSaveRunning() {
+    std::lock_guard<std::mutex> saveLock(forkedSaveMutex_);
+    return forkedSave_ && forkedSave_->running();
+}
+
+std::optional<ForkedSaveResult> ItemManager::waitForkedSave() {
+    std::lock_guard<std::mutex> saveLock(forkedSaveMutex_);
+    if (!forkedSave_) return std::nullopt;
+    return forkedSave_->wait();
+}
+
+void ItemManager::setMemoryResource(ItemResource resource) {
+    std::lock_guard<MeteredMutex> lock(mutex_);
+    itemResource_ = resource ? std::move(resource) : std::make_shared<std::pmr::synchronized_pool_resource>();
+}
+
+ItemResource ItemManager::memoryResource() const {
+    std::lock_guard<MeteredMutex> lock(mutex_);
+    return itemResource_;
+}
+
+void ItemManager::setExportTagIndex(bool enabled) {
+    exportTagIndex_.store(enabled);
+}
+
+bool ItemManager::isExportTagIndexEnabled() const {
+    return exportTagIndex_.load();
+}
+
+void ItemManager::setMetricsEnabled(bool enabled) {
+    std::lock_guard<std::mutex> lock(metricsMutex_);
+    if (enabled && !metricsRegistry_) metricsRegistry_ = std::make_unique<MetricsRegistry>();
+    metrics_.store(enabled ? metricsRegistry_.get() : nullptr, std::memory_order_release);
+}
+
+bool ItemManager::isMetricsEnabled() const {
+    return activeMetrics() != nullptr;
+}
+
+MetricsSnapshot ItemManager::metrics() const {
+    MetricsSnapshot snapshot;
+    {
+        std::lock_guard<std::mutex> lock(metricsMutex_);
+        if (metricsRegistry_) snapshot = metricsRegistry_->snapshot();
+    }
+    snapshot.enabled = isMetricsEnabled();
+    const MigrationRegistry::Counters migration = migrationRegistry->counters();
+    snapshot.migratedRecords = migration.records;
+    snapshot.migrationSteps = migration.steps;
+    snapshot.migrationChainsBuilt = migration.chainsBuilt;
+    return snapshot;
+}
+
+void ItemManager::resetMetrics() {
+    std::lock_guard<std::mutex> lock(metricsMutex_);
+    if (metricsRegistry_) metricsRegistry_->reset();
+}
+
+bool ItemManager::dumpMetrics(const std::string& filename) const {
+    if (!AtomicFileWriter::writeAtomically(filename, metrics().toJson().dump(4))) {
+        LOG_CONTEXT(LogLevel::ERR, "Failed to write metrics to file: " + filename, false);
+        return false;
+    }
+    return true;
+}
+
+void ItemManager::dumpMetrics(const std::function<void(const MetricsSnapshot&)>& sink) const {
+    if (sink) sink(metrics());
+}
+
+void ItemManager::recordTransfer(MetricOp op, const std::string& filename, size_t items) const {
+    MetricsRegistry* metrics = activeMetrics();
+    if (!metrics) return;
+    std::error_code ec;
+    const auto bytes = std::filesystem::file_size(filename, ec);
+    metrics->recordTransfer(op, ec ? 0 : static_cast<uint64_t>(bytes), items);
+}
+
+void ItemManager::setLazyImport(bool enabled) {
+    std::lock_guard<MeteredMutex> lock(mutex_);
+    lazyImport_ = enabled;
+}
+
+bool ItemManager::isLazyImportEnabled() const {
+    std::lock_guard<MeteredMutex> lock(mutex_);
+    return lazyImport_;
+}
+
+void ItemManager::setDeferredMigration(bool enabled) {
+    std::lock_guard<MeteredMutex> lock(mutex_);
+    deferMigration_ = enabled;
+}
+
+bool ItemManager::isDeferredMigrationEnabled() const {
+    std::lock_guard<MeteredMutex> lock(mutex_);
+    return deferMigration_;
+}
+
+bool ItemManager::isStalePlaceholder(const BaseItem& item) const {
+    auto* lazy = dynamic_cast<const LazyItem*>(&item);
+    return lazy && lazy->version() < migrationRegistry->getLatestVersion(lazy->getTypeName());
+}
+
+size_t ItemManager::pendingMigrations() const {
+    std::lock_guard<MeteredMutex> lock(mutex_);
+    size_t pending = 0;
+    for (const auto& [tag, item] : items) {
+        if (isStalePlaceholder(*item)) ++pending;
+    }
+    return pending;
+}
+
+void ItemManager::startBackgroundMigration(const MigrationTaskOptions& options) {
+    stopBackgroundMigration();
+
+    // Tags to visit are collected by the first batch, and again by the first one after an import
+    // (which takes mutex_, so never overlaps a batch); each later batch takes the next ones, skipping
+    // items that were decoded, replaced or removed in the meantime.
+    auto pending = std::make_shared<std::vector<std::string>>();
+    auto collectedAt = std::make_shared<std::optional<uint64_t>>();
+    auto batch = [this, pending, collectedAt](size_t maxItems) -> std::optional<BackgroundMigrator::BatchResult> {
+        std::unique_lock<MeteredMutex> lock(mutex_, std::try_to_lock);
+        if (!lock.owns_lock()) return std::nullopt;
+
+        if (*collectedAt != importGeneration_) {
+            pending->clear();
+            for (const auto& [tag, item] : items) {
+                if (isStalePlaceholder(*item)) pending->push_back(tag);
+            }
+            *collectedAt = importGeneration_;
+        }
+
+        BackgroundMigrator::BatchResult result;
+        while (!pending->empty() && result.migrated + result.failed < maxItems) {
+            auto it = items.find(pending->back());
+            pending->pop_back();
+            if (it == items.end() || !isStalePlaceholder(*it->second)) continue;
+            if (materialize(it) == items.end()) {
+                ++result.failed;
+            } else {
+                ++result.migrated;
+            }
+        }
+        result.done = pending->empty();
+        return result;
+    };
+
+    auto migrator = std::make_shared<BackgroundMigrator>(options, std::move(batch));
+    std::lock_guard<std::mutex> lock(migratorMutex_);
+    migrator_ = std::move(migrator);
+}
+
+void ItemManager::stopBackgroundMigration() {
+    std::shared_ptr<BackgroundMigrator> migrator;
+    {
+        std::lock_guard<std::mutex> lock(migratorMutex_);
+        migrator.swap(migrator_);
+    }
+    if (migrator) {
+        migrator->stop();
+        std::lock_guard<std::mutex> lock(migratorMutex_);
+        lastMigrationStats_ = migrator->stats();
+    }
+}
+
+void ItemManager::waitBackgroundMigration() {
+    std::shared_ptr<BackgroundMigrator> migrator;
+    {
+        std::lock_guard<std::mutex> lock(migratorMutex_);
+        migrator = migrator_;
+    }
+    if (migrator) migrator->wait();
+}
+
+MigrationTaskStats ItemManager::backgroundMigrationStats() const {
+    std::lock_guard<std::mutex> lock(migratorMutex_);
+    return migrator_ ? migrator_->stats() : lastMigrationStats_;
+}
+
+bool ItemManager::enableMappedStore(const std::string& path) {
+    std::lock_guard<MeteredMutex> lock(mutex_);
+
+    std::unique_ptr<MappedItemStore> store;
+    try {
+        store = std::make_unique<MappedItemStore>(path);
+    } catch (const std::exception& e) {
+        LOG_CONTEXT(LogLevel::ERR, "Cannot open mapped store '" + path + "': " + e.what(), {});
+        return false;
+    }
+
+    if (mapped_) {
+        flushMappedDirty();
+        mapped_.reset();
+    }
+    mapped_ = std::move(store);
+    for (const auto& [tag, _] : items) writeMapped(tag);
+    if (snapshot_) {
+        snapshot_.reset();   // rebuilt with the items of the file on next use
+        snapshotStale_.clear();
+        spare_.reset();
+        spareStale_.clear();
+    }
+
+    const MappedStoreStats stats = mapped_->stats();
+    LOG_CONTEXT(LogLevel::INFO, "Mapped store '" + path + "' opened with " + std::to_string(stats.records) + " items"
+                                 + (stats.indexRebuilt ? " (index rebuilt)." : "."), {});
+    return true;
+}
+
+void ItemManager::disableMappedStore() {
+    std::lock_guard<MeteredMutex> lock(mutex_);
+    if (!mapped_) return;
+
+    flushMappedDirty();
+    std::vector<std::string> mappedOnly;
+    mapped_->forEach([&](const MappedRecord& record) {
+        std::string tag(record.tag);
+        if (items.find(tag) == items.end()) mappedOnly.push_back(std::move(tag));
+    });
+    for (const auto& tag : mappedOnly) findOrLoad(tag);
+    mapped_.reset();
+}
+
+bool ItemManager::isMappedStoreEnabled() const {
+    std::lock_guard<MeteredMutex> lock(mutex_);
+    return mapped_ != nullptr;
+}
+
+void ItemManager::syncMappedStore() {
+    std::lock_guard<MeteredMutex> lock(mutex_);
+    if (!mapped_) return;
+    flushMappedDirty();
+    mapped_->sync();
+}
+
+void ItemManager::compactMappedStore() {
+    std::lock_guard<MeteredMutex> lock(mutex_);
+    if (!mapped_) return;
+    flushMappedDirty();
+    mapped_->compact();
+}
+
+std::optional<MappedStoreStats> ItemManager::mappedStoreStats() const {
+    std::lock_guard<MeteredMutex> lock(mutex_);
+    if (!mapped_) return std::nullopt;
+    return mapped_->stats();
+}
+
+bool ItemManager::enableSegmentLog(const std::string& directory, SegmentLogOptions options) {
+    std::shared_ptr<SegmentLog> log;
+    try {
+        log = std::make_shared<SegmentLog>(directory, options);
+    } catch (const std::exception& e) {
+        LOG_CONTEXT(LogLevel::ERR, "Cannot open segment log '" + directory + "': " + e.what(), {});
+        return false;
+    }
+
+    std::lock_guard<MeteredMutex> lock(mutex_);
+    segmentLog_.reset();
+    segmentDirty_.clear();
+
+    // Load what the log holds (nothing is appended while segmentLog_ is unset)...
+    std::unordered_set<std::string> logged;
+    size_t loaded = 0;
+    TypeDispatch dispatch(*this);
+    for (const auto& tag : log->tags()) {
+        logged.insert(tag);
+        auto record = log->read(tag);
+        const TypeSlot* slot = record ? dispatch.find(record->type) : nullptr;
+        if (!slot) {
+            LOG_CONTEXT(LogLevel::WARNING, "Logged item '" + tag + "' has an unregistered type" +
+                                             (record ? ": " + demangleType(record->type) : std::string()) + "; skipped.", {});
+            continue;
+        }
+        try {
+            auto item = slot->factory(json::from_msgpack(record->payload), itemResource_);
+            auto existing = items.find(tag);
+            if (existing != items.end()) idMap.erase(existing->second->getId());
+            idMap[item->getId()] = item;
+            items[tag] = std::move(item);
+            markChanged(tag);
+            ++loaded;
+        } catch (const std::exception& e) {
+            LOG_CONTEXT(LogLevel::WARNING, "Cannot decode logged item '" + tag + "': " + e.what(), {});
+        }
+    }
+
+    // ...then append what only memory holds.
+    segmentLog_ = std::move(log);
+    for (const auto& [tag, _] : items) {
+        if (logged.find(tag) == logged.end()) appendSegment(tag);
+    }
+
+    const SegmentLogStats stats = segmentLog_->stats();
+    LOG_CONTEXT(LogLevel::INFO, "Segment log '" + directory + "' opened: " + std::to_string(loaded) + " items loaded from "
+                                 + std::to_string(stats.segments) + " segments (" + std::to_string(stats.footersRead)
+                                 + " indexed from footers).", {});
+    return true;
+}
+
+void ItemManager::disableSegmentLog() {
+    std::shared_ptr<SegmentLog> log;
+    {
+        std::lock_guard<MeteredMutex> lock(mutex_);
+        if (segmentLog_) flushSegmentDirty();
+        log = std::move(segmentLog_);
+    }
+    if (log) log->sync();
+}
+
+bool ItemManager::compactSegmentLog() {
+    std::shared_ptr<SegmentLog> log;
+    {
+        std::lock_guard<MeteredMutex> lock(mutex_);
+        if (segmentLog_) flushSegmentDirty();
+        log = segmentLog_;
+    }
+    // The merge runs without the store lock; writers keep appending meanwhile.
+    return log && log->compact();
+}
+
+std::optional<SegmentLogStats> ItemManager::segmentLogStats() const {
+    std::lock_guard<MeteredMutex> lock(mutex_);
+    if (!segmentLog_) return std::nullopt;
+    return segmentLog_->stats();
+}
+
+CheckpointStats ItemManager::checkpointerStats() const {
+    std::lock_guard<std::mutex> lock(checkpointerMutex_);
+    return checkpointer_ ? checkpointer_->stats() : lastCheckpointStats_;
+}
+
+bool ItemManager::checkpointToFile(const std::string& snapshotFile) {
+    const ScopedOperation timed(activeMetrics(), MetricOp::Checkpoint);
+
+    if (snapshotFile.empty()) {
+        LOG_CONTEXT(LogLevel::ERR, "Cannot checkpoint to empty filename.", {});
+        return false;
+    }
+
+    std::shared_ptr<WriteAheadLog> wal;
+    uint64_t walSeq = 0;
+    size_t count = 0;
+    Snapshot view;
+    {
+        // Every store change (undo/redo, imports and deltas included) appends its records under
+        // this lock, and pending getItemRaw writes are appended just below, so `items` holds exactly
+        // the state the log describes up to lastSequence().
+        std::lock_guard<MeteredMutex> lock(mutex_);
+        appendWalRecords({});
+        wal = wal_;
+        if (wal) {
+            walSeq = wal->lastSequence();
+            wal->rotate();   // swaps files only; the covered records are dropped with the sealed file
+        }
+        view = snapshotLocked();
+    }
+    count = view->size();
+
+    // Both files must be on disk before log records are dropped, hence the durable writes.
+    const bool written = AtomicFileWriter::writeAtomicallyStreamed(snapshotFile, [&](AtomicFileWriter::Sink& sink) {
+        std::string record;
+        for (const auto& [tag, item] : *view) {
+            if (!item) continue;
+            record.clear();
+            appendSnapshotRecord(record, tag, *item);
+            if (!sink.write(record)) return false;
+        }
+        return true;
+    }, AtomicWriteOptions{true});
+
+    if (!written) {
+        LOG_CONTEXT(LogLevel::ERR, "Failed to write snapshot: " + snapshotFile, {});
+        return false;
+    }
+
+    json manifest = {{"format", "binary"}, {"walSequence", walSeq}, {"items", count}};
+    if (!AtomicFileWriter::writeAtomically(snapshotFile + ".manifest", manifest.dump(4), AtomicWriteOptions{true})) {
+        LOG_CONTEXT(LogLevel::ERR, "Failed to write snapshot manifest for: " + snapshotFile, {});
+        return false;
+    }
+
+    // Replaying a record the snapshot already covers is harmless (records carry full state),
+    // so the sealed log file is only deleted once both files are in place.
+    if (wal && walSeq > 0) {
+        wal->truncateThrough(walSeq);
+    }
+
+    LOG_CONTEXT(LogLevel::INFO, "Checkpoint of " + std::to_string(count) + " item(s) written to '" + snapshotFile
+                                + "' at log sequence " + std::to_string(walSeq) + ".", {});
+    return true;
+}
+
+bool ItemManager::recoverFromSnapshot(const std::string& snapshotFile, const std::string& walFile, unsigned threads) {
+    const ScopedOperation timed(activeMetrics(), MetricOp::Recover);
+
+    const auto started = std::chrono::steady_clock::now();
+
+    // The store is being rebuilt, so hold the lock throughout; the worker threads below only
+    // read the type registries on behalf of this thread.
+    std::lock_guard<MeteredMutex> lock(mutex_);
+
+    uint64_t snapshotSeq = 0;
+    std::ifstream manifestIn(snapshotFile + ".manifest");
+    if (manifestIn) {
+        try {
+            json manifest;
+            manifestIn >> manifest;
+            snapshotSeq = manifest.value("walSequence", uint64_t{0});
+        } catch (const std::exception& e) {
+            LOG_CONTEXT(LogLevel::WARNING, "Ignoring unreadable snapshot manifest, replaying the whole log: " + std::string(e.what()), {});
+        }
+    }
+
+    struct RecoveryRecord {
+        std::string_view tag;
+        std::string_view type;
+        std::string_view payload;
+        bool msgpack = false;
+        bool removed = false;
+    };
+
+    std::vector<RecoveryRecord> records;
+    std::unordered_map<std::string_view, size_t> latest;  // tag -> index of its newest record
+    size_t superseded = 0;
+
+    auto addRecord = [&](const RecoveryRecord& record) {
+        auto [it, inserted] = latest.try_emplace(record.tag, records.size());
+        if (!inserted) {
+            it->second = records.size();
+            ++superseded;
+        }
+        records.push_back(record);
+    };
+
+    // 1. Snapshot records (binary export layout), referenced in place.
+    std::string snapshotImage;
+    if (auto content = ioBackend()->readFile(snapshotFile)) {
+        snapshotImage = std::move(*content);
+    } else {
+        LOG_CONTEXT(LogLevel::WARNING, "No snapshot found at '" + snapshotFile + "' — recovering from the log only.", {});
+    }
+
+    size_t snapshotRecords = 0;
+    const char* p = snapshotImage.data();
+    const char* end = p + snapshotImage.size();
+    auto readField = [&](std::string_view& field) {
+        uint32_t size = 0;
+        if (static_cast<size_t>(end - p) < sizeof(size)) return false;
+        std::memcpy(&size, p, sizeof(size));
+        p += sizeof(size);
+        if (static_cast<size_t>(end - p) < size) return false;
+        field = std::string_view(p, size);
+        p += size;
+        return true;
+    };
+    while (p < end) {
+        RecoveryRecord record;
+        if (!readField(record.type) || !readField(record.tag) || !readField(record.payload)) {
+            LOG_CONTEXT(LogLevel::WARNING, "Snapshot '" + snapshotFile + "' ends with a truncated record — ignoring it.", {});
+            break;
+        }
+        addRecord(record);
+        ++snapshotRecords;
+    }
+
+    // 2. Log tail: records newer than the snapshot. A deque keeps the strings the views point into in place.
+    std::deque<WalRecord> walRecords;
+    WriteAheadLog::replay(walFile, [&](WalRecord&& record) {
+        if (record.seq <= snapshotSeq) return;
+        walRecords.push_back(std::move(record));
+        const WalRecord& stored = walRecords.back();
+        addRecord({stored.tag, stored.type, stored.payload, true, stored.op == WalOp::Remove});
+    });
+
+    // 3. Decode the surviving record of each tag, sharded by tag across workers.
+
+    std::vector<size_t> live;
+    live.reserve(latest.size());
+    for (const auto& [tag, index] : latest) {
+        if (!records[index].removed) live.push_back(index);
+    }
+
+    size_t workerCount = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+    workerCount = std::max<size_t>(1, std::min(workerCount, live.size() / 256 + 1));
+
+    std::vector<std::vector<std::shared_ptr<BaseItem>>> shards(workerCount);
+    std::atomic<size_t> skipped{0};
+    std::mutex migrationMutex;
+
+    auto decodeShard = [&](size_t shard) {
+        std::hash<std::string_view> hasher;
+        TypeDispatch dispatch(*this);   // read-only over the type table, one per worker
+        for (size_t index : live) {
+            const RecoveryRecord& record = records[index];
+            if (hasher(record.tag) % workerCount != shard) continue;
+
+            const TypeSlot* slot = dispatch.find(record.type);
+            if (!slot) {
+                ++skipped;
+                continue;
+            }
+            try {
+                json j = record.msgpack ? json::from_msgpack(record.payload.begin(), record.payload.end())
+                                        : json::parse(record.payload.begin(), record.payload.end());
+                const std::string typeName(record.type);
+                int version = j.is_object() ? j.value("version", 1) : 1;
+                if (version < migrationRegistry->getLatestVersion(typeName)) {
+                    std::lock_guard<std::mutex> migrationLock(migrationMutex);
+                    migrationRegistry->upgradeInPlace(typeName, version, j);
+                }
+                if (auto item = slot->factory(j, itemResource_)) {
+                    shards[shard].push_back(std::move(item));
+                } else {
+                    ++skipped;
+                }
+            } catch (const std::exception&) {
+                ++skipped;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t shard = 1; shard < workerCount; ++shard) workers.emplace_back(decodeShard, shard);
+    decodeShard(0);
+    for (auto& worker : workers) worker.join();
+
+    // 4. Swap the recovered state in.
+    State recovered;
+    recovered.reserve(live.size());
+    for (auto& shard : shards) {
+        for (auto& item : shard) {
+            std::string tag = item->getTag();
+            recovered.emplace(std::move(tag), std::move(item));
+        }
+    }
+
+    undoHistory.push_back({cloneCurrentState(), {}});
+    redoQueue = {};
+    markCleared();
+    items = std::move(recovered);
+    for (const auto& [tag, item] : items) markChanged(tag);
+    idMap.clear();
+    for (const auto& [tag, item] : items) idMap[item->getId()] = item;
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+    LOG_CONTEXT(LogLevel::INFO, "Recovered " + std::to_string(items.size()) + " item(s) from '" + snapshotFile + "' ("
+                                + std::to_string(snapshotRecords) + " snapshot record(s), " + std::to_string(walRecords.size())
+                                + " log record(s), " + std::to_string(superseded) + " superseded, " + std::to_string(skipped.load())
+                                + " skipped) in " + std::to_string(elapsed.count()) + " ms on " + std::to_string(workerCount) + " thread(s).", {});
+    return true;
+}
+
 void ItemManager::listRegisteredTypes() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<MeteredMutex> lock(mutex_);
     
     std::cout << Logger::getColorCode(LogColor::CYAN) +":::| Registered Types:\n" + Logger::getColorCode(LogColor::RESET);
     for (const auto& entry : registeredTypes) {
-        std::cout << " - " << demangleType(entry.first) << std::endl;
+        std::cout << " - " << demangleType(entry.second.name()) << std::endl;
     }
 }
 
 void ItemManager::filterByTag(const std::vector<std::string>& tags) const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    const ScopedOperation timed(activeMetrics(), MetricOp::FilterByTag);
+    std::lock_guard<MeteredMutex> lock(mutex_);
 
     std::cout << Logger::getColorCode(LogColor::CYAN)
               << "\n ::::::| Items filtered by tags |::::::\n"
@@ -1689,7 +3594,8 @@ void ItemManager::filterByTag(const std::vector<std::string>& tags) const {
 }
 
 void ItemManager::sortItemsByTag() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    const ScopedOperation timed(activeMetrics(), MetricOp::SortItemsByTag);
+    std::lock_guard<MeteredMutex> lock(mutex_);
    
     if (items.empty()) {
         LOG_CONTEXT(LogLevel::INFO, "No items to sort by tag.", {});
@@ -1712,7 +3618,7 @@ void ItemManager::sortItemsByTag() const {
 }
 
 void ItemManager::displayAllClasses() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<MeteredMutex> lock(mutex_);
 
     std::unordered_map<std::string, int> classCounts;
 
@@ -1733,7 +3639,7 @@ void ItemManager::displayAllClasses() const {
 }
 
 const std::unordered_map<std::string, std::shared_ptr<BaseItem>>& ItemManager::getItemMapStore() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<MeteredMutex> lock(mutex_);
     return items;
 }
 
@@ -0,0 +1,94 @@
+#pragma once
+#ifndef TYPE_REGISTRATION_H
+#define TYPE_REGISTRATION_H
+
+#include "utils/TypeId.hpp"
+#include "versionForMigration/MigrationRegistry.h"
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+class ItemManager;
+
+// :::TypeRegistration class
+// :::Process-wide list of the types declared with SMART_STORE_REGISTER_TYPE, filled during static
+// :::initialization. Every ItemManager installs them all when it is constructed (deserializer slot,
+// :::schema, latest version and migrations), so addItem is left with one integer check per call.
+// :::A type first seen by a manager later (addItem/emplace of a type with no declaration, or a
+// :::manager built before its declaration ran) is installed then, migrations included. Tools that
+// :::only move records (smartstore-convert) take the migrations alone, with installMigrations.
+// **************************************************************************************************
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+class TypeRegistration {
+    public:
+        using Installer = void (*)(ItemManager&);
+
+        struct Entry {
+            TypeId id = 0;
+            std::string wireName;   // the type name records carry
+            Installer install = nullptr;
+            int latestVersion = 1;
+            // migrations[i] upgrades a record from version i + 1 to i + 2.
+            std::vector<MigrationRegistry::Step> migrations;
+
+            // Registers the latest version and the migrations under the wire name.
+            void installMigrations(MigrationRegistry& registry) const {
+                registry.registerVersion(wireName, latestVersion);
+                for (size_t step = 0; step < migrations.size(); ++step) {
+                    registry.registerStep(wireName, static_cast<int>(step) + 1, migrations[step]);
+                }
+            }
+        };
+
+        static bool add(Entry entry) {
+            std::lock_guard<std::mutex> lock(mutex());
+            entries().push_back(std::move(entry));
+            return true;
+        }
+
+        static std::optional<Entry> find(TypeId id) {
+            std::lock_guard<std::mutex> lock(mutex());
+            for (const auto& entry : entries()) {
+                if (entry.id == id) return entry;
+            }
+            return std::nullopt;
+        }
+
+        static std::vector<Entry> all() {
+            std::lock_guard<std::mutex> lock(mutex());
+            return entries();
+        }
+
+        // The versions and migrations of every declared type, without any ItemManager.
+        static void installMigrations(MigrationRegistry& registry) {
+            for (const auto& entry : all()) entry.installMigrations(registry);
+        }
+
+    private:
+        static std::vector<Entry>& entries() {
+            static std::vector<Entry> list;
+            return list;
+        }
+
+        static std::mutex& mutex() {
+            static std::mutex m;
+            return m;
+        }
+};
+
+#define SMART_STORE_CONCAT_IMPL(a, b) a##b
+#define SMART_STORE_CONCAT(a, b) SMART_STORE_CONCAT_IMPL(a, b)
+
+// Declares T at namespace scope, once per process: its current version (a constant) and the
+// migrations that bring older records up to it, in order (the first upgrades version 1 to 2), each
+// either `void(json&)` (in place) or `json(const json&)`. Records written without a version are
+// read as version 1, so each step should leave data that already has its change as it is. A type
+// name containing commas needs an alias.
+//     SMART_STORE_REGISTER_TYPE(User, 3, addAge, addEmail);
+#define SMART_STORE_REGISTER_TYPE(T, version, ...)                                              \
+    [[maybe_unused]] static const bool SMART_STORE_CONCAT(smartStoreTypeRegistered_, __COUNTER__) = \
+        ItemManager::declareType<T, version>(__VA_ARGS__)
+
+#endif // TYPE_REGISTRATION_H
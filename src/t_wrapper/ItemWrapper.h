@@ -12,6 +12,7 @@
 #include "interface/BaseItem.h"
 #include <iostream>
 #include <memory>
+#include <utility>
 #include <atomic>
 #include <string>
 #include <type_traits> 
@@ -23,6 +24,7 @@
 #include "versionForMigration/MigrationRegistry.h"
 #include "err_log/Logger.hpp"
 #include "utils/Json_traits.hpp"
+#include "utils/ItemAllocator.hpp"
 #include <cstdlib>    // for free()
 
 
@@ -44,20 +46,15 @@ namespace IdProvider {
         static std::random_device rd;
         static std::mt19937 gen(rd());
         static std::uniform_int_distribution<> dis(0, 15);
+        static constexpr char hex[] = "0123456789abcdef";
 
-        std::stringstream ss;
-        ss << "obj_";
-        for (int i = 0; i < 8; ++i) ss << std::hex << dis(gen);
-        ss << '-';
-        for (int i = 0; i < 4; ++i) ss << std::hex << dis(gen);
-        ss << "-4"; // UUID version 4
-        for (int i = 0; i < 3; ++i) ss << std::hex << dis(gen);
-        ss << '-';
-        ss << std::hex << ((dis(gen) & 0x3) | 0x8); // UUID variant (8, 9, A, B)
-        for (int i = 0; i < 3; ++i) ss << std::hex << dis(gen);
-        ss << '-';
-        for (int i = 0; i < 12; ++i) ss << std::hex << dis(gen);
-        return ss.str();
+        // obj_xxxxxxxx-xxxx-4xxx-yxxx-xxxxxxxxxxxx, built in place: one allocation, for the result.
+        char id[] = "obj_xxxxxxxx-xxxx-4xxx-yxxx-xxxxxxxxxxxx";
+        for (char& c : id) {
+            if (c == 'x') c = hex[dis(gen)];
+            else if (c == 'y') c = hex[(dis(gen) & 0x3) | 0x8]; // UUID variant (8, 9, A, B)
+        }
+        return std::string(id, sizeof(id) - 1);
     }
 }
 
@@ -67,6 +64,7 @@ class ItemWrapper : public BaseItem {
 private:
     std::shared_ptr<T> data;
     std::string tag;
+    ItemResource resource_;   // where clones (and payloads built from json) are allocated; nullptr = default
 
     std::string demangleType(const std::string& mangledName) const{
         #if defined(__GNUC__) || defined(__clang__)
@@ -96,11 +94,11 @@ mutable std::string id_; // Unique ID for each item, mutable to allow modificati
 
 public:
 public:
-    ItemWrapper(std::shared_ptr<T> obj, const std::string& tag = "")
-         : data(std::move(obj)), tag(tag),id_(IdProvider::generateId()) {} 
+    ItemWrapper(std::shared_ptr<T> obj, const std::string& tag = "", ItemResource resource = nullptr)
+         : data(std::move(obj)), tag(tag), resource_(std::move(resource)), id_(IdProvider::generateId()) {} 
 
-    ItemWrapper(const nlohmann::json& j) {
-        data = std::make_shared<T>();
+    ItemWrapper(const nlohmann::json& j, ItemResource resource = nullptr) : resource_(std::move(resource)) {
+        data = std::allocate_shared<T>(ItemAllocator<T>(resource_));
 
         // Assign id
         id_ = j.contains("id") && !j.at("id").get<std::string>().empty()
@@ -150,6 +148,8 @@ public:
 
     std::shared_ptr<BaseItem> clone() const override;
 
+    std::shared_ptr<BaseItem> cloneForWrite() const override;
+
     std::string getTag() const override;
 
      T& getData();
@@ -163,6 +163,33 @@ public:
     static std::string friendlyName;
 };
 
+
+// :: Payload stored inside its wrapper's own allocation
+// ****************************************************
+// Built with std::allocate_shared, control block, wrapper and T share a single allocation. The
+// wrapper's `data` pointer is a non-owning alias of `value`, whose lifetime is the wrapper's.
+// Used by ItemManager::emplaceItem and friends, and by clone()/cloneForWrite().
+
+template<typename T>
+struct InlinePayload {
+    T value;
+
+    template<typename... Args>
+    explicit InlinePayload(std::in_place_t, Args&&... args) : value(std::forward<Args>(args)...) {}
+};
+
+template<typename T>
+class InlineItemWrapper : private InlinePayload<T>, public ItemWrapper<T> {
+public:
+    template<typename... Args>
+    InlineItemWrapper(const std::string& tag, ItemResource resource, Args&&... args)
+        : InlinePayload<T>(std::in_place, std::forward<Args>(args)...),
+          ItemWrapper<T>(std::shared_ptr<T>(std::shared_ptr<T>(), &this->value), tag, std::move(resource)) {}
+
+    InlineItemWrapper(const InlineItemWrapper&) = delete;
+    InlineItemWrapper& operator=(const InlineItemWrapper&) = delete;
+};
+
 #include "ItemWrapper.tpp"  // Template definitions should be included at the end of the header
 
 
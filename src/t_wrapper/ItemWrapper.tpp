@@ -117,7 +117,16 @@ json ItemWrapper<T>::serialize() const {
 
 template<typename T>
 std::shared_ptr<BaseItem> ItemWrapper<T>::clone() const {
-    return std::make_shared<ItemWrapper<T>>(std::make_shared<T>(*data), tag);
+    // One allocation: the copy of the payload lives inside the new wrapper.
+    return std::allocate_shared<InlineItemWrapper<T>>(ItemAllocator<InlineItemWrapper<T>>(resource_), tag, resource_, *data);
+}
+
+template<typename T>
+std::shared_ptr<BaseItem> ItemWrapper<T>::cloneForWrite() const {
+    std::shared_ptr<ItemWrapper<T>> copy =
+        std::allocate_shared<InlineItemWrapper<T>>(ItemAllocator<InlineItemWrapper<T>>(resource_), tag, resource_, *data);
+    copy->id_ = id_;
+    return copy;
 }
 
 template<typename T>
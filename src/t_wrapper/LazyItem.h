@@ -0,0 +1,117 @@
+
+//     ::::::::::::::::::::::::::::::::::::::::::::
+//     :: *  © 2025 Victor. All rights reserved. ::
+//     :: *  Smart_Store Framework               ::
+//     :: *  Licensed under the MIT License      ::
+//     ::::::::::::::::::::::::::::::::::::::::::::
+
+#pragma once
+#ifndef LAZY_ITEM_H
+#define LAZY_ITEM_H
+
+#include "interface/BaseItem.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+// :::LazyItem class
+// :::Placeholder left in the store by a lazy import: it keeps the record exactly as it was read
+// :::(the item's serialize() output as JSON text, with "version" when it is not 1) and builds the
+// :::real ItemWrapper<T> only when first asked for it. The decoder, supplied by ItemManager, applies
+// :::the pending migrations and the type's factory; it runs at most once per placeholder.
+// :::Copies share the raw bytes, so undo history and snapshots of untouched items cost nothing,
+// :::and exporters copy raw() straight through instead of decoding.
+// **************************************************************************************************
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+class LazyItem : public BaseItem {
+public:
+    // Gets the parsed record to upgrade and decode in place.
+    using Decoder = std::function<std::shared_ptr<BaseItem>(json&)>;
+
+    // `version` is the record's schema version, 0 if the importer did not read it. Whatever the
+    // importer did not supply is read from the record here, so both stay fixed for the item's life.
+    LazyItem(std::string tag, std::string typeName, std::shared_ptr<const std::string> raw,
+             Decoder decoder, std::string id = "", int version = 0)
+        : tag_(std::move(tag)), typeName_(std::move(typeName)), raw_(std::move(raw)),
+          decoder_(std::move(decoder)), id_(std::move(id)), version_(version) {
+        if (id_.empty() || version_ <= 0) readHeader();
+    }
+
+    // Decodes the record on first call and returns the same item afterwards. Throws if the record
+    // cannot be parsed or decoded (a later call tries again).
+    std::shared_ptr<BaseItem> materialize() const {
+        std::call_once(decodeOnce_, [this] {
+            json j = json::parse(*raw_);
+            if (!j.contains("id")) j["id"] = getId();
+            auto item = decoder_ ? decoder_(j) : nullptr;
+            if (!item) throw std::runtime_error("No decoder produced an item for tag '" + tag_ + "'.");
+            decoded_ = std::move(item);
+            decodedFlag_.store(true, std::memory_order_release);
+        });
+        return decoded_;
+    }
+
+    bool isDecoded() const { return decodedFlag_.load(std::memory_order_acquire); }
+
+    // The record as imported.
+    const std::string& raw() const { return *raw_; }
+
+    // raw() parsed, without migrating or decoding it.
+    json rawJson() const { return json::parse(*raw_); }
+
+    void display() const override { materialize()->display(); }
+
+    std::string getTypeName() const override { return typeName_; }
+
+    json serialize() const override { return materialize()->serialize(); }
+
+    // A fresh placeholder over the same bytes. The decoded item is never written to while a
+    // placeholder holds it (ItemManager swaps in the decoded item before any write), so the raw
+    // bytes still describe it, and the copy keeps the id like ItemWrapper::cloneForWrite.
+    std::shared_ptr<BaseItem> clone() const override {
+        return std::make_shared<LazyItem>(tag_, typeName_, raw_, decoder_, getId(), version());
+    }
+
+    std::string getTag() const override { return tag_; }
+
+    nlohmann::json toJson() const override { return serialize(); }
+
+    // The record's "id" (legacy binary records without one fall back to the tag, as the eager
+    // importer does).
+    std::string getId() const override { return id_; }
+
+    // The version the record was written with (its "version" field, 1 if it has none).
+    int version() const { return version_; }
+
+private:
+    std::string tag_;
+    std::string typeName_;
+    std::shared_ptr<const std::string> raw_;
+    Decoder decoder_;
+
+    mutable std::once_flag decodeOnce_;
+    mutable std::shared_ptr<BaseItem> decoded_;
+    mutable std::atomic<bool> decodedFlag_{false};
+
+    std::string id_;
+    int version_ = 0;
+
+    // Fills in id_ and version_ from the top level of the record, keeping nothing else of it.
+    void readHeader() {
+        const json header = json::parse(*raw_, [](int depth, json::parse_event_t event, json& parsed) {
+            if (depth == 1 && event == json::parse_event_t::key) return parsed == "id" || parsed == "version";
+            return true;
+        }, false);
+        if (id_.empty()) id_ = (header.is_object() && header.contains("id") && header["id"].is_string()) ? header["id"].get<std::string>() : tag_;
+        if (version_ <= 0) version_ = (header.is_object() && header.contains("version") && header["version"].is_number_integer()) ? header["version"].get<int>() : 1;
+    }
+};
+
+#endif // LAZY_ITEM_H
@@ -0,0 +1,101 @@
+
+//     ::::::::::::::::::::::::::::::::::::::::::::
+//     :: *  © 2025 Victor. All rights reserved. ::
+//     :: *  Smart_Store Framework               ::
+//     :: *  Licensed under the MIT License      ::
+//     ::::::::::::::::::::::::::::::::::::::::::::
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+//::::: Allocation counting
+//*************************
+// Counts heap allocations, per thread, through replacements of the global operator new/delete.
+// The replacements are compiled into the one translation unit that defines SMARTSTORE_ALLOCATION_HOOK
+// before including this header (the test binary and the benchmarks do); elsewhere only the counters
+// exist and stay at zero. Allocations through a pmr resource are counted when the resource goes to the
+// heap, not when it hands out a block it already has. Over-aligned new is not counted.
+//
+//     AllocationScope scope;
+//     manager.getItemRaw<int>("a");
+//     scope.counted().allocations;   // heap allocations made by this thread since `scope` was created
+
+struct AllocationCount {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+    uint64_t deallocations = 0;
+};
+
+inline thread_local AllocationCount threadAllocations;
+
+// Set in a binary built with the hook, i.e. when counts mean anything.
+inline bool allocationCountingEnabled = false;
+
+class AllocationScope {
+public:
+    AllocationScope() noexcept : start_(threadAllocations) {}
+
+    // Counted on this thread since construction (or the last reset).
+    AllocationCount counted() const noexcept {
+        const AllocationCount& now = threadAllocations;
+        return {now.allocations - start_.allocations, now.bytes - start_.bytes, now.deallocations - start_.deallocations};
+    }
+
+    void reset() noexcept { start_ = threadAllocations; }
+
+private:
+    AllocationCount start_;
+};
+
+#ifdef SMARTSTORE_ALLOCATION_HOOK
+
+namespace allocation_hook {
+
+    static const bool installed = (allocationCountingEnabled = true);
+
+    inline void* allocate(std::size_t size) {
+        for (;;) {
+            if (void* p = std::malloc(size ? size : 1)) {
+                AllocationCount& count = threadAllocations;
+                ++count.allocations;
+                count.bytes += size;
+                return p;
+            }
+            std::new_handler handler = std::get_new_handler();
+            if (!handler) throw std::bad_alloc();
+            handler();
+        }
+    }
+
+    inline void* allocateNothrow(std::size_t size) noexcept {
+        try {
+            return allocate(size);
+        } catch (...) {
+            return nullptr;
+        }
+    }
+
+    inline void release(void* p) noexcept {
+        if (!p) return;
+        ++threadAllocations.deallocations;
+        std::free(p);
+    }
+
+}  // namespace allocation_hook
+
+void* operator new(std::size_t size) { return allocation_hook::allocate(size); }
+void* operator new[](std::size_t size) { return allocation_hook::allocate(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return allocation_hook::allocateNothrow(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocation_hook::allocateNothrow(size); }
+
+void operator delete(void* p) noexcept { allocation_hook::release(p); }
+void operator delete[](void* p) noexcept { allocation_hook::release(p); }
+void operator delete(void* p, std::size_t) noexcept { allocation_hook::release(p); }
+void operator delete[](void* p, std::size_t) noexcept { allocation_hook::release(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { allocation_hook::release(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { allocation_hook::release(p); }
+
+#endif // SMARTSTORE_ALLOCATION_HOOK
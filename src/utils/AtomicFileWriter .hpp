@@ -6,44 +6,327 @@
 //     ::::::::::::::::::::::::::::::::::::::::::::
 
 #pragma once
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
 #include <fstream>
+#include <functional>
 #include <string>
-#include <filesystem>
+#include <string_view>
 #include <system_error>
+#include <vector>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
 
 //::::: AtomicFileWriter class
 //****************************
+// Writes go to a temporary file that is renamed over the target only once complete, so readers
+// see either the old or the new file. On POSIX the file is written with plain write()/writev()
+// straight from the caller's buffers. On Linux the temporary is an anonymous O_TMPFILE that is
+// linked in at commit (copied to a named temporary if /proc cannot link it); elsewhere it gets a
+// name unique to the process and call, so concurrent writers of the same target never share a
+// temporary. Files are created 0666 and the process umask applies, like any file the program opens.
+
+struct AtomicWriteOptions {
+    bool durable = false;       // fdatasync the file before the rename and fsync the directory after it
+    uint64_t expectedSize = 0;  // when known, reserve the blocks up front (fallocate)
+};
 
 class AtomicFileWriter {
 public:
 
-    // Writes a string atomically to a file
-    static bool writeAtomically(const std::string& targetFilename, const std::string& content) {
-        std::string tempFilename = targetFilename + ".tmp";
+    //::::: Sink: streaming target of one atomic write
+    // Abandoned (temporary removed, target untouched) unless commit() succeeds.
+    class Sink {
+    public:
+        Sink(const std::string& targetFilename, AtomicWriteOptions options = {})
+            : target_(targetFilename), options_(options) {
+            open();
+        }
+
+        ~Sink() { abandon(); }
+
+        Sink(const Sink&) = delete;
+        Sink& operator=(const Sink&) = delete;
+
+        bool ok() const { return ok_; }
+
+#if !defined(_WIN32)
+        // Descriptor of the temporary, for callers issuing their own positional writes (pwrite,
+        // io_uring) before commit(). Not opened with O_APPEND.
+        int fd() const { return fd_; }
+#endif
+
+        // Small pieces are gathered in a buffer; large ones go to the file directly (no copy).
+        bool write(std::string_view data) {
+            if (!ok_) return false;
+            if (buffer_.size() + data.size() <= kBufferSize) {
+                buffer_.append(data.data(), data.size());
+                return true;
+            }
+            const std::string_view pieces[2] = {buffer_, data};
+            ok_ = writePieces(pieces, 2);
+            buffer_.clear();
+            return ok_;
+        }
+
+        // Writes several caller-owned pieces with as few syscalls as possible.
+        bool write(const std::string_view* pieces, size_t count) {
+            if (!ok_) return false;
+            if (!buffer_.empty()) {
+                const std::string_view pending[1] = {buffer_};
+                ok_ = writePieces(pending, 1);
+                buffer_.clear();
+            }
+            return ok_ && (ok_ = writePieces(pieces, count));
+        }
+
+        // Flushes, optionally syncs, and renames over the target.
+        bool commit() {
+            if (!ok_ || committed_) return false;
+            if (!buffer_.empty()) {
+                const std::string_view pending[1] = {buffer_};
+                ok_ = writePieces(pending, 1);
+                buffer_.clear();
+            }
+            ok_ = ok_ && finish();
+            committed_ = ok_;
+            if (!ok_) abandon();
+            return ok_;
+        }
+
+        // Drops the temporary; the target is left as it was.
+        void abandon() {
+            if (committed_) return;
+#if defined(_WIN32)
+            if (out_.is_open()) out_.close();
+#else
+            if (fd_ >= 0) ::close(fd_);
+            fd_ = -1;
+#endif
+            if (!tempPath_.empty()) std::remove(tempPath_.c_str());
+            tempPath_.clear();
+            ok_ = false;
+        }
+
+    private:
+        static constexpr size_t kBufferSize = 1 << 20;
+
+        std::string target_;
+        AtomicWriteOptions options_;
+        std::string tempPath_;
+        std::string buffer_;
+        bool ok_ = false;
+        bool committed_ = false;
+
+        static std::string uniqueTempName(const std::string& target) {
+            static std::atomic<uint64_t> counter{0};
+#if defined(_WIN32)
+            const long pid = static_cast<long>(::_getpid());
+#else
+            const long pid = static_cast<long>(::getpid());
+#endif
+            return target + ".tmp." + std::to_string(pid) + "." + std::to_string(counter++);
+        }
+
+        static std::string directoryOf(const std::string& target) {
+            std::filesystem::path dir = std::filesystem::path(target).parent_path();
+            return dir.empty() ? std::string(".") : dir.string();
+        }
 
-        std::ofstream out(tempFilename, std::ios::trunc);
-        if (!out.is_open()) return false;
+#if defined(_WIN32)
+        std::ofstream out_;
 
-        out << content;
-        out.close();
+        void open() {
+            tempPath_ = uniqueTempName(target_);
+            out_.open(tempPath_, std::ios::binary | std::ios::trunc);
+            ok_ = out_.is_open();
+        }
 
-        std::error_code ec;
-        std::filesystem::rename(tempFilename, targetFilename, ec);
-        return !ec;
+        bool writePieces(const std::string_view* pieces, size_t count) {
+            for (size_t i = 0; i < count; ++i) out_.write(pieces[i].data(), static_cast<std::streamsize>(pieces[i].size()));
+            return static_cast<bool>(out_);
+        }
+
+        bool finish() {
+            out_.flush();
+            out_.close();
+            if (!out_) return false;
+            std::error_code ec;
+            std::filesystem::rename(tempPath_, target_, ec);
+            if (ec) return false;
+            tempPath_.clear();
+            return true;
+        }
+#else
+        int fd_ = -1;
+        bool anonymous_ = false;   // O_TMPFILE: no name until commit
+
+        void open() {
+#if defined(__linux__) && defined(O_TMPFILE)
+            // Readable too, in case commit has to copy it out (see linkTemporary).
+            fd_ = ::open(directoryOf(target_).c_str(), O_TMPFILE | O_RDWR | O_CLOEXEC, 0666);
+            anonymous_ = fd_ >= 0;
+#endif
+            if (fd_ < 0) {
+                tempPath_ = uniqueTempName(target_);
+                fd_ = ::open(tempPath_.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+                if (fd_ < 0) tempPath_.clear();
+            }
+            ok_ = fd_ >= 0;
+
+#if defined(__linux__)
+            // Reserve blocks without changing the file size, so a short write needs no truncation.
+            if (ok_ && options_.expectedSize > 0) {
+                (void)::fallocate(fd_, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(options_.expectedSize));
+            }
+#endif
+        }
+
+        bool writePieces(const std::string_view* pieces, size_t count) {
+            std::vector<iovec> iov;
+            iov.reserve(std::min<size_t>(count, IOV_MAX));
+            size_t next = 0;
+            while (next < count || !iov.empty()) {
+                while (next < count && iov.size() < static_cast<size_t>(IOV_MAX)) {
+                    if (!pieces[next].empty()) {
+                        iov.push_back({const_cast<char*>(pieces[next].data()), pieces[next].size()});
+                    }
+                    ++next;
+                }
+                if (iov.empty()) break;
+
+                ssize_t n = ::writev(fd_, iov.data(), static_cast<int>(iov.size()));
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) return false;
+
+                // Drop what was written; resume a partially written piece where it stopped.
+                size_t done = static_cast<size_t>(n);
+                size_t first = 0;
+                while (first < iov.size() && done >= iov[first].iov_len) done -= iov[first++].iov_len;
+                iov.erase(iov.begin(), iov.begin() + static_cast<std::ptrdiff_t>(first));
+                if (!iov.empty() && done > 0) {
+                    iov.front().iov_base = static_cast<char*>(iov.front().iov_base) + done;
+                    iov.front().iov_len -= done;
+                }
+            }
+            return true;
+        }
+
+        static bool syncFile(int fd) {
+#if defined(__APPLE__)
+            return ::fsync(fd) == 0;
+#else
+            return ::fdatasync(fd) == 0;
+#endif
+        }
+
+        // Gives the anonymous temporary the name tempPath_. linkat through /proc needs /proc mounted;
+        // without it the data is copied into a named temporary, which then stands in for fd_.
+        bool linkTemporary() {
+            const std::string procPath = "/proc/self/fd/" + std::to_string(fd_);
+            if (::linkat(AT_FDCWD, procPath.c_str(), AT_FDCWD, tempPath_.c_str(), AT_SYMLINK_FOLLOW) == 0) return true;
+
+            const int named = ::open(tempPath_.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+            if (named < 0) return false;
+            const int source = fd_;
+            fd_ = named;
+            buffer_.resize(kBufferSize);
+            bool copied = true;
+            for (off_t offset = 0; copied;) {
+                const ssize_t n = ::pread(source, buffer_.data(), buffer_.size(), offset);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) {
+                    copied = n == 0;
+                    break;
+                }
+                const std::string_view piece(buffer_.data(), static_cast<size_t>(n));
+                copied = writePieces(&piece, 1);
+                offset += n;
+            }
+            buffer_.clear();
+            buffer_.shrink_to_fit();
+            ::close(source);
+            if (copied && (!options_.durable || syncFile(fd_))) return true;
+            std::remove(tempPath_.c_str());
+            return false;
+        }
+
+        bool finish() {
+            if (options_.durable && !syncFile(fd_)) return false;
+
+            if (anonymous_) {
+                // linkat cannot replace an existing file: give the data a unique name, then rename it.
+                tempPath_ = uniqueTempName(target_);
+                if (!linkTemporary()) {
+                    tempPath_.clear();
+                    return false;
+                }
+            }
+
+            const bool closed = ::close(fd_) == 0;
+            fd_ = -1;
+            if (!closed || std::rename(tempPath_.c_str(), target_.c_str()) != 0) return false;
+            tempPath_.clear();
+
+            if (options_.durable) {
+                const int dirFd = ::open(directoryOf(target_).c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+                if (dirFd < 0) return false;
+                const bool synced = ::fsync(dirFd) == 0;
+                ::close(dirFd);
+                return synced;
+            }
+            return true;
+        }
+#endif
+    };
+
+    // Writes a string atomically to a file
+    static bool writeAtomically(const std::string& targetFilename, std::string_view content, AtomicWriteOptions options = {}) {
+        options.expectedSize = content.size();
+        Sink sink(targetFilename, options);
+        return sink.write(content) && sink.commit();
     }
 
     // Writes binary data atomically to a file
-   static bool writeAtomicallyBinary(const std::string& targetFilename, const std::vector<uint8_t>& binaryData) {
-        std::string tempFilename = targetFilename + ".tmp";
-
-        std::ofstream out(tempFilename, std::ios::binary);
-        if (!out.is_open()) return false;
+    static bool writeAtomicallyBinary(const std::string& targetFilename, const std::vector<uint8_t>& binaryData, AtomicWriteOptions options = {}) {
+        return writeAtomically(targetFilename, std::string_view(reinterpret_cast<const char*>(binaryData.data()), binaryData.size()), options);
+    }
 
-        out.write(reinterpret_cast<const char*>(binaryData.data()), binaryData.size());
-        out.close();
+    // Streams into a file atomically: `producer` writes to the sink and returns false to abandon.
+    static bool writeAtomicallyStreamed(const std::string& targetFilename, const std::function<bool(Sink&)>& producer,
+                                        AtomicWriteOptions options = {}) {
+        Sink sink(targetFilename, options);
+        return sink.ok() && producer(sink) && sink.commit();
+    }
 
-        std::filesystem::rename(tempFilename, targetFilename);
-        return true;
+    // Writes data atomically in chunks of at most `chunkSize` bytes, calling `beforeChunk(size)`
+    // before each one (e.g. to throttle). If the callback returns false the write is abandoned
+    // and the target is left untouched.
+    static bool writeAtomicallyChunked(const std::string& targetFilename, std::string_view content, size_t chunkSize,
+                                       const std::function<bool(size_t)>& beforeChunk, AtomicWriteOptions options = {}) {
+        options.expectedSize = content.size();
+        chunkSize = chunkSize ? chunkSize : std::max<size_t>(content.size(), 1);
+        return writeAtomicallyStreamed(targetFilename, [&](Sink& sink) {
+            for (size_t offset = 0; offset < content.size(); offset += chunkSize) {
+                const size_t size = std::min(chunkSize, content.size() - offset);
+                if (beforeChunk && !beforeChunk(size)) return false;
+                // One piece per call: the chunk reaches the file now, not when the buffer fills.
+                const std::string_view piece = content.substr(offset, size);
+                if (!sink.write(&piece, 1)) return false;
+            }
+            return true;
+        }, options);
     }
 
 };
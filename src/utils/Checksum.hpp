@@ -0,0 +1,41 @@
+
+//     ::::::::::::::::::::::::::::::::::::::::::::
+//     :: *  © 2025 Victor. All rights reserved. ::
+//     :: *  Smart_Store Framework               ::
+//     :: *  Licensed under the MIT License      ::
+//     ::::::::::::::::::::::::::::::::::::::::::::
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+//::::: CRC-32 (IEEE 802.3) used to detect torn or corrupt on-disk records
+//************************************************************************
+
+namespace Checksum {
+
+    namespace detail {
+        inline const std::array<uint32_t, 256>& crc32Table() {
+            static const std::array<uint32_t, 256> table = [] {
+                std::array<uint32_t, 256> t{};
+                for (uint32_t i = 0; i < 256; ++i) {
+                    uint32_t c = i;
+                    for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                    t[i] = c;
+                }
+                return t;
+            }();
+            return table;
+        }
+    }
+
+    // Continues a running CRC; pass the previous result as `crc` to checksum data in pieces.
+    inline uint32_t crc32(const void* data, size_t size, uint32_t crc = 0) {
+        const auto& table = detail::crc32Table();
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        crc = ~crc;
+        for (size_t i = 0; i < size; ++i) crc = table[(crc ^ bytes[i]) & 0xFFu] ^ (crc >> 8);
+        return ~crc;
+    }
+}
@@ -0,0 +1,68 @@
+
+//     ::::::::::::::::::::::::::::::::::::::::::::
+//     :: *  © 2025 Victor. All rights reserved. ::
+//     :: *  Smart_Store Framework               ::
+//     :: *  Licensed under the MIT License      ::
+//     ::::::::::::::::::::::::::::::::::::::::::::
+
+#pragma once
+#include <string>
+#include <string_view>
+#include <nlohmann/json.hpp>
+
+//::::: CSV helpers shared by the CSV exporters
+//*********************************************
+// Escaping copies whole runs of safe bytes with a single append instead of
+// building a temporary string per character.
+
+namespace CsvUtils {
+
+    // Appends `field` wrapped in quotes, doubling any embedded quote.
+    inline void appendQuoted(std::string& out, std::string_view field) {
+        out.push_back('"');
+        size_t start = 0;
+        for (size_t pos = field.find('"'); pos != std::string_view::npos; pos = field.find('"', start)) {
+            out.append(field.data() + start, pos + 1 - start);  // run including the quote
+            out.push_back('"');                                  // doubled quote
+            start = pos + 1;
+        }
+        out.append(field.data() + start, field.size() - start);
+        out.push_back('"');
+    }
+
+    // Appends `field` as-is, quoting only when it contains a delimiter, quote or line break.
+    inline void appendField(std::string& out, std::string_view field) {
+        if (field.find_first_of(",\"\r\n") == std::string_view::npos) {
+            out.append(field.data(), field.size());
+        } else {
+            appendQuoted(out, field);
+        }
+    }
+
+    // Appends a JSON value as a typed cell: strings raw, scalars in JSON notation,
+    // nulls empty and nested objects/arrays as compact JSON.
+    inline void appendJsonCell(std::string& out, const nlohmann::json& value) {
+        if (value.is_null()) return;
+        if (value.is_string()) {
+            appendField(out, value.get_ref<const std::string&>());
+        } else {
+            appendField(out, value.dump());
+        }
+    }
+
+    // Turns an arbitrary type name into something safe to embed in a file name.
+    inline std::string sanitizeForFilename(std::string_view name) {
+        std::string result;
+        result.reserve(name.size());
+        for (char c : name) {
+            const bool safe = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '-';
+            if (safe) {
+                result.push_back(c);
+            } else if (result.empty() || result.back() != '_') {
+                result.push_back('_');
+            }
+        }
+        while (!result.empty() && result.back() == '_') result.pop_back();
+        return result.empty() ? std::string("unknown") : result;
+    }
+}
@@ -0,0 +1,54 @@
+
+//     ::::::::::::::::::::::::::::::::::::::::::::
+//     :: *  © 2025 Victor. All rights reserved. ::
+//     :: *  Smart_Store Framework               ::
+//     :: *  Licensed under the MIT License      ::
+//     ::::::::::::::::::::::::::::::::::::::::::::
+
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+//::::: Allocator for item wrappers and their payloads
+//****************************************************
+// Items are created with std::allocate_shared over a std::pmr::memory_resource, so the wrapper, its
+// payload and their control blocks come from the resource (by default a pool per ItemManager, which
+// keeps blocks of each size in their own slabs and reuses them across undo clones and re-imports).
+// The allocator holds the resource by shared_ptr, and every control block keeps a copy: an item still
+// referenced by a snapshot keeps its resource alive after the manager is gone.
+
+using ItemResource = std::shared_ptr<std::pmr::memory_resource>;
+
+template<typename T>
+class ItemAllocator {
+public:
+    using value_type = T;
+
+    ItemAllocator() noexcept = default;
+    explicit ItemAllocator(ItemResource resource) noexcept : resource_(std::move(resource)) {}
+
+    template<typename U>
+    ItemAllocator(const ItemAllocator<U>& other) noexcept : resource_(other.resource()) {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(get()->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        get()->deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    // nullptr means the process default resource (new/delete unless changed).
+    const ItemResource& resource() const noexcept { return resource_; }
+
+    template<typename U>
+    bool operator==(const ItemAllocator<U>& other) const noexcept { return get()->is_equal(*other.get()); }
+
+    std::pmr::memory_resource* get() const noexcept {
+        return resource_ ? resource_.get() : std::pmr::get_default_resource();
+    }
+
+private:
+    ItemResource resource_;
+};
@@ -0,0 +1,108 @@
+//     ::::::::::::::::::::::::::::::::::::::::::::
+//     :: *  © 2025 Victor. All rights reserved. ::
+//     :: *  Smart_Store Framework               ::
+//     :: *  Licensed under the MIT License      ::
+//     ::::::::::::::::::::::::::::::::::::::::::::
+
+#pragma once
+#include <cctype>
+#include <cstddef>
+#include <string_view>
+
+//::::: Extent of JSON values in text already in memory
+//******************************************************
+// Scanned like the converter's JsonReader, with string and nesting state only: nothing is
+// decoded or validated, so a lazy import can keep each record's bytes without building a
+// document. Positions are offsets into the scanned text; npos means the text ends too early.
+
+namespace JsonSpan {
+
+    constexpr size_t npos = std::string_view::npos;
+
+    inline size_t skipSpace(std::string_view text, size_t pos) {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) ++pos;
+        return pos;
+    }
+
+    // One past the closing quote of the string whose opening quote is at `pos`.
+    inline size_t stringEnd(std::string_view text, size_t pos) {
+        for (size_t i = pos + 1; i < text.size(); ++i) {
+            if (text[i] == '\\') ++i;
+            else if (text[i] == '"') return i + 1;
+        }
+        return npos;
+    }
+
+    // One past the last byte of the value starting at `pos`. A scalar runs to the next
+    // delimiter or space.
+    inline size_t valueEnd(std::string_view text, size_t pos) {
+        if (pos >= text.size()) return npos;
+        if (text[pos] == '"') return stringEnd(text, pos);
+        if (text[pos] == '{' || text[pos] == '[') {
+            int depth = 0;
+            for (size_t i = pos; i < text.size(); ++i) {
+                const char c = text[i];
+                if (c == '"') {
+                    i = stringEnd(text, i);
+                    if (i == npos) return npos;
+                    --i;
+                } else if (c == '{' || c == '[') {
+                    ++depth;
+                } else if ((c == '}' || c == ']') && --depth == 0) {
+                    return i + 1;
+                }
+            }
+            return npos;
+        }
+        size_t i = pos;
+        while (i < text.size() && text[i] != ',' && text[i] != '}' && text[i] != ']'
+               && !std::isspace(static_cast<unsigned char>(text[i]))) ++i;
+        return i == pos ? npos : i;
+    }
+
+    // Calls visit(element) for every element of the array whose '[' is at `pos`. False if there
+    // is no array there or it is cut short.
+    template<typename Visit>
+    bool forEachElement(std::string_view text, size_t pos, Visit&& visit) {
+        if (pos >= text.size() || text[pos] != '[') return false;
+        size_t i = skipSpace(text, pos + 1);
+        if (i < text.size() && text[i] == ']') return true;
+        while (true) {
+            const size_t end = valueEnd(text, i);
+            if (end == npos) return false;
+            visit(text.substr(i, end - i));
+            i = skipSpace(text, end);
+            if (i >= text.size()) return false;
+            if (text[i] == ']') return true;
+            if (text[i] != ',') return false;
+            i = skipSpace(text, i + 1);
+        }
+    }
+
+    // Calls visit(key, value) for every member of the object whose '{' is at `pos`; `key` is the
+    // text between the quotes, escapes left as they are. False if there is no object there or it
+    // is cut short.
+    template<typename Visit>
+    bool forEachMember(std::string_view text, size_t pos, Visit&& visit) {
+        if (pos >= text.size() || text[pos] != '{') return false;
+        size_t i = skipSpace(text, pos + 1);
+        if (i < text.size() && text[i] == '}') return true;
+        while (true) {
+            if (i >= text.size() || text[i] != '"') return false;
+            const size_t keyEnd = stringEnd(text, i);
+            if (keyEnd == npos) return false;
+            const std::string_view key = text.substr(i + 1, keyEnd - i - 2);
+            i = skipSpace(text, keyEnd);
+            if (i >= text.size() || text[i] != ':') return false;
+            i = skipSpace(text, i + 1);
+            const size_t end = valueEnd(text, i);
+            if (end == npos) return false;
+            visit(key, text.substr(i, end - i));
+            i = skipSpace(text, end);
+            if (i >= text.size()) return false;
+            if (text[i] == '}') return true;
+            if (text[i] != ',') return false;
+            i = skipSpace(text, i + 1);
+        }
+    }
+}
@@ -0,0 +1,47 @@
+
+//     ::::::::::::::::::::::::::::::::::::::::::::
+//     :: *  © 2025 Victor. All rights reserved. ::
+//     :: *  Smart_Store Framework               ::
+//     :: *  Licensed under the MIT License      ::
+//     ::::::::::::::::::::::::::::::::::::::::::::
+
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+
+//::::: TokenBucket class
+//***********************
+// Caps a byte rate: tokens refill at `ratePerSecond` up to `burst`. Taking more tokens than
+// are available puts the bucket in debt, and the caller is told how long to wait it off.
+// Not thread-safe; meant to be owned by a single background thread.
+
+class TokenBucket {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // A rate of 0 disables limiting.
+    explicit TokenBucket(double ratePerSecond = 0, double burst = 0)
+        : rate_(ratePerSecond), burst_(std::max(burst, ratePerSecond / 10)), tokens_(burst_), last_(Clock::now()) {}
+
+    bool limited() const { return rate_ > 0; }
+
+    // Takes `amount` tokens and returns how long the caller should wait before using them.
+    std::chrono::nanoseconds acquire(size_t amount) {
+        if (!limited()) return std::chrono::nanoseconds::zero();
+
+        const auto now = Clock::now();
+        const double elapsed = std::chrono::duration<double>(now - last_).count();
+        last_ = now;
+
+        tokens_ = std::min(burst_, tokens_ + elapsed * rate_) - static_cast<double>(amount);
+        if (tokens_ >= 0) return std::chrono::nanoseconds::zero();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(-tokens_ / rate_));
+    }
+
+private:
+    double rate_;
+    double burst_;
+    double tokens_;
+    Clock::time_point last_;
+};
@@ -0,0 +1,69 @@
+
+//     ::::::::::::::::::::::::::::::::::::::::::::
+//     :: *  © 2025 Victor. All rights reserved. ::
+//     :: *  Smart_Store Framework               ::
+//     :: *  Licensed under the MIT License      ::
+//     ::::::::::::::::::::::::::::::::::::::::::::
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+
+//::::: Compile-time type identity
+//********************************
+// TypeIds::nameOf<T>() is T's readable name, cut out of __PRETTY_FUNCTION__ (__FUNCSIG__ on MSVC) at
+// compile time, so it costs no demangling and no allocation. TypeIds::of<T>() is its 64-bit FNV-1a
+// hash, usable as a constant. Both are stable for a given compiler; exported records keep the
+// typeid() names they have always used (see ItemManager::typeIdOf). TypeIds::indexOf<T>() is a
+// small per-process integer, used to index ItemManager's type table directly.
+
+using TypeId = uint64_t;
+
+namespace TypeIds {
+
+    constexpr TypeId hash(std::string_view text) {
+        uint64_t h = 14695981039346656037ull;
+        for (char c : text) {
+            h ^= static_cast<unsigned char>(c);
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    template<typename T>
+    constexpr std::string_view nameOf() {
+#if defined(__clang__) || defined(__GNUC__)
+        // clang: "... nameOf() [T = Foo]"   gcc: "... nameOf() [with T = Foo; std::string_view = ...]"
+        constexpr std::string_view signature = __PRETTY_FUNCTION__;
+        constexpr size_t start = signature.find("T = ") + 4;
+        constexpr size_t end = signature.find_first_of(";]", start);
+        return signature.substr(start, end - start);
+#elif defined(_MSC_VER)
+        // "class std::basic_string_view<...> __cdecl TypeIds::nameOf<struct Foo>(void)"
+        constexpr std::string_view signature = __FUNCSIG__;
+        constexpr size_t start = signature.find("nameOf<") + 7;
+        constexpr size_t end = signature.rfind(">(void)");
+        return signature.substr(start, end - start);
+#else
+        return "unknown";
+#endif
+    }
+
+    template<typename T>
+    constexpr TypeId of() {
+        return hash(nameOf<T>());
+    }
+
+    inline std::atomic<uint32_t>& nextIndex() {
+        static std::atomic<uint32_t> next{0};
+        return next;
+    }
+
+    // Dense index of T, handed out in order of first use and fixed for the life of the process.
+    template<typename T>
+    uint32_t indexOf() {
+        static const uint32_t index = nextIndex().fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+}
@@ -0,0 +1,69 @@
+#include "BackgroundMigrator.h"
+
+#include <algorithm>
+#include <iostream>
+
+// ::::| BackgroundMigrator: batched, idle-time "migrate all" task
+// ****************************************************************
+
+BackgroundMigrator::BackgroundMigrator(MigrationTaskOptions options, BatchFn batch)
+    : options_(options), batch_(std::move(batch)) {
+    options_.batchSize = std::max<size_t>(1, options_.batchSize);
+    thread_ = std::thread(&BackgroundMigrator::run, this);
+}
+
+BackgroundMigrator::~BackgroundMigrator() {
+    stop();
+}
+
+void BackgroundMigrator::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+}
+
+void BackgroundMigrator::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return !running_; });
+}
+
+MigrationTaskStats BackgroundMigrator::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void BackgroundMigrator::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_) {
+        lock.unlock();
+        std::optional<BatchResult> result;
+        bool aborted = false;
+        try {
+            result = batch_(options_.batchSize);
+        } catch (const std::exception& e) {
+            std::cerr << ":::| ERROR in background migration thread: " << e.what() << "\n";
+            aborted = true;
+        }
+        lock.lock();
+
+        if (aborted) break;
+        if (!result) {
+            ++stats_.deferred;
+        } else {
+            ++stats_.batches;
+            stats_.migrated += result->migrated;
+            stats_.failed += result->failed;
+            if (result->done) {
+                stats_.finished = true;
+                break;
+            }
+        }
+        cv_.wait_for(lock, options_.pause, [this] { return stop_; });
+    }
+    running_ = false;
+    lock.unlock();
+    cv_.notify_all();
+}
@@ -0,0 +1,71 @@
+#pragma once
+#ifndef BACKGROUND_MIGRATOR_H
+#define BACKGROUND_MIGRATOR_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+// :::BackgroundMigrator class
+// :::Background "migrate all" task: upgrades the stale items of a store a bounded batch at a time,
+// :::pausing between batches. A batch that finds the store busy is put off rather than waited for,
+// :::so foreground work goes first. The thread ends on its own once no stale item is left.
+// **************************************************************************************************
+// ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+struct MigrationTaskOptions {
+    size_t batchSize = 256;                   // items upgraded per batch
+    std::chrono::milliseconds pause{5};       // idle time between batches
+};
+
+struct MigrationTaskStats {
+    uint64_t migrated = 0;     // items upgraded
+    uint64_t failed = 0;       // items whose record could not be decoded
+    uint64_t batches = 0;      // batches run
+    uint64_t deferred = 0;     // batches put off because the store was busy
+    bool finished = false;     // every stale item was handled
+};
+
+class BackgroundMigrator {
+    public:
+        struct BatchResult {
+            size_t migrated = 0;
+            size_t failed = 0;
+            bool done = false;   // nothing stale is left
+        };
+        // Upgrades at most `maxItems` items; nullopt if the store was busy and nothing was done.
+        using BatchFn = std::function<std::optional<BatchResult>(size_t maxItems)>;
+
+        BackgroundMigrator(MigrationTaskOptions options, BatchFn batch);
+        ~BackgroundMigrator();
+
+        BackgroundMigrator(const BackgroundMigrator&) = delete;
+        BackgroundMigrator& operator=(const BackgroundMigrator&) = delete;
+
+        // Stops the thread after the batch in progress, if any.
+        void stop();
+
+        // Blocks until the task has finished or was stopped.
+        void wait();
+
+        MigrationTaskStats stats() const;
+
+    private:
+        void run();
+
+        MigrationTaskOptions options_;
+        BatchFn batch_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable cv_;
+        bool stop_ = false;
+        bool running_ = true;
+        MigrationTaskStats stats_;
+        std::thread thread_;
+};
+
+#endif // BACKGROUND_MIGRATOR_H
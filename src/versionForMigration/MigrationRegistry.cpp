@@ -7,18 +7,16 @@
 constexpr int MigrationRegistry::kMaxMigrationDepth;
 
 void MigrationRegistry::registerVersion(const std::string& typeName, int latest) {
+    std::unique_lock<std::shared_mutex> lock(chainMutex_);
     latestVersions[typeName] = latest;
-
-    if (latestVersions.size() > kMaxMigrationDepth) {
-        auto it = latestVersions.begin();
-        std::advance(it, latestVersions.size() - kMaxMigrationDepth);
-        latestVersions.erase(latestVersions.begin(), it);
-    }
+    chains_.erase(typeName);
 }
 
-void MigrationRegistry::registerMigration(const std::string& typeName, int fromVersion, MigrationFn fn) {
+void MigrationRegistry::registerStep(const std::string& typeName, int fromVersion, Step step) {
+    std::unique_lock<std::shared_mutex> lock(chainMutex_);
     auto& chain = migrations[typeName];
-    chain[fromVersion] = std::move(fn);
+    chain[fromVersion] = std::move(step);
+    chains_.erase(typeName);   // cached chains point into this map
 
     while (static_cast<int>(chain.size()) > kMaxMigrationDepth) {
         chain.erase(chain.begin());
@@ -26,36 +24,91 @@ void MigrationRegistry::registerMigration(const std::string& typeName, int fromV
 }
 
 int MigrationRegistry::getLatestVersion(const std::string& typeName) const {
+    std::shared_lock<std::shared_mutex> lock(chainMutex_);
     auto it = latestVersions.find(typeName);
     return (it != latestVersions.end()) ? it->second : 1;
 }
 
-nlohmann::json MigrationRegistry::upgradeToLatest(const std::string& typeName, int currentVersion, const nlohmann::json& data) const {
-    auto upgraded = data;
-    int latest = getLatestVersion(typeName);
-    auto it = migrations.find(typeName);
-    if (it == migrations.end()) return upgraded;
+const MigrationRegistry::Chain* MigrationRegistry::findChain(const std::string& typeName, int fromVersion) const {
+    auto type = chains_.find(typeName);
+    if (type == chains_.end()) return nullptr;
+    auto chain = type->second.find(fromVersion);
+    return chain != type->second.end() ? chain->second.get() : nullptr;
+}
+
+void MigrationRegistry::buildChain(const std::string& typeName, int fromVersion) const {
+    auto built = std::make_unique<Chain>();
+    built->reached = fromVersion;
+
+    auto latestIt = latestVersions.find(typeName);
+    const int latest = latestIt != latestVersions.end() ? latestIt->second : 1;
+    auto steps = migrations.find(typeName);
+    if (steps != migrations.end()) {
+        // Same walk as applying the steps one by one: stop at a gap or after kMaxMigrationDepth + 1 steps.
+        while (built->reached < latest && static_cast<int>(built->steps.size()) <= kMaxMigrationDepth) {
+            auto step = steps->second.find(built->reached);
+            if (step == steps->second.end()) break;
+            built->steps.push_back(&step->second);
+            ++built->reached;
+        }
+    }
+
+    chains_[typeName][fromVersion] = std::move(built);
+    ++chainsBuilt_;
+}
 
-    int depth = 0;
-    while (currentVersion < latest) {
-        auto fnIt = it->second.find(currentVersion);
-        if (fnIt == it->second.end()) break;
-        upgraded = fnIt->second(upgraded);
+int MigrationRegistry::upgradeInPlace(const std::string& typeName, int currentVersion, nlohmann::json& data) const {
+    std::shared_lock<std::shared_mutex> lock(chainMutex_);
+    auto latestIt = latestVersions.find(typeName);
+    if (latestIt == latestVersions.end() || currentVersion >= latestIt->second) return currentVersion;
 
-        logs.push_back("[MIGRATION] Type: " + typeName + " | v" + std::to_string(currentVersion) + " -> v" + std::to_string(currentVersion + 1));
+    const Chain* chain = findChain(typeName, currentVersion);
+    while (!chain) {
+        lock.unlock();
+        {
+            std::unique_lock<std::shared_mutex> write(chainMutex_);
+            if (!findChain(typeName, currentVersion)) buildChain(typeName, currentVersion);
+        }
+        lock.lock();
+        chain = findChain(typeName, currentVersion);   // a registration in between drops it again
+    }
 
-        currentVersion++;
-        if (++depth > kMaxMigrationDepth) break;
+    if (chain->steps.empty()) return currentVersion;
+    for (const Step* step : chain->steps) {
+        (*step)(data);
     }
+    ++chain->records;
+    ++recordsMigrated_;
+    stepsApplied_ += chain->steps.size();
+    return chain->reached;
+}
+
+nlohmann::json MigrationRegistry::upgradeToLatest(const std::string& typeName, int currentVersion, const nlohmann::json& data) const {
+    auto upgraded = data;
+    upgradeInPlace(typeName, currentVersion, upgraded);
     return upgraded;
 }
 
+MigrationRegistry::Counters MigrationRegistry::counters() const {
+    return {recordsMigrated_.load(), stepsApplied_.load(), chainsBuilt_.load()};
+}
+
 void MigrationRegistry::printMigrationLog() const {
-    for (const auto& entry : logs) {
-        std::cout << entry << std::endl;
+    std::shared_lock<std::shared_mutex> lock(chainMutex_);
+    for (const auto& [typeName, byVersion] : chains_) {
+        for (const auto& [fromVersion, chain] : byVersion) {
+            if (chain->records == 0) continue;
+            std::cout << "[MIGRATION] Type: " << typeName << " | v" << fromVersion << " -> v" << chain->reached
+                      << " | records: " << chain->records << std::endl;
+        }
     }
 }
 
 void MigrationRegistry::clearMigrationLog() {
-    logs.clear();
+    std::shared_lock<std::shared_mutex> lock(chainMutex_);
+    for (const auto& [typeName, byVersion] : chains_) {
+        for (const auto& [fromVersion, chain] : byVersion) chain->records = 0;
+    }
+    recordsMigrated_ = 0;
+    stepsApplied_ = 0;
 }
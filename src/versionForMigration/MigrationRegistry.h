@@ -2,10 +2,16 @@
 #ifndef MIGRATION_REGISTRY_H
 #define MIGRATION_REGISTRY_H
 
+#include <atomic>
 #include <functional>
 #include <string>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 #include <iostream>
 #include <nlohmann/json.hpp>
@@ -13,6 +19,9 @@
 // :::Forward declaration of MigrationRegistry class
 // :::This class is responsible for managing migrations of items in the system.
 // :::It allows registering versions, migration functions, and upgrading items to the latest version.
+// :::Migrations upgrade a record in place. The steps from a given version up to the latest are
+// :::resolved into one chain the first time a record of that version is seen, and reused until a
+// :::version or migration of the type is registered again. Migrations are counted, not logged.
 // **************************************************************************************************
 // ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
@@ -21,25 +30,75 @@ class MigrationRegistry {
         ~MigrationRegistry() {
             latestVersions.clear();
             migrations.clear();
-            logs.clear();
+            chains_.clear();
         }
-    
+
+        // Copying form: returns the upgraded record.
         using MigrationFn = std::function<nlohmann::json(const nlohmann::json&)>;
+        // In-place form: upgrades the record it is given.
+        using Step = std::function<void(nlohmann::json&)>;
         static constexpr int kMaxMigrationDepth = 10;
-    
+
+        // Either form as a Step; the copying form costs one copy per step, the in-place form none.
+        template<typename Fn>
+        static Step toStep(Fn fn) {
+            if constexpr (std::is_invocable_r_v<void, Fn&, nlohmann::json&> &&
+                          !std::is_invocable_v<Fn&, const nlohmann::json&>) {
+                return Step(std::move(fn));
+            } else {
+                return [fn = std::move(fn)](nlohmann::json& j) { j = fn(std::as_const(j)); };
+            }
+        }
+
         void registerVersion(const std::string& typeName, int latest);
-        void registerMigration(const std::string& typeName, int fromVersion, MigrationFn fn);
+
+        template<typename Fn>
+        void registerMigration(const std::string& typeName, int fromVersion, Fn fn) {
+            registerStep(typeName, fromVersion, toStep(std::move(fn)));
+        }
+        void registerStep(const std::string& typeName, int fromVersion, Step step);
+
         int getLatestVersion(const std::string& typeName) const;
+
+        // Upgrades `data` in place from `currentVersion`; returns the version reached.
+        int upgradeInPlace(const std::string& typeName, int currentVersion, nlohmann::json& data) const;
+
+        // Copy of `data`, upgraded (one copy whatever the number of steps).
         nlohmann::json upgradeToLatest(const std::string& typeName, int currentVersion, const nlohmann::json& data) const;
-    
-        // Log API
+
+        struct Counters {
+            uint64_t records = 0;   // records that went through at least one step
+            uint64_t steps = 0;     // steps applied
+            uint64_t chainsBuilt = 0;
+        };
+        Counters counters() const;
+
+        // Log API: records migrated per type and starting version.
         void printMigrationLog() const;
         void clearMigrationLog();
-    
+
     private:
+        struct Chain {
+            std::vector<const Step*> steps;
+            int reached = 1;
+            mutable std::atomic<uint64_t> records{0};
+        };
+
+        // The cached chain from `fromVersion`, or nullptr. Caller holds chainMutex_.
+        const Chain* findChain(const std::string& typeName, int fromVersion) const;
+        // Resolves the steps from `fromVersion` up to the latest version. Caller holds chainMutex_ exclusively.
+        void buildChain(const std::string& typeName, int fromVersion) const;
+
         std::map<std::string, int> latestVersions;
-        std::unordered_map<std::string, std::map<int, MigrationFn>> migrations;
-        mutable std::vector<std::string> logs;
+        std::unordered_map<std::string, std::map<int, Step>> migrations;
+
+        // Guards the three maps: registration takes it exclusively, upgrades shared.
+        mutable std::shared_mutex chainMutex_;
+        mutable std::unordered_map<std::string, std::map<int, std::unique_ptr<Chain>>> chains_;
+
+        mutable std::atomic<uint64_t> recordsMigrated_{0};
+        mutable std::atomic<uint64_t> stepsApplied_{0};
+        mutable std::atomic<uint64_t> chainsBuilt_{0};
     };
-    
-    #endif // MIGRATION_REGISTRY_H
\ No newline at end of file
+
+    #endif // MIGRATION_REGISTRY_H
@@ -1,16 +1,30 @@
 #include <gtest/gtest.h>
 #include "t_manager/ItemManager.h"
+#include "utils/AtomicFileWriter .hpp"
+#include "persistence/RecordConverter.h"
+#define SMARTSTORE_ALLOCATION_HOOK   // this binary counts its heap allocations, for the budgets below
+#include "utils/AllocationCounter.hpp"
 #include <cstdio> // For std::remove
 #include <nlohmann/json.hpp>
 #include <fstream>  // For file handling (std::ofstream, std::ifstream)
 #include <iostream>
 #include <map>
+#include <set>
 #include <vector>
 #include <memory>
 #include <string>
 #include <sstream>
+#include <filesystem>
 #include <mutex>
 #include <thread>
+#include <atomic>
+#include <chrono>
+#include <memory_resource>
+#include <csignal>
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#include <sys/stat.h>
+#endif
 using json = nlohmann::json;
 std::mutex mutex;
 
@@ -642,6 +656,65 @@ TEST(CSVSingleImportTest, ImportOneObjectByTagAndType) {
     std::remove(filename.c_str());
 }
 
+struct DummyColumns {
+    std::string name;
+    int score;
+    std::vector<int> history;
+
+    friend void to_json(json& j, const DummyColumns& obj) {
+        j = json{{"name", obj.name}, {"score", obj.score}, {"history", obj.history}};
+    }
+
+    friend void from_json(const json& j, DummyColumns& obj) {
+        obj.name = j.at("name");
+        obj.score = j.at("score");
+        obj.history = j.at("history").get<std::vector<int>>();
+    }
+};
+
+TEST(CSVColumnarExportTest, WritesOneFilePerTypeWithTypedColumns) {
+    const std::string filename = "test_columnar.csv";
+    const std::string schemaFile  = "test_columnar_DummyCSV.csv";
+    const std::string columnsFile = "test_columnar_DummyColumns.csv";
+    const std::string scalarFile  = "test_columnar_int.csv";
+
+    ItemManager manager;
+    manager.addItem(std::make_shared<DummyCSV>(DummyCSV{"Echo", 88}), "with_schema");
+    manager.addItem(std::make_shared<DummyColumns>(DummyColumns{"Say \"hi\", Bob", 7, {1, 2}}), "keys");
+    manager.addItem(std::make_shared<int>(42), "scalar");
+
+    ASSERT_TRUE(manager.exportToFile_CSVColumnar(filename));
+
+    auto readLines = [](const std::string& path) {
+        std::ifstream in(path);
+        std::vector<std::string> lines;
+        for (std::string line; std::getline(in, line);) lines.push_back(line);
+        return lines;
+    };
+
+    // Columns come from the registered schema.
+    auto schemaLines = readLines(schemaFile);
+    ASSERT_EQ(schemaLines.size(), 2u);
+    EXPECT_EQ(schemaLines[0], "id,tag,name,score");
+    EXPECT_NE(schemaLines[1].find(",with_schema,Echo,88"), std::string::npos);
+
+    // Columns come from the first-level keys; quotes are doubled and nested values stay JSON.
+    auto columnLines = readLines(columnsFile);
+    ASSERT_EQ(columnLines.size(), 2u);
+    EXPECT_EQ(columnLines[0], "id,tag,history,name,score");
+    EXPECT_NE(columnLines[1].find(",keys,\"[1,2]\",\"Say \"\"hi\"\", Bob\",7"), std::string::npos);
+
+    // Scalars get a single value column.
+    auto scalarLines = readLines(scalarFile);
+    ASSERT_EQ(scalarLines.size(), 2u);
+    EXPECT_EQ(scalarLines[0], "id,tag,value");
+    EXPECT_NE(scalarLines[1].find(",scalar,42"), std::string::npos);
+
+    std::remove(schemaFile.c_str());
+    std::remove(columnsFile.c_str());
+    std::remove(scalarFile.c_str());
+}
+
 struct WithSchema {
     std::string name;
     int age;
@@ -1856,6 +1929,1695 @@ TEST(ThreadSafetyTest, AsyncImportSingleObject_CSVWorksSafely) {
 }
 
 
+// ::::: Write-ahead log of mutations :::::
+// ***************************************
+
+TEST(WriteAheadLogTest, LogsAddModifyRemoveInOrder) {
+    const std::string walFile = "test_wal_ops.wal";
+    std::remove(walFile.c_str());
+
+    {
+        ItemManager manager;
+        manager.enableWriteAheadLog(walFile);
+        manager.addItem(std::make_shared<int>(1), "a");
+        manager.addItem(std::make_shared<std::string>("text"), "b");
+        manager.modifyItem<int>("a", [](int& v) { v = 2; });
+        manager.removeByTag("b");
+        manager.disableWriteAheadLog();
+    }
+
+    std::vector<WalRecord> records;
+    WriteAheadLog::replay(walFile, [&](WalRecord&& r) { records.push_back(std::move(r)); });
+
+    ASSERT_EQ(records.size(), 4u);
+    EXPECT_EQ(records[0].op, WalOp::Add);
+    EXPECT_EQ(records[1].op, WalOp::Add);
+    EXPECT_EQ(records[2].op, WalOp::Modify);
+    EXPECT_EQ(records[3].op, WalOp::Remove);
+    for (size_t i = 0; i < records.size(); ++i) EXPECT_EQ(records[i].seq, i + 1);
+
+    EXPECT_EQ(records[1].tag, "b");
+    EXPECT_EQ(records[1].type, typeid(std::string).name());
+    EXPECT_EQ(json::from_msgpack(records[2].payload)["data"], 2);
+    EXPECT_TRUE(records[3].payload.empty());
+
+    std::remove(walFile.c_str());
+}
+
+TEST(WriteAheadLogTest, LogsUndoRedoImportsAndRawWrites) {
+    const std::string walFile = "test_wal_replaced.wal";
+    const std::string importFile = "test_wal_replaced.json";
+    std::remove(walFile.c_str());
+    {
+        ItemManager source;
+        source.addItem(std::make_shared<int>(7), "imported");
+        source.exportToFile_Json(importFile);
+    }
+
+    {
+        ItemManager manager;
+        manager.enableWriteAheadLog(walFile);
+        manager.addItem(std::make_shared<int>(1), "a");
+        manager.addItem(std::make_shared<int>(2), "b");
+        manager.undo();                          // Remove b
+        manager.redo();                          // Modify b
+        manager.getItemRaw<int>("a") = 10;       // logged at the next change...
+        manager.modifyItem<int>("b", [](int& v) { v = 3; });   // ...ahead of its own record
+        manager.importFromFile_Json(importFile); // Remove a and b, Modify imported
+        manager.disableWriteAheadLog();
+    }
+
+    std::vector<WalRecord> records;
+    WriteAheadLog::replay(walFile, [&](WalRecord&& r) { records.push_back(std::move(r)); });
+
+    ASSERT_EQ(records.size(), 9u);
+    EXPECT_EQ(records[2].op, WalOp::Remove);
+    EXPECT_EQ(records[2].tag, "b");
+    EXPECT_EQ(records[3].op, WalOp::Modify);
+    EXPECT_EQ(records[3].tag, "b");
+    EXPECT_EQ(json::from_msgpack(records[3].payload)["data"], 2);
+    EXPECT_EQ(records[4].tag, "a");
+    EXPECT_EQ(json::from_msgpack(records[4].payload)["data"], 10);
+    EXPECT_EQ(records[5].tag, "b");
+    std::map<std::string, WalOp> importOps;
+    for (size_t i = 6; i < records.size(); ++i) importOps[records[i].tag] = records[i].op;
+    EXPECT_EQ(importOps, (std::map<std::string, WalOp>{{"a", WalOp::Remove}, {"b", WalOp::Remove}, {"imported", WalOp::Modify}}));
+
+    std::remove(walFile.c_str());
+    std::remove(importFile.c_str());
+}
+
+TEST(WriteAheadLogTest, ConcurrentWritersAreGroupCommitted) {
+    const std::string walFile = "test_wal_group.wal";
+    std::remove(walFile.c_str());
+
+    WalStats stats;
+    {
+        WriteAheadLog wal(walFile);
+        std::vector<std::thread> writers;
+        for (int t = 0; t < 4; ++t) {
+            writers.emplace_back([&wal, t]() {
+                for (int i = 0; i < 100; ++i) {
+                    uint64_t seq = wal.append(WalOp::Add, "tag_" + std::to_string(t) + "_" + std::to_string(i), "i", "x");
+                    wal.commit(seq);
+                    EXPECT_GE(wal.durableSequence(), seq);
+                }
+            });
+        }
+        for (auto& th : writers) th.join();
+        stats = wal.stats();
+    }
+
+    EXPECT_EQ(stats.records, 400u);
+    EXPECT_LE(stats.syncs, stats.records);
+    EXPECT_EQ(WriteAheadLog::replay(walFile, nullptr), 400u);
+
+    std::remove(walFile.c_str());
+}
+
+TEST(WriteAheadLogTest, TornTailIsDroppedAndSequenceContinues) {
+    const std::string walFile = "test_wal_torn.wal";
+    std::remove(walFile.c_str());
+
+    {
+        WriteAheadLog wal(walFile, WalOptions{WalSyncPolicy::None});
+        wal.append(WalOp::Add, "a", "i", "1");
+        wal.append(WalOp::Add, "b", "i", "2");
+        wal.flush();
+    }
+    {
+        std::ofstream out(walFile, std::ios::binary | std::ios::app);
+        out << "\x20\x00\x00\x00garbage";  // half-written frame
+    }
+
+    WriteAheadLog reopened(walFile, WalOptions{WalSyncPolicy::Interval, std::chrono::milliseconds(1)});
+    EXPECT_EQ(reopened.lastSequence(), 2u);
+    reopened.commit(reopened.append(WalOp::Remove, "a", "i", ""));
+    reopened.flush();
+
+    std::vector<uint64_t> seqs;
+    WriteAheadLog::replay(walFile, [&](WalRecord&& r) { seqs.push_back(r.seq); });
+    EXPECT_EQ(seqs, (std::vector<uint64_t>{1, 2, 3}));
+
+    std::remove(walFile.c_str());
+}
+
+TEST(WriteAheadLogTest, FailedWriteIsCutOffAndRetried) {
+#if defined(_WIN32)
+    GTEST_SKIP() << "relies on RLIMIT_FSIZE";
+#else
+    const std::string walFile = "test_wal_failed.wal";
+    std::remove(walFile.c_str());
+
+    WriteAheadLog wal(walFile);
+    wal.commit(wal.append(WalOp::Add, "a", "i", "1"));
+    const uint64_t goodSize = std::filesystem::file_size(walFile);
+
+    // Let the next batch land only partly: the write stops 20 bytes in with EFBIG.
+    rlimit original{};
+    ASSERT_EQ(::getrlimit(RLIMIT_FSIZE, &original), 0);
+    auto previousHandler = std::signal(SIGXFSZ, SIG_IGN);
+    rlimit capped = original;
+    capped.rlim_cur = goodSize + 20;
+    ASSERT_EQ(::setrlimit(RLIMIT_FSIZE, &capped), 0);
+
+    const uint64_t seq = wal.append(WalOp::Add, "b", "i", std::string(100, 'x'));
+    EXPECT_THROW(wal.commit(seq), std::exception);
+    ::setrlimit(RLIMIT_FSIZE, &original);
+    std::signal(SIGXFSZ, previousHandler);
+
+    EXPECT_EQ(wal.durableSequence(), 1u);
+    EXPECT_EQ(std::filesystem::file_size(walFile), goodSize);   // no torn frame left behind
+
+    wal.commit(wal.append(WalOp::Add, "c", "i", "3"));
+    std::vector<std::string> tags;
+    WriteAheadLog::replay(walFile, [&](WalRecord&& r) { tags.push_back(r.tag); });
+    EXPECT_EQ(tags, (std::vector<std::string>{"a", "b", "c"}));
+
+    std::remove(walFile.c_str());
+#endif
+}
+
+TEST(WriteAheadLogTest, RotationSealsTheFileAndTruncationDropsIt) {
+    const std::string walFile = "test_wal_rotate.wal";
+    const std::string sealedFile = walFile + ".prev";
+    std::remove(walFile.c_str());
+    std::remove(sealedFile.c_str());
+
+    {
+        WriteAheadLog wal(walFile);
+        wal.commit(wal.append(WalOp::Add, "a", "i", "1"));
+        wal.commit(wal.append(WalOp::Add, "b", "i", "2"));
+        ASSERT_TRUE(wal.rotate());
+        EXPECT_FALSE(wal.rotate());   // the sealed file is not covered yet
+        wal.commit(wal.append(WalOp::Remove, "a", "i", ""));
+    }
+
+    // A crash before truncation: both files are replayed in order and the sequence continues.
+    std::vector<uint64_t> seqs;
+    WriteAheadLog::replay(walFile, [&](WalRecord&& r) { seqs.push_back(r.seq); });
+    EXPECT_EQ(seqs, (std::vector<uint64_t>{1, 2, 3}));
+
+    WriteAheadLog reopened(walFile);
+    EXPECT_EQ(reopened.lastSequence(), 3u);
+    reopened.truncateThrough(1);
+    EXPECT_TRUE(std::filesystem::exists(sealedFile));
+    reopened.truncateThrough(2);
+    EXPECT_FALSE(std::filesystem::exists(sealedFile));
+    EXPECT_EQ(WriteAheadLog::replay(walFile, nullptr), 1u);
+
+    std::remove(walFile.c_str());
+}
+
+
+// ::::: Snapshot checkpoint and recovery :::::
+// ********************************************
+
+TEST(SnapshotRecoveryTest, RecoversSnapshotPlusLogTail) {
+    const std::string walFile = "test_recovery.wal";
+    const std::string snapshotFile = "test_recovery.snapshot";
+    std::remove(walFile.c_str());
+    std::remove(snapshotFile.c_str());
+    std::remove((snapshotFile + ".manifest").c_str());
+
+    {
+        ItemManager manager;
+        manager.enableWriteAheadLog(walFile);
+        manager.addItem(std::make_shared<int>(1), "a");
+        manager.addItem(std::make_shared<std::string>("keep"), "b");
+        manager.addItem(std::make_shared<int>(3), "c");
+        ASSERT_TRUE(manager.checkpointToFile(snapshotFile));
+
+        manager.modifyItem<int>("a", [](int& v) { v = 10; });
+        manager.removeByTag("b");
+        manager.addItem(std::make_shared<int>(4), "d");
+        manager.modifyItem<int>("d", [](int& v) { v = 5; });
+    }
+
+    // Only the mutations made after the checkpoint are left in the log.
+    EXPECT_EQ(WriteAheadLog::replay(walFile, nullptr), 4u);
+
+    ItemManager recovered;
+    recovered.addItem(std::make_shared<int>(0), "registration_int");
+    recovered.addItem(std::make_shared<std::string>(""), "registration_string");
+    ASSERT_TRUE(recovered.recoverFromSnapshot(snapshotFile, walFile, 4));
+
+    EXPECT_EQ(recovered.getItem<int>("a").value_or(-1), 10);
+    EXPECT_FALSE(recovered.hasItem("b"));
+    EXPECT_EQ(recovered.getItem<int>("c").value_or(-1), 3);
+    EXPECT_EQ(recovered.getItem<int>("d").value_or(-1), 5);
+    EXPECT_FALSE(recovered.hasItem("registration_int"));
+
+    // Without the manifest the whole log is replayed over the snapshot, with the same result.
+    std::remove((snapshotFile + ".manifest").c_str());
+    ASSERT_TRUE(recovered.recoverFromSnapshot(snapshotFile, walFile, 1));
+    EXPECT_EQ(recovered.getItem<int>("a").value_or(-1), 10);
+    EXPECT_FALSE(recovered.hasItem("b"));
+    EXPECT_EQ(recovered.getItem<int>("d").value_or(-1), 5);
+
+    std::remove(walFile.c_str());
+    std::remove(snapshotFile.c_str());
+}
+
+
+TEST(SnapshotRecoveryTest, UndoAfterCheckpointSurvivesRecovery) {
+    const std::string walFile = "test_recovery_undo.wal";
+    const std::string snapshotFile = "test_recovery_undo.snapshot";
+    std::remove(walFile.c_str());
+    std::remove(snapshotFile.c_str());
+    std::remove((snapshotFile + ".manifest").c_str());
+
+    {
+        ItemManager manager;
+        manager.enableWriteAheadLog(walFile);
+        manager.addItem(std::make_shared<int>(1), "a");
+        manager.addItem(std::make_shared<int>(2), "undone");
+        ASSERT_TRUE(manager.checkpointToFile(snapshotFile));
+        manager.undo();
+        manager.getItemRaw<int>("a") = 5;
+    }
+
+    ItemManager recovered;
+    recovered.addItem(std::make_shared<int>(0), "registration_int");
+    ASSERT_TRUE(recovered.recoverFromSnapshot(snapshotFile, walFile, 1));
+    EXPECT_FALSE(recovered.hasItem("undone"));
+    EXPECT_EQ(recovered.getItem<int>("a").value_or(-1), 5);
+
+    std::remove(walFile.c_str());
+    std::remove(snapshotFile.c_str());
+    std::remove((snapshotFile + ".manifest").c_str());
+}
+
+// ::::: Incremental (delta) export :::::
+// **************************************
+
+TEST(DeltaExportTest, ExportsOnlyChangesAndAppliesOntoBase) {
+    const std::string baseFile = "test_delta_base.json";
+    const std::string deltaFile = "test_delta_1.json";
+
+    ItemManager manager;
+    manager.addItem(std::make_shared<int>(1), "a");
+    manager.addItem(std::make_shared<int>(2), "b");
+    manager.addItem(std::make_shared<int>(3), "c");
+    manager.exportToFile_Json(baseFile);
+    const uint64_t baseSeq = manager.changeSequence();
+
+    manager.modifyItem<int>("a", [](int& v) { v = 10; });
+    manager.removeByTag("b");
+    manager.addItem(std::make_shared<int>(4), "d");
+    ASSERT_TRUE(manager.exportChangesSince(baseSeq, deltaFile));
+
+    std::ifstream in(deltaFile);
+    json delta;
+    in >> delta;
+    std::set<std::string> upserted;
+    for (const auto& entry : delta["upserts"]) upserted.insert(entry["tag"].get<std::string>());
+    EXPECT_EQ(upserted, (std::set<std::string>{"a", "d"}));
+    EXPECT_EQ(delta["removed"], json::array({"b"}));
+    EXPECT_EQ(delta["seq"].get<uint64_t>(), manager.changeSequence());
+
+    ItemManager replica;
+    replica.addItem(std::make_shared<int>(0), "registration");
+    replica.importFromFile_Json(baseFile);
+    ASSERT_TRUE(replica.applyDeltaFromFile_Json(deltaFile));
+
+    EXPECT_EQ(replica.getItem<int>("a").value_or(-1), 10);
+    EXPECT_FALSE(replica.hasItem("b"));
+    EXPECT_EQ(replica.getItem<int>("c").value_or(-1), 3);
+    EXPECT_EQ(replica.getItem<int>("d").value_or(-1), 4);
+
+    std::remove(baseFile.c_str());
+    std::remove(deltaFile.c_str());
+}
+
+TEST(DeltaExportTest, UndoOnlyMarksItemsItChanged) {
+    const std::string deltaFile = "test_delta_undo.json";
+
+    ItemManager manager;
+    manager.addItem(std::make_shared<int>(1), "a");
+    manager.addItem(std::make_shared<int>(2), "b");
+    manager.modifyItem<int>("a", [](int& v) { v = 5; });
+    const uint64_t seq = manager.changeSequence();
+
+    manager.undo();
+    ASSERT_TRUE(manager.exportChangesSince(seq, deltaFile));
+
+    std::ifstream in(deltaFile);
+    json delta;
+    in >> delta;
+    ASSERT_EQ(delta["upserts"].size(), 1u);
+    EXPECT_EQ(delta["upserts"][0]["tag"], "a");
+    EXPECT_EQ(delta["upserts"][0]["data"]["data"], 1);
+    EXPECT_TRUE(delta["removed"].empty());
+
+    std::remove(deltaFile.c_str());
+}
+
+TEST(DeltaExportTest, UndoAndRedoMarkWritesMadeInPlace) {
+    const std::string deltaFile = "test_delta_redo.json";
+    ItemManager manager;
+    auto changesSince = [&](uint64_t seq) {
+        EXPECT_TRUE(manager.exportChangesSince(seq, deltaFile));
+        std::ifstream in(deltaFile);
+        json delta;
+        in >> delta;
+        std::map<std::string, json> upserts;
+        for (const auto& entry : delta["upserts"]) upserts[entry["tag"]] = entry["data"]["data"];
+        return std::make_pair(upserts, delta["removed"]);
+    };
+
+    manager.addItem(std::make_shared<int>(1), "a");
+    manager.addItem(std::make_shared<int>(2), "b");
+    manager.addItem(std::make_shared<int>(3), "c");
+    manager.getItemRaw<int>("b") = 20;   // no undo state of its own
+    uint64_t seq = manager.changeSequence();
+
+    manager.undo();   // back to before "c": the in-place write to "b" is undone too
+    auto [upserts, removed] = changesSince(seq);
+    EXPECT_EQ(upserts, (std::map<std::string, json>{{"b", 2}}));
+    EXPECT_EQ(removed, json::array({"c"}));
+
+    manager.undo();
+    seq = manager.changeSequence();
+    manager.redo();   // the oldest queued state: "b" = 20 and "c"
+    std::tie(upserts, removed) = changesSince(seq);
+    EXPECT_EQ(upserts, (std::map<std::string, json>{{"b", 20}, {"c", 3}}));
+    EXPECT_TRUE(removed.empty());
+
+    std::remove(deltaFile.c_str());
+}
+
+
+// ::::: Background checkpointer :::::
+// ***********************************
+
+namespace {
+    template<typename Pred>
+    bool waitFor(Pred pred, std::chrono::milliseconds timeout = std::chrono::milliseconds(5000)) {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!pred()) {
+            if (std::chrono::steady_clock::now() > deadline) return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return true;
+    }
+}
+
+TEST(CheckpointerTest, SavesPeriodicallyAndSkipsUnchangedCycles) {
+    const std::string file = "test_checkpointer.json";
+    std::remove(file.c_str());
+
+    ItemManager manager;
+    manager.addItem(std::make_shared<int>(7), "seven");
+
+    CheckpointOptions options;
+    options.path = file;
+    options.format = CheckpointFormat::Json;
+    options.interval = std::chrono::milliseconds(10);
+    manager.startCheckpointer(options);
+
+    ASSERT_TRUE(waitFor([&] { return manager.checkpointerStats().checkpoints >= 1; }));
+    ASSERT_TRUE(waitFor([&] { return manager.checkpointerStats().skipped >= 3; }));
+    EXPECT_EQ(manager.checkpointerStats().checkpoints, 1u);
+
+    manager.modifyItem<int>("seven", [](int& v) { v = 8; });
+    ASSERT_TRUE(waitFor([&] { return manager.checkpointerStats().checkpoints >= 2; }));
+    manager.stopCheckpointer();
+
+    const CheckpointStats stats = manager.checkpointerStats();
+    EXPECT_EQ(stats.lastSequence, manager.changeSequence());
+    EXPECT_GT(stats.bytesWritten, stats.lastBytes);
+
+    ItemManager restored;
+    restored.addItem(std::make_shared<int>(0), "registration");
+    restored.importFromFile_Json(file);
+    EXPECT_EQ(restored.getItem<int>("seven").value_or(-1), 8);
+
+    std::remove(file.c_str());
+}
+
+TEST(CheckpointerTest, WriteBandwidthIsCapped) {
+    const std::string file = "test_checkpointer_throttled.bin";
+
+    ItemManager manager;
+    for (int i = 0; i < 50; ++i) {
+        manager.addItem(std::make_shared<std::string>(std::string(200, 'x')), "item_" + std::to_string(i));
+    }
+
+    CheckpointOptions options;
+    options.path = file;
+    options.interval = std::chrono::milliseconds(1);
+    options.maxBytesPerSecond = 30 * 1024;
+    options.chunkSize = 1024;
+    manager.startCheckpointer(options);
+
+    ASSERT_TRUE(waitFor([&] { return manager.checkpointerStats().checkpoints >= 1; }));
+    manager.stopCheckpointer();
+
+    // ~15 KiB at 30 KiB/s with a 3 KiB burst cannot finish in much under 400 ms.
+    const CheckpointStats stats = manager.checkpointerStats();
+    EXPECT_GT(stats.lastBytes, 12u * 1024);
+    EXPECT_GE(stats.lastDuration.count(), 250);
+
+    std::remove(file.c_str());
+}
+
+
+// ::::: Consistent snapshots for off-lock export :::::
+// ****************************************************
+
+TEST(SnapshotViewTest, SnapshotIsIsolatedFromLaterWrites) {
+    ItemManager manager;
+    manager.addItem(std::make_shared<int>(1), "a");
+
+    ItemManager::Snapshot before = manager.snapshot();
+    EXPECT_EQ(manager.snapshot().get(), before.get());  // nothing changed: same view
+
+    manager.modifyItem<int>("a", [](int& v) { v = 2; });
+    manager.getItemRaw<int>("a") = 3;
+    manager.addItem(std::make_shared<int>(4), "b");
+
+    ItemManager::Snapshot after = manager.snapshot();
+    ASSERT_EQ(before->size(), 1u);
+    EXPECT_EQ(dynamic_cast<ItemWrapper<int>&>(*before->at("a")).getData(), 1);
+    EXPECT_EQ(dynamic_cast<ItemWrapper<int>&>(*after->at("a")).getData(), 3);
+    EXPECT_EQ(after->count("b"), 1u);
+    EXPECT_EQ(before->at("a")->getId(), after->at("a")->getId());  // copy-on-write keeps the id
+}
+
+TEST(SnapshotViewTest, ReleasedViewIsReusedInsteadOfCopied) {
+    ItemManager manager;
+    for (int i = 0; i < 4; ++i) manager.addItem(std::make_shared<int>(i), "n" + std::to_string(i));
+
+    ItemManager::Snapshot first = manager.snapshot();
+    const auto* firstMap = first.get();
+    manager.modifyItem<int>("n0", [](int& v) { v = 10; });
+    ItemManager::Snapshot second = manager.snapshot();   // `first` is still read: copied once
+    ASSERT_NE(second.get(), firstMap);
+
+    first.reset();
+    manager.removeByTag("n1");
+    manager.modifyItem<int>("n2", [](int& v) { v = 20; });
+    ItemManager::Snapshot third = manager.snapshot();   // `second` is read, `first` is free again
+    EXPECT_EQ(third.get(), firstMap);
+
+    EXPECT_EQ(third->size(), 3u);
+    EXPECT_EQ(dynamic_cast<ItemWrapper<int>&>(*third->at("n0")).getData(), 10);
+    EXPECT_EQ(dynamic_cast<ItemWrapper<int>&>(*third->at("n2")).getData(), 20);
+    EXPECT_EQ(second->size(), 4u);
+    EXPECT_EQ(dynamic_cast<ItemWrapper<int>&>(*second->at("n2")).getData(), 2);
+}
+
+TEST(SnapshotViewTest, ExportRunsAlongsideWriters) {
+    const std::string file = "test_snapshot_export.json";
+
+    ItemManager manager;
+    for (int i = 0; i < 20; ++i) manager.addItem(std::make_shared<int>(i), "n" + std::to_string(i));
+
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (int round = 0; !done; ++round) {
+            manager.modifyItem<int>("n" + std::to_string(round % 20), [round](int& v) { v = round; });
+        }
+    });
+    for (int i = 0; i < 5; ++i) manager.exportToFile_Json(file);
+    done = true;
+    writer.join();
+
+    std::ifstream in(file);
+    json exported;
+    ASSERT_NO_THROW(in >> exported);
+    EXPECT_EQ(exported.size(), 20u);
+
+    std::remove(file.c_str());
+}
+
+TEST(SnapshotViewTest, ImportsReplaceTheStoreInOneStep) {
+    const std::string file = "test_snapshot_import.json";
+    {
+        ItemManager source;
+        for (int i = 0; i < 5; ++i) source.addItem(std::make_shared<int>(i), "new" + std::to_string(i));
+        source.exportToFile_Json(file);
+    }
+
+    ItemManager manager;
+    for (int i = 0; i < 10; ++i) manager.addItem(std::make_shared<int>(i), "old" + std::to_string(i));
+
+    // Views taken while imports run see the old store or the imported one, never part of either.
+    std::atomic<bool> done{false};
+    std::atomic<int> torn{0};
+    std::thread reader([&] {
+        while (!done) {
+            ItemManager::Snapshot view = manager.snapshot();
+            const bool old = view->size() == 10 && view->count("old0");
+            const bool imported = view->size() == 5 && view->count("new0") && view->count("new4");
+            if (!old && !imported) ++torn;
+        }
+    });
+    for (int i = 0; i < 5; ++i) manager.importFromFile_Json(file);
+    done = true;
+    reader.join();
+
+    EXPECT_EQ(torn.load(), 0);
+    EXPECT_EQ(manager.snapshot()->size(), 5u);
+
+    std::remove(file.c_str());
+}
+
+
+// ::::: Forked (BGSAVE-style) save :::::
+// **************************************
+
+TEST(ForkedSaveTest, ChildWritesSnapshotWhileParentKeepsWriting) {
+    if (!ForkedSave::supported()) GTEST_SKIP() << "fork() not available";
+    const std::string file = "test_forked_save.bin";
+    std::remove(file.c_str());
+
+    ItemManager manager;
+    manager.addItem(std::make_shared<int>(1), "one");
+    manager.addItem(std::make_shared<std::string>("two"), "two");
+
+    ASSERT_TRUE(manager.startForkedSave(file));
+    manager.modifyItem<int>("one", [](int& v) { v = 100; });  // after the fork: not in the file
+
+    auto result = manager.waitForkedSave();
+    ASSERT_TRUE(result.has_value());
+    EXPECT_TRUE(result->ok);
+    EXPECT_EQ(result->exitStatus, 0);
+    EXPECT_GT(result->bytes, 0u);
+    EXPECT_FALSE(manager.isForkedSaveRunning());
+
+    ItemManager restored;
+    restored.addItem(std::make_shared<int>(0), "registration_int");
+    restored.addItem(std::make_shared<std::string>(""), "registration_string");
+    ASSERT_TRUE(restored.importFromFile_Binary(file));
+    EXPECT_EQ(restored.getItem<int>("one").value_or(-1), 1);
+    EXPECT_EQ(restored.getItem<std::string>("two").value_or(""), "two");
+
+    std::remove(file.c_str());
+}
+
+
+// ::::: AtomicFileWriter :::::
+// ****************************
+
+namespace {
+    std::string readWholeFile(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    }
+}
+
+TEST(AtomicFileWriterTest, ConcurrentWritersToSameTargetNeverMix) {
+    const std::string file = "test_atomic_concurrent.dat";
+    const size_t size = 256 * 1024;
+
+    std::vector<std::thread> writers;
+    std::atomic<int> failures{0};
+    for (char c = 'a'; c < 'a' + 8; ++c) {
+        writers.emplace_back([&, c] {
+            const std::string content(size, c);
+            for (int i = 0; i < 5; ++i) {
+                if (!AtomicFileWriter::writeAtomically(file, content)) ++failures;
+            }
+        });
+    }
+    for (auto& w : writers) w.join();
+
+    EXPECT_EQ(failures.load(), 0);
+    const std::string result = readWholeFile(file);
+    ASSERT_EQ(result.size(), size);
+    EXPECT_EQ(result.find_first_not_of(result[0]), std::string::npos);
+
+    for (const auto& entry : std::filesystem::directory_iterator(".")) {
+        EXPECT_EQ(entry.path().filename().string().rfind(file + ".tmp", 0), std::string::npos) << entry.path();
+    }
+    std::remove(file.c_str());
+}
+
+TEST(AtomicFileWriterTest, StreamedWriteCommitsOrLeavesTargetUntouched) {
+    const std::string file = "test_atomic_streamed.dat";
+    ASSERT_TRUE(AtomicFileWriter::writeAtomically(file, "old", AtomicWriteOptions{true}));
+
+    EXPECT_FALSE(AtomicFileWriter::writeAtomicallyStreamed(file, [](AtomicFileWriter::Sink& sink) {
+        sink.write("partial");
+        return false;
+    }));
+    EXPECT_EQ(readWholeFile(file), "old");
+
+    const std::string big(3 * 1024 * 1024, 'z');
+    EXPECT_TRUE(AtomicFileWriter::writeAtomicallyStreamed(file, [&](AtomicFileWriter::Sink& sink) {
+        for (int i = 0; i < 1000; ++i) sink.write("0123456789");
+        const std::string_view pieces[] = {"[", big, "]"};
+        return sink.write(pieces, 3);
+    }, AtomicWriteOptions{true, 10000 + big.size() + 2}));
+
+    const std::string result = readWholeFile(file);
+    ASSERT_EQ(result.size(), 10000 + big.size() + 2);
+    EXPECT_EQ(result.substr(0, 10), "0123456789");
+    EXPECT_EQ(result[10000], '[');
+    EXPECT_EQ(result.back(), ']');
+    std::remove(file.c_str());
+}
+
+#if !defined(_WIN32)
+TEST(AtomicFileWriterTest, NewFilesFollowTheUmask) {
+    const std::string file = "test_atomic_mode.dat";
+    const mode_t previous = ::umask(002);
+    const bool written = AtomicFileWriter::writeAtomically(file, "shared");
+    ::umask(previous);
+    ASSERT_TRUE(written);
+
+    const auto perms = std::filesystem::status(file).permissions();
+    EXPECT_NE(perms & std::filesystem::perms::group_write, std::filesystem::perms::none);
+    EXPECT_EQ(perms & std::filesystem::perms::others_write, std::filesystem::perms::none);
+    std::remove(file.c_str());
+}
+#endif
+
+
+// ::::: I/O backends :::::
+// ************************
+
+TEST(IoBackendTest, WritesAndReadsBackFilesOnEveryBackend) {
+    for (IoBackendKind kind : {IoBackendKind::ThreadPool, IoBackendKind::Auto}) {
+        IoBackendOptions options;
+        options.kind = kind;
+        options.chunkSize = 256 * 1024;
+        auto backend = IoBackend::create(options);
+        SCOPED_TRACE(backend->name());
+
+        std::vector<std::string> contents;
+        std::vector<FileWrite> writes;
+        for (int i = 0; i < 3; ++i) {
+            std::string content(3 * 1024 * 1024 + i * 777, '\0');
+            for (size_t j = 0; j < content.size(); ++j) content[j] = static_cast<char>((j * 31 + i) & 0xFF);
+            contents.push_back(std::move(content));
+        }
+        for (int i = 0; i < 3; ++i) writes.push_back({"test_io_backend_" + std::to_string(i) + ".dat", contents[i]});
+
+        ASSERT_TRUE(backend->writeFiles(writes));
+        for (int i = 0; i < 3; ++i) {
+            auto read = backend->readFile(writes[i].path);
+            ASSERT_TRUE(read.has_value());
+            EXPECT_TRUE(*read == contents[i]);
+            std::remove(writes[i].path.c_str());
+        }
+        EXPECT_FALSE(backend->readFile("test_io_backend_missing.dat").has_value());
+    }
+}
+
+
+// ::::: Memory-mapped store :::::
+// *******************************
+
+TEST(MappedStoreTest, ReopensWithoutImportAndDecodesOnAccess) {
+    const std::string storeFile = "test_mapped.store";
+    std::remove(storeFile.c_str());
+    std::remove((storeFile + ".index").c_str());
+
+    {
+        ItemManager manager;
+        manager.addItem(std::make_shared<int>(42), "n");   // already in memory when the store is enabled
+        ASSERT_TRUE(manager.enableMappedStore(storeFile));
+        manager.addItem(std::make_shared<std::string>("text"), "s");
+        manager.addItem(std::make_shared<Dummy>(Dummy{7}), "d");
+        for (int i = 0; i < 600; ++i) manager.addItem(std::make_shared<int>(i), "k" + std::to_string(i));
+        manager.modifyItem<int>("n", [](int& v) { v = 43; });
+        manager.removeByTag("k5");
+    }
+
+    ItemManager reopened;
+    ASSERT_TRUE(reopened.enableMappedStore(storeFile));
+    auto stats = reopened.mappedStoreStats();
+    ASSERT_TRUE(stats.has_value());
+    EXPECT_EQ(stats->records, 602u);
+    EXPECT_FALSE(stats->indexRebuilt);
+
+    // Nothing was imported; items are found in the mapping.
+    EXPECT_TRUE(reopened.getItemMapStore().empty());
+    EXPECT_EQ(reopened.getItem<int>("n").value_or(-1), 43);
+    EXPECT_EQ(reopened.getItem<int>("k599").value_or(-1), 599);
+    EXPECT_EQ(reopened.getItem<std::string>("s").value_or(""), "text");
+    EXPECT_FALSE(reopened.hasItem("k5"));
+    EXPECT_TRUE(reopened.getItemMapStore().empty());   // scalars are read without decoding
+
+    // Decoding items outside getItem<T> (exports, disable) needs their types registered.
+    reopened.addItem(std::make_shared<Dummy>(), "registration");
+    reopened.addItem(std::make_shared<std::string>(), "registration_string");
+    EXPECT_EQ(reopened.getItem<Dummy>("d").value_or(Dummy{}).value, 7);
+    EXPECT_TRUE(reopened.modifyItem<int>("k7", [](int& v) { v = 700; }));
+    EXPECT_EQ(reopened.snapshot()->size(), 604u);
+    reopened.disableMappedStore();
+    EXPECT_EQ(reopened.getItemMapStore().size(), 604u);
+
+    ItemManager third;
+    ASSERT_TRUE(third.enableMappedStore(storeFile));
+    EXPECT_EQ(third.getItem<int>("k7").value_or(-1), 700);
+    EXPECT_TRUE(third.hasItem("registration"));
+
+    third.disableMappedStore();
+    std::remove(storeFile.c_str());
+    std::remove((storeFile + ".index").c_str());
+}
+
+TEST(MappedStoreTest, RebuildsLostIndexAndCompacts) {
+    const std::string storeFile = "test_mapped_rebuild.store";
+    std::remove(storeFile.c_str());
+    std::remove((storeFile + ".index").c_str());
+
+    {
+        ItemManager manager;
+        ASSERT_TRUE(manager.enableMappedStore(storeFile));
+        for (int i = 0; i < 100; ++i) manager.addItem(std::make_shared<int>(i), "k" + std::to_string(i));
+        for (int i = 0; i < 100; ++i) manager.modifyItem<int>("k" + std::to_string(i), [](int& v) { v += 1000; });
+        manager.removeByTag("k0");
+    }
+    std::remove((storeFile + ".index").c_str());   // as if the index never reached the disk
+
+    ItemManager reopened;
+    ASSERT_TRUE(reopened.enableMappedStore(storeFile));
+    auto before = reopened.mappedStoreStats();
+    ASSERT_TRUE(before.has_value());
+    EXPECT_TRUE(before->indexRebuilt);
+    EXPECT_EQ(before->records, 99u);
+    EXPECT_EQ(reopened.getItem<int>("k42").value_or(-1), 1042);
+    EXPECT_FALSE(reopened.hasItem("k0"));
+
+    reopened.compactMappedStore();
+    auto after = reopened.mappedStoreStats();
+    EXPECT_EQ(after->records, 99u);
+    EXPECT_LT(after->usedBytes, before->usedBytes / 2);
+    EXPECT_EQ(reopened.getItem<int>("k99").value_or(-1), 1099);
+
+    reopened.disableMappedStore();
+    std::remove(storeFile.c_str());
+    std::remove((storeFile + ".index").c_str());
+}
+
+// ::::: Log-structured segments :::::
+// ***********************************
+
+TEST(SegmentLogTest, ReopensFromFootersAndCompactsDeadVersions) {
+    const std::string dir = "test_segments";
+    std::filesystem::remove_all(dir);
+
+    SegmentLogOptions options;
+    options.segmentBytes = 4096;
+    options.compactionInterval = std::chrono::milliseconds(0);   // compacted by hand below
+
+    {
+        ItemManager manager;
+        ASSERT_TRUE(manager.enableSegmentLog(dir, options));
+        for (int i = 0; i < 40; ++i) manager.addItem(std::make_shared<int>(i), "k" + std::to_string(i));
+        for (int round = 1; round <= 5; ++round) {
+            for (int i = 0; i < 40; ++i) manager.modifyItem<int>("k" + std::to_string(i), [round](int& v) { v += round; });
+        }
+        manager.removeByTag("k0");
+
+        auto before = manager.segmentLogStats();
+        ASSERT_TRUE(before.has_value());
+        EXPECT_GT(before->segments, 3u);
+        EXPECT_EQ(before->records, 39u);
+        EXPECT_GT(before->deadBytes, before->sealedBytes / 2);
+
+        ASSERT_TRUE(manager.compactSegmentLog());
+        auto after = manager.segmentLogStats();
+        EXPECT_EQ(after->compactions, 1u);
+        EXPECT_EQ(after->deadBytes, 0u);
+        EXPECT_GT(after->reclaimedBytes, 0u);
+        EXPECT_LT(after->totalBytes, before->totalBytes);
+        manager.modifyItem<int>("k1", [](int& v) { v = 1000; });   // lands after the merge
+    }
+
+    ItemManager reopened;
+    reopened.addItem(std::make_shared<int>(0), "registration");
+    ASSERT_TRUE(reopened.enableSegmentLog(dir, options));
+    auto stats = reopened.segmentLogStats();
+    EXPECT_GE(stats->footersRead, 1u);
+    EXPECT_EQ(stats->records, 40u);   // 39 logged + "registration"
+    EXPECT_FALSE(reopened.hasItem("k0"));
+    EXPECT_EQ(reopened.getItem<int>("k1").value_or(-1), 1000);
+    EXPECT_EQ(reopened.getItem<int>("k7").value_or(-1), 7 + 15);
+    EXPECT_EQ(reopened.getItem<int>("k39").value_or(-1), 39 + 15);
+
+    reopened.disableSegmentLog();
+    std::filesystem::remove_all(dir);
+}
+
+TEST(SegmentLogTest, RawWritesReachTheLogAtTheNextFlush) {
+    const std::string dir = "test_segments_raw";
+    std::filesystem::remove_all(dir);
+
+    SegmentLogOptions options;
+    options.compactionInterval = std::chrono::milliseconds(0);
+    {
+        ItemManager manager;
+        ASSERT_TRUE(manager.enableSegmentLog(dir, options));
+        manager.addItem(std::make_shared<int>(1), "x");
+        const uint64_t logged = manager.segmentLogStats()->lastSequence;
+        manager.getItemRaw<int>("x") = 42;
+        manager.getItemRaw<int>("x");
+        EXPECT_EQ(manager.segmentLogStats()->lastSequence, logged);   // nothing appended yet
+        manager.disableSegmentLog();
+    }
+
+    ItemManager reopened;
+    reopened.addItem(std::make_shared<int>(0), "registration");
+    ASSERT_TRUE(reopened.enableSegmentLog(dir, options));
+    EXPECT_EQ(reopened.getItem<int>("x").value_or(-1), 42);
+
+    reopened.disableSegmentLog();
+    std::filesystem::remove_all(dir);
+}
+
+TEST(SegmentLogTest, BackgroundCompactorRunsPastGarbageThreshold) {
+    const std::string dir = "test_segments_background";
+    std::filesystem::remove_all(dir);
+
+    SegmentLogOptions options;
+    options.segmentBytes = 2048;
+    options.garbageRatio = 0.3;
+    options.minCompactBytes = 0;
+    options.compactionInterval = std::chrono::milliseconds(10);
+
+    ItemManager manager;
+    ASSERT_TRUE(manager.enableSegmentLog(dir, options));
+    manager.addItem(std::make_shared<std::string>("v0"), "hot");
+    for (int i = 1; i <= 200; ++i) manager.modifyItem<std::string>("hot", [i](std::string& v) { v = "v" + std::to_string(i); });
+
+    ASSERT_TRUE(waitFor([&] { return manager.segmentLogStats()->compactions >= 1; }));
+    EXPECT_EQ(manager.segmentLogStats()->records, 1u);
+
+    manager.disableSegmentLog();
+    std::filesystem::remove_all(dir);
+}
+
+TEST(SegmentLogTest, CompactionStreamsMergedSegmentsLargerThanItsBuffer) {
+    const std::string dir = "test_segments_large";
+    std::filesystem::remove_all(dir);
+
+    SegmentLogOptions options;
+    options.segmentBytes = 256 * 1024;
+    options.compactionInterval = std::chrono::milliseconds(0);
+    auto payload = [](int i, int round) { return std::string(100 * 1024, static_cast<char>('a' + (i + round) % 26)); };
+
+    {
+        SegmentLog log(dir, options);
+        for (int i = 0; i < 30; ++i) log.put("big" + std::to_string(i), "blob", payload(i, 0));
+        for (int i = 0; i < 30; i += 3) log.put("big" + std::to_string(i), "blob", payload(i, 1));
+        log.roll();
+        ASSERT_TRUE(log.compact());
+        EXPECT_EQ(log.stats().deadBytes, 0u);
+    }
+
+    SegmentLog reopened(dir, options);
+    EXPECT_EQ(reopened.stats().records, 30u);
+    for (int i = 0; i < 30; ++i) {
+        auto record = reopened.read("big" + std::to_string(i));
+        ASSERT_TRUE(record.has_value());
+        EXPECT_EQ(record->type, "blob");
+        EXPECT_EQ(record->payload, payload(i, i % 3 == 0 ? 1 : 0));
+    }
+    std::filesystem::remove_all(dir);
+}
+
+// ::::: Lazy import :::::
+
+TEST(LazyImportTest, DecodesOnFirstAccessOnly) {
+    const std::string file = "test_lazy_import.json";
+    const std::string type = typeid(Dummy).name();
+
+    json entries = json::array();
+    for (int i = 0; i < 3; ++i) {
+        const std::string tag = "d" + std::to_string(i);
+        const std::string id = "obj_lazy_" + std::to_string(i);
+        entries.push_back({{"id", id}, {"tag", tag}, {"type", type},
+                           {"data", {{"id", id}, {"tag", tag}, {"type", type}, {"data", {{"value", i * 10}}}}}});
+    }
+    ASSERT_TRUE(AtomicFileWriter::writeAtomically(file, entries.dump()));
+
+    ItemManager manager;
+    manager.addItem(std::make_shared<Dummy>(), "registration");
+    manager.setLazyImport(true);
+    manager.importFromFile_Json(file);
+    auto isLazy = [&manager](const std::string& tag) {
+        return dynamic_cast<const LazyItem*>(manager.getItemMapStore().at(tag).get()) != nullptr;
+    };
+    EXPECT_TRUE(isLazy("d0") && isLazy("d1") && isLazy("d2"));
+    EXPECT_EQ(manager.getItemMapStore().at("d0")->getId(), "obj_lazy_0");
+
+    EXPECT_EQ(manager.getItem<Dummy>("d1")->value, 10);
+    EXPECT_FALSE(isLazy("d1"));
+    EXPECT_TRUE(manager.modifyItem<Dummy>("d1", [](Dummy& d) { d.value = 11; }));
+    EXPECT_EQ(manager.getItemRaw<Dummy>("d2").value, 20);
+    EXPECT_TRUE(isLazy("d0"));
+    EXPECT_EQ(manager.getItem<Dummy>("d1")->value, 11);
+
+    manager.undo();
+    EXPECT_EQ(manager.getItem<Dummy>("d1")->value, 10);
+
+    std::remove(file.c_str());
+}
+
+TEST(LazyImportTest, SnapshotOutlivesTheManager) {
+    const std::string file = "test_lazy_outlive.json";
+    const std::string type = typeid(Dummy).name();
+    json entries = json::array();
+    entries.push_back({{"id", "obj_orphan"}, {"tag", "orphan"}, {"type", type},
+                       {"data", {{"id", "obj_orphan"}, {"tag", "orphan"}, {"type", type}, {"data", {{"value", 7}}}}}});
+    ASSERT_TRUE(AtomicFileWriter::writeAtomically(file, entries.dump()));
+
+    ItemManager::Snapshot view;
+    {
+        ItemManager manager;
+        manager.addItem(std::make_shared<Dummy>(), "registration");
+        manager.setLazyImport(true);
+        manager.importFromFile_Json(file);
+        view = manager.snapshot();
+    }
+    const auto* lazy = dynamic_cast<const LazyItem*>(view->at("orphan").get());
+    ASSERT_NE(lazy, nullptr);
+    EXPECT_FALSE(lazy->isDecoded());
+    EXPECT_EQ(lazy->serialize()["data"]["value"], 7);   // decodes without the manager
+
+    std::remove(file.c_str());
+}
+
+TEST(LazyImportTest, ReExportCopiesUntouchedRecordsVerbatim) {
+    const std::string in = "test_lazy_in.bin";
+    const std::string out = "test_lazy_out.bin";
+    const std::string type = typeid(int).name();
+    // Key order and spacing serialize() never produces, so equal files mean the bytes were copied.
+    const std::string payload = R"({ "data" : 42,  "type" : ")" + type + R"(", "tag" : "answer", "id" : "obj_raw" })";
+    {
+        std::ofstream file(in, std::ios::binary);
+        auto put = [&file](const std::string& s) {
+            uint32_t size = static_cast<uint32_t>(s.size());
+            file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+            file.write(s.data(), size);
+        };
+        put(type);
+        put("answer");
+        put(payload);
+    }
+    auto readAll = [](const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), {});
+    };
+
+    ItemManager manager;
+    manager.addItem(std::make_shared<int>(0), "registration");
+    manager.setLazyImport(true);
+    ASSERT_TRUE(manager.importFromFile_Binary(in));
+    ASSERT_TRUE(manager.exportToFile_Binary(out));
+    EXPECT_EQ(readAll(out), readAll(in));
+    ASSERT_TRUE(manager.checkpointToFile(out));   // checkpoints copy the record the same way
+    EXPECT_EQ(readAll(out), readAll(in));
+    EXPECT_NE(dynamic_cast<const LazyItem*>(manager.getItemMapStore().at("answer").get()), nullptr);
+
+    EXPECT_EQ(manager.getItem<int>("answer").value_or(-1), 42);
+    EXPECT_EQ(manager.getItemMapStore().at("answer")->getId(), "obj_raw");
+    EXPECT_TRUE(manager.modifyItem<int>("answer", [](int& v) { v = 43; }));
+    ASSERT_TRUE(manager.exportToFile_Binary(out));
+    EXPECT_NE(readAll(out), readAll(in));   // written to, so serialized again
+
+    ItemManager eager;
+    eager.addItem(std::make_shared<int>(0), "registration");
+    ASSERT_TRUE(eager.importFromFile_Binary(out));
+    EXPECT_EQ(eager.getItem<int>("answer").value_or(-1), 43);
+
+    std::remove(in.c_str());
+    std::remove(out.c_str());
+    std::remove((out + ".manifest").c_str());
+}
+
+TEST(LazyImportTest, JsonReExportCopiesDataVerbatim) {
+    const std::string in = "test_lazy_in.json";
+    const std::string out = "test_lazy_out.json";
+    const std::string type = typeid(int).name();
+    const std::string data = R"({ "data" : 42,  "type" : ")" + type + R"(", "tag" : "answer", "id" : "obj_raw" })";
+    // The second record's data has no id: the entry's is added, as the eager import does.
+    const std::string file = R"({"items": [ {"tag": "answer", "type": ")" + type + R"(", "data": )" + data + R"(},
+        {"id": "obj_bare", "tag": "bare", "type": ")" + type + R"(", "data": {"data": 7}} ]})";
+    ASSERT_TRUE(AtomicFileWriter::writeAtomically(in, file));
+
+    ItemManager manager;
+    manager.addItem(std::make_shared<int>(0), "registration");
+    manager.setLazyImport(true);
+    manager.importFromFile_Json(in);
+    EXPECT_EQ(manager.getItemMapStore().at("answer")->getId(), "obj_raw");
+    EXPECT_EQ(manager.getItemMapStore().at("bare")->getId(), "obj_bare");
+
+    manager.exportToFile_Json(out);
+    std::ifstream exported(out, std::ios::binary);
+    const std::string text(std::istreambuf_iterator<char>(exported), {});
+    EXPECT_NE(text.find("\"data\": " + data + ",\n"), std::string::npos);
+    EXPECT_EQ(json::parse(text).size(), 2u);
+
+    ItemManager eager;
+    eager.addItem(std::make_shared<int>(0), "registration");
+    eager.importFromFile_Json(out);
+    EXPECT_EQ(eager.getItem<int>("answer").value_or(-1), 42);
+    EXPECT_EQ(eager.getItem<int>("bare").value_or(-1), 7);
+    EXPECT_EQ(eager.getItemMapStore().at("bare")->getId(), "obj_bare");
+
+    std::string torn = file.substr(0, file.size() - 20);
+    ASSERT_TRUE(AtomicFileWriter::writeAtomically(in, torn));
+    EXPECT_THROW(manager.importFromFile_Json(in), std::exception);
+
+    std::remove(in.c_str());
+    std::remove(out.c_str());
+}
+
+// ::::: Sidecar tag index :::::
+
+TEST(TagIndexTest, SingleObjectImportsSeekThroughSidecar) {
+    ItemManager source;
+    for (int i = 0; i < 20; ++i) source.addItem(std::make_shared<Dummy>(Dummy{i}), "d" + std::to_string(i));
+    source.setExportTagIndex(true);
+
+    const std::string type = typeid(Dummy).name();
+    const std::string json = "test_tagidx.json", bin = "test_tagidx.bin", xml = "test_tagidx.xml", csv = "test_tagidx.csv";
+    source.exportToFile_Json(json);
+    ASSERT_TRUE(source.exportToFile_Binary(bin));
+    ASSERT_TRUE(source.exportToFile_XML(xml));
+    ASSERT_TRUE(source.exportToFile_CSV(csv));
+    for (const auto& file : {json, bin, xml, csv}) ASSERT_TRUE(std::filesystem::exists(TagIndex::sidecarPath(file)));
+
+    std::string text;
+    {
+        std::ifstream in(json);
+        text.assign(std::istreambuf_iterator<char>(in), {});
+    }
+    EXPECT_EQ(text, nlohmann::json::parse(text).dump(4));   // same layout as before
+
+    // Break the JSON array but keep size and mtime: only a read through the index can still succeed.
+    auto stamp = std::filesystem::last_write_time(json);
+    {
+        std::fstream io(json, std::ios::in | std::ios::out | std::ios::binary);
+        io.put('X');
+    }
+    std::filesystem::last_write_time(json, stamp);
+
+    ItemManager target;
+    target.addItem(std::make_shared<Dummy>(), "registration");
+    ASSERT_NE(target.importSingleObject_Json(json, type, "d7"), nullptr);
+    EXPECT_EQ(target.getItem<Dummy>("d7")->value, 7);
+    ASSERT_NE(target.importSingleObject_Binary(bin, type, "d8"), nullptr);
+    EXPECT_EQ(target.getItem<Dummy>("d8")->value, 8);
+    ASSERT_TRUE(target.importSingleObject_XML(xml, type, "d9").has_value());
+    EXPECT_EQ(target.getItem<Dummy>("d9")->value, 9);
+    ASSERT_NE(target.importSingleObject_CSV(csv, type, "d11"), nullptr);
+    EXPECT_EQ(target.getItem<Dummy>("d11")->value, 11);
+
+    for (const auto& file : {json, bin, xml, csv}) {
+        std::remove(file.c_str());
+        std::remove(TagIndex::sidecarPath(file).c_str());
+    }
+}
+
+TEST(TagIndexTest, StaleSidecarFallsBackToScan) {
+    const std::string bin = "test_tagidx_stale.bin";
+    const std::string type = typeid(Dummy).name();
+
+    ItemManager source;
+    source.addItem(std::make_shared<Dummy>(Dummy{1}), "a");
+    source.addItem(std::make_shared<Dummy>(Dummy{2}), "b");
+    source.setExportTagIndex(true);
+    ASSERT_TRUE(source.exportToFile_Binary(bin));
+
+    // Rewritten without an index: the old sidecar no longer describes the file.
+    source.modifyItem<Dummy>("b", [](Dummy& d) { d.value = 200; });
+    source.setExportTagIndex(false);
+    ASSERT_TRUE(source.exportToFile_Binary(bin));
+    EXPECT_FALSE(TagIndex::readRecord(bin, type, "b").has_value());
+
+    ItemManager target;
+    target.addItem(std::make_shared<Dummy>(), "registration");
+    ASSERT_NE(target.importSingleObject_Binary(bin, type, "b"), nullptr);
+    EXPECT_EQ(target.getItem<Dummy>("b")->value, 200);
+
+    std::remove(bin.c_str());
+    std::remove(TagIndex::sidecarPath(bin).c_str());
+}
+
+// ::::: Item allocation :::::
+
+namespace {
+    // Forwards to new/delete, counting what goes through.
+    class CountingResource : public std::pmr::memory_resource {
+    public:
+        std::atomic<size_t> allocations{0};
+        std::atomic<size_t> live{0};
+
+    private:
+        void* do_allocate(size_t bytes, size_t align) override {
+            ++allocations;
+            ++live;
+            return std::pmr::new_delete_resource()->allocate(bytes, align);
+        }
+        void do_deallocate(void* p, size_t bytes, size_t align) override {
+            --live;
+            std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+        }
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+    };
+}
+
+TEST(ItemAllocatorTest, WrappersClonesAndImportsUsePluggedResource) {
+    const std::string file = "test_allocator.bin";
+    auto counting = std::make_shared<CountingResource>();
+    {
+        ItemManager manager;
+        manager.setMemoryResource(counting);
+        EXPECT_EQ(manager.memoryResource(), counting);
+
+        for (int i = 0; i < 50; ++i) manager.addItem(std::make_shared<Dummy>(Dummy{i}), "k" + std::to_string(i));
+        EXPECT_GE(counting->allocations.load(), 50u);
+
+        size_t before = counting->allocations;
+        manager.modifyItem<Dummy>("k0", [](Dummy& d) { d.value = -1; });   // undo clone of every item
+        EXPECT_GE(counting->allocations - before, 50u);
+
+        ASSERT_TRUE(manager.exportToFile_Binary(file));
+        before = counting->allocations;
+        ASSERT_TRUE(manager.importFromFile_Binary(file));
+        EXPECT_GE(counting->allocations - before, 100u);   // decoded wrappers and payloads
+        EXPECT_EQ(manager.getItem<Dummy>("k0")->value, -1);
+    }
+    EXPECT_EQ(counting->live.load(), 0u);
+    std::remove(file.c_str());
+}
+
+TEST(ItemAllocatorTest, SnapshotOutlivesManagerAndItsPool) {
+    ItemManager::Snapshot view;
+    {
+        ItemManager manager;
+        manager.addItem(std::make_shared<std::string>("kept"), "s");
+        manager.addItem(std::make_shared<int>(5), "n");
+        view = manager.snapshot();
+    }
+    EXPECT_EQ(view->at("n")->serialize()["data"], 5);
+    EXPECT_EQ(view->at("s")->clone()->getTag(), "s");
+}
+
+// ::::: Emplace :::::
+
+TEST(EmplaceTest, EmplaceTryEmplaceAndInsertOrAssign) {
+    ItemManager manager;
+    manager.emplaceItem<Dummy>("a", 5);
+    EXPECT_EQ(manager.getItem<Dummy>("a")->value, 5);
+    EXPECT_THROW(manager.emplaceItem<Dummy>("a", 6), std::runtime_error);
+
+    EXPECT_FALSE(manager.tryEmplace<Dummy>("a", 9));
+    EXPECT_EQ(manager.getItem<Dummy>("a")->value, 5);
+    EXPECT_TRUE(manager.tryEmplace<Dummy>("b", 7));
+    EXPECT_EQ(manager.getItem<Dummy>("b")->value, 7);
+
+    EXPECT_FALSE(manager.insertOrAssign<std::string>("a", 3, 'x'));   // replaced, type and all
+    EXPECT_EQ(manager.getItem<std::string>("a").value_or(""), "xxx");
+    EXPECT_TRUE(manager.insertOrAssign<int>("c", 42));
+    EXPECT_TRUE(manager.modifyItem<int>("c", [](int& v) { ++v; }));
+    EXPECT_EQ(manager.getItem<int>("c").value_or(0), 43);
+
+    manager.undo();
+    manager.undo();
+    manager.undo();
+    EXPECT_EQ(manager.getItem<Dummy>("a")->value, 5);
+    EXPECT_FALSE(manager.hasItem("c"));
+}
+
+TEST(EmplaceTest, OneAllocationPerEmplaceAndPerUndoClone) {
+    auto counting = std::make_shared<CountingResource>();
+    ItemManager manager;
+    manager.setMemoryResource(counting);
+
+    manager.emplaceItem<Dummy>("first", 1);
+    EXPECT_EQ(counting->allocations.load(), 1u);   // control block, wrapper and payload together
+
+    manager.emplaceItem<Dummy>("second", 2);
+    EXPECT_EQ(counting->allocations.load(), 3u);   // undo clone of "first" + the new item
+    EXPECT_EQ(manager.getItem<Dummy>("second")->value, 2);
+}
+
+// ::::: Type ids :::::
+
+TEST(TypeIdTest, CompileTimeIdsKeyTheRegistries) {
+    static_assert(TypeIds::of<int>() != TypeIds::of<long>());
+    static_assert(TypeIds::of<Dummy>() == TypeIds::hash("Dummy"));
+    EXPECT_EQ(TypeIds::nameOf<Dummy>(), "Dummy");
+    EXPECT_EQ(TypeIds::nameOf<std::vector<int>>().substr(0, 11), "std::vector");
+
+    ItemManager manager;
+    manager.addItem(std::make_shared<Dummy>(Dummy{3}), "d");
+    EXPECT_EQ(manager.demangleType(typeid(Dummy).name()), "Dummy");   // seeded at registration
+
+    // Records still carry the typeid() name and resolve to the registered type.
+    const std::string file = "test_typeid.bin";
+    ASSERT_TRUE(manager.exportToFile_Binary(file));
+    ItemManager other;
+    other.addItem(std::make_shared<Dummy>(), "registration");
+    ASSERT_TRUE(other.importFromFile_Binary(file));
+    EXPECT_EQ(other.getItem<Dummy>("d")->value, 3);
+    std::remove(file.c_str());
+}
+
+// ::::: Type dispatch :::::
+
+TEST(TypeDispatchTest, ImportsResolveEachTypeToItsSlot) {
+    const std::string file = "test_dispatch.bin";
+    {
+        ItemManager manager;
+        for (int i = 0; i < 200; ++i) {
+            // Interleaved types, so the per-import cache misses its last hit on every record.
+            manager.addItem(std::make_shared<Dummy>(Dummy{i}), "d" + std::to_string(i));
+            manager.addItem(std::make_shared<std::string>("s" + std::to_string(i)), "s" + std::to_string(i));
+        }
+        ASSERT_TRUE(manager.exportToFile_Binary(file));
+    }
+
+    // Records of a type this manager has no slot for are skipped; the others import.
+    ItemManager manager;
+    manager.addItem(std::make_shared<std::string>("registration"), "registration");
+    ASSERT_TRUE(manager.importFromFile_Binary(file));
+    EXPECT_FALSE(manager.hasItem("d0"));
+    EXPECT_EQ(*manager.getItem<std::string>("s150"), "s150");
+
+    // A type registered later gets the next slot and resolves on the next import.
+    manager.addItem(std::make_shared<Dummy>(Dummy{-1}), "registration_d");
+    ASSERT_TRUE(manager.importFromFile_Binary(file));
+    EXPECT_EQ(manager.getItem<Dummy>("d199")->value, 199);
+    EXPECT_EQ(*manager.getItem<std::string>("s199"), "s199");
+    std::remove(file.c_str());
+}
+
+// ::::: Static type registration :::::
+
+struct Profile {
+    std::string name;
+    std::string email;
+};
+
+void to_json(json& j, const Profile& p) {
+    j = json{{"name", p.name}, {"email", p.email}};
+}
+
+void from_json(const json& j, Profile& p) {
+    j.at("name").get_to(p.name);
+    j.at("email").get_to(p.email);   // absent in version 1 records
+}
+
+SMART_STORE_REGISTER_TYPE(Profile, 2, [](const json& j) {
+    json upgraded = j;
+    if (!upgraded["data"].contains("email")) upgraded["data"]["email"] = "unknown@example.com";
+    return upgraded;
+});
+
+TEST(StaticRegistrationTest, DeclaredTypeImportsAndMigratesWithoutAnyAddItem) {
+    const std::string file = "test_static_registration.json";
+    const std::string type = typeid(Profile).name();
+    {
+        std::ofstream out(file);
+        out << json::array({
+            {{"id", "p1"}, {"tag", "ada"}, {"type", type},
+             {"data", {{"id", "p1"}, {"tag", "ada"}, {"type", type}, {"data", {{"name", "Ada"}}}}}},
+            {{"id", "p2"}, {"tag", "bob"}, {"type", type},
+             {"data", {{"id", "p2"}, {"tag", "bob"}, {"type", type}, {"data", {{"name", "Bob"}, {"email", "bob@example.com"}}}}}}
+        }).dump();
+    }
+
+    ItemManager manager;   // Profile was installed here, with its migration
+    manager.importFromFile_Json(file);
+    ASSERT_TRUE(manager.hasItem("ada"));
+    EXPECT_EQ(manager.getItem<Profile>("ada")->email, "unknown@example.com");
+    EXPECT_EQ(manager.getItem<Profile>("bob")->email, "bob@example.com");
+
+    // addItem of an installed type does no further registration; undeclared types still register on first use.
+    manager.addItem(std::make_shared<Profile>(Profile{"Cy", "cy@example.com"}), "cy");
+    manager.addItem(std::make_shared<Dummy>(Dummy{5}), "d");
+    EXPECT_EQ(manager.getItem<Profile>("cy")->name, "Cy");
+    EXPECT_EQ(manager.getItem<Dummy>("d")->value, 5);
+    std::remove(file.c_str());
+}
+
+// ::::: Migration chains :::::
+
+TEST(MigrationChainTest, StepsRunInPlaceThroughACachedChainAndAreCounted) {
+    MigrationRegistry registry;
+    registry.registerVersion("Record", 4);
+    registry.registerMigration("Record", 1, [](json& j) { j["a"] = 1; });
+    registry.registerMigration("Record", 2, [](const json& j) {   // copying form is still accepted
+        json upgraded = j;
+        upgraded["b"] = 2;
+        return upgraded;
+    });
+    registry.registerMigration("Record", 3, [](json& j) { j["c"] = j["a"].get<int>() + j["b"].get<int>(); });
+
+    for (int i = 0; i < 100; ++i) {
+        json record = {{"id", i}};
+        EXPECT_EQ(registry.upgradeInPlace("Record", 1, record), 4);
+        EXPECT_EQ(record["c"], 3);
+    }
+    json partial = {{"a", 1}, {"b", 5}};
+    EXPECT_EQ(registry.upgradeInPlace("Record", 3, partial), 4);
+    EXPECT_EQ(partial["c"], 6);
+    json current = {{"c", 0}};
+    EXPECT_EQ(registry.upgradeInPlace("Record", 4, current), 4);
+    EXPECT_EQ(current["c"], 0);
+
+    auto counters = registry.counters();
+    EXPECT_EQ(counters.records, 101u);
+    EXPECT_EQ(counters.steps, 301u);
+    EXPECT_EQ(counters.chainsBuilt, 2u);   // one per starting version seen
+
+    // Registering a step again drops the cached chains of that type.
+    registry.registerMigration("Record", 3, [](json& j) { j["c"] = -1; });
+    json again = {{"a", 1}, {"b", 2}};
+    EXPECT_EQ(registry.upgradeToLatest("Record", 3, again)["c"], -1);
+    EXPECT_EQ(registry.counters().chainsBuilt, 3u);
+}
+
+TEST(MigrationChainTest, EveryRegisteredTypeKeepsItsVersion) {
+    MigrationRegistry registry;   // kMaxMigrationDepth bounds one chain, not the number of types
+    for (int i = 0; i < 3 * MigrationRegistry::kMaxMigrationDepth; ++i) {
+        const std::string type = "Type" + std::to_string(i);
+        registry.registerVersion(type, 2);
+        registry.registerMigration(type, 1, [i](json& j) { j["from"] = i; });
+    }
+    for (int i = 0; i < 3 * MigrationRegistry::kMaxMigrationDepth; ++i) {
+        const std::string type = "Type" + std::to_string(i);
+        json record = json::object();
+        EXPECT_EQ(registry.getLatestVersion(type), 2) << type;
+        EXPECT_EQ(registry.upgradeInPlace(type, 1, record), 2) << type;
+        EXPECT_EQ(record["from"], i);
+    }
+}
+
+// ::::: Deferred migration :::::
+
+TEST(DeferredMigrationTest, StaleRecordsMigrateOnAccessOrInTheBackground) {
+    const std::string file = "test_deferred_migration.json";
+    const std::string type = typeid(Profile).name();
+    {
+        json entries = json::array();
+        for (int i = 0; i < 300; ++i) {   // version 1: no email yet
+            const std::string tag = "old" + std::to_string(i);
+            entries.push_back({{"id", tag}, {"tag", tag}, {"type", type},
+                               {"data", {{"id", tag}, {"tag", tag}, {"type", type}, {"data", {{"name", tag}}}}}});
+        }
+        entries.push_back({{"id", "new"}, {"tag", "new"}, {"type", type}, {"version", 2},
+                           {"data", {{"id", "new"}, {"tag", "new"}, {"type", type},
+                                     {"data", {{"name", "new"}, {"email", "new@example.com"}}}}}});
+        std::ofstream(file) << entries.dump();
+    }
+
+    ItemManager manager;
+    manager.setDeferredMigration(true);
+    manager.importFromFile_Json(file);
+    EXPECT_EQ(manager.pendingMigrations(), 300u);
+    EXPECT_EQ(manager.migrationCounters().records, 0u);
+    EXPECT_EQ(manager.getItem<Profile>("new")->email, "new@example.com");   // current: decoded at import
+
+    EXPECT_EQ(manager.getItem<Profile>("old7")->email, "unknown@example.com");
+    EXPECT_EQ(manager.pendingMigrations(), 299u);
+
+    manager.startBackgroundMigration({64, std::chrono::milliseconds(1)});
+    manager.waitBackgroundMigration();
+    auto stats = manager.backgroundMigrationStats();
+    EXPECT_TRUE(stats.finished);
+    EXPECT_EQ(stats.migrated, 299u);
+    EXPECT_GE(stats.batches, 5u);
+    EXPECT_EQ(manager.pendingMigrations(), 0u);
+    EXPECT_EQ(manager.migrationCounters().records, 300u);
+    EXPECT_EQ(manager.getItem<Profile>("old299")->email, "unknown@example.com");
+    manager.stopBackgroundMigration();
+    std::remove(file.c_str());
+}
+
+TEST(DeferredMigrationTest, BackgroundMigrationPicksUpImportsThatRunMeanwhile) {
+    const std::string file = "test_deferred_migration_import.json";
+    const std::string type = typeid(Profile).name();
+    {
+        json entries = json::array();
+        for (int i = 0; i < 2000; ++i) {   // version 1: no email yet
+            const std::string tag = "old" + std::to_string(i);
+            entries.push_back({{"id", tag}, {"tag", tag}, {"type", type},
+                               {"data", {{"id", tag}, {"tag", tag}, {"type", type}, {"data", {{"name", tag}}}}}});
+        }
+        std::ofstream(file) << entries.dump();
+    }
+
+    ItemManager manager;
+    manager.setDeferredMigration(true);
+    manager.importFromFile_Json(file);
+    manager.startBackgroundMigration({16, std::chrono::milliseconds(2)});
+    manager.importFromFile_Json(file);   // fresh placeholders while the task runs
+    manager.waitBackgroundMigration();
+
+    EXPECT_TRUE(manager.backgroundMigrationStats().finished);
+    EXPECT_EQ(manager.pendingMigrations(), 0u);
+    EXPECT_EQ(manager.getItem<Profile>("old1999")->email, "unknown@example.com");
+    manager.stopBackgroundMigration();
+    std::remove(file.c_str());
+}
+
+// ::::: Offline conversion :::::
+
+TEST(RecordConverterTest, ConvertsBetweenFormatsAndMigratesOnTheWay) {
+    const std::string source = "test_convert.json";
+    const std::string type = typeid(Profile).name();
+    {
+        json entries = json::array();
+        for (int i = 0; i < 250; ++i) {   // version 1: no email yet
+            const std::string tag = "p" + std::to_string(i);
+            entries.push_back({{"id", tag}, {"tag", tag}, {"type", type},
+                               {"data", {{"id", tag}, {"tag", tag}, {"type", type}, {"data", {{"name", "n, \"" + tag + "\""}}}}}});
+        }
+        std::ofstream(source) << json{{"items", entries}}.dump(2);
+    }
+
+    MigrationRegistry migrations;
+    TypeRegistration::installMigrations(migrations);
+    RecordConverter converter(migrations);
+
+    ConvertOptions options;
+    options.from = RecordFormat::Json;
+    options.to = RecordFormat::Binary;
+    options.workers = 3;
+    options.batchSize = 16;
+    options.maxBatchesInFlight = 2;
+    auto stats = converter.convert(source, "test_convert.bin", options);
+    ASSERT_TRUE(stats.has_value());
+    EXPECT_EQ(stats->records, 250u);
+    EXPECT_EQ(stats->migrated, 250u);
+    EXPECT_EQ(stats->skipped, 0u);
+    EXPECT_GT(stats->bytesIn, 0u);
+
+    // binary -> XML -> CSV -> JSON: already current, nothing left to migrate.
+    const std::vector<std::pair<std::string, RecordFormat>> chain = {
+        {"test_convert.bin", RecordFormat::Binary}, {"test_convert.xml", RecordFormat::Xml},
+        {"test_convert.csv", RecordFormat::Csv}, {"test_convert_out.json", RecordFormat::Json}};
+    for (size_t i = 0; i + 1 < chain.size(); ++i) {
+        options.from = chain[i].second;
+        options.to = chain[i + 1].second;
+        stats = converter.convert(chain[i].first, chain[i + 1].first, options);
+        ASSERT_TRUE(stats.has_value());
+        EXPECT_EQ(stats->records, 250u);
+        EXPECT_EQ(stats->migrated, 0u);
+    }
+
+    ItemManager binary;
+    ASSERT_TRUE(binary.importFromFile_Binary("test_convert.bin"));
+    ItemManager roundTrip;
+    roundTrip.importFromFile_Json("test_convert_out.json");
+    for (ItemManager* manager : {&binary, &roundTrip}) {
+        EXPECT_EQ(manager->migrationCounters().records, 0u);   // written at the latest version
+        EXPECT_EQ(manager->getItem<Profile>("p42")->name, "n, \"p42\"");
+        EXPECT_EQ(manager->getItem<Profile>("p249")->email, "unknown@example.com");
+    }
+
+    options.from = RecordFormat::Json;
+    options.to = RecordFormat::Binary;
+    EXPECT_FALSE(converter.convert("test_convert.csv", "test_convert_bad.bin", options).has_value());   // not JSON
+    EXPECT_FALSE(std::filesystem::exists("test_convert_bad.bin"));
+    for (const char* file : {"test_convert.json", "test_convert.bin", "test_convert.xml", "test_convert.csv", "test_convert_out.json"}) {
+        std::remove(file);
+    }
+}
+
+TEST(RecordConverterTest, TruncatedInputCountsAsSkipped) {
+    ItemManager manager;
+    for (int i = 0; i < 5; ++i) manager.addItem(std::make_shared<int>(i), "n" + std::to_string(i));
+    manager.exportToFile_Json("test_torn.json");
+    ASSERT_TRUE(manager.exportToFile_Binary("test_torn.bin"));
+    ASSERT_TRUE(manager.exportToFile_XML("test_torn.xml"));
+
+    MigrationRegistry migrations;
+    RecordConverter converter(migrations);
+    ConvertOptions options;
+    options.to = RecordFormat::Csv;
+    for (const auto& [file, format] : {std::pair{"test_torn.json", RecordFormat::Json},
+                                       std::pair{"test_torn.bin", RecordFormat::Binary},
+                                       std::pair{"test_torn.xml", RecordFormat::Xml}}) {
+        options.from = format;
+        auto whole = converter.convert(file, "test_torn.csv", options);
+        ASSERT_TRUE(whole.has_value()) << file;
+        EXPECT_EQ(whole->records, 5u) << file;
+        EXPECT_EQ(whole->skipped, 0u) << file;
+
+        std::filesystem::resize_file(file, std::filesystem::file_size(file) - 30);   // inside the last record
+        auto torn = converter.convert(file, "test_torn.csv", options);
+        ASSERT_TRUE(torn.has_value()) << file;
+        EXPECT_EQ(torn->records, 4u) << file;
+        EXPECT_EQ(torn->skipped, 1u) << file;
+    }
+    for (const char* file : {"test_torn.json", "test_torn.bin", "test_torn.xml", "test_torn.csv",
+                             "test_torn.bin.manifest", "test_torn.json.tagidx", "test_torn.bin.tagidx"}) {
+        std::remove(file);
+    }
+}
+
+// ::::: Allocation budgets :::::
+
+TEST(AllocationBudgetTest, ReadsDoNotAllocate) {
+    ASSERT_TRUE(allocationCountingEnabled);
+    ItemManager manager;
+    // Tags past the small-string buffer (15 bytes in libstdc++), so any copy of one allocates.
+    const std::string prefix = "allocation_budget_item_";
+    for (int i = 0; i < 100; ++i) manager.addItem(std::make_shared<int>(i), prefix + std::to_string(i));
+    const ItemManager& view = manager;
+    const std::string tag = prefix + "42";
+
+    AllocationScope scope;
+    const int sum = view.getItemRaw<int>(tag) + manager.getItemRaw<int>(tag) + *manager.getItem<int>(tag);
+    AllocationCount reads = scope.counted();
+    EXPECT_EQ(reads.allocations, 0u) << reads.bytes << " bytes";
+    EXPECT_EQ(sum, 126);
+
+    // hasItem only pays for its log line.
+    scope.reset();
+    EXPECT_TRUE(manager.hasItem(tag));
+    EXPECT_LE(scope.counted().allocations, 6u);
+}
+
+TEST(AllocationBudgetTest, AddItemCostsAConstantPlusTheUndoCopy) {
+    // Allocations of one addItem into a store already holding `stored` items (and a warm-up one).
+    auto addItemCost = [](int stored) {
+        ItemManager manager;
+        manager.addItem(std::make_shared<int>(-1), "warm");
+        for (int i = 0; i < stored; ++i) manager.addItem(std::make_shared<int>(i), "n" + std::to_string(i));
+        auto item = std::make_shared<int>(7);
+        const std::string tag = "added";
+
+        AllocationScope scope;
+        manager.addItem(item, tag);
+        return scope.counted().allocations;
+    };
+
+    const uint64_t alone = addItemCost(0);
+    const uint64_t loaded = addItemCost(200);
+    // The wrapper, its id, the map and change-tracking entries and the log line...
+    EXPECT_LE(alone, 14u);
+    // ...and the undo copy of the store: a map node and an id per stored item.
+    EXPECT_LE(loaded - alone, 2u * 200 + 4) << alone << " allocations alone, " << loaded << " with 200 items";
+}
+
+// ::::: Metrics :::::
+
+TEST(MetricsTest, CountsCallsLockTimesAndTransfers) {
+    const std::string filename = "test_metrics_export.json";
+    ItemManager manager;
+    manager.addItem(std::make_shared<int>(0), "before");  // not counted: metrics are off
+    EXPECT_FALSE(manager.metrics().enabled);
+    EXPECT_TRUE(manager.metrics().operations.empty());
+
+    manager.setMetricsEnabled(true);
+    ASSERT_TRUE(manager.isMetricsEnabled());
+    manager.addItem(std::make_shared<int>(1), "a");
+    manager.addItem(std::make_shared<int>(2), "b");
+    EXPECT_EQ(manager.getItem<int>("a"), 1);
+    EXPECT_TRUE(manager.hasItem("b"));
+    manager.exportToFile_Json(filename);
+    manager.importFromFile_Json(filename);
+
+    const MetricsSnapshot snapshot = manager.metrics();
+    EXPECT_TRUE(snapshot.enabled);
+    const OperationMetrics* added = snapshot.find(MetricOp::AddItem);
+    ASSERT_NE(added, nullptr);
+    EXPECT_EQ(added->calls, 2u);
+    EXPECT_EQ(added->latency.count, 2u);
+    EXPECT_LE(added->latency.p50Ns, added->latency.maxNs);
+    EXPECT_EQ(snapshot.find(MetricOp::Snapshot), nullptr);  // the export's own snapshot is not a call
+
+    const OperationMetrics* exported = snapshot.find(MetricOp::ExportJson);
+    ASSERT_NE(exported, nullptr);
+    EXPECT_EQ(exported->items, 3u);
+    EXPECT_EQ(exported->bytes, std::filesystem::file_size(filename));
+    const OperationMetrics* imported = snapshot.find(MetricOp::ImportJson);
+    ASSERT_NE(imported, nullptr);
+    EXPECT_EQ(imported->items, 3u);
+    EXPECT_EQ(imported->bytes, exported->bytes);
+
+    // addItem twice, getItem, hasItem, the export's snapshot and the import's install step each took
+    // and released the store lock.
+    EXPECT_GE(snapshot.lockWait.count, 6u);
+    EXPECT_EQ(snapshot.lockHold.count, snapshot.lockWait.count);
+
+    const json report = snapshot.toJson();
+    EXPECT_EQ(report["operations"]["addItem"]["calls"], 2);
+    EXPECT_EQ(report["operations"]["exportToFile_Json"]["items"], 3);
+    EXPECT_TRUE(report["lock"]["hold"].contains("p99_ns"));
+    EXPECT_TRUE(report["migration"].contains("steps"));
+
+    // Off again: nothing more is counted, and what was counted stays until reset.
+    manager.setMetricsEnabled(false);
+    manager.addItem(std::make_shared<int>(3), "c");
+    EXPECT_EQ(manager.metrics().find(MetricOp::AddItem)->calls, 2u);
+    manager.resetMetrics();
+    EXPECT_TRUE(manager.metrics().operations.empty());
+
+    std::remove(filename.c_str());
+}
+
+TEST(MetricsTest, DumpsToFileOrCallback) {
+    const std::string filename = "test_metrics_dump.json";
+    ItemManager manager;
+    manager.setMetricsEnabled(true);
+    manager.addItem(std::make_shared<int>(1), "a");
+    manager.undo();
+
+    ASSERT_TRUE(manager.dumpMetrics(filename));
+    std::ifstream in(filename);
+    const json dumped = json::parse(in);
+    EXPECT_EQ(dumped["operations"]["addItem"]["calls"], 1);
+    EXPECT_EQ(dumped["operations"]["undo"]["calls"], 1);
+
+    uint64_t undone = 0;
+    manager.dumpMetrics([&](const MetricsSnapshot& snapshot) { undone = snapshot.find(MetricOp::Undo)->calls; });
+    EXPECT_EQ(undone, 1u);
+
+    std::remove(filename.c_str());
+}
+
+TEST(MetricsTest, HistogramPercentilesStayWithinABucket) {
+    LatencyHistogram histogram;
+    for (uint64_t ns = 1; ns <= 10000; ++ns) histogram.record(ns);
+
+    const HistogramSnapshot h = histogram.snapshot();
+    EXPECT_EQ(h.count, 10000u);
+    EXPECT_EQ(h.minNs, 1u);
+    EXPECT_EQ(h.maxNs, 10000u);
+    // Each percentile is the bound of the bucket it falls in: at or above the exact value, by under 1/16.
+    EXPECT_GE(h.p50Ns, 5000u);
+    EXPECT_LE(h.p50Ns, 5000u + 5000u / 16);
+    EXPECT_GE(h.p99Ns, 9900u);
+    EXPECT_LE(h.p99Ns, 10000u);
+    for (uint64_t ns : {0ull, 15ull, 16ull, 1000ull, 123456789ull}) {
+        EXPECT_GE(LatencyHistogram::upperBoundOf(LatencyHistogram::bucketOf(ns)), ns);
+    }
+}
+
 TEST(ItemManagerAuthorship, DisplaysAuthorSignature) {
     ItemManager manager;
     manager.showSignature();